@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+#include "Argon2Hasher.hpp"
+
+namespace mylib::crypto {
+
+/**
+ * Подбор параметров Argon2 под конкретную машину: замеряет задержку хэша
+ * при заданном числе одновременных хэшей и выбирает самые стойкие
+ * параметры, укладывающиеся в цель. Сначала растёт память (до бюджета на
+ * один хэш), затем число проходов - как рекомендует RFC 9106.
+ */
+class Argon2Calibrator {
+public:
+    // Цель, например "<= 150 мс на хэш при 8 одновременных хэшах в 1 ГиБ"
+    struct Target {
+        double max_latency_ms = 150.0;
+        unsigned int concurrency = 8;             // одновременных хэшей
+        size_t memory_budget = size_t(1) << 30;   // байт на все одновременные хэши
+        Argon2Hasher::Type type = Argon2Hasher::Type::id;
+        unsigned int min_t_cost = 1;              // для Argon2i разумно 3
+        unsigned int lanes = 0;                   // 0 - ядра / concurrency, не меньше 1
+        unsigned int repeats = 3;                 // замеров на точку, берётся медиана
+    };
+
+    // Одна точка кривой: concurrency хэшей запускаются одновременно,
+    // задержка - время до завершения последнего из них
+    struct Sample {
+        Argon2Hasher::Params params;
+        unsigned int threads;
+        double latency_ms;
+        double hashes_per_sec;     // на всю машину
+        double mib_per_sec;        // заполненной памяти на всю машину
+        bool within_target;
+    };
+
+    struct Result {
+        Target target;
+        Argon2Hasher::Params params;  // для hashPasswordWithSalt
+        unsigned int threads;
+        double latency_ms;
+        bool meets_target;           // false - даже минимальные параметры медленнее цели
+        std::vector<Sample> curve;   // все замеры в порядке выполнения
+
+        // CSV с кривой пропускной способности; строки "#" - цель и выбор
+        void writeReport(std::ostream& out) const;
+    };
+
+    /**
+     * Бросает std::invalid_argument, если concurrency, repeats или задержка
+     * нулевые, либо бюджета не хватает на минимальную память (8 блоков по
+     * 1 КиБ на дорожку) для каждого хэша
+     */
+    static Result calibrate(const Target& target);
+};
+
+} // namespace mylib::crypto
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "Argon2Hasher.hpp"
+
+namespace mylib::crypto {
+
+/**
+ * Внутрипроцессный сервис хэширования паролей для нагрузки "шторм логинов":
+ * очередь запросов, фиксированный пул рабочих потоков и общий бюджет памяти.
+ * Задание запускается, только если его m_cost помещается в остаток бюджета,
+ * поэтому суммарная память Argon2 не растёт вместе с числом запросов.
+ *
+ * Очереди ведутся по арендаторам (tenant) и обслуживаются по кругу: один
+ * шумный арендатор не задерживает остальных больше чем на одно задание.
+ * Внутри арендатора порядок FIFO. Задание, не запущенное до своего срока,
+ * завершается исключением DeadlineExceeded сразу по истечении срока, где бы
+ * оно ни стояло в очереди, и освобождает место в очереди арендатора;
+ * запущенное доводится до конца.
+ */
+class Argon2HashService {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        unsigned int workers = 0;                 // 0 - по числу ядер
+        size_t memory_budget = size_t(1) << 30;   // байт на все выполняемые задания
+        size_t max_queue_per_tenant = 0;          // 0 - без ограничения
+        Argon2Hasher::Params params;              // параметры новых хэшей
+        unsigned int threads_per_job = 0;         // 0 - по одному на дорожку
+    };
+
+    // Срок истёк до запуска задания
+    class DeadlineExceeded : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    // Очередь арендатора переполнена или сервис остановлен
+    class Rejected : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    // Снимок метрик; задержки - по последним 1024 завершённым заданиям
+    struct Metrics {
+        size_t queue_depth = 0;
+        std::map<std::string, size_t> tenant_queue_depth;
+        size_t running = 0;
+        size_t memory_in_use = 0;       // байт, занятых запущенными заданиями
+        size_t memory_peak = 0;
+        uint64_t completed = 0;         // включая задания, завершённые ошибкой Argon2
+        uint64_t expired = 0;
+        uint64_t rejected = 0;
+        double wait_p50_ms = 0;         // от постановки в очередь до запуска
+        double wait_p99_ms = 0;
+        double latency_p50_ms = 0;      // от постановки в очередь до результата
+        double latency_p99_ms = 0;
+        double latency_max_ms = 0;
+    };
+
+    Argon2HashService();
+    explicit Argon2HashService(const Options& options);
+    // Ждёт выполняемые задания; ожидающие завершаются исключением Rejected
+    ~Argon2HashService();
+
+    /**
+     * Хэш в формате Argon2Hasher::hashPasswordWithSalt с параметрами из Options
+     */
+    std::future<std::string> hash(const std::string& tenant, std::string password,
+                                  Clock::time_point deadline = Clock::time_point::max());
+
+    /**
+     * Проверка по строке хэша; память задания берётся из её параметров.
+     * Некорректная строка или m_cost больше бюджета - исключение сразу
+     */
+    std::future<bool> verify(const std::string& tenant, std::string password, std::string stored,
+                             Clock::time_point deadline = Clock::time_point::max());
+
+    Metrics metrics() const;
+
+    Argon2HashService(const Argon2HashService&) = delete;
+    Argon2HashService& operator=(const Argon2HashService&) = delete;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace mylib::crypto
@@ -5,46 +5,126 @@
 #include <random>
 #include <stdexcept>
 #include <sstream>
+#include <limits>
 #include "argon2_wrapper.hpp"
 
 namespace mylib::crypto {
 
 class Argon2Hasher {
 public:
+    using Type = argon2::Type;
+
+    // Параметры, записанные в строке хэша
+    struct Params {
+        Type type = Type::i;
+        unsigned int t_cost = 3;
+        unsigned int m_cost = 1 << 12;
+        unsigned int lanes = 1;
+    };
+
     /**
-     * Хэширует пароль + соль, возвращает "salt$hash"
+     * Хэширует пароль + соль, возвращает
+     * "$shs-argon2<type>$v=16$m=<m>,t=<t>,p=<lanes>$<salt>$<hash>".
+     * Это собственный формат библиотеки, а не строка PHC из libargon2:
+     * соль - hex-текст, и в Argon2 подаются именно его ASCII-байты, хэш
+     * тоже в hex, версия ядра 0x10. Отдельный префикс "shs-" не даёт
+     * парсерам PHC принять такую строку и молча не совпасть; строки
+     * "$argon2..." отсюда, наоборот, отклоняются с invalid_argument.
+     * Дорожки (lanes) входят в хэш и позволяют заполнять память на нескольких
+     * ядрах; threads - сколько потоков реально работает (0 - по одному на
+     * дорожку), на результат не влияет
      */
     static std::string hashPasswordWithSalt(
         const std::string& password,
         unsigned int t_cost = 3,
         unsigned int m_cost = 1 << 12,
         size_t salt_len = 16,
-        size_t out_len = 32
+        size_t out_len = 32,
+        Type type = Type::i,
+        unsigned int lanes = 1,
+        unsigned int threads = 0
     ) {
+        Params params{type, t_cost, m_cost, lanes};
         auto salt = generateSaltHex(salt_len);
-        auto hash = hashPasswordHex(password, salt, t_cost, m_cost, out_len);
+        auto hash = hashPasswordHex(password, salt, params, threads, out_len);
 
-        // Соединяем соль и хэш
-        return salt + "$" + hash;
+        return encodeParams(params) + "$" + salt + "$" + hash;
     }
 
     /**
-     * Проверяет пароль по строке "salt$hash"
+     * Проверяет пароль по строке из hashPasswordWithSalt, параметры берутся
+     * из неё. t_cost, m_cost и out_len нужны только для старых строк вида
+     * "salt$hash" (Argon2i, одна дорожка)
      */
     static bool verifyPassword(
         const std::string& password,
         const std::string& stored, 
         unsigned int t_cost = 3,
         unsigned int m_cost = 1 << 12,
-        size_t out_len = 32
+        size_t out_len = 32,
+        unsigned int threads = 0
     ) {
+        Params params{Type::i, t_cost, m_cost, 1};
         auto [salt, expected_hash] = splitSaltAndHash(stored);
+        if (isEncoded(stored)) {
+            params = storedParams(stored);
+            out_len = expected_hash.size() / 2;
+        }
 
-        auto computed_hash = hashPasswordHex(password, salt, t_cost, m_cost, out_len);
+        auto computed_hash = hashPasswordHex(password, salt, params, threads, out_len);
         return constantTimeCompare(computed_hash, expected_hash);
     }
 
+    /**
+     * Параметры строки хэша; для старого формата - значения по умолчанию
+     */
+    static Params storedParams(const std::string& stored) {
+        Params params;
+        if (!isEncoded(stored)) {
+            return params;
+        }
+        auto fields = splitFields(stored);
+        if (fields[1] == "shs-argon2i") {
+            params.type = Type::i;
+        } else if (fields[1] == "shs-argon2d") {
+            params.type = Type::d;
+        } else if (fields[1] == "shs-argon2id") {
+            params.type = Type::id;
+        } else {
+            throw std::invalid_argument("Invalid stored format: unknown type " + fields[1]);
+        }
+        if (fields[2] != "v=" + std::to_string(VERSION)) {
+            throw std::invalid_argument("Invalid stored format: unsupported version " + fields[2]);
+        }
+        std::vector<std::string> costs;
+        std::string cost;
+        std::istringstream in(fields[3]);
+        while (std::getline(in, cost, ',')) {
+            costs.push_back(cost);
+        }
+        if (costs.size() != 3 || fields[3].back() == ',') {
+            throw std::invalid_argument("Invalid stored format: bad parameters " + fields[3]);
+        }
+        params.m_cost = parseCost(costs[0], "m=");
+        params.t_cost = parseCost(costs[1], "t=");
+        params.lanes = parseCost(costs[2], "p=");
+        // Те же нижние границы, что у ядра: хотя бы один проход, одна
+        // дорожка и 8 блоков по 1 КиБ на дорожку
+        if (params.t_cost == 0 || params.lanes == 0 ||
+            params.m_cost < 8ull * params.lanes) {
+            throw std::invalid_argument("Invalid stored format: parameters out of range " + fields[3]);
+        }
+        return params;
+    }
+
+    /**
+     * Соль и хэш из строки любого формата
+     */
     static std::pair<std::string, std::string> splitSaltAndHash(const std::string& stored) {
+        if (isEncoded(stored)) {
+            auto fields = splitFields(stored);
+            return {fields[4], fields[5]};
+        }
         auto pos = stored.find('$');
         if (pos == std::string::npos) {
             throw std::invalid_argument("Invalid stored format: missing separator '$'");
@@ -55,20 +135,70 @@ public:
     }
 
 private:
+    static constexpr unsigned int VERSION = 0x10;
+
+    static bool isEncoded(const std::string& stored) {
+        return !stored.empty() && stored[0] == '$';
+    }
+
+    // "" shs-argon2<type> v= m=,t=,p= salt hash
+    static std::vector<std::string> splitFields(const std::string& stored) {
+        std::vector<std::string> fields;
+        std::string field;
+        std::istringstream in(stored);
+        while (std::getline(in, field, '$')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 6 || fields[4].empty() || fields[5].empty()) {
+            throw std::invalid_argument("Invalid stored format: expected $shs-argon2<type>$v=$m=,t=,p=$salt$hash");
+        }
+        return fields;
+    }
+
+    // "<name><digits>" без знака, пробелов и переполнения unsigned int
+    static unsigned int parseCost(const std::string& field, const char* name) {
+        const size_t prefix = std::char_traits<char>::length(name);
+        if (field.compare(0, prefix, name) != 0 || field.size() == prefix) {
+            throw std::invalid_argument("Invalid stored format: bad parameter " + field);
+        }
+        unsigned long long value = 0;
+        for (size_t i = prefix; i < field.size(); ++i) {
+            if (field[i] < '0' || field[i] > '9') {
+                throw std::invalid_argument("Invalid stored format: bad parameter " + field);
+            }
+            value = value * 10 + static_cast<unsigned int>(field[i] - '0');
+            if (value > std::numeric_limits<unsigned int>::max()) {
+                throw std::invalid_argument("Invalid stored format: parameter overflows " + field);
+            }
+        }
+        return static_cast<unsigned int>(value);
+    }
+
+    static std::string encodeParams(const Params& params) {
+        static const char* names[] = {"shs-argon2i", "shs-argon2d", "shs-argon2id"};
+        std::ostringstream out;
+        out << "$" << names[static_cast<int>(params.type)]
+            << "$v=" << VERSION
+            << "$m=" << params.m_cost << ",t=" << params.t_cost << ",p=" << params.lanes;
+        return out.str();
+    }
+
     static std::vector<uint8_t> hashPassword(
         const std::string& password,
         const std::string& salt,
-        unsigned int t_cost,
-        unsigned int m_cost,
+        const Params& params,
+        unsigned int threads,
         size_t out_len
     ) {
         std::vector<uint8_t> hash(out_len);
 
-        int result = mylib::crypto::argon2::hash_argon2i(
+        int result = mylib::crypto::argon2::hash_argon2(
+            params.type,
             hash.data(), hash.size(),
             password.data(), password.size(),
             salt.data(), salt.size(),
-            t_cost, m_cost
+            params.t_cost, params.m_cost,
+            params.lanes, threads == 0 ? params.lanes : threads
         );
 
         if (result != 0) {
@@ -83,11 +213,11 @@ private:
     static std::string hashPasswordHex(
         const std::string& password,
         const std::string& salt,
-        unsigned int t_cost,
-        unsigned int m_cost,
+        const Params& params,
+        unsigned int threads,
         size_t out_len
     ) {
-        auto hash_bytes = hashPassword(password, salt, t_cost, m_cost, out_len);
+        auto hash_bytes = hashPassword(password, salt, params, threads, out_len);
         return bytesToHex(hash_bytes);
     }
 
@@ -24,12 +24,39 @@ int hash_argon2d(void* out, size_t outlen,
                  const void* salt, size_t saltlen,
                  unsigned int t_cost, unsigned int m_cost);
 
+// Вариант Argon2 для hash_argon2
+enum class Type { i, d, id };
+
+// Хэширование с заданным вариантом, числом дорожек (влияет на результат) и
+// потоков (не влияет). Пароль копируется и стирается, память очищается
+int hash_argon2(Type type, void* out, size_t outlen,
+                const void* in, size_t inlen,
+                const void* salt, size_t saltlen,
+                unsigned int t_cost, unsigned int m_cost,
+                unsigned int lanes, unsigned int threads);
+
 // Работа с контекстом
 int Argon2i(Argon2_Context* context);
 int Argon2d(Argon2_Context* context);
 int Argon2id(Argon2_Context* context);
 int Argon2ds(Argon2_Context* context);
 
+// Ядро заполнения памяти: "avx512", "avx2" или "sse2"
+const char* FillBackend();
+// Принудительный выбор ядра для бенчмарков; nullptr - автоматический выбор
+int SelectFillBackend(const char* name);
+// Дистанция предвыборки опорных блоков для Argon2i/id, 0 - без предвыборки
+uint32_t PrefetchDistance();
+int SetPrefetchDistance(uint32_t distance);
+
+// Арена памяти для повторных вызовов: ArenaAllocate/ArenaFree передаются
+// как allocate_cbk/free_cbk, освобождённые области очищаются и переиспользуются
+int ArenaAllocate(uint8_t** memory, size_t bytes);
+void ArenaFree(uint8_t* memory, size_t bytes);
+// Лимит кэша арены и тип страниц: 0 - обычные, 1 - THP, 2 - HUGETLB
+int ConfigureArena(size_t cache_limit, int pages);
+void TrimArena();
+
 // Вспомогательные функции
 const char* ErrorMessage(int error_code);
 void secure_wipe_memory(void* v, size_t n);
@@ -15,11 +15,80 @@ public:
     static constexpr size_t SALT_SIZE = 16;
     static constexpr size_t PERSONAL_SIZE = 16;
 
+    static constexpr size_t XOF_UNKNOWN_LENGTH = 0xFFFFFFFF;
+
+    // Parallel is BLAKE2bp: four leaves in SIMD lanes under a root node. It
+    // produces different digests than sequential Blake2b.
+    // XOF is BLAKE2Xb. output_length is then the XOF length the output
+    // commits to (up to 2^32 - 2 bytes), or XOF_UNKNOWN_LENGTH for a stream
+    // of up to 256 GiB that can only be read with squeeze().
+    enum class Mode { Sequential, Parallel, XOF };
+
+    // Tree mode: leaf_length-byte leaves hashed on a thread pool and combined
+    // level by level through nodes of up to `fanout` children (0 puts every
+    // leaf under the root). max_depth counts the leaf level and caps the
+    // tree height; 255 means unlimited. threads = 0 uses every core.
+    struct TreeParams {
+        uint32_t leaf_length = 1u << 20;
+        uint8_t fanout = 0;
+        uint8_t max_depth = 2;
+        size_t threads = 0;
+    };
+
+    // Blake2b state captured after parameter setup and, when keyed, after
+    // compressing the key block. Hashers made from it start with a state
+    // copy. Copies of a Template share the prepared state.
+    class Template {
+    public:
+        explicit Template(size_t output_length = MAX_OUTPUT_SIZE);
+        Template(const void* key, size_t key_length, size_t output_length = MAX_OUTPUT_SIZE);
+        Template(const std::array<uint8_t, SALT_SIZE>& salt,
+                 const std::array<uint8_t, PERSONAL_SIZE>& personal,
+                 size_t output_length = MAX_OUTPUT_SIZE,
+                 const void* key = nullptr, size_t key_length = 0);
+
+        size_t output_length() const;
+
+        // One-shot hash without a heap-allocated hasher
+        void hash(const void* data, size_t length, uint8_t* out) const;
+        std::vector<uint8_t> hash(const void* data, size_t length) const;
+
+        struct State;  // defined in shsBlake2.cpp
+
+    private:
+        friend class shsBlake2;
+        std::shared_ptr<const State> state;
+    };
+
+    // One message of a hash_batch() call; key is optional
+    struct BatchMessage {
+        const void* data;
+        size_t length;
+        size_t output_length = MAX_OUTPUT_SIZE;
+        const void* key = nullptr;
+        size_t key_length = 0;
+    };
+
+    struct FileResult {
+        std::vector<uint8_t> digest;
+        uint64_t bytes;
+        double seconds;
+        double bytes_per_second;
+    };
+
 
     explicit shsBlake2(size_t output_length = MAX_OUTPUT_SIZE);
     shsBlake2(const void* key, size_t key_length, size_t output_length = MAX_OUTPUT_SIZE);
     shsBlake2(const std::vector<uint8_t>& key, size_t output_length = MAX_OUTPUT_SIZE);
 
+    explicit shsBlake2(Mode mode, size_t output_length = MAX_OUTPUT_SIZE);
+    shsBlake2(Mode mode, const void* key, size_t key_length,
+              size_t output_length = MAX_OUTPUT_SIZE);
+
+    explicit shsBlake2(const TreeParams& tree, size_t output_length = MAX_OUTPUT_SIZE);
+
+    explicit shsBlake2(const Template& prepared);
+
     shsBlake2(const std::array<uint8_t, SALT_SIZE>& salt,
               const std::array<uint8_t, PERSONAL_SIZE>& personal,
               size_t output_length = MAX_OUTPUT_SIZE);
@@ -35,6 +104,27 @@ public:
     std::vector<uint8_t> finalize();
     void finalize(void* out, size_t outlen);
 
+    // XOF mode: reads the next bytes of output. The first call ends the
+    // input; update() throws afterwards. Large reads are split across
+    // SIMD lanes and threads since output blocks are independent.
+    void squeeze(void* out, size_t length);
+    std::vector<uint8_t> squeeze(size_t length);
+    // XOF mode: moves the squeeze() position to byte `offset` of the output
+    void seek(uint64_t offset);
+
+    // Checkpoint for resuming a stream in another process: the mode, the
+    // state and the number of input bytes hashed so far, in a versioned blob
+    // authenticated with HMAC-SHA512 under mac_key. Not available in tree
+    // mode or once squeezing has started.
+    std::vector<uint8_t> export_state(const void* mac_key, size_t mac_key_length) const;
+    std::vector<uint8_t> export_state(const std::vector<uint8_t>& mac_key) const;
+    // Replaces this hasher, mode and output length included, with an
+    // exported one. Returns the input offset to continue reading from.
+    uint64_t import_state(const void* blob, size_t blob_length,
+                          const void* mac_key, size_t mac_key_length);
+    uint64_t import_state(const std::vector<uint8_t>& blob,
+                          const std::vector<uint8_t>& mac_key);
+
 
     static std::vector<uint8_t> hash(const void* data, size_t length, 
                                     size_t output_length = MAX_OUTPUT_SIZE);
@@ -42,6 +132,19 @@ public:
                                     size_t output_length = MAX_OUTPUT_SIZE);
     static std::vector<uint8_t> hash(const std::string& data, 
                                     size_t output_length = MAX_OUTPUT_SIZE);
+
+    // No hasher object and no heap allocation. Inputs of up to BLOCK_SIZE
+    // bytes (keys, IDs, short records) take a single compression of a
+    // padded stack block; longer ones a stack state.
+    static void hash_into(const void* data, size_t length, uint8_t* out,
+                          size_t output_length = MAX_OUTPUT_SIZE);
+    template <size_t N = MAX_OUTPUT_SIZE>
+    static std::array<uint8_t, N> hash_array(const void* data, size_t length) {
+        static_assert(N > 0 && N <= MAX_OUTPUT_SIZE, "Invalid output length");
+        std::array<uint8_t, N> out;
+        hash_into(data, length, out.data(), N);
+        return out;
+    }
     
 
     static std::vector<uint8_t> hash_keyed(const void* data, size_t length, 
@@ -52,6 +155,41 @@ public:
                                          size_t output_length = MAX_OUTPUT_SIZE);
 
 
+    static std::vector<uint8_t> hash_parallel(const void* data, size_t length,
+                                              size_t output_length = MAX_OUTPUT_SIZE);
+    static std::vector<uint8_t> hash_parallel(const std::vector<uint8_t>& data,
+                                              size_t output_length = MAX_OUTPUT_SIZE);
+    static std::vector<uint8_t> hash_parallel(const std::string& data,
+                                              size_t output_length = MAX_OUTPUT_SIZE);
+
+
+    // Hashes independent messages batch_lanes() at a time, one per SIMD
+    // lane. Digests are written back to back in message order, each taking
+    // its message's output_length bytes of `out`.
+    static void hash_batch(const BatchMessage* messages, size_t count, uint8_t* out);
+    static void hash_batch(const std::vector<BatchMessage>& messages, uint8_t* out);
+    // Same lanes, every message starting from `prepared`; each digest takes
+    // prepared.output_length() bytes
+    static void hash_batch(const Template& prepared, const void* const* data,
+                           const size_t* lengths, size_t count, uint8_t* out);
+
+    // Messages per compression on the running CPU: 8 (AVX-512), 4 (AVX2) or 1
+    static size_t batch_lanes();
+
+
+    static std::vector<uint8_t> hash_tree(const void* data, size_t length,
+                                          const TreeParams& tree,
+                                          size_t output_length = MAX_OUTPUT_SIZE);
+    static std::vector<uint8_t> hash_tree(const std::vector<uint8_t>& data,
+                                          const TreeParams& tree,
+                                          size_t output_length = MAX_OUTPUT_SIZE);
+
+
+    static std::vector<uint8_t> hash_xof(const void* data, size_t length, size_t output_length,
+                                         const void* key = nullptr, size_t key_length = 0);
+    static std::vector<uint8_t> hash_xof(const std::vector<uint8_t>& data, size_t output_length);
+
+
     static std::vector<uint8_t> hash_long(const void* data, size_t length, 
                                          size_t output_length);
     static std::vector<uint8_t> hash_long(const std::vector<uint8_t>& data, 
@@ -60,10 +198,25 @@ public:
                                          size_t output_length);
 
 
+    // Regular files with at least 1 MiB left to read are mmap'ed, smaller
+    // ones are read sequentially through a single buffer; pipes, sockets and
+    // other non-regular files go through a double buffer filled by a reader
+    // thread. The fd overload reads from the current offset to EOF and does
+    // not close the descriptor.
+    static FileResult hash_file(const std::string& path,
+                                size_t output_length = MAX_OUTPUT_SIZE);
+    static FileResult hash_file(int fd, size_t output_length = MAX_OUTPUT_SIZE);
+    static FileResult hash_file(const std::string& path, const TreeParams& tree,
+                                size_t output_length = MAX_OUTPUT_SIZE);
+
+
     shsBlake2(const shsBlake2&) = delete;
     shsBlake2& operator=(const shsBlake2&) = delete;
 
 private:
+    void updateState(const void* data, size_t length);
+    void readXof(uint64_t offset, uint8_t* out, size_t length);
+
     struct Impl;
     std::unique_ptr<Impl> impl;
     size_t output_len;
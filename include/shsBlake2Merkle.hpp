@@ -0,0 +1,123 @@
+#ifndef SHS_BLAKE2_MERKLE_HPP
+#define SHS_BLAKE2_MERKLE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Verified streaming over a binary Merkle tree of Blake2b-256 node hashes.
+// The input is split into fixed-size chunks; the left subtree of every
+// parent holds the largest power of two of chunks below the parent's count,
+// so a slice is proven by the sibling hashes along its path only.
+//
+// An encoding starts with the input length (8 bytes, little-endian)
+// followed by the tree in pre-order: each parent contributes its two child
+// hashes, each chunk its bytes. The inline encoding carries the chunks, the
+// outboard encoding only the header and parent hashes and is served next
+// to the original file. Slices have the inline layout either way. The
+// length is hashed into the root node, so every slice authenticates it.
+class shsBlake2Merkle {
+public:
+
+    static constexpr size_t HASH_SIZE = 32;
+    static constexpr size_t PARENT_SIZE = 2 * HASH_SIZE;
+    static constexpr size_t HEADER_SIZE = 8;
+    static constexpr size_t MIN_CHUNK_SIZE = 1024;
+    static constexpr size_t MAX_CHUNK_SIZE = size_t(1) << 24;
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 16384;
+
+    using Hash = std::array<uint8_t, HASH_SIZE>;
+
+    struct Encoded {
+        Hash root;
+        std::vector<uint8_t> encoding;
+    };
+
+    // Incremental slice verifier. Feed it the slice in pieces of any size;
+    // it checks every parent as soon as both hashes have arrived and every
+    // chunk before emitting its bytes, so nothing unverified reaches `out`.
+    // Throws std::runtime_error on the first mismatch.
+    class SliceDecoder {
+    public:
+        SliceDecoder(const shsBlake2Merkle& tree, const Hash& root,
+                     uint64_t start, uint64_t length);
+
+        // Appends the verified bytes of [start, start + length) that the
+        // new input completes
+        void update(const void* data, size_t length, std::vector<uint8_t>& out);
+
+        // True once every node of the slice has been verified
+        bool finished() const;
+
+        // Input length from the slice header; verified once the root node
+        // (the first one after the header) has been accepted
+        uint64_t content_length() const { return total; }
+
+    private:
+        struct Node {
+            uint64_t first;
+            uint64_t count;
+            Hash expected;
+            bool root;
+        };
+
+        void begin(uint64_t content_length);
+
+        size_t chunk_size;
+        size_t threads;
+        Hash root_hash;
+        uint64_t start;
+        uint64_t length;
+        uint64_t total = 0;
+        uint64_t first_chunk = 0;
+        uint64_t last_chunk = 0;
+        bool have_header = false;
+        std::vector<Node> stack;
+        std::vector<uint8_t> pending;
+    };
+
+
+    // chunk_size must be a power of two in [MIN_CHUNK_SIZE, MAX_CHUNK_SIZE].
+    // Building and verification use up to `threads` threads (0 uses every
+    // core).
+    explicit shsBlake2Merkle(size_t chunk_size = DEFAULT_CHUNK_SIZE, size_t threads = 0);
+
+    size_t chunk_size() const { return chunk_len; }
+
+    Hash root(const void* data, size_t length) const;
+    Encoded encode(const void* data, size_t length) const;
+    Encoded outboard(const void* data, size_t length) const;
+
+    // Cuts the slice covering [start, start + length) out of an inline
+    // encoding, or out of an outboard encoding plus the original data. The
+    // slice always contains at least one chunk: a range that is empty or
+    // starts past the end is widened to the last chunk. Throws std::invalid_argument if the encoding is
+    // shorter than its header claims.
+    std::vector<uint8_t> extract_slice(const void* encoded, size_t encoded_length,
+                                       uint64_t start, uint64_t length) const;
+    std::vector<uint8_t> extract_slice(const void* outboard, size_t outboard_length,
+                                       const void* data, size_t data_length,
+                                       uint64_t start, uint64_t length) const;
+
+    // One-shot SliceDecoder; also throws std::runtime_error if the slice is
+    // truncated
+    std::vector<uint8_t> decode_slice(const void* slice, size_t slice_length, const Hash& root,
+                                      uint64_t start, uint64_t length) const;
+    std::vector<uint8_t> decode(const void* encoded, size_t encoded_length,
+                                const Hash& root) const;
+
+private:
+    struct Tree;
+
+    Tree build(const uint8_t* data, uint64_t length) const;
+    std::vector<uint8_t> serialize(const Tree& tree, const uint8_t* data,
+                                   uint64_t length, bool with_chunks) const;
+    std::vector<uint8_t> slice(const uint8_t* encoded, size_t encoded_length,
+                               const uint8_t* data, uint64_t start, uint64_t length) const;
+
+    size_t chunk_len;
+    size_t threads;
+};
+
+#endif // SHS_BLAKE2_MERKLE_HPP
@@ -0,0 +1,118 @@
+#ifndef SHS_BLAKE3_HPP
+#define SHS_BLAKE3_HPP
+
+#include <array>
+#include <vector>
+#include <string>
+#include <memory>
+
+// BLAKE3. Whole 1 KiB chunks are hashed side by side, one per SIMD lane
+// (4 with SSE4.1, 8 with AVX2, 16 with AVX-512), and update_parallel()
+// additionally spreads subtrees over the shared thread pool. Every mode is
+// an XOF: finalize() returns the first output_length bytes of the stream
+// that squeeze() and seek() read.
+class shsBlake3 {
+public:
+
+    static constexpr size_t BLOCK_SIZE = 64;
+    static constexpr size_t CHUNK_SIZE = 1024;
+    static constexpr size_t KEY_SIZE = 32;
+    static constexpr size_t DEFAULT_OUTPUT_SIZE = 32;
+
+    // Selects the derive-key mode. The context string should be hardcoded,
+    // globally unique and application-specific.
+    struct DeriveKeyContext {
+        std::string context;
+    };
+
+    struct FileResult {
+        std::vector<uint8_t> digest;
+        uint64_t bytes;
+        double seconds;
+        double bytes_per_second;
+    };
+
+
+    explicit shsBlake3(size_t output_length = DEFAULT_OUTPUT_SIZE);
+    shsBlake3(const std::array<uint8_t, KEY_SIZE>& key,
+              size_t output_length = DEFAULT_OUTPUT_SIZE);
+    shsBlake3(const void* key, size_t key_length, size_t output_length = DEFAULT_OUTPUT_SIZE);
+    shsBlake3(const std::vector<uint8_t>& key, size_t output_length = DEFAULT_OUTPUT_SIZE);
+    shsBlake3(const DeriveKeyContext& derive, size_t output_length = DEFAULT_OUTPUT_SIZE);
+
+    ~shsBlake3();
+
+
+    void update(const void* data, size_t length);
+    void update(const std::vector<uint8_t>& data);
+    void update(const std::string& data);
+
+    // Same result as update(); large inputs are split into subtrees hashed
+    // on up to `threads` threads (0 uses every core)
+    void update_parallel(const void* data, size_t length, size_t threads = 0);
+
+
+    std::vector<uint8_t> finalize();
+    void finalize(void* out, size_t outlen);
+
+    // Reads the next bytes of output. The first call ends the input;
+    // update() throws afterwards.
+    void squeeze(void* out, size_t length);
+    std::vector<uint8_t> squeeze(size_t length);
+    // Moves the squeeze() position to byte `offset` of the output
+    void seek(uint64_t offset);
+
+
+    static std::vector<uint8_t> hash(const void* data, size_t length,
+                                    size_t output_length = DEFAULT_OUTPUT_SIZE);
+    static std::vector<uint8_t> hash(const std::vector<uint8_t>& data,
+                                    size_t output_length = DEFAULT_OUTPUT_SIZE);
+    static std::vector<uint8_t> hash(const std::string& data,
+                                    size_t output_length = DEFAULT_OUTPUT_SIZE);
+
+
+    static std::vector<uint8_t> hash_keyed(const void* data, size_t length,
+                                         const void* key, size_t key_length,
+                                         size_t output_length = DEFAULT_OUTPUT_SIZE);
+    static std::vector<uint8_t> hash_keyed(const std::vector<uint8_t>& data,
+                                         const std::vector<uint8_t>& key,
+                                         size_t output_length = DEFAULT_OUTPUT_SIZE);
+
+
+    static std::vector<uint8_t> derive_key(const std::string& context,
+                                           const void* material, size_t length,
+                                           size_t output_length = KEY_SIZE);
+    static std::vector<uint8_t> derive_key(const std::string& context,
+                                           const std::vector<uint8_t>& material,
+                                           size_t output_length = KEY_SIZE);
+
+
+    // Multi-threaded hash; the digest equals hash()
+    static std::vector<uint8_t> hash_parallel(const void* data, size_t length,
+                                              size_t output_length = DEFAULT_OUTPUT_SIZE);
+    static std::vector<uint8_t> hash_parallel(const std::vector<uint8_t>& data,
+                                              size_t output_length = DEFAULT_OUTPUT_SIZE);
+    static std::vector<uint8_t> hash_parallel(const std::string& data,
+                                              size_t output_length = DEFAULT_OUTPUT_SIZE);
+
+
+    // Mapped windows are hashed with update_parallel(). The fd overload
+    // reads from the current offset to EOF and does not close the descriptor.
+    static FileResult hash_file(const std::string& path,
+                                size_t output_length = DEFAULT_OUTPUT_SIZE);
+    static FileResult hash_file(int fd, size_t output_length = DEFAULT_OUTPUT_SIZE);
+
+    // Kernel picked for the running CPU: "avx512", "avx2", "sse41" or "portable"
+    static const char* backend();
+
+
+    shsBlake3(const shsBlake3&) = delete;
+    shsBlake3& operator=(const shsBlake3&) = delete;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+    size_t output_len;
+};
+
+#endif // SHS_BLAKE3_HPP
@@ -0,0 +1,71 @@
+#ifndef SHS_HKDF_SHA512_HPP
+#define SHS_HKDF_SHA512_HPP
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * HKDF-SHA512 (RFC 5869). An instance is keyed with the PRK once, so every
+ * expand block of every label resumes from the same cached HMAC pad states.
+ */
+class shsHKDFSHA512 {
+public:
+
+    static constexpr size_t HASH_SIZE = 64;
+    static constexpr size_t MAX_OUTPUT_SIZE = 255 * HASH_SIZE;
+
+    // One labeled subkey: info and the caller buffer it is written into
+    struct Label {
+        const uint8_t* info;
+        size_t info_length;
+        uint8_t* out;
+        size_t out_length;
+    };
+
+
+    // From an existing pseudorandom key (skips extract)
+    shsHKDFSHA512(const uint8_t* prk, size_t prk_length);
+    explicit shsHKDFSHA512(const std::vector<uint8_t>& prk);
+
+    // Extract PRK = HMAC(salt, ikm), then key expand with it
+    shsHKDFSHA512(const uint8_t* salt, size_t salt_length,
+                  const uint8_t* ikm, size_t ikm_length);
+    shsHKDFSHA512(const std::vector<uint8_t>& salt, const std::vector<uint8_t>& ikm);
+
+    ~shsHKDFSHA512();
+
+
+    void expand(const uint8_t* info, size_t info_length,
+                uint8_t* out, size_t out_length) const;
+    std::vector<uint8_t> expand(const std::vector<uint8_t>& info, size_t length) const;
+    std::vector<uint8_t> expand(const std::string& info, size_t length) const;
+
+    void expand_many(const Label* labels, size_t count) const;
+
+
+    static std::array<uint8_t, HASH_SIZE> extract(const uint8_t* salt, size_t salt_length,
+                                                  const uint8_t* ikm, size_t ikm_length);
+    static std::array<uint8_t, HASH_SIZE> extract(const std::vector<uint8_t>& salt,
+                                                  const std::vector<uint8_t>& ikm);
+
+    // Extract + expand in one call; derive_many keeps all state on the stack
+    static std::vector<uint8_t> derive(const std::vector<uint8_t>& salt,
+                                       const std::vector<uint8_t>& ikm,
+                                       const std::vector<uint8_t>& info,
+                                       size_t length);
+    static void derive_many(const uint8_t* salt, size_t salt_length,
+                            const uint8_t* ikm, size_t ikm_length,
+                            const Label* labels, size_t count);
+
+
+    shsHKDFSHA512(const shsHKDFSHA512&) = delete;
+    shsHKDFSHA512& operator=(const shsHKDFSHA512&) = delete;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+#endif // SHS_HKDF_SHA512_HPP
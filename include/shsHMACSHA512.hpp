@@ -0,0 +1,75 @@
+#ifndef SHS_HMAC_SHA512_HPP
+#define SHS_HMAC_SHA512_HPP
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * HMAC-SHA512 keyed once: the constructor compresses the ipad and opad
+ * blocks and every MAC resumes from those cached midstates.
+ *
+ * update()/finalize() form a streaming MAC that resets itself to the keyed
+ * state after finalize(); mac()/mac_batch() are one-shot and leave the
+ * stream untouched, so a single object can serve both.
+ */
+class shsHMACSHA512 {
+public:
+
+    static constexpr size_t BLOCK_SIZE = 128;
+    static constexpr size_t OUTPUT_SIZE = 64;
+    // Shortest tag verify_truncated() accepts (128 bits)
+    static constexpr size_t MIN_TRUNCATED_TAG_SIZE = 16;
+
+
+    shsHMACSHA512(const uint8_t* key, size_t key_length);
+    explicit shsHMACSHA512(const std::vector<uint8_t>& key);
+    explicit shsHMACSHA512(const std::string& key);
+
+    ~shsHMACSHA512();
+
+
+    void update(const std::vector<uint8_t>& data);
+    void update(const std::string& data);
+    void update(const uint8_t* data, size_t length);
+
+    std::array<uint8_t, OUTPUT_SIZE> finalize();
+    void finalize(uint8_t* out);
+    void reset();
+
+
+    std::array<uint8_t, OUTPUT_SIZE> mac(const std::vector<uint8_t>& data) const;
+    std::array<uint8_t, OUTPUT_SIZE> mac(const std::string& data) const;
+    std::array<uint8_t, OUTPUT_SIZE> mac(const uint8_t* data, size_t length) const;
+    void mac(const uint8_t* data, size_t length, uint8_t* out) const;
+
+    // Tags are written back to back: out must hold count * OUTPUT_SIZE bytes
+    void mac_batch(const uint8_t* const* data, const size_t* lengths,
+                   size_t count, uint8_t* out) const;
+    std::vector<std::array<uint8_t, OUTPUT_SIZE>> mac_batch(
+        const std::vector<std::vector<uint8_t>>& messages) const;
+
+    // Constant-time check of a full OUTPUT_SIZE-byte tag
+    bool verify(const uint8_t* data, size_t length, const uint8_t* tag) const;
+    // Constant-time check of the first tag_length bytes of the MAC; tags shorter
+    // than MIN_TRUNCATED_TAG_SIZE or longer than OUTPUT_SIZE are rejected
+    bool verify_truncated(const uint8_t* data, size_t length,
+                          const uint8_t* tag, size_t tag_length) const;
+
+
+    static std::array<uint8_t, OUTPUT_SIZE> hash(const std::vector<uint8_t>& key,
+                                                 const std::vector<uint8_t>& data);
+    static std::array<uint8_t, OUTPUT_SIZE> hash(const std::string& key,
+                                                 const std::string& data);
+
+
+    shsHMACSHA512(const shsHMACSHA512&) = delete;
+    shsHMACSHA512& operator=(const shsHMACSHA512&) = delete;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+#endif // SHS_HMAC_SHA512_HPP
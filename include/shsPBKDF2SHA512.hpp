@@ -0,0 +1,49 @@
+#ifndef SHS_PBKDF2_SHA512_HPP
+#define SHS_PBKDF2_SHA512_HPP
+
+#include <string>
+#include <vector>
+
+/*
+ * PBKDF2-HMAC-SHA512 (RFC 8018) for verifying legacy password hashes.
+ *
+ * After the first HMAC every iteration hashes exactly 64 bytes, so the loop
+ * runs on precomputed ipad/opad midstates with a constant padding block and
+ * never touches the byte-oriented SHA-512 API. Independent output blocks of
+ * one derivation and all blocks of a batch are spread across SIMD lanes
+ * (8 with AVX-512, 4 with AVX2).
+ */
+class shsPBKDF2SHA512 {
+public:
+
+    static constexpr size_t HASH_SIZE = 64;
+
+    struct Job {
+        const uint8_t* password;
+        size_t password_length;
+        const uint8_t* salt;
+        size_t salt_length;
+        uint32_t iterations;
+        uint8_t* out;
+        size_t out_length;
+    };
+
+
+    static void derive(const uint8_t* password, size_t password_length,
+                       const uint8_t* salt, size_t salt_length,
+                       uint32_t iterations, uint8_t* out, size_t out_length);
+    static std::vector<uint8_t> derive(const std::string& password,
+                                       const std::vector<uint8_t>& salt,
+                                       uint32_t iterations, size_t length = HASH_SIZE);
+
+    // Jobs may differ in password, salt, iteration count and output length
+    static void derive_batch(const Job* jobs, size_t count);
+
+    static bool verify(const std::string& password, const std::vector<uint8_t>& salt,
+                       uint32_t iterations, const std::vector<uint8_t>& expected);
+
+    // Number of SIMD lanes the running CPU processes per compression
+    static unsigned lanes();
+};
+
+#endif // SHS_PBKDF2_SHA512_HPP
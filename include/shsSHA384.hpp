@@ -0,0 +1,36 @@
+#ifndef SHS_SHA384_HPP
+#define SHS_SHA384_HPP
+
+#include <string>
+#include <vector>
+#include <array>
+
+class shsSHA384 {
+public:
+    static constexpr size_t DIGEST_SIZE = 48;
+
+    shsSHA384();
+    ~shsSHA384();
+
+
+    void update(const std::vector<uint8_t>& data);
+    void update(const std::string& data);
+    void update(const uint8_t* data, size_t length);
+
+    std::array<uint8_t, DIGEST_SIZE> finalize();
+
+
+    static std::array<uint8_t, DIGEST_SIZE> hash(const std::vector<uint8_t>& data);
+    static std::array<uint8_t, DIGEST_SIZE> hash(const std::string& data);
+    static std::array<uint8_t, DIGEST_SIZE> hash(const uint8_t* data, size_t length);
+
+
+    shsSHA384(const shsSHA384&) = delete;
+    shsSHA384& operator=(const shsSHA384&) = delete;
+
+private:
+    struct Impl;
+    Impl* impl;
+};
+
+#endif // SHS_SHA384_HPP
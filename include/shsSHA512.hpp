@@ -7,6 +7,13 @@
 
 class shsSHA512 {
 public:
+    struct FileResult {
+        std::array<uint8_t, 64> digest;
+        uint64_t bytes;
+        double seconds;
+        double bytes_per_second;
+    };
+
     shsSHA512();
     ~shsSHA512();
 
@@ -17,11 +24,37 @@ public:
 
     std::array<uint8_t, 64> finalize();  
 
+    // Checkpoint of the streaming state; see shsBlake2::export_state.
+    // import_state() returns the number of input bytes already hashed.
+    std::vector<uint8_t> export_state(const uint8_t* mac_key, size_t mac_key_length) const;
+    std::vector<uint8_t> export_state(const std::vector<uint8_t>& mac_key) const;
+    uint64_t import_state(const uint8_t* blob, size_t blob_length,
+                          const uint8_t* mac_key, size_t mac_key_length);
+    uint64_t import_state(const std::vector<uint8_t>& blob,
+                          const std::vector<uint8_t>& mac_key);
+
 
     static std::array<uint8_t, 64> hash(const std::vector<uint8_t>& data);
     static std::array<uint8_t, 64> hash(const std::string& data);
     static std::array<uint8_t, 64> hash(const uint8_t* data, size_t length);
 
+    // Fixed-size inputs (Merkle nodes, keys, chained digests) skip buffering
+    // and hash a single precomputed-padding block
+    static std::array<uint8_t, 64> hash(const std::array<uint8_t, 32>& data);
+    static std::array<uint8_t, 64> hash(const std::array<uint8_t, 64>& data);
+    static std::array<uint8_t, 64> hash(const std::array<uint8_t, 96>& data);
+
+    // H^n(seed): SHA-512 applied n times; n = 0 returns seed
+    static std::array<uint8_t, 64> iterate(const std::array<uint8_t, 64>& seed, uint64_t n);
+
+    // Regular files with at least 1 MiB left to read are mmap'ed, smaller
+    // ones are read sequentially through a single buffer; pipes, sockets and
+    // other non-regular files go through a double buffer filled by a reader
+    // thread. The fd overload reads from the current offset to EOF and does
+    // not close the descriptor.
+    static FileResult hash_file(const std::string& path);
+    static FileResult hash_file(int fd);
+
 
     shsSHA512(const shsSHA512&) = delete;
     shsSHA512& operator=(const shsSHA512&) = delete;
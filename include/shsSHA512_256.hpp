@@ -0,0 +1,36 @@
+#ifndef SHS_SHA512_256_HPP
+#define SHS_SHA512_256_HPP
+
+#include <string>
+#include <vector>
+#include <array>
+
+class shsSHA512_256 {
+public:
+    static constexpr size_t DIGEST_SIZE = 32;
+
+    shsSHA512_256();
+    ~shsSHA512_256();
+
+
+    void update(const std::vector<uint8_t>& data);
+    void update(const std::string& data);
+    void update(const uint8_t* data, size_t length);
+
+    std::array<uint8_t, DIGEST_SIZE> finalize();
+
+
+    static std::array<uint8_t, DIGEST_SIZE> hash(const std::vector<uint8_t>& data);
+    static std::array<uint8_t, DIGEST_SIZE> hash(const std::string& data);
+    static std::array<uint8_t, DIGEST_SIZE> hash(const uint8_t* data, size_t length);
+
+
+    shsSHA512_256(const shsSHA512_256&) = delete;
+    shsSHA512_256& operator=(const shsSHA512_256&) = delete;
+
+private:
+    struct Impl;
+    Impl* impl;
+};
+
+#endif // SHS_SHA512_256_HPP
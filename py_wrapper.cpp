@@ -6,6 +6,8 @@
 #include "include/Argon2Hasher.hpp"
 #include "ed25519_wrapper.hpp"
 #include "include/shsSHA512.hpp"  // Добавляем заголовок SHA512
+#include "include/shsSHA384.hpp"
+#include "include/shsSHA512_256.hpp"
 #include "include/shsBlake2.hpp"
 
 namespace py = pybind11;
@@ -152,40 +154,69 @@ void bind_aes(py::module_& m) {
 }
 
 void bind_argon2(py::module_& m) {
-    py::class_<mylib::crypto::Argon2Hasher>(m, "Argon2Hasher")
+    using mylib::crypto::Argon2Hasher;
+
+    py::enum_<Argon2Hasher::Type>(m, "Argon2Type")
+        .value("i", Argon2Hasher::Type::i)
+        .value("d", Argon2Hasher::Type::d)
+        .value("id", Argon2Hasher::Type::id)
+        .export_values();
+
+    py::class_<Argon2Hasher::Params>(m, "Argon2Params")
+        .def_readonly("type", &Argon2Hasher::Params::type)
+        .def_readonly("t_cost", &Argon2Hasher::Params::t_cost)
+        .def_readonly("m_cost", &Argon2Hasher::Params::m_cost)
+        .def_readonly("lanes", &Argon2Hasher::Params::lanes);
+
+    py::class_<Argon2Hasher>(m, "Argon2Hasher")
         .def_static("hashPasswordWithSalt",
-             &mylib::crypto::Argon2Hasher::hashPasswordWithSalt,
+             &Argon2Hasher::hashPasswordWithSalt,
              py::arg("password"),
              py::arg("t_cost") = 3,
              py::arg("m_cost") = 1 << 12,
              py::arg("salt_len") = 16,
              py::arg("out_len") = 32,
+             py::arg("type") = Argon2Hasher::Type::i,
+             py::arg("lanes") = 1,
+             py::arg("threads") = 0,
+             py::call_guard<py::gil_scoped_release>(),
              "Hash password with salt\n"
              "Args:\n"
              "    password: password to hash\n"
              "    t_cost: time cost (default: 3)\n"
-             "    m_cost: memory cost (default: 1 << 12)\n"
+             "    m_cost: memory cost in KiB (default: 1 << 12)\n"
              "    salt_len: length of the salt (default: 16)\n"
              "    out_len: length of the output hash (default: 32)\n"
+             "    type: Argon2Type.i, Argon2Type.d or Argon2Type.id (default: i)\n"
+             "    lanes: lanes filled in parallel; part of the hash (default: 1)\n"
+             "    threads: threads actually used, 0 for one per lane (default: 0)\n"
              "Returns:\n"
-             "    Salt and hash as string in format 'salt$hash'")
+             "    '$shs-argon2<type>$v=16$m=<m_cost>,t=<t_cost>,p=<lanes>$salt$hash'")
 
         .def_static("verifyPassword",
-             &mylib::crypto::Argon2Hasher::verifyPassword,
+             &Argon2Hasher::verifyPassword,
              py::arg("password"),
              py::arg("stored"),
              py::arg("t_cost") = 3,
              py::arg("m_cost") = 1 << 12,
              py::arg("out_len") = 32,
+             py::arg("threads") = 0,
+             py::call_guard<py::gil_scoped_release>(),
              "Verify password against stored hash\n"
              "Args:\n"
              "    password: password to verify\n"
-             "    stored: stored hash in format 'salt$hash'\n"
-             "    t_cost: time cost (default: 3)\n"
-             "    m_cost: memory cost (default: 1 << 12)\n"
-             "    out_len: length of the output hash (default: 32)\n"
+             "    stored: string from hashPasswordWithSalt, or legacy 'salt$hash'\n"
+             "    t_cost: time cost of a legacy string (default: 3)\n"
+             "    m_cost: memory cost of a legacy string (default: 1 << 12)\n"
+             "    out_len: hash length of a legacy string (default: 32)\n"
+             "    threads: threads to use, 0 for one per lane (default: 0)\n"
              "Returns:\n"
-             "    True if password matches, False otherwise");
+             "    True if password matches, False otherwise")
+
+        .def_static("storedParams",
+             &Argon2Hasher::storedParams,
+             py::arg("stored"),
+             "Parameters encoded in a stored hash (defaults for a legacy string)");
 }
 
 void bind_sha512(py::module_& m) {
@@ -232,6 +263,72 @@ void bind_sha512(py::module_& m) {
             "Finalize and return hash\n"
             "Returns:\n"
             "    SHA512 hash as bytes");
+
+    m.def("sha384_hash",
+        [](const std::vector<uint8_t>& data) {
+            return shsSHA384::hash(data);
+        },
+        py::arg("data"),
+        "Compute SHA-384 hash of binary data\n"
+        "Args:\n"
+        "    data: input bytes to hash\n"
+        "Returns:\n"
+        "    48-byte SHA-384 hash as bytes");
+
+    py::class_<shsSHA384>(m, "SHA384")
+        .def(py::init<>(), "Initialize SHA-384 hasher")
+        .def("update",
+            [](shsSHA384& hasher, const std::string& data) {
+                hasher.update(data);
+            },
+            py::arg("data"),
+            "Update hash with string data")
+        .def("update_bytes",
+            [](shsSHA384& hasher, const std::vector<uint8_t>& data) {
+                hasher.update(data);
+            },
+            py::arg("data"),
+            "Update hash with binary data")
+        .def("finalize",
+            [](shsSHA384& hasher) {
+                return hasher.finalize();
+            },
+            "Finalize and return hash\n"
+            "Returns:\n"
+            "    SHA-384 hash as bytes");
+
+    m.def("sha512_256_hash",
+        [](const std::vector<uint8_t>& data) {
+            return shsSHA512_256::hash(data);
+        },
+        py::arg("data"),
+        "Compute SHA-512/256 hash of binary data\n"
+        "Args:\n"
+        "    data: input bytes to hash\n"
+        "Returns:\n"
+        "    32-byte SHA-512/256 hash as bytes");
+
+    py::class_<shsSHA512_256>(m, "SHA512_256")
+        .def(py::init<>(), "Initialize SHA-512/256 hasher")
+        .def("update",
+            [](shsSHA512_256& hasher, const std::string& data) {
+                hasher.update(data);
+            },
+            py::arg("data"),
+            "Update hash with string data")
+        .def("update_bytes",
+            [](shsSHA512_256& hasher, const std::vector<uint8_t>& data) {
+                hasher.update(data);
+            },
+            py::arg("data"),
+            "Update hash with binary data")
+        .def("finalize",
+            [](shsSHA512_256& hasher) {
+                return hasher.finalize();
+            },
+            "Finalize and return hash\n"
+            "Returns:\n"
+            "    SHA-512/256 hash as bytes");
 }
 
 
@@ -0,0 +1,240 @@
+/*
+ * Argon2 source code package
+ *
+ * This work is licensed under a Creative Commons CC0 1.0 License/Waiver.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication along with
+ * this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#include <stdint.h>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define ARGON2_ARENA_MMAP 1
+#endif
+
+#include "argon2.h"
+
+/*
+ * Regions handed out by the arena. Idle regions are kept mapped (and their
+ * pages resident) up to the cache limit; a region is wiped before it goes
+ * idle, so the next user never sees the previous one's blocks.
+ */
+namespace {
+
+const size_t kRegionAlignment = 64;
+const size_t kHugePageSize = size_t(2) << 20;
+const size_t kDefaultCacheLimit = size_t(1) << 30;
+
+struct Region {
+    uint8_t* base;
+    size_t size;
+};
+
+struct Arena {
+    std::mutex mutex;
+    std::vector<Region> idle;
+    std::unordered_map<uint8_t*, Region> live;
+    size_t cached = 0;
+    size_t cache_limit = kDefaultCacheLimit;
+    Argon2_arena_pages pages = ARGON2_ARENA_PAGES_DEFAULT;
+};
+
+Arena& arena() {
+    static Arena* instance = new Arena(); // never destroyed: hashing may outlive static destructors
+    return *instance;
+}
+
+size_t RoundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// Size multiple of the regions mapped for @pages
+size_t Granule(Argon2_arena_pages pages) {
+#ifdef ARGON2_ARENA_MMAP
+    if (pages != ARGON2_ARENA_PAGES_DEFAULT) {
+        return kHugePageSize;
+    }
+    return (size_t) sysconf(_SC_PAGESIZE);
+#else
+    (void) pages;
+    return kRegionAlignment;
+#endif
+}
+
+bool MapRegion(size_t bytes, Argon2_arena_pages pages, Region* region) {
+    const size_t size = RoundUp(bytes, Granule(pages));
+#ifdef ARGON2_ARENA_MMAP
+#ifdef MAP_HUGETLB
+    if (pages == ARGON2_ARENA_PAGES_HUGETLB) {
+        // Fails unless huge pages are reserved (vm.nr_hugepages); fall back to
+        // ordinary pages in that case
+        void* p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            *region = Region{(uint8_t*) p, size};
+            return true;
+        }
+    }
+#endif
+    void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+#ifdef MADV_HUGEPAGE
+    if (pages != ARGON2_ARENA_PAGES_DEFAULT) {
+        madvise(p, size, MADV_HUGEPAGE); // advisory only
+    }
+#endif
+    *region = Region{(uint8_t*) p, size};
+    return true;
+#else
+    void* p = ::operator new(size, std::align_val_t(kRegionAlignment), std::nothrow);
+    if (p == NULL) {
+        return false;
+    }
+    *region = Region{(uint8_t*) p, size};
+    return true;
+#endif
+}
+
+void UnmapRegion(const Region& region) {
+#ifdef ARGON2_ARENA_MMAP
+    munmap(region.base, region.size);
+#else
+    ::operator delete(region.base, std::align_val_t(kRegionAlignment));
+#endif
+}
+
+// Unmaps idle regions until at most @limit bytes stay cached; called with the lock held
+void TrimLocked(Arena& a, size_t limit, std::vector<Region>* released) {
+    while (a.cached > limit && !a.idle.empty()) {
+        Region region = a.idle.front();
+        a.idle.erase(a.idle.begin());
+        a.cached -= region.size;
+        released->push_back(region);
+    }
+}
+
+} // namespace
+
+int Argon2ArenaConfigure(size_t cache_limit, Argon2_arena_pages pages) {
+    if (pages != ARGON2_ARENA_PAGES_DEFAULT && pages != ARGON2_ARENA_PAGES_TRANSPARENT &&
+        pages != ARGON2_ARENA_PAGES_HUGETLB) {
+        return ARGON2_INCORRECT_PARAMETER;
+    }
+    Arena& a = arena();
+    std::vector<Region> released;
+    {
+        std::lock_guard<std::mutex> lock(a.mutex);
+        a.cache_limit = cache_limit;
+        // Regions of the old page kind would be reused forever otherwise
+        TrimLocked(a, a.pages == pages ? cache_limit : 0, &released);
+        a.pages = pages;
+    }
+    for (const Region& region : released) {
+        UnmapRegion(region);
+    }
+    return ARGON2_OK;
+}
+
+int Argon2ArenaAllocate(uint8_t **memory, size_t bytes) {
+    if (memory == NULL || bytes == 0) {
+        return ARGON2_MEMORY_ALLOCATION_ERROR;
+    }
+    Arena& a = arena();
+    Argon2_arena_pages pages;
+    {
+        std::lock_guard<std::mutex> lock(a.mutex);
+        // Smallest idle region that fits, but not one more than twice the
+        // region a fresh mapping would get: a 1 GiB region should not be
+        // pinned by a 1 MiB hash
+        const size_t wanted = RoundUp(bytes, Granule(a.pages));
+        size_t best = a.idle.size();
+        for (size_t i = 0; i < a.idle.size(); ++i) {
+            const Region& region = a.idle[i];
+            if (region.size >= bytes && region.size / 2 <= wanted &&
+                (best == a.idle.size() || region.size < a.idle[best].size)) {
+                best = i;
+            }
+        }
+        if (best != a.idle.size()) {
+            Region region = a.idle[best];
+            a.idle.erase(a.idle.begin() + best);
+            a.cached -= region.size;
+            a.live.emplace(region.base, region);
+            *memory = region.base;
+            return ARGON2_OK;
+        }
+        pages = a.pages;
+    }
+
+    Region region;
+    if (!MapRegion(bytes, pages, &region)) {
+        return ARGON2_MEMORY_ALLOCATION_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(a.mutex);
+    a.live.emplace(region.base, region);
+    *memory = region.base;
+    return ARGON2_OK;
+}
+
+void Argon2ArenaFree(uint8_t *memory, size_t bytes) {
+    if (memory == NULL) {
+        return;
+    }
+    Arena& a = arena();
+    Region region;
+    {
+        std::lock_guard<std::mutex> lock(a.mutex);
+        auto it = a.live.find(memory);
+        if (it == a.live.end()) {
+            return;
+        }
+        region = it->second;
+        a.live.erase(it);
+    }
+
+    // Only the first @bytes were handed out; the rest is still clean
+    secure_wipe_memory(region.base, bytes < region.size ? bytes : region.size);
+
+    std::vector<Region> released;
+    {
+        std::lock_guard<std::mutex> lock(a.mutex);
+        if (region.size <= a.cache_limit) {
+            a.idle.push_back(region);
+            a.cached += region.size;
+            TrimLocked(a, a.cache_limit, &released);
+        } else {
+            released.push_back(region);
+        }
+    }
+    for (const Region& r : released) {
+        UnmapRegion(r);
+    }
+}
+
+size_t Argon2ArenaCachedBytes() {
+    Arena& a = arena();
+    std::lock_guard<std::mutex> lock(a.mutex);
+    return a.cached;
+}
+
+void Argon2ArenaTrim() {
+    Arena& a = arena();
+    std::vector<Region> released;
+    {
+        std::lock_guard<std::mutex> lock(a.mutex);
+        TrimLocked(a, 0, &released);
+    }
+    for (const Region& region : released) {
+        UnmapRegion(region);
+    }
+}
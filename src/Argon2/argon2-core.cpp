@@ -13,13 +13,14 @@
 
 #include <inttypes.h>
 #include <vector>
-#include <thread>
 #include <cstring>
 
 #include "argon2.h"
 #include "argon2-core.h"
 #include "kat.h"
 
+#include "../shsThreadPool.hpp"
+
 
 #include "../Blake2/blake2.h"
 #include "../Blake2/blake2-impl.h"
@@ -51,9 +52,6 @@ int AllocateMemory(block **memory, uint32_t m_cost) {
 
 void ClearMemory(Argon2_instance_t* instance, bool clear) {
     if (instance->memory != NULL && clear) {
-        if (instance->type == Argon2_ds && instance->Sbox != NULL) {
-            secure_wipe_memory(instance->Sbox, ARGON2_SBOX_SIZE * sizeof (uint64_t));
-        }
         secure_wipe_memory(instance->memory, sizeof (block) * instance->memory_blocks);
     }
 }
@@ -85,11 +83,6 @@ void Finalize(const Argon2_Context *context, Argon2_instance_t* instance) {
         // Clear memory
         ClearMemory(instance, context->clear_memory);
 
-        // Deallocate Sbox memory
-        if (instance->memory != NULL && instance->Sbox != NULL) {
-            delete[] instance->Sbox;
-        }
-
         // Deallocate the memory
         if (NULL != context->free_cbk) {
             context->free_cbk((uint8_t *) instance->memory, instance->memory_blocks * sizeof (block));
@@ -150,35 +143,50 @@ uint32_t IndexAlpha(const Argon2_instance_t* instance, const Argon2_position_t*
 }
 
 void FillMemoryBlocks(Argon2_instance_t* instance) {
-    std::vector<std::thread> Threads;
     if (instance == NULL) {
         return;
     }
+    // Segments of one slice are independent, so each slice is a single loop
+    // over the lanes on the library's persistent pool; parallelFor returning
+    // is the barrier before the next slice. At most @threads threads take
+    // part, fewer if the pool is smaller - the output does not depend on it.
+    shsThreadPool& pool = shsThreadPool::shared();
+
+    // The Argon2ds S-box is scratch of this call only; it is derived from
+    // the first block, so it is wiped before the storage is released
+    std::vector<uint64_t> sbox;
+    if (Argon2_ds == instance->type) {
+        sbox.resize(ARGON2_SBOX_SIZE);
+        instance->Sbox = sbox.data();
+    }
+
+    // Reference indices of the data-independent segments, one row per lane,
+    // allocated once per call rather than in every segment
+    std::vector<uint64_t> pseudo_rands;
+    if (Argon2_i == instance->type || Argon2_id == instance->type) {
+        pseudo_rands.resize((size_t) instance->lanes * instance->segment_length);
+        instance->pseudo_rands = pseudo_rands.data();
+    }
+
     for (uint32_t r = 0; r < instance->passes; ++r) {
         if (Argon2_ds == instance->type) {
             GenerateSbox(instance);
         }
         for (uint8_t s = 0; s < ARGON2_SYNC_POINTS; ++s) {
-            for (uint32_t l = 0; l < instance->lanes; ++l) {
-                Threads.push_back(std::thread(FillSegment, instance, Argon2_position_t(r, l, s, 0)));
-                if(instance->threads <= Threads.size()){ //have to join extra threads
-                    for (auto& t : Threads) {
-                        t.join();
-                    }
-                    Threads.clear();
-                }
-            }
-            if(!Threads.empty()){
-                for (auto& t : Threads) {
-                    t.join();
-                }
-                Threads.clear();
-            }
+            pool.parallelFor(instance->lanes, [&](size_t l) {
+                FillSegment(instance, Argon2_position_t(r, (uint32_t) l, s, 0));
+            }, instance->threads);
         }
         if(instance->internal_print){
             InternalKat(instance, r); // Print all memory blocks
         }
     }
+
+    if (instance->Sbox != NULL) {
+        secure_wipe_memory(instance->Sbox, ARGON2_SBOX_SIZE * sizeof (uint64_t));
+        instance->Sbox = NULL;
+    }
+    instance->pseudo_rands = NULL;
 }
 
 int ValidateInputs(const Argon2_Context* context) {
@@ -384,7 +392,7 @@ int Initialize(Argon2_instance_t* instance, Argon2_Context* context) {
         if (ARGON2_OK != result) {
             return result;
         }
-        memcpy(&(instance->memory), p, sizeof(instance->memory));
+        instance->memory = (block*) p;
     } else {
         result = AllocateMemory(&(instance->memory), instance->memory_blocks);
     }
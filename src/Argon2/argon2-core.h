@@ -109,12 +109,13 @@ struct Argon2_instance_t {
     const uint32_t lane_length; //Value derived from @memory_blocks and @lanes  --- just for cache and readability
     const uint32_t segment_length;  //Value derived from @lane_length and SYNC_POINTS --- just for cache and readability
     uint64_t *Sbox; //S-boxes for Argon2_ds
+    uint64_t *pseudo_rands; //Address scratch, @segment_length values per lane (Argon2i and Argon2id only)
     const bool internal_print; //whether to print the memory blocks to the file - for test vectors only!
 
     Argon2_instance_t(block* ptr, Argon2_type t, uint32_t p, uint32_t m, uint32_t l, uint32_t thr, bool pr) :
     memory(ptr),  passes(p), memory_blocks(m), lanes(l),threads(thr), type(t),   lane_length(m / l),
     segment_length(m / (l*ARGON2_SYNC_POINTS)),
-     Sbox(NULL), internal_print(pr) {
+     Sbox(NULL), pseudo_rands(NULL), internal_print(pr) {
     };
 };
 
@@ -233,6 +234,7 @@ void FillBlock(const block* prev_block, const block* ref_block, block* next_bloc
  * @param instance Pointer to the current instance
  * @param position Current position
  * @pre all block pointers must be valid
+ * @pre instance->pseudo_rands must be set for Argon2i and Argon2id
  */
 void FillSegment(const Argon2_instance_t* instance, Argon2_position_t position);
 
@@ -253,6 +255,7 @@ int Argon2Core(Argon2_Context* context, Argon2_type type);
 /*
  * Generates the Sbox from the first memory block (must be ready at that time)
  * @param instance Pointer to the current instance 
+ * @pre instance->Sbox must point to ARGON2_SBOX_SIZE values owned by the caller
  */
 void GenerateSbox(Argon2_instance_t* instance);
 
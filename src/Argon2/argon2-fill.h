@@ -0,0 +1,63 @@
+/*
+ * Argon2 source code package
+ *
+ * This work is licensed under a Creative Commons CC0 1.0 License/Waiver.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication along with
+ * this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+#pragma once
+
+#ifndef __ARGON2_FILL_H__
+#define __ARGON2_FILL_H__
+
+#include <stdint.h>
+
+#include "argon2.h"
+#include "argon2-core.h"
+#include "../cpu-features.h"
+
+/*
+ * Block compression kernels of the optimized core. Every kernel computes
+ * next = P(state ^ ref) ^ (state ^ ref) (plus the Argon2ds S-box term) and
+ * leaves the result in @state as well, so a segment keeps the previous block
+ * there instead of reloading it from memory.
+ * @param state 128 words holding the previous block; overwritten with the new one
+ * @param ref_block Pointer to the reference block
+ * @param next_block Pointer to the block to be constructed
+ * @param Sbox Pointer to the Sbox (Argon2_ds only, otherwise NULL)
+ */
+typedef void (*Argon2FillBlockFn)(uint64_t* state, const uint8_t* ref_block, uint8_t* next_block, const uint64_t* Sbox);
+
+void FillBlockSSE2(uint64_t* state, const uint8_t* ref_block, uint8_t* next_block, const uint64_t* Sbox);
+
+#if defined(SHS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define ARGON2_HAVE_AVX 1
+void FillBlockAVX2(uint64_t* state, const uint8_t* ref_block, uint8_t* next_block, const uint64_t* Sbox);
+void FillBlockAVX512(uint64_t* state, const uint8_t* ref_block, uint8_t* next_block, const uint64_t* Sbox);
+#endif
+
+/*
+ * Kernel picked for this CPU, or the one forced by Argon2SelectFillBackend()
+ */
+Argon2FillBlockFn Argon2FillBlockResolve();
+
+/*
+ * Argon2ds S-box chain over the first and last word of state ^ ref
+ */
+static inline uint64_t Argon2SboxMix(const uint64_t* block_XY, const uint64_t* Sbox) {
+    uint64_t x = block_XY[0] ^ block_XY[127];
+    for (int i = 0; i < 6 * 16; ++i) {
+        uint32_t x1 = x >> 32;
+        uint32_t x2 = x & 0xFFFFFFFF;
+        uint64_t y = Sbox[x1 & ARGON2_SBOX_MASK];
+        uint64_t z = Sbox[(x2 & ARGON2_SBOX_MASK) + ARGON2_SBOX_SIZE / 2];
+        x = (uint64_t) x1 * (uint64_t) x2;
+        x += y;
+        x ^= z;
+    }
+    return x;
+}
+
+#endif
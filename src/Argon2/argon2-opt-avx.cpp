@@ -0,0 +1,247 @@
+/*
+ * Argon2 source code package
+ *
+ * This work is licensed under a Creative Commons CC0 1.0 License/Waiver.
+ *
+ * You should have received a copy of the CC0 Public Domain Dedication along with
+ * this software. If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+ */
+
+/*
+ * AVX2 and AVX-512 block kernels. The 1 KiB block is an 8x8 matrix of
+ * 16-byte cells; the permutation runs BLAKE2_ROUND over each row of cells
+ * and then over each column. One round works on 16 words A|B|C|D, which fit
+ * in four __m256i (one round per register set) or, two rounds side by side,
+ * in four __m512i. Rows are contiguous in memory; a column gathers the
+ * cells of two rows per register, which is the only reshuffling needed.
+ */
+
+#include "argon2-fill.h"
+
+#ifdef ARGON2_HAVE_AVX
+
+#include <immintrin.h>
+
+/* ---------------------------------------------------------------------- */
+/* AVX2                                                                   */
+
+SHS_TARGET("avx2")
+static inline __m256i BlaMkaAVX2(__m256i x, __m256i y) {
+    const __m256i z = _mm256_mul_epu32(x, y);
+    return _mm256_add_epi64(_mm256_add_epi64(x, y), _mm256_add_epi64(z, z));
+}
+
+#define AVX2_ROTR32(x) _mm256_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+#define AVX2_ROTR24(x) _mm256_shuffle_epi8((x), r24)
+#define AVX2_ROTR16(x) _mm256_shuffle_epi8((x), r16)
+#define AVX2_ROTR63(x) _mm256_xor_si256(_mm256_srli_epi64((x), 63), _mm256_add_epi64((x), (x)))
+
+#define AVX2_G(A, B, C, D)                                                     \
+    do {                                                                       \
+        A = BlaMkaAVX2(A, B);                                                  \
+        D = AVX2_ROTR32(_mm256_xor_si256(D, A));                               \
+        C = BlaMkaAVX2(C, D);                                                  \
+        B = AVX2_ROTR24(_mm256_xor_si256(B, C));                               \
+        A = BlaMkaAVX2(A, B);                                                  \
+        D = AVX2_ROTR16(_mm256_xor_si256(D, A));                               \
+        C = BlaMkaAVX2(C, D);                                                  \
+        B = AVX2_ROTR63(_mm256_xor_si256(B, C));                               \
+    } while ((void)0, 0)
+
+/* Lane i of B, C, D moves to lane i - 1, i - 2, i - 3 and back */
+#define AVX2_ROUND(A, B, C, D)                                                 \
+    do {                                                                       \
+        AVX2_G(A, B, C, D);                                                    \
+        B = _mm256_permute4x64_epi64(B, _MM_SHUFFLE(0, 3, 2, 1));              \
+        C = _mm256_permute4x64_epi64(C, _MM_SHUFFLE(1, 0, 3, 2));              \
+        D = _mm256_permute4x64_epi64(D, _MM_SHUFFLE(2, 1, 0, 3));              \
+        AVX2_G(A, B, C, D);                                                    \
+        B = _mm256_permute4x64_epi64(B, _MM_SHUFFLE(2, 1, 0, 3));              \
+        C = _mm256_permute4x64_epi64(C, _MM_SHUFFLE(1, 0, 3, 2));              \
+        D = _mm256_permute4x64_epi64(D, _MM_SHUFFLE(0, 3, 2, 1));              \
+    } while ((void)0, 0)
+
+/* Two 16-byte cells, from @lo and @hi, as one register */
+SHS_TARGET("avx2")
+static inline __m256i LoadCellsAVX2(const uint64_t* lo, const uint64_t* hi) {
+    return _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) lo)),
+        _mm_loadu_si128((const __m128i*) hi), 1);
+}
+
+SHS_TARGET("avx2")
+static inline void StoreCellsAVX2(uint64_t* lo, uint64_t* hi, __m256i v) {
+    _mm_storeu_si128((__m128i*) lo, _mm256_castsi256_si128(v));
+    _mm_storeu_si128((__m128i*) hi, _mm256_extracti128_si256(v, 1));
+}
+
+SHS_TARGET("avx2")
+void FillBlockAVX2(uint64_t* state, const uint8_t* ref_block, uint8_t* next_block, const uint64_t* Sbox) {
+    const __m256i r16 = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+                                         2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+    const __m256i r24 = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+                                         3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+    __m256i block_XY[32];
+    __m256i* s = (__m256i*) state;
+
+    for (uint32_t i = 0; i < 32; ++i) { // Initial XOR
+        block_XY[i] = _mm256_xor_si256(_mm256_loadu_si256(s + i),
+                                       _mm256_loadu_si256((const __m256i*) ref_block + i));
+        _mm256_storeu_si256(s + i, block_XY[i]);
+    }
+
+    uint64_t x = 0;
+    if (Sbox != NULL) {
+        x = Argon2SboxMix(state, Sbox);
+    }
+
+    // Rows: 16 contiguous words each
+    for (uint32_t i = 0; i < 8; ++i) {
+        __m256i A = _mm256_loadu_si256(s + 4 * i + 0);
+        __m256i B = _mm256_loadu_si256(s + 4 * i + 1);
+        __m256i C = _mm256_loadu_si256(s + 4 * i + 2);
+        __m256i D = _mm256_loadu_si256(s + 4 * i + 3);
+        AVX2_ROUND(A, B, C, D);
+        _mm256_storeu_si256(s + 4 * i + 0, A);
+        _mm256_storeu_si256(s + 4 * i + 1, B);
+        _mm256_storeu_si256(s + 4 * i + 2, C);
+        _mm256_storeu_si256(s + 4 * i + 3, D);
+    }
+
+    // Columns: cell i of every row, two rows per register
+    for (uint32_t i = 0; i < 8; ++i) {
+        uint64_t* c = state + 2 * i;
+        __m256i A = LoadCellsAVX2(c + 0, c + 16);
+        __m256i B = LoadCellsAVX2(c + 32, c + 48);
+        __m256i C = LoadCellsAVX2(c + 64, c + 80);
+        __m256i D = LoadCellsAVX2(c + 96, c + 112);
+        AVX2_ROUND(A, B, C, D);
+        StoreCellsAVX2(c + 0, c + 16, A);
+        StoreCellsAVX2(c + 32, c + 48, B);
+        StoreCellsAVX2(c + 64, c + 80, C);
+        StoreCellsAVX2(c + 96, c + 112, D);
+    }
+
+    for (uint32_t i = 0; i < 32; ++i) { // Feedback
+        _mm256_storeu_si256(s + i, _mm256_xor_si256(_mm256_loadu_si256(s + i), block_XY[i]));
+    }
+    state[0] += x;
+    state[127] += x;
+    for (uint32_t i = 0; i < 32; ++i) {
+        _mm256_storeu_si256((__m256i*) next_block + i, _mm256_loadu_si256(s + i));
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/* AVX-512: the low and high 256 bits carry two independent rounds        */
+
+/* GCC's unmasked forms of several AVX-512 intrinsics pass an uninitialized
+ * merge source and trip -Wuninitialized once inlined; the zero-masking forms
+ * with a full mask compile to the same instructions */
+#define AVX512_ALL ((__mmask8) 0xFF)
+#define AVX512_ROR(x, n) _mm512_maskz_ror_epi64(AVX512_ALL, (x), (n))
+#define AVX512_PERMUTE(x, imm) _mm512_maskz_permutex_epi64(AVX512_ALL, (x), (imm))
+
+SHS_TARGET("avx512f")
+static inline __m512i BlaMkaAVX512(__m512i x, __m512i y) {
+    const __m512i z = _mm512_maskz_mul_epu32(AVX512_ALL, x, y);
+    return _mm512_add_epi64(_mm512_add_epi64(x, y), _mm512_add_epi64(z, z));
+}
+
+#define AVX512_G(A, B, C, D)                                                   \
+    do {                                                                       \
+        A = BlaMkaAVX512(A, B);                                                \
+        D = AVX512_ROR(_mm512_xor_si512(D, A), 32);                            \
+        C = BlaMkaAVX512(C, D);                                                \
+        B = AVX512_ROR(_mm512_xor_si512(B, C), 24);                            \
+        A = BlaMkaAVX512(A, B);                                                \
+        D = AVX512_ROR(_mm512_xor_si512(D, A), 16);                            \
+        C = BlaMkaAVX512(C, D);                                                \
+        B = AVX512_ROR(_mm512_xor_si512(B, C), 63);                            \
+    } while ((void)0, 0)
+
+/* vpermq with an immediate permutes each 256-bit half on its own */
+#define AVX512_ROUND(A, B, C, D)                                               \
+    do {                                                                       \
+        AVX512_G(A, B, C, D);                                                  \
+        B = AVX512_PERMUTE(B, _MM_SHUFFLE(0, 3, 2, 1));                        \
+        C = AVX512_PERMUTE(C, _MM_SHUFFLE(1, 0, 3, 2));                        \
+        D = AVX512_PERMUTE(D, _MM_SHUFFLE(2, 1, 0, 3));                        \
+        AVX512_G(A, B, C, D);                                                  \
+        B = AVX512_PERMUTE(B, _MM_SHUFFLE(2, 1, 0, 3));                        \
+        C = AVX512_PERMUTE(C, _MM_SHUFFLE(1, 0, 3, 2));                        \
+        D = AVX512_PERMUTE(D, _MM_SHUFFLE(0, 3, 2, 1));                        \
+    } while ((void)0, 0)
+
+SHS_TARGET("avx512f")
+static inline __m512i LoadHalvesAVX512(const uint64_t* lo, const uint64_t* hi) {
+    return _mm512_maskz_inserti64x4(AVX512_ALL, _mm512_castsi256_si512(_mm256_loadu_si256((const __m256i*) lo)),
+                                    _mm256_loadu_si256((const __m256i*) hi), 1);
+}
+
+SHS_TARGET("avx512f")
+static inline void StoreHalvesAVX512(uint64_t* lo, uint64_t* hi, __m512i v) {
+    _mm256_storeu_si256((__m256i*) lo, _mm512_maskz_extracti64x4_epi64(AVX512_ALL, v, 0));
+    _mm256_storeu_si256((__m256i*) hi, _mm512_maskz_extracti64x4_epi64(AVX512_ALL, v, 1));
+}
+
+/* Cells i, i+1 of rows r, r+1 arrive as (r.i, r.i+1, r+1.i, r+1.i+1) and
+ * are needed as (r.i, r+1.i | r.i+1, r+1.i+1); the swap is its own inverse */
+#define AVX512_SWAP_CELLS(v) _mm512_maskz_shuffle_i64x2(AVX512_ALL, (v), (v), _MM_SHUFFLE(3, 1, 2, 0))
+
+SHS_TARGET("avx512f")
+void FillBlockAVX512(uint64_t* state, const uint8_t* ref_block, uint8_t* next_block, const uint64_t* Sbox) {
+    __m512i block_XY[16];
+    __m512i* s = (__m512i*) state;
+
+    for (uint32_t i = 0; i < 16; ++i) { // Initial XOR
+        block_XY[i] = _mm512_xor_si512(_mm512_loadu_si512(s + i),
+                                       _mm512_loadu_si512((const __m512i*) ref_block + i));
+        _mm512_storeu_si512(s + i, block_XY[i]);
+    }
+
+    uint64_t x = 0;
+    if (Sbox != NULL) {
+        x = Argon2SboxMix(state, Sbox);
+    }
+
+    // Rows r and r + 1 side by side
+    for (uint32_t r = 0; r < 8; r += 2) {
+        uint64_t* lo = state + 16 * r;
+        uint64_t* hi = lo + 16;
+        __m512i A = LoadHalvesAVX512(lo + 0, hi + 0);
+        __m512i B = LoadHalvesAVX512(lo + 4, hi + 4);
+        __m512i C = LoadHalvesAVX512(lo + 8, hi + 8);
+        __m512i D = LoadHalvesAVX512(lo + 12, hi + 12);
+        AVX512_ROUND(A, B, C, D);
+        StoreHalvesAVX512(lo + 0, hi + 0, A);
+        StoreHalvesAVX512(lo + 4, hi + 4, B);
+        StoreHalvesAVX512(lo + 8, hi + 8, C);
+        StoreHalvesAVX512(lo + 12, hi + 12, D);
+    }
+
+    // Columns i and i + 1 side by side
+    for (uint32_t i = 0; i < 8; i += 2) {
+        uint64_t* c = state + 2 * i;
+        __m512i A = AVX512_SWAP_CELLS(LoadHalvesAVX512(c + 0, c + 16));
+        __m512i B = AVX512_SWAP_CELLS(LoadHalvesAVX512(c + 32, c + 48));
+        __m512i C = AVX512_SWAP_CELLS(LoadHalvesAVX512(c + 64, c + 80));
+        __m512i D = AVX512_SWAP_CELLS(LoadHalvesAVX512(c + 96, c + 112));
+        AVX512_ROUND(A, B, C, D);
+        StoreHalvesAVX512(c + 0, c + 16, AVX512_SWAP_CELLS(A));
+        StoreHalvesAVX512(c + 32, c + 48, AVX512_SWAP_CELLS(B));
+        StoreHalvesAVX512(c + 64, c + 80, AVX512_SWAP_CELLS(C));
+        StoreHalvesAVX512(c + 96, c + 112, AVX512_SWAP_CELLS(D));
+    }
+
+    for (uint32_t i = 0; i < 16; ++i) { // Feedback
+        _mm512_storeu_si512(s + i, _mm512_xor_si512(_mm512_loadu_si512(s + i), block_XY[i]));
+    }
+    state[0] += x;
+    state[127] += x;
+    for (uint32_t i = 0; i < 16; ++i) {
+        _mm512_storeu_si512((__m512i*) next_block + i, _mm512_loadu_si512(s + i));
+    }
+}
+
+#endif
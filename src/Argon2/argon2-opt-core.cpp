@@ -23,8 +23,12 @@
 #endif
 
 
+#include <atomic>
+#include <cstring>
+
 #include "argon2.h"
 #include "argon2-core.h"
+#include "argon2-fill.h"
 #include "kat.h"
 
 
@@ -38,20 +42,12 @@
 const char* ARGON2_KAT_FILENAME = "kat-argon2-opt.log";
 
 
-//const __m128i r16 = _mm_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
-//const __m128i r24 = _mm_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
-
-__m128i t0, t1;
-
 /*
- * Function fills a new memory block
- * @param state Pointer to the just produced block. Content will be updated(!)
- * @param ref_block Pointer to the reference block
- * @param next_block Pointer to the block to be constructed
- * @param Sbox Pointer to the Sbox (used in Argon2_ds only)
- * @pre all block pointers must be valid
+ * SSE2 kernel, the fallback of every x86-64 CPU. The block is held as 64
+ * __m128i; see argon2-fill.h for the contract.
  */
-void FillBlock(__m128i* state, const uint8_t *ref_block, uint8_t *next_block, const uint64_t* Sbox) {
+void FillBlockSSE2(uint64_t* state_words, const uint8_t *ref_block, uint8_t *next_block, const uint64_t* Sbox) {
+    __m128i* state = (__m128i*) state_words;
     __m128i block_XY[ARGON2_QWORDS_IN_BLOCK];
     
      for (uint32_t i = 0; i < ARGON2_QWORDS_IN_BLOCK; i++) {//Initial XOR
@@ -61,16 +57,7 @@ void FillBlock(__m128i* state, const uint8_t *ref_block, uint8_t *next_block, co
 
     uint64_t x = 0;
     if (Sbox != NULL) { //S-boxes in Argon2ds
-	x = *(uint64_t*)block_XY ^ ((uint64_t*)block_XY)[2 * ARGON2_QWORDS_IN_BLOCK - 1];
-        for (int i = 0; i < 6 * 16; ++i) {
-            uint32_t x1 = x >> 32;
-            uint32_t x2 = x & 0xFFFFFFFF;
-            uint64_t y = Sbox[x1 & ARGON2_SBOX_MASK];
-            uint64_t z = Sbox[(x2 & ARGON2_SBOX_MASK) + ARGON2_SBOX_SIZE / 2];
-            x = (uint64_t) x1 * (uint64_t) x2;
-            x += y;
-            x ^= z;
-        }
+        x = Argon2SboxMix((const uint64_t*) block_XY, Sbox);
     }
 
       for (uint32_t i = 0; i < 8; ++i) {
@@ -97,7 +84,73 @@ void FillBlock(__m128i* state, const uint8_t *ref_block, uint8_t *next_block, co
     }
 }
 
+struct FillBackend {
+    const char* name;
+    Argon2FillBlockFn fn;
+    int (*supported)(void);
+};
+
+static int AlwaysSupported(void) {
+    return 1;
+}
+
+// Fastest first
+static const FillBackend kFillBackends[] = {
+#ifdef ARGON2_HAVE_AVX
+    {"avx512", FillBlockAVX512, shs_cpu_has_avx512f},
+    {"avx2", FillBlockAVX2, shs_cpu_has_avx2},
+#endif
+    {"sse2", FillBlockSSE2, AlwaysSupported},
+};
+
+static std::atomic<const FillBackend*> fill_backend(NULL);
+
+static const FillBackend* BestFillBackend() {
+    for (const FillBackend& backend : kFillBackends) {
+        if (backend.supported()) {
+            return &backend;
+        }
+    }
+    return &kFillBackends[sizeof(kFillBackends) / sizeof(kFillBackends[0]) - 1];
+}
+
+static const FillBackend* ActiveFillBackend() {
+    const FillBackend* backend = fill_backend.load(std::memory_order_acquire);
+    if (backend == NULL) {
+        // racing first calls all store the same value
+        backend = BestFillBackend();
+        fill_backend.store(backend, std::memory_order_release);
+    }
+    return backend;
+}
+
+Argon2FillBlockFn Argon2FillBlockResolve() {
+    return ActiveFillBackend()->fn;
+}
+
+const char* Argon2FillBackend() {
+    return ActiveFillBackend()->name;
+}
+
+int Argon2SelectFillBackend(const char* name) {
+    if (name == NULL) {
+        fill_backend.store(BestFillBackend(), std::memory_order_release);
+        return ARGON2_OK;
+    }
+    for (const FillBackend& backend : kFillBackends) {
+        if (strcmp(backend.name, name) == 0) {
+            if (!backend.supported()) {
+                return ARGON2_INCORRECT_PARAMETER;
+            }
+            fill_backend.store(&backend, std::memory_order_release);
+            return ARGON2_OK;
+        }
+    }
+    return ARGON2_INCORRECT_PARAMETER;
+}
+
 void GenerateAddresses(const Argon2_instance_t* instance, const Argon2_position_t* position, uint64_t* pseudo_rands) {
+    const Argon2FillBlockFn FillBlock = Argon2FillBlockResolve();
     block input_block(0), address_block(0);
     if (instance != NULL && position != NULL) {
         input_block.v[0] = position->pass;
@@ -110,17 +163,68 @@ void GenerateAddresses(const Argon2_instance_t* instance, const Argon2_position_
         for (uint32_t i = 0; i < instance->segment_length; ++i) {
             if (i % ARGON2_ADDRESSES_IN_BLOCK == 0) {
                 input_block.v[6]++;
-                block zero_block(0), zero2_block(0);
-                FillBlock((__m128i *) & zero_block.v, (uint8_t *) & input_block.v, (uint8_t *) & address_block.v, NULL);
-                FillBlock((__m128i *) & zero2_block.v, (uint8_t *) & address_block.v, (uint8_t *) & address_block.v, NULL);
+                alignas(64) uint64_t zero_block[ARGON2_WORDS_IN_BLOCK] = {0}, zero2_block[ARGON2_WORDS_IN_BLOCK] = {0};
+                FillBlock(zero_block, (uint8_t *) & input_block.v, (uint8_t *) & address_block.v, NULL);
+                FillBlock(zero2_block, (uint8_t *) & address_block.v, (uint8_t *) & address_block.v, NULL);
             }
             pseudo_rands[i] = address_block[i % ARGON2_ADDRESSES_IN_BLOCK];
         }
     }
 }
 
+/*
+ * Default for Argon2PrefetchDistance(): how many blocks ahead FillSegment
+ * prefetches the reference block when the addresses are known in advance
+ * (Argon2i, first half-pass of Argon2id); 0 turns prefetching off
+ */
+#ifndef ARGON2_PREFETCH_DISTANCE
+#define ARGON2_PREFETCH_DISTANCE 16
+#endif
+
+static std::atomic<uint32_t> prefetch_distance(ARGON2_PREFETCH_DISTANCE);
+
+uint32_t Argon2PrefetchDistance() {
+    return prefetch_distance.load(std::memory_order_relaxed);
+}
+
+int Argon2SetPrefetchDistance(uint32_t distance) {
+    if (distance > ARGON2_MAX_PREFETCH_DISTANCE) {
+        return ARGON2_INCORRECT_PARAMETER;
+    }
+    prefetch_distance.store(distance, std::memory_order_relaxed);
+    return ARGON2_OK;
+}
+
+/*
+ * Reference block for the block at @index of the segment at @position
+ */
+static inline block* ReferenceBlock(const Argon2_instance_t* instance, Argon2_position_t position, uint32_t index, uint64_t pseudo_rand) {
+    /* Computing the lane of the reference block */
+    uint64_t ref_lane = ((pseudo_rand >> 32)) % instance->lanes;
+    if ((position.pass == 0) && (position.slice == 0)) {
+        // Can not reference other lanes yet
+        ref_lane = position.lane;
+    }
+
+    /* Computing the number of possible reference block within the lane. */
+    position.index = index;
+    uint64_t ref_index = IndexAlpha(instance, &position, pseudo_rand & 0xFFFFFFFF, ref_lane == position.lane);
+    return instance->memory + instance->lane_length * ref_lane + ref_index;
+}
+
+/*
+ * Pulls all 16 cache lines of a block towards L1 without waiting for them
+ */
+static inline void PrefetchBlock(const block* b) {
+    const char* p = (const char*) b->v;
+    for (uint32_t offset = 0; offset < ARGON2_BLOCK_SIZE; offset += 64) {
+        _mm_prefetch(p + offset, _MM_HINT_T0);
+    }
+}
+
 /*
  * Function that fills the segment using previous segments also from other threads. Identical to the reference code except that it calls optimized FillBlock()
+ * and, when the addresses are data-independent, prefetches reference blocks Argon2PrefetchDistance() blocks ahead
  * @param instance Pointer to the current instance
  * @param position Current position
  * @pre all block pointers must be valid
@@ -129,18 +233,21 @@ void FillSegment(const Argon2_instance_t* instance, Argon2_position_t position)
  	if (instance == NULL){
 	   return;
  	}    
-	uint64_t pseudo_rand, ref_index, ref_lane;
+	uint64_t pseudo_rand;
 	uint32_t prev_offset, curr_offset;
-	__m128i state[64];
+	alignas(64) uint64_t state[ARGON2_WORDS_IN_BLOCK];
+	const Argon2FillBlockFn FillBlock = Argon2FillBlockResolve();
 	bool data_independent_addressing = (instance->type == Argon2_i) || (instance->type == Argon2_id && (position.pass == 0) && (position.slice < ARGON2_SYNC_POINTS / 2));
 
     
-   // Pseudo-random values that determine the reference block position
-   uint64_t *pseudo_rands = new uint64_t[instance->segment_length];
-   if (pseudo_rands == NULL) {
-		return;
-	}
+   // Pseudo-random values that determine the reference block position; this
+   // lane's row of the scratch FillMemoryBlocks set up
+   uint64_t *pseudo_rands = NULL;
    if (data_independent_addressing) {
+       if (instance->pseudo_rands == NULL) {
+           return;
+       }
+       pseudo_rands = instance->pseudo_rands + (size_t) position.lane * instance->segment_length;
        GenerateAddresses(instance, &position, pseudo_rands);
    }
 
@@ -158,6 +265,16 @@ void FillSegment(const Argon2_instance_t* instance, Argon2_position_t position)
        // Previous block
        prev_offset = curr_offset - 1;
    }
+   // The reference blocks of a data-independent segment are known up front;
+   // keep the next few in flight so the compression does not wait on DRAM
+   const uint32_t distance = data_independent_addressing ? Argon2PrefetchDistance() : 0;
+   const bool prefetch = distance > 0;
+   if (prefetch) {
+       for (uint32_t j = starting_index; j < starting_index + distance && j < instance->segment_length; ++j) {
+           PrefetchBlock(ReferenceBlock(instance, position, j, pseudo_rands[j]));
+       }
+   }
+
    memcpy(state, (uint8_t *) ((instance->memory + prev_offset)->v), ARGON2_BLOCK_SIZE);
    for (uint32_t i = starting_index; i < instance->segment_length; ++i, ++curr_offset, ++prev_offset) {
        /*1.1 Rotating prev_offset if needed */
@@ -173,41 +290,31 @@ void FillSegment(const Argon2_instance_t* instance, Argon2_position_t position)
            pseudo_rand = instance->memory[prev_offset][0];
        }
 
-       /* 1.2.2 Computing the lane of the reference block */
-       ref_lane = ((pseudo_rand >> 32)) % instance->lanes;
-       if ((position.pass == 0) && (position.slice == 0)) {
-           // Can not reference other lanes yet
-           ref_lane = position.lane;
+       /* 1.2.2 Computing the reference block */
+       block* ref_block = ReferenceBlock(instance, position, i, pseudo_rand);
+       if (prefetch && i + distance < instance->segment_length) {
+           uint32_t ahead = i + distance;
+           PrefetchBlock(ReferenceBlock(instance, position, ahead, pseudo_rands[ahead]));
        }
 
-       /* 1.2.3 Computing the number of possible reference block within the lane. */
-       position.index = i;
-       ref_index = IndexAlpha(instance, &position, pseudo_rand & 0xFFFFFFFF, ref_lane == position.lane);
-
        /* 2 Creating a new block */
-       block* ref_block = instance->memory + instance->lane_length * ref_lane + ref_index;
        block* curr_block = instance->memory + curr_offset;
        FillBlock(state, (uint8_t *) ref_block->v, (uint8_t *) curr_block->v, instance->Sbox);
    }
 
-   delete[] pseudo_rands;
-   
 }
 
 void GenerateSbox(Argon2_instance_t* instance) {
-    if (instance == NULL) {
+    if (instance == NULL || instance->Sbox == NULL) {
         return;
     }
-    block start_block(instance->memory[0]), out_block(0), zero_block(0);
-    
-    if (instance->Sbox == NULL) {
-        instance->Sbox = new uint64_t[ARGON2_SBOX_SIZE];
-    }
+    const Argon2FillBlockFn FillBlock = Argon2FillBlockResolve();
+    block start_block(instance->memory[0]), out_block(0);
 
     for (uint32_t i = 0; i < ARGON2_SBOX_SIZE / ARGON2_WORDS_IN_BLOCK; ++i) {
-        block zero_block(0), zero2_block(0);
-        FillBlock((__m128i*) zero_block.v, (uint8_t*) start_block.v, (uint8_t*) out_block.v, NULL);
-        FillBlock((__m128i*) zero2_block.v, (uint8_t*) out_block.v, (uint8_t*) start_block.v, NULL);
+        alignas(64) uint64_t zero_block[ARGON2_WORDS_IN_BLOCK] = {0}, zero2_block[ARGON2_WORDS_IN_BLOCK] = {0};
+        FillBlock(zero_block, (uint8_t*) start_block.v, (uint8_t*) out_block.v, NULL);
+        FillBlock(zero2_block, (uint8_t*) out_block.v, (uint8_t*) start_block.v, NULL);
         memcpy(instance->Sbox + i * ARGON2_WORDS_IN_BLOCK, start_block.v, ARGON2_BLOCK_SIZE);
     }
 }
@@ -155,17 +155,30 @@ void FillSegment(const Argon2_instance_t* instance, Argon2_position_t position)
     
 
 void GenerateSbox(Argon2_instance_t* instance) {
-    if (instance == NULL){
+    if (instance == NULL || instance->Sbox == NULL){
         return;
     }
     block zero_block(0), start_block(instance->memory[0]), out_block(0);
     
-    if (instance->Sbox == NULL){
-        instance->Sbox = new uint64_t[ARGON2_SBOX_SIZE];
-    }
     for (uint32_t i = 0; i < ARGON2_SBOX_SIZE / ARGON2_WORDS_IN_BLOCK; ++i) {
         FillBlock(&zero_block, &start_block, &out_block, NULL);
         FillBlock(&zero_block, &out_block, &start_block, NULL);
         memcpy(instance->Sbox + i*ARGON2_WORDS_IN_BLOCK, start_block.v, ARGON2_BLOCK_SIZE);
     }
 }
+
+const char* Argon2FillBackend() {
+    return "ref";
+}
+
+int Argon2SelectFillBackend(const char* name) {
+    return (name == NULL || strcmp(name, "ref") == 0) ? ARGON2_OK : ARGON2_INCORRECT_PARAMETER;
+}
+
+uint32_t Argon2PrefetchDistance() {
+    return 0;
+}
+
+int Argon2SetPrefetchDistance(uint32_t distance) {
+    return distance == 0 ? ARGON2_OK : ARGON2_INCORRECT_PARAMETER;
+}
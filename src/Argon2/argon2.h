@@ -284,6 +284,80 @@ int VerifyD(Argon2_Context* context, const char *hash);
 const char* ErrorMessage(int error_code);
 
 
+/*
+ * Name of the block kernel used for filling memory: "avx512", "avx2" or "sse2".
+ * The fastest one the CPU supports is picked on first use.
+ */
+const char* Argon2FillBackend();
+
+/*
+ * Forces the block kernel by name, for benchmarks and tests; NULL restores
+ * the automatic choice. Outputs do not depend on the kernel. Should not be
+ * called while other threads are hashing.
+ * @return ARGON2_OK, or ARGON2_INCORRECT_PARAMETER if the name is unknown or the CPU lacks the instructions
+ */
+int Argon2SelectFillBackend(const char* name);
+
+/* Largest distance Argon2SetPrefetchDistance() accepts */
+const uint32_t ARGON2_MAX_PREFETCH_DISTANCE = 256;
+
+/*
+ * How many blocks ahead reference blocks are prefetched while filling a
+ * segment whose addresses are data-independent (Argon2i, first half-pass of
+ * Argon2id); 0 means no prefetching
+ */
+uint32_t Argon2PrefetchDistance();
+
+/*
+ * Sets the prefetch distance, for benchmarks and tests. Outputs do not
+ * depend on it. Should not be called while other threads are hashing.
+ * @return ARGON2_OK, or ARGON2_INCORRECT_PARAMETER if @distance exceeds ARGON2_MAX_PREFETCH_DISTANCE
+ */
+int Argon2SetPrefetchDistance(uint32_t distance);
+
+
+/********************************************* Memory arena --- for repeated hashing *************************************************************/
+
+/*
+ * Pages backing new arena regions. Transparent huge pages are requested with
+ * madvise(MADV_HUGEPAGE); HUGETLB maps from the reserved huge page pool and
+ * falls back to ordinary pages when the pool is empty.
+ */
+enum Argon2_arena_pages {
+    ARGON2_ARENA_PAGES_DEFAULT = 0,
+    ARGON2_ARENA_PAGES_TRANSPARENT = 1,
+    ARGON2_ARENA_PAGES_HUGETLB = 2
+};
+
+/*
+ * Process-wide arena for the block memory. Pass Argon2ArenaAllocate and
+ * Argon2ArenaFree as allocate_cbk/free_cbk: a released region is wiped and kept
+ * mapped, so the next call of about the same size reuses its resident pages
+ * instead of faulting in fresh ones. Regions are at least 64-byte aligned.
+ * Safe to use from several threads at once.
+ */
+int Argon2ArenaAllocate(uint8_t **memory, size_t bytes_to_allocate);
+void Argon2ArenaFree(uint8_t *memory, size_t bytes_to_allocate);
+
+/*
+ * Sets how many bytes of idle regions the arena keeps (1 GiB by default) and
+ * the pages used for regions mapped from now on. Idle regions above the new
+ * limit, or all of them if the page kind changes, are unmapped.
+ * @return ARGON2_OK, or ARGON2_INCORRECT_PARAMETER for an unknown page kind
+ */
+int Argon2ArenaConfigure(size_t cache_limit, Argon2_arena_pages pages);
+
+/*
+ * Bytes currently held in idle regions
+ */
+size_t Argon2ArenaCachedBytes();
+
+/*
+ * Unmaps every idle region
+ */
+void Argon2ArenaTrim();
+
+
 /* Function that securely cleans the memory
  * @param mem Pointer to the memory
  * @param s Memory size in bytes
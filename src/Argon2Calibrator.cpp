@@ -0,0 +1,208 @@
+#include "../include/Argon2Calibrator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "shsThreadPool.hpp"
+
+namespace mylib::crypto {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr unsigned int kSyncPoints = 4;
+constexpr unsigned int kStartMemory = 1 << 10;   // 1 MiB
+constexpr double kHeadroom = 0.95;               // room for run-to-run noise
+
+const char* typeName(Argon2Hasher::Type type) {
+    switch (type) {
+        case Argon2Hasher::Type::i:  return "argon2i";
+        case Argon2Hasher::Type::d:  return "argon2d";
+        case Argon2Hasher::Type::id: return "argon2id";
+    }
+    return "?";
+}
+
+// The core rounds memory down to whole segments; use that size directly so
+// the reported m_cost is the one that ran
+unsigned int roundMemory(size_t m_cost, unsigned int lanes) {
+    const size_t step = size_t(kSyncPoints) * lanes;
+    return static_cast<unsigned int>(std::max(m_cost / step, size_t(2)) * step);
+}
+
+void hashOnce(const Argon2Hasher::Params& params, unsigned int threads, uint8_t seed) {
+    uint8_t out[32];
+    const uint8_t password[16] = {seed, 'c', 'a', 'l', 'i', 'b', 'r', 'a', 't', 'e'};
+    const uint8_t salt[16] = {seed, 's', 'a', 'l', 't'};
+    int result = argon2::hash_argon2(params.type, out, sizeof(out),
+                                     password, sizeof(password), salt, sizeof(salt),
+                                     params.t_cost, params.m_cost, params.lanes, threads);
+    if (result != 0) {
+        throw std::runtime_error(argon2::ErrorMessage(result));
+    }
+}
+
+class Prober {
+public:
+    Prober(const Argon2Calibrator::Target& target, unsigned int threads, Argon2Calibrator::Result& result)
+        : target(target), threads(threads), result(result) {}
+
+    // Median over target.repeats rounds of the time `concurrency`
+    // simultaneous hashes take to finish; the point is added to the curve
+    Argon2Calibrator::Sample probe(const Argon2Hasher::Params& params) {
+        std::vector<double> rounds;
+        for (unsigned int r = 0; r < target.repeats; ++r) {
+            std::vector<std::thread> workers;
+            std::vector<std::string> errors(target.concurrency);
+            auto start = Clock::now();
+            for (unsigned int c = 1; c < target.concurrency; ++c) {
+                workers.emplace_back([&, c]() {
+                    try {
+                        hashOnce(params, threads, static_cast<uint8_t>(c));
+                    } catch (const std::exception& e) {
+                        errors[c] = e.what();
+                    }
+                });
+            }
+            hashOnce(params, threads, 0);
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            rounds.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            for (const auto& error : errors) {
+                if (!error.empty()) {
+                    throw std::runtime_error(error);
+                }
+            }
+        }
+        std::sort(rounds.begin(), rounds.end());
+        const double latency = rounds[rounds.size() / 2];
+
+        Argon2Calibrator::Sample sample;
+        sample.params = params;
+        sample.threads = threads;
+        sample.latency_ms = latency;
+        sample.hashes_per_sec = target.concurrency * 1000.0 / latency;
+        sample.mib_per_sec = sample.hashes_per_sec * params.m_cost * params.t_cost / 1024.0;
+        sample.within_target = latency <= target.max_latency_ms;
+        result.curve.push_back(sample);
+        return sample;
+    }
+
+private:
+    const Argon2Calibrator::Target& target;
+    const unsigned int threads;
+    Argon2Calibrator::Result& result;
+};
+
+} // namespace
+
+Argon2Calibrator::Result Argon2Calibrator::calibrate(const Target& target) {
+    if (target.concurrency == 0 || target.repeats == 0 || !(target.max_latency_ms > 0)) {
+        throw std::invalid_argument("Argon2 calibration: concurrency, repeats and latency must be positive");
+    }
+    const unsigned int cores = static_cast<unsigned int>(shsThreadPool::shared().concurrency());
+    const unsigned int lanes = target.lanes != 0 ? target.lanes
+                                                 : std::max(1u, cores / target.concurrency);
+    const size_t per_hash = target.memory_budget / target.concurrency / 1024;
+    if (per_hash < size_t(2) * kSyncPoints * lanes) {
+        throw std::invalid_argument("Argon2 calibration: memory budget too small for "
+                                    + std::to_string(target.concurrency) + " hashes");
+    }
+    const unsigned int m_max = roundMemory(std::min<size_t>(per_hash, UINT32_MAX), lanes);
+    const unsigned int t_min = std::max(1u, target.min_t_cost);
+
+    Result result;
+    result.target = target;
+    result.threads = lanes;
+    Prober prober(target, lanes, result);
+
+    // Throwaway hash so pool start-up and kernel selection are not measured
+    hashOnce(Argon2Hasher::Params{target.type, 1, roundMemory(kStartMemory, lanes), lanes}, lanes, 0);
+
+    // 1. Memory: double from 1 MiB until the target or the budget is hit,
+    //    then interpolate once between the last good and the first bad point.
+    //    A host too slow for 1 MiB halves down to the minimum first.
+    const unsigned int m_min = roundMemory(0, lanes);
+    Argon2Hasher::Params params{target.type, t_min, std::min(roundMemory(kStartMemory, lanes), m_max), lanes};
+    Sample best = prober.probe(params);
+    while (!best.within_target && params.m_cost > m_min) {
+        params.m_cost = std::max(m_min, roundMemory(params.m_cost / 2, lanes));
+        best = prober.probe(params);
+    }
+    if (!best.within_target) {
+        result.params = best.params;
+        result.latency_ms = best.latency_ms;
+        result.meets_target = false;
+        return result;
+    }
+    while (best.params.m_cost < m_max) {
+        params.m_cost = std::min<unsigned int>(m_max, roundMemory(size_t(best.params.m_cost) * 2, lanes));
+        const Sample next = prober.probe(params);
+        if (!next.within_target) {
+            // Latency grows about linearly with memory
+            size_t guess = static_cast<size_t>(best.params.m_cost * kHeadroom *
+                                               target.max_latency_ms / best.latency_ms);
+            params.m_cost = roundMemory(std::min<size_t>(guess, m_max), lanes);
+            if (params.m_cost > best.params.m_cost && params.m_cost < next.params.m_cost) {
+                const Sample refined = prober.probe(params);
+                if (refined.within_target) {
+                    best = refined;
+                }
+            }
+            break;
+        }
+        best = next;
+    }
+
+    // 2. Passes: spend what is left of the latency on more passes over the
+    //    chosen memory, stepping down until a measured point fits
+    params = best.params;
+    unsigned int t_cost = static_cast<unsigned int>(best.params.t_cost * kHeadroom *
+                                                    target.max_latency_ms / best.latency_ms);
+    while (t_cost > best.params.t_cost) {
+        params.t_cost = t_cost;
+        const Sample next = prober.probe(params);
+        if (next.within_target) {
+            best = next;
+            break;
+        }
+        t_cost = std::min(t_cost - 1, static_cast<unsigned int>(t_cost * target.max_latency_ms / next.latency_ms));
+    }
+
+    result.params = best.params;
+    result.latency_ms = best.latency_ms;
+    result.meets_target = true;
+    return result;
+}
+
+void Argon2Calibrator::Result::writeReport(std::ostream& out) const {
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << "# Argon2 calibration: " << typeName(target.type)
+        << ", <= " << target.max_latency_ms << " ms per hash"
+        << ", " << target.concurrency << " concurrent"
+        << ", " << (target.memory_budget >> 20) << " MiB budget"
+        << ", " << shsThreadPool::shared().concurrency() << " cores\n";
+    out << "# selected: m_cost=" << params.m_cost << " t_cost=" << params.t_cost
+        << " lanes=" << params.lanes << " threads=" << threads
+        << " latency_ms=" << std::fixed << std::setprecision(2) << latency_ms
+        << (meets_target ? "" : " (target not met)") << "\n";
+    out << "m_cost_kib,t_cost,lanes,threads,concurrency,latency_ms,hashes_per_sec,mib_per_sec,within_target\n";
+    for (const auto& s : curve) {
+        out << s.params.m_cost << "," << s.params.t_cost << "," << s.params.lanes << ","
+            << s.threads << "," << target.concurrency << ","
+            << s.latency_ms << "," << s.hashes_per_sec << "," << s.mib_per_sec << ","
+            << (s.within_target ? 1 : 0) << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace mylib::crypto
@@ -0,0 +1,370 @@
+#include "../include/Argon2HashService.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mylib::crypto {
+
+namespace {
+
+constexpr size_t kLatencyWindow = 1024;
+constexpr unsigned int kMinBlocksPerLane = 8;
+
+using Clock = Argon2HashService::Clock;
+
+double millisecondsBetween(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// Argon2 memory of one hash with @params, as the core sizes it
+size_t jobMemory(const Argon2Hasher::Params& params) {
+    size_t blocks = std::max<size_t>(params.m_cost, size_t(kMinBlocksPerLane) * params.lanes);
+    return blocks * 1024;
+}
+
+double percentile(std::vector<double> values, double q) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(q * values.size()));
+    return values[index];
+}
+
+void pushWindow(std::deque<double>& window, double value) {
+    window.push_back(value);
+    if (window.size() > kLatencyWindow) {
+        window.pop_front();
+    }
+}
+
+} // namespace
+
+struct Argon2HashService::Impl {
+    struct Job {
+        size_t memory;
+        Clock::time_point submitted;
+        Clock::time_point deadline;
+        // Computes the result and returns the call that fulfils the promise,
+        // so the worker settles its accounting before the caller wakes up
+        std::function<std::function<void()>()> run;
+        std::function<void(std::exception_ptr)> fail;
+    };
+
+    Options options;
+    unsigned int threads;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable reap;    // wakes the reaper when an earlier deadline arrives
+    std::map<std::string, std::deque<Job>> queues;
+    std::deque<std::string> ready;   // tenants with queued jobs, in round-robin order
+    size_t queued = 0;
+    size_t running = 0;
+    size_t memory_in_use = 0;
+    size_t memory_peak = 0;
+    uint64_t completed = 0;
+    uint64_t expired = 0;
+    uint64_t rejected = 0;
+    std::deque<double> waits;
+    std::deque<double> latencies;
+    Clock::time_point next_deadline = Clock::time_point::max();   // reaper's next wake-up
+    bool stopping = false;
+    std::vector<std::thread> workers;
+    std::thread reaper;
+
+    explicit Impl(const Options& opts) : options(opts) {
+        threads = options.threads_per_job;
+        unsigned int count = options.workers;
+        if (count == 0) {
+            count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        workers.reserve(count);
+        for (unsigned int i = 0; i < count; ++i) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+        reaper = std::thread([this]() { reaperLoop(); });
+    }
+
+    void submit(const std::string& tenant, Job job) {
+        bool stopped;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto& queue = queues[tenant];
+            if (!stopping && (options.max_queue_per_tenant == 0 ||
+                              queue.size() < options.max_queue_per_tenant)) {
+                if (queue.empty()) {
+                    ready.push_back(tenant);
+                }
+                if (job.deadline < next_deadline) {
+                    next_deadline = job.deadline;
+                    reap.notify_one();
+                }
+                queue.push_back(std::move(job));
+                ++queued;
+                wake.notify_one();
+                return;
+            }
+            if (queue.empty()) {
+                queues.erase(tenant);
+            }
+            ++rejected;
+            stopped = stopping;
+        }
+        job.fail(std::make_exception_ptr(Rejected(stopped ? "Argon2 hash service is stopped"
+                                                           : "Argon2 hash service queue is full for tenant " + tenant)));
+    }
+
+    // Takes the head job of the next tenant in turn, moving the tenant to
+    // the back if it has more. Called with the lock held and jobs queued.
+    Job takeNext() {
+        std::string tenant = ready.front();
+        ready.pop_front();
+        auto it = queues.find(tenant);
+        Job job = std::move(it->second.front());
+        it->second.pop_front();
+        if (it->second.empty()) {
+            queues.erase(it);
+        } else {
+            ready.push_back(tenant);
+        }
+        --queued;
+        return job;
+    }
+
+    // Removes every queued job whose deadline is at or before @now, wherever
+    // it sits, and sets next_deadline to the earliest one left. Called with
+    // the lock held.
+    std::vector<Job> takeExpired(Clock::time_point now) {
+        std::vector<Job> expired_jobs;
+        next_deadline = Clock::time_point::max();
+        for (auto it = queues.begin(); it != queues.end();) {
+            auto& queue = it->second;
+            auto keep = std::stable_partition(queue.begin(), queue.end(),
+                                              [now](const Job& job) { return job.deadline > now; });
+            for (auto job = keep; job != queue.end(); ++job) {
+                expired_jobs.push_back(std::move(*job));
+            }
+            queue.erase(keep, queue.end());
+            for (const auto& job : queue) {
+                next_deadline = std::min(next_deadline, job.deadline);
+            }
+            if (queue.empty()) {
+                ready.erase(std::find(ready.begin(), ready.end(), it->first));
+                it = queues.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        queued -= expired_jobs.size();
+        expired += expired_jobs.size();
+        return expired_jobs;
+    }
+
+    // Fails expired jobs as soon as their deadline passes, so they neither
+    // wait for a free worker nor hold their tenant's queue slots
+    void reaperLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            if (next_deadline == Clock::time_point::max()) {
+                reap.wait(lock);
+                continue;
+            }
+            if (Clock::now() < next_deadline) {
+                reap.wait_until(lock, next_deadline);
+                continue;
+            }
+            std::vector<Job> expired_jobs = takeExpired(Clock::now());
+            if (expired_jobs.empty()) {
+                continue;
+            }
+            // A worker waiting for memory may have been waiting on one of these
+            wake.notify_all();
+            lock.unlock();
+            for (auto& job : expired_jobs) {
+                job.fail(std::make_exception_ptr(DeadlineExceeded("Argon2 job deadline passed while queued")));
+            }
+            lock.lock();
+        }
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            if (stopping) {
+                return;
+            }
+            if (ready.empty()) {
+                wake.wait(lock);
+                continue;
+            }
+            const Job& head = queues[ready.front()].front();
+            const auto now = Clock::now();
+            if (head.deadline <= now) {
+                Job job = takeNext();
+                ++expired;
+                lock.unlock();
+                job.fail(std::make_exception_ptr(DeadlineExceeded("Argon2 job deadline passed while queued")));
+                lock.lock();
+                continue;
+            }
+            // Strict turn order: a large job waits for memory rather than
+            // letting smaller ones behind it overtake it indefinitely
+            if (memory_in_use + head.memory > options.memory_budget) {
+                if (head.deadline == Clock::time_point::max()) {
+                    wake.wait(lock);
+                } else {
+                    wake.wait_until(lock, head.deadline);
+                }
+                continue;
+            }
+
+            Job job = takeNext();
+            memory_in_use += job.memory;
+            memory_peak = std::max(memory_peak, memory_in_use);
+            ++running;
+            pushWindow(waits, millisecondsBetween(job.submitted, now));
+            lock.unlock();
+
+            std::function<void()> deliver = job.run();
+
+            lock.lock();
+            memory_in_use -= job.memory;
+            --running;
+            ++completed;
+            pushWindow(latencies, millisecondsBetween(job.submitted, Clock::now()));
+            wake.notify_all();
+            lock.unlock();
+            deliver();
+            lock.lock();
+        }
+    }
+};
+
+Argon2HashService::Argon2HashService() : Argon2HashService(Options()) {}
+
+Argon2HashService::Argon2HashService(const Options& options) : impl(std::make_unique<Impl>(options)) {}
+
+Argon2HashService::~Argon2HashService() {
+    std::vector<Impl::Job> pending;
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->stopping = true;
+        while (!impl->ready.empty()) {
+            pending.push_back(impl->takeNext());
+        }
+        impl->rejected += pending.size();
+    }
+    impl->wake.notify_all();
+    impl->reap.notify_all();
+    for (auto& worker : impl->workers) {
+        worker.join();
+    }
+    impl->reaper.join();
+    for (auto& job : pending) {
+        job.fail(std::make_exception_ptr(Rejected("Argon2 hash service is stopped")));
+    }
+}
+
+std::future<std::string> Argon2HashService::hash(const std::string& tenant, std::string password,
+                                                 Clock::time_point deadline) {
+    const Argon2Hasher::Params params = impl->options.params;
+    const size_t memory = jobMemory(params);
+    if (memory > impl->options.memory_budget) {
+        throw std::invalid_argument("Argon2 hash service: m_cost exceeds the memory budget");
+    }
+    auto promise = std::make_shared<std::promise<std::string>>();
+    auto secret = std::make_shared<std::string>(std::move(password));
+    const unsigned int threads = impl->threads;
+    Impl::Job job;
+    job.memory = memory;
+    job.submitted = Clock::now();
+    job.deadline = deadline;
+    job.run = [promise, secret, params, threads]() -> std::function<void()> {
+        std::function<void()> deliver;
+        try {
+            auto stored = std::make_shared<std::string>(Argon2Hasher::hashPasswordWithSalt(
+                *secret, params.t_cost, params.m_cost, 16, 32, params.type, params.lanes, threads));
+            deliver = [promise, stored]() { promise->set_value(std::move(*stored)); };
+        } catch (...) {
+            deliver = [promise, error = std::current_exception()]() { promise->set_exception(error); };
+        }
+        argon2::secure_wipe_memory(&(*secret)[0], secret->size());
+        return deliver;
+    };
+    job.fail = [promise, secret](std::exception_ptr error) {
+        argon2::secure_wipe_memory(&(*secret)[0], secret->size());
+        promise->set_exception(error);
+    };
+    auto future = promise->get_future();
+    impl->submit(tenant, std::move(job));
+    return future;
+}
+
+std::future<bool> Argon2HashService::verify(const std::string& tenant, std::string password,
+                                            std::string stored, Clock::time_point deadline) {
+    const size_t memory = jobMemory(Argon2Hasher::storedParams(stored));
+    if (memory > impl->options.memory_budget) {
+        throw std::invalid_argument("Argon2 hash service: m_cost exceeds the memory budget");
+    }
+    auto promise = std::make_shared<std::promise<bool>>();
+    auto secret = std::make_shared<std::string>(std::move(password));
+    auto hash = std::make_shared<std::string>(std::move(stored));
+    const unsigned int threads = impl->threads;
+    Impl::Job job;
+    job.memory = memory;
+    job.submitted = Clock::now();
+    job.deadline = deadline;
+    job.run = [promise, secret, hash, threads]() -> std::function<void()> {
+        std::function<void()> deliver;
+        try {
+            bool match = Argon2Hasher::verifyPassword(*secret, *hash, 3, 1 << 12, 32, threads);
+            deliver = [promise, match]() { promise->set_value(match); };
+        } catch (...) {
+            deliver = [promise, error = std::current_exception()]() { promise->set_exception(error); };
+        }
+        argon2::secure_wipe_memory(&(*secret)[0], secret->size());
+        return deliver;
+    };
+    job.fail = [promise, secret](std::exception_ptr error) {
+        argon2::secure_wipe_memory(&(*secret)[0], secret->size());
+        promise->set_exception(error);
+    };
+    auto future = promise->get_future();
+    impl->submit(tenant, std::move(job));
+    return future;
+}
+
+Argon2HashService::Metrics Argon2HashService::metrics() const {
+    std::vector<double> waits;
+    std::vector<double> latencies;
+    Metrics m;
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        m.queue_depth = impl->queued;
+        for (const auto& [tenant, queue] : impl->queues) {
+            m.tenant_queue_depth[tenant] = queue.size();
+        }
+        m.running = impl->running;
+        m.memory_in_use = impl->memory_in_use;
+        m.memory_peak = impl->memory_peak;
+        m.completed = impl->completed;
+        m.expired = impl->expired;
+        m.rejected = impl->rejected;
+        waits.assign(impl->waits.begin(), impl->waits.end());
+        latencies.assign(impl->latencies.begin(), impl->latencies.end());
+    }
+    m.wait_p50_ms = percentile(waits, 0.50);
+    m.wait_p99_ms = percentile(waits, 0.99);
+    m.latency_p50_ms = percentile(latencies, 0.50);
+    m.latency_p99_ms = percentile(latencies, 0.99);
+    m.latency_max_ms = latencies.empty() ? 0 : *std::max_element(latencies.begin(), latencies.end());
+    return m;
+}
+
+} // namespace mylib::crypto
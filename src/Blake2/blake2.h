@@ -43,6 +43,28 @@ typedef struct __blake2b_state {
     uint8_t last_node;
 } blake2b_state;
 
+/* BLAKE2bp: four leaves fed 128-byte blocks round-robin, combined by a
+ * root node. The leaves advance together in SIMD lanes. */
+#define BLAKE2BP_PARALLELISM 4
+
+typedef struct __blake2bp_state {
+    blake2b_state S[BLAKE2BP_PARALLELISM];
+    blake2b_state R;
+    uint8_t buf[BLAKE2BP_PARALLELISM * BLAKE2B_BLOCKBYTES];
+    size_t buflen;
+    size_t outlen;
+} blake2bp_state;
+
+/* BLAKE2Xb: a Blake2b root hash over the input, expanded into independent
+ * 64-byte output blocks (node_offset = block index). The 32-bit XOF
+ * length shares the node_offset word. */
+#define BLAKE2XB_UNKNOWN_LENGTH 0xFFFFFFFFUL
+
+typedef struct __blake2xb_state {
+    blake2b_state S;
+    blake2b_param P;
+} blake2xb_state;
+
 /* Ensure param structs have not been wrongly padded */
 /* Poor man's static_assert */
 enum {
@@ -62,6 +84,33 @@ int blake2b_final(blake2b_state *S, void *out, size_t outlen);
 /* Simple API */
 int blake2b(void *out, size_t outlen, const void *in, size_t inlen,
             const void *key, size_t keylen);
+/* Unkeyed Blake2b of at most BLAKE2B_BLOCKBYTES bytes: one compression of
+ * a padded stack block, no state setup. blake2b() takes this path by
+ * itself for such inputs. */
+int blake2b_oneblock(void *out, size_t outlen, const void *in, size_t inlen);
+
+int blake2bp_init(blake2bp_state *S, size_t outlen);
+int blake2bp_init_key(blake2bp_state *S, size_t outlen, const void *key,
+                      size_t keylen);
+int blake2bp_update(blake2bp_state *S, const void *in, size_t inlen);
+int blake2bp_final(blake2bp_state *S, void *out, size_t outlen);
+int blake2bp(void *out, size_t outlen, const void *in, size_t inlen,
+             const void *key, size_t keylen);
+
+int blake2xb_init(blake2xb_state *S, size_t outlen);
+int blake2xb_init_key(blake2xb_state *S, size_t outlen, const void *key,
+                      size_t keylen);
+int blake2xb_update(blake2xb_state *S, const void *in, size_t inlen);
+/* Finishes the root hash; the state must not be updated afterwards */
+int blake2xb_root(blake2xb_state *S, uint8_t root[BLAKE2B_OUTBYTES]);
+/* Bytes [offset, offset + outlen) of the output stream of `root`. With
+ * BLAKE2XB_UNKNOWN_LENGTH every block is a full 64-byte digest, so reads
+ * are prefix-consistent up to 2^32 blocks. */
+int blake2xb_output(const blake2xb_state *S, const uint8_t root[BLAKE2B_OUTBYTES],
+                    uint64_t offset, void *out, size_t outlen);
+int blake2xb_final(blake2xb_state *S, void *out, size_t outlen);
+int blake2xb(void *out, size_t outlen, const void *in, size_t inlen,
+             const void *key, size_t keylen);
 
 /* Argon2 Team - Begin Code */
 int blake2b_long(void *out, size_t outlen, const void *in, size_t inlen);
@@ -0,0 +1,479 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "blake2b-compress.h"
+#include "blake2-impl.h"
+
+#ifdef BLAKE2B_HAVE_SIMD
+
+#include <immintrin.h>
+
+static const uint64_t blake2b_simd_IV[8] = {
+    UINT64_C(0x6a09e667f3bcc908), UINT64_C(0xbb67ae8584caa73b),
+    UINT64_C(0x3c6ef372fe94f82b), UINT64_C(0xa54ff53a5f1d36f1),
+    UINT64_C(0x510e527fade682d1), UINT64_C(0x9b05688c2b3e6c1f),
+    UINT64_C(0x1f83d9abfb41bd6b), UINT64_C(0x5be0cd19137e2179)};
+
+/* Message schedule; with the rounds unrolled every index is a constant */
+static const uint8_t blake2b_simd_sigma[12][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+    {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
+    {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+    {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13},
+    {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+    {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11},
+    {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+    {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5},
+    {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+};
+
+#define SIGMA(r, i) blake2b_simd_sigma[r][i]
+
+/* ---------------------------------------------------------------------- */
+/* SSSE3 / SSE4.1: each row of the 4x4 state is split over two registers  */
+
+#define SSE_ROTR32(x) _mm_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+#define SSE_ROTR24(x) _mm_shuffle_epi8((x), r24)
+#define SSE_ROTR16(x) _mm_shuffle_epi8((x), r16)
+#define SSE_ROTR63(x) _mm_xor_si128(_mm_srli_epi64((x), 63), _mm_add_epi64((x), (x)))
+
+#define SSE_G1(b0, b1)                                                         \
+    do {                                                                       \
+        row1l = _mm_add_epi64(_mm_add_epi64(row1l, b0), row2l);                \
+        row1h = _mm_add_epi64(_mm_add_epi64(row1h, b1), row2h);                \
+        row4l = SSE_ROTR32(_mm_xor_si128(row4l, row1l));                       \
+        row4h = SSE_ROTR32(_mm_xor_si128(row4h, row1h));                       \
+        row3l = _mm_add_epi64(row3l, row4l);                                   \
+        row3h = _mm_add_epi64(row3h, row4h);                                   \
+        row2l = SSE_ROTR24(_mm_xor_si128(row2l, row3l));                       \
+        row2h = SSE_ROTR24(_mm_xor_si128(row2h, row3h));                       \
+    } while ((void)0, 0)
+
+#define SSE_G2(b0, b1)                                                         \
+    do {                                                                       \
+        row1l = _mm_add_epi64(_mm_add_epi64(row1l, b0), row2l);                \
+        row1h = _mm_add_epi64(_mm_add_epi64(row1h, b1), row2h);                \
+        row4l = SSE_ROTR16(_mm_xor_si128(row4l, row1l));                       \
+        row4h = SSE_ROTR16(_mm_xor_si128(row4h, row1h));                       \
+        row3l = _mm_add_epi64(row3l, row4l);                                   \
+        row3h = _mm_add_epi64(row3h, row4h);                                   \
+        row2l = SSE_ROTR63(_mm_xor_si128(row2l, row3l));                       \
+        row2h = SSE_ROTR63(_mm_xor_si128(row2h, row3h));                       \
+    } while ((void)0, 0)
+
+#define SSE_DIAGONALIZE()                                                      \
+    do {                                                                       \
+        __m128i t0 = _mm_alignr_epi8(row2h, row2l, 8);                         \
+        __m128i t1 = _mm_alignr_epi8(row2l, row2h, 8);                         \
+        row2l = t0;                                                            \
+        row2h = t1;                                                            \
+        t0 = row3l;                                                            \
+        row3l = row3h;                                                         \
+        row3h = t0;                                                            \
+        t0 = _mm_alignr_epi8(row4h, row4l, 8);                                 \
+        t1 = _mm_alignr_epi8(row4l, row4h, 8);                                 \
+        row4l = t1;                                                            \
+        row4h = t0;                                                            \
+    } while ((void)0, 0)
+
+#define SSE_UNDIAGONALIZE()                                                    \
+    do {                                                                       \
+        __m128i t0 = _mm_alignr_epi8(row2l, row2h, 8);                         \
+        __m128i t1 = _mm_alignr_epi8(row2h, row2l, 8);                         \
+        row2l = t0;                                                            \
+        row2h = t1;                                                            \
+        t0 = row3l;                                                            \
+        row3l = row3h;                                                         \
+        row3h = t0;                                                            \
+        t0 = _mm_alignr_epi8(row4l, row4h, 8);                                 \
+        t1 = _mm_alignr_epi8(row4h, row4l, 8);                                 \
+        row4l = t1;                                                            \
+        row4h = t0;                                                            \
+    } while ((void)0, 0)
+
+/* lane 0 of each register pair handles the even G of the step */
+#define SSE_MSG(r, i, j) \
+    _mm_set_epi64x((long long)m[SIGMA(r, j)], (long long)m[SIGMA(r, i)])
+
+#define SSE_ROUND(r)                                                           \
+    do {                                                                       \
+        SSE_G1(SSE_MSG(r, 0, 2), SSE_MSG(r, 4, 6));                            \
+        SSE_G2(SSE_MSG(r, 1, 3), SSE_MSG(r, 5, 7));                            \
+        SSE_DIAGONALIZE();                                                     \
+        SSE_G1(SSE_MSG(r, 8, 10), SSE_MSG(r, 12, 14));                         \
+        SSE_G2(SSE_MSG(r, 9, 11), SSE_MSG(r, 13, 15));                         \
+        SSE_UNDIAGONALIZE();                                                   \
+    } while ((void)0, 0)
+
+/* Body shared by the SSSE3 and SSE4.1 builds; SSE4.1 only changes how the
+ * compiler inserts the message words (pinsrq instead of unpacks) */
+#define SSE_COMPRESS_BODY(S, block)                                            \
+    do {                                                                       \
+        const __m128i r16 = _mm_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1,              \
+                                          10, 11, 12, 13, 14, 15, 8, 9);       \
+        const __m128i r24 = _mm_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2,              \
+                                          11, 12, 13, 14, 15, 8, 9, 10);       \
+        uint64_t m[16];                                                        \
+        __m128i row1l, row1h, row2l, row2h, row3l, row3h, row4l, row4h;        \
+        unsigned int i;                                                        \
+                                                                               \
+        for (i = 0; i < 16; ++i) {                                             \
+            m[i] = load64((block) + i * sizeof(m[i]));                         \
+        }                                                                      \
+                                                                               \
+        row1l = _mm_loadu_si128((const __m128i *)&(S)->h[0]);                  \
+        row1h = _mm_loadu_si128((const __m128i *)&(S)->h[2]);                  \
+        row2l = _mm_loadu_si128((const __m128i *)&(S)->h[4]);                  \
+        row2h = _mm_loadu_si128((const __m128i *)&(S)->h[6]);                  \
+        row3l = _mm_loadu_si128((const __m128i *)&blake2b_simd_IV[0]);         \
+        row3h = _mm_loadu_si128((const __m128i *)&blake2b_simd_IV[2]);         \
+        row4l = _mm_xor_si128(                                                 \
+            _mm_loadu_si128((const __m128i *)&blake2b_simd_IV[4]),             \
+            _mm_loadu_si128((const __m128i *)&(S)->t[0]));                     \
+        row4h = _mm_xor_si128(                                                 \
+            _mm_loadu_si128((const __m128i *)&blake2b_simd_IV[6]),             \
+            _mm_loadu_si128((const __m128i *)&(S)->f[0]));                     \
+                                                                               \
+        SSE_ROUND(0);                                                          \
+        SSE_ROUND(1);                                                          \
+        SSE_ROUND(2);                                                          \
+        SSE_ROUND(3);                                                          \
+        SSE_ROUND(4);                                                          \
+        SSE_ROUND(5);                                                          \
+        SSE_ROUND(6);                                                          \
+        SSE_ROUND(7);                                                          \
+        SSE_ROUND(8);                                                          \
+        SSE_ROUND(9);                                                          \
+        SSE_ROUND(10);                                                         \
+        SSE_ROUND(11);                                                         \
+                                                                               \
+        row1l = _mm_xor_si128(row1l, row3l);                                   \
+        row1h = _mm_xor_si128(row1h, row3h);                                   \
+        row2l = _mm_xor_si128(row2l, row4l);                                   \
+        row2h = _mm_xor_si128(row2h, row4h);                                   \
+        _mm_storeu_si128((__m128i *)&(S)->h[0], _mm_xor_si128(                 \
+            _mm_loadu_si128((const __m128i *)&(S)->h[0]), row1l));             \
+        _mm_storeu_si128((__m128i *)&(S)->h[2], _mm_xor_si128(                 \
+            _mm_loadu_si128((const __m128i *)&(S)->h[2]), row1h));             \
+        _mm_storeu_si128((__m128i *)&(S)->h[4], _mm_xor_si128(                 \
+            _mm_loadu_si128((const __m128i *)&(S)->h[4]), row2l));             \
+        _mm_storeu_si128((__m128i *)&(S)->h[6], _mm_xor_si128(                 \
+            _mm_loadu_si128((const __m128i *)&(S)->h[6]), row2h));             \
+    } while ((void)0, 0)
+
+SHS_TARGET("ssse3")
+void blake2b_compress_ssse3(blake2b_state *S, const uint8_t *block) {
+    SSE_COMPRESS_BODY(S, block);
+}
+
+SHS_TARGET("sse4.1")
+void blake2b_compress_sse41(blake2b_state *S, const uint8_t *block) {
+    SSE_COMPRESS_BODY(S, block);
+}
+
+/* ---------------------------------------------------------------------- */
+/* AVX2: one row per register, diagonalization by vpermq                  */
+
+#define AVX2_ROTR32(x) _mm256_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+#define AVX2_ROTR24(x) _mm256_shuffle_epi8((x), r24)
+#define AVX2_ROTR16(x) _mm256_shuffle_epi8((x), r16)
+#define AVX2_ROTR63(x) _mm256_xor_si256(_mm256_srli_epi64((x), 63), _mm256_add_epi64((x), (x)))
+
+#define AVX2_G1(msg)                                                           \
+    do {                                                                       \
+        a = _mm256_add_epi64(_mm256_add_epi64(a, msg), b);                     \
+        d = AVX2_ROTR32(_mm256_xor_si256(d, a));                               \
+        c = _mm256_add_epi64(c, d);                                            \
+        b = AVX2_ROTR24(_mm256_xor_si256(b, c));                               \
+    } while ((void)0, 0)
+
+#define AVX2_G2(msg)                                                           \
+    do {                                                                       \
+        a = _mm256_add_epi64(_mm256_add_epi64(a, msg), b);                     \
+        d = AVX2_ROTR16(_mm256_xor_si256(d, a));                               \
+        c = _mm256_add_epi64(c, d);                                            \
+        b = AVX2_ROTR63(_mm256_xor_si256(b, c));                               \
+    } while ((void)0, 0)
+
+#define AVX2_DIAGONALIZE()                                                     \
+    do {                                                                       \
+        b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(0, 3, 2, 1));              \
+        c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));              \
+        d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(2, 1, 0, 3));              \
+    } while ((void)0, 0)
+
+#define AVX2_UNDIAGONALIZE()                                                   \
+    do {                                                                       \
+        b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(2, 1, 0, 3));              \
+        c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));              \
+        d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(0, 3, 2, 1));              \
+    } while ((void)0, 0)
+
+#define AVX2_MSG(r, i0, i1, i2, i3)                                            \
+    _mm256_set_epi64x((long long)m[SIGMA(r, i3)], (long long)m[SIGMA(r, i2)],  \
+                      (long long)m[SIGMA(r, i1)], (long long)m[SIGMA(r, i0)])
+
+#define AVX2_ROUND(r)                                                          \
+    do {                                                                       \
+        AVX2_G1(AVX2_MSG(r, 0, 2, 4, 6));                                      \
+        AVX2_G2(AVX2_MSG(r, 1, 3, 5, 7));                                      \
+        AVX2_DIAGONALIZE();                                                    \
+        AVX2_G1(AVX2_MSG(r, 8, 10, 12, 14));                                   \
+        AVX2_G2(AVX2_MSG(r, 9, 11, 13, 15));                                   \
+        AVX2_UNDIAGONALIZE();                                                  \
+    } while ((void)0, 0)
+
+SHS_TARGET("avx2")
+void blake2b_compress_avx2(blake2b_state *S, const uint8_t *block) {
+    const __m256i r16 = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+                                         2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+    const __m256i r24 = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+                                         3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+    uint64_t m[16];
+    __m256i a, b, c, d;
+    const __m256i h0 = _mm256_loadu_si256((const __m256i *)&S->h[0]);
+    const __m256i h1 = _mm256_loadu_si256((const __m256i *)&S->h[4]);
+    unsigned int i;
+
+    for (i = 0; i < 16; ++i) {
+        m[i] = load64(block + i * sizeof(m[i]));
+    }
+
+    a = h0;
+    b = h1;
+    c = _mm256_loadu_si256((const __m256i *)&blake2b_simd_IV[0]);
+    /* t[0], t[1], f[0], f[1] are contiguous in the state */
+    d = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)&blake2b_simd_IV[4]),
+                         _mm256_loadu_si256((const __m256i *)&S->t[0]));
+
+    AVX2_ROUND(0);
+    AVX2_ROUND(1);
+    AVX2_ROUND(2);
+    AVX2_ROUND(3);
+    AVX2_ROUND(4);
+    AVX2_ROUND(5);
+    AVX2_ROUND(6);
+    AVX2_ROUND(7);
+    AVX2_ROUND(8);
+    AVX2_ROUND(9);
+    AVX2_ROUND(10);
+    AVX2_ROUND(11);
+
+    _mm256_storeu_si256((__m256i *)&S->h[0], _mm256_xor_si256(h0, _mm256_xor_si256(a, c)));
+    _mm256_storeu_si256((__m256i *)&S->h[4], _mm256_xor_si256(h1, _mm256_xor_si256(b, d)));
+}
+
+/* ---------------------------------------------------------------------- */
+/* AVX2, four states: lane l of every register belongs to S[l], so G runs  */
+/* on whole registers with no diagonalization                             */
+
+#define X4_G(r, i, a, b, c, d)                                                 \
+    do {                                                                       \
+        v[a] = _mm256_add_epi64(_mm256_add_epi64(v[a], v[b]), m[SIGMA(r, 2 * (i))]); \
+        v[d] = AVX2_ROTR32(_mm256_xor_si256(v[d], v[a]));                      \
+        v[c] = _mm256_add_epi64(v[c], v[d]);                                   \
+        v[b] = AVX2_ROTR24(_mm256_xor_si256(v[b], v[c]));                      \
+        v[a] = _mm256_add_epi64(_mm256_add_epi64(v[a], v[b]), m[SIGMA(r, 2 * (i) + 1)]); \
+        v[d] = AVX2_ROTR16(_mm256_xor_si256(v[d], v[a]));                      \
+        v[c] = _mm256_add_epi64(v[c], v[d]);                                   \
+        v[b] = AVX2_ROTR63(_mm256_xor_si256(v[b], v[c]));                      \
+    } while ((void)0, 0)
+
+#define X4_ROUND(r)                                                            \
+    do {                                                                       \
+        X4_G(r, 0, 0, 4, 8, 12);                                               \
+        X4_G(r, 1, 1, 5, 9, 13);                                               \
+        X4_G(r, 2, 2, 6, 10, 14);                                              \
+        X4_G(r, 3, 3, 7, 11, 15);                                              \
+        X4_G(r, 4, 0, 5, 10, 15);                                              \
+        X4_G(r, 5, 1, 6, 11, 12);                                              \
+        X4_G(r, 6, 2, 7, 8, 13);                                               \
+        X4_G(r, 7, 3, 4, 9, 14);                                               \
+    } while ((void)0, 0)
+
+/* 4x4 transpose of 64-bit elements: row k of the input becomes lane k */
+#define X4_TRANSPOSE(r0, r1, r2, r3)                                           \
+    do {                                                                       \
+        __m256i t0 = _mm256_unpacklo_epi64(r0, r1);                            \
+        __m256i t1 = _mm256_unpackhi_epi64(r0, r1);                            \
+        __m256i t2 = _mm256_unpacklo_epi64(r2, r3);                            \
+        __m256i t3 = _mm256_unpackhi_epi64(r2, r3);                            \
+        r0 = _mm256_permute2x128_si256(t0, t2, 0x20);                          \
+        r1 = _mm256_permute2x128_si256(t1, t3, 0x20);                          \
+        r2 = _mm256_permute2x128_si256(t0, t2, 0x31);                          \
+        r3 = _mm256_permute2x128_si256(t1, t3, 0x31);                          \
+    } while ((void)0, 0)
+
+/* Load words [w, w+4) of four lane sources into out[w..w+3], transposed */
+#define X4_LOAD(out, w, p0, p1, p2, p3)                                        \
+    do {                                                                       \
+        out[(w) + 0] = _mm256_loadu_si256((const __m256i *)(p0));              \
+        out[(w) + 1] = _mm256_loadu_si256((const __m256i *)(p1));              \
+        out[(w) + 2] = _mm256_loadu_si256((const __m256i *)(p2));              \
+        out[(w) + 3] = _mm256_loadu_si256((const __m256i *)(p3));              \
+        X4_TRANSPOSE(out[(w) + 0], out[(w) + 1], out[(w) + 2], out[(w) + 3]);  \
+    } while ((void)0, 0)
+
+SHS_TARGET("avx2")
+void blake2b_compress_x4_avx2(blake2b_state *S[4], const uint8_t *const blocks[4]) {
+    const __m256i r16 = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+                                         2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+    const __m256i r24 = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+                                         3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+    __m256i m[16], v[16], h[8], tf[4];
+    unsigned int i;
+
+    for (i = 0; i < 16; i += 4) {
+        X4_LOAD(m, i, blocks[0] + 8 * i, blocks[1] + 8 * i, blocks[2] + 8 * i, blocks[3] + 8 * i);
+    }
+    X4_LOAD(h, 0, &S[0]->h[0], &S[1]->h[0], &S[2]->h[0], &S[3]->h[0]);
+    X4_LOAD(h, 4, &S[0]->h[4], &S[1]->h[4], &S[2]->h[4], &S[3]->h[4]);
+    /* t[0], t[1], f[0], f[1] */
+    X4_LOAD(tf, 0, &S[0]->t[0], &S[1]->t[0], &S[2]->t[0], &S[3]->t[0]);
+
+    for (i = 0; i < 8; ++i) {
+        v[i] = h[i];
+        v[i + 8] = _mm256_set1_epi64x((long long)blake2b_simd_IV[i]);
+    }
+    for (i = 0; i < 4; ++i) {
+        v[12 + i] = _mm256_xor_si256(v[12 + i], tf[i]);
+    }
+
+    X4_ROUND(0);
+    X4_ROUND(1);
+    X4_ROUND(2);
+    X4_ROUND(3);
+    X4_ROUND(4);
+    X4_ROUND(5);
+    X4_ROUND(6);
+    X4_ROUND(7);
+    X4_ROUND(8);
+    X4_ROUND(9);
+    X4_ROUND(10);
+    X4_ROUND(11);
+
+    for (i = 0; i < 8; ++i) {
+        h[i] = _mm256_xor_si256(h[i], _mm256_xor_si256(v[i], v[i + 8]));
+    }
+    /* the transpose is its own inverse */
+    X4_TRANSPOSE(h[0], h[1], h[2], h[3]);
+    X4_TRANSPOSE(h[4], h[5], h[6], h[7]);
+    for (i = 0; i < 4; ++i) {
+        _mm256_storeu_si256((__m256i *)&S[i]->h[0], h[i]);
+        _mm256_storeu_si256((__m256i *)&S[i]->h[4], h[i + 4]);
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/* AVX-512, eight states: same layout as X4 with native 64-bit rotates    */
+
+#define X8_G(r, i, a, b, c, d)                                                 \
+    do {                                                                       \
+        v[a] = _mm512_add_epi64(_mm512_add_epi64(v[a], v[b]), m[SIGMA(r, 2 * (i))]); \
+        v[d] = _mm512_ror_epi64(_mm512_xor_si512(v[d], v[a]), 32);             \
+        v[c] = _mm512_add_epi64(v[c], v[d]);                                   \
+        v[b] = _mm512_ror_epi64(_mm512_xor_si512(v[b], v[c]), 24);             \
+        v[a] = _mm512_add_epi64(_mm512_add_epi64(v[a], v[b]), m[SIGMA(r, 2 * (i) + 1)]); \
+        v[d] = _mm512_ror_epi64(_mm512_xor_si512(v[d], v[a]), 16);             \
+        v[c] = _mm512_add_epi64(v[c], v[d]);                                   \
+        v[b] = _mm512_ror_epi64(_mm512_xor_si512(v[b], v[c]), 63);             \
+    } while ((void)0, 0)
+
+#define X8_ROUND(r)                                                            \
+    do {                                                                       \
+        X8_G(r, 0, 0, 4, 8, 12);                                               \
+        X8_G(r, 1, 1, 5, 9, 13);                                               \
+        X8_G(r, 2, 2, 6, 10, 14);                                              \
+        X8_G(r, 3, 3, 7, 11, 15);                                              \
+        X8_G(r, 4, 0, 5, 10, 15);                                              \
+        X8_G(r, 5, 1, 6, 11, 12);                                              \
+        X8_G(r, 6, 2, 7, 8, 13);                                               \
+        X8_G(r, 7, 3, 4, 9, 14);                                               \
+    } while ((void)0, 0)
+
+/* 8x8 transpose of 64-bit elements in place over r[0..7] */
+#define X8_TRANSPOSE(r)                                                        \
+    do {                                                                       \
+        __m512i t0 = _mm512_unpacklo_epi64(r[0], r[1]);                        \
+        __m512i t1 = _mm512_unpackhi_epi64(r[0], r[1]);                        \
+        __m512i t2 = _mm512_unpacklo_epi64(r[2], r[3]);                        \
+        __m512i t3 = _mm512_unpackhi_epi64(r[2], r[3]);                        \
+        __m512i t4 = _mm512_unpacklo_epi64(r[4], r[5]);                        \
+        __m512i t5 = _mm512_unpackhi_epi64(r[4], r[5]);                        \
+        __m512i t6 = _mm512_unpacklo_epi64(r[6], r[7]);                        \
+        __m512i t7 = _mm512_unpackhi_epi64(r[6], r[7]);                        \
+        __m512i u0 = _mm512_shuffle_i64x2(t0, t2, _MM_SHUFFLE(2, 0, 2, 0));    \
+        __m512i u1 = _mm512_shuffle_i64x2(t0, t2, _MM_SHUFFLE(3, 1, 3, 1));    \
+        __m512i u2 = _mm512_shuffle_i64x2(t1, t3, _MM_SHUFFLE(2, 0, 2, 0));    \
+        __m512i u3 = _mm512_shuffle_i64x2(t1, t3, _MM_SHUFFLE(3, 1, 3, 1));    \
+        __m512i u4 = _mm512_shuffle_i64x2(t4, t6, _MM_SHUFFLE(2, 0, 2, 0));    \
+        __m512i u5 = _mm512_shuffle_i64x2(t4, t6, _MM_SHUFFLE(3, 1, 3, 1));    \
+        __m512i u6 = _mm512_shuffle_i64x2(t5, t7, _MM_SHUFFLE(2, 0, 2, 0));    \
+        __m512i u7 = _mm512_shuffle_i64x2(t5, t7, _MM_SHUFFLE(3, 1, 3, 1));    \
+        r[0] = _mm512_shuffle_i64x2(u0, u4, _MM_SHUFFLE(2, 0, 2, 0));          \
+        r[4] = _mm512_shuffle_i64x2(u0, u4, _MM_SHUFFLE(3, 1, 3, 1));          \
+        r[2] = _mm512_shuffle_i64x2(u1, u5, _MM_SHUFFLE(2, 0, 2, 0));          \
+        r[6] = _mm512_shuffle_i64x2(u1, u5, _MM_SHUFFLE(3, 1, 3, 1));          \
+        r[1] = _mm512_shuffle_i64x2(u2, u6, _MM_SHUFFLE(2, 0, 2, 0));          \
+        r[5] = _mm512_shuffle_i64x2(u2, u6, _MM_SHUFFLE(3, 1, 3, 1));          \
+        r[3] = _mm512_shuffle_i64x2(u3, u7, _MM_SHUFFLE(2, 0, 2, 0));          \
+        r[7] = _mm512_shuffle_i64x2(u3, u7, _MM_SHUFFLE(3, 1, 3, 1));          \
+    } while ((void)0, 0)
+
+#define X8_LANES(field) \
+    _mm512_set_epi64((long long)S[7]->field, (long long)S[6]->field,           \
+                     (long long)S[5]->field, (long long)S[4]->field,           \
+                     (long long)S[3]->field, (long long)S[2]->field,           \
+                     (long long)S[1]->field, (long long)S[0]->field)
+
+SHS_TARGET("avx512f")
+void blake2b_compress_x8_avx512(blake2b_state *S[8], const uint8_t *const blocks[8]) {
+    __m512i m[16], v[16], h[8];
+    unsigned int i, w;
+
+    for (w = 0; w < 16; w += 8) {
+        for (i = 0; i < 8; ++i) {
+            m[w + i] = _mm512_loadu_si512((const void *)(blocks[i] + 8 * w));
+        }
+        X8_TRANSPOSE((m + w));
+    }
+    for (i = 0; i < 8; ++i) {
+        h[i] = _mm512_loadu_si512((const void *)S[i]->h);
+    }
+    X8_TRANSPOSE(h);
+
+    for (i = 0; i < 8; ++i) {
+        v[i] = h[i];
+        v[i + 8] = _mm512_set1_epi64((long long)blake2b_simd_IV[i]);
+    }
+    v[12] = _mm512_xor_si512(v[12], X8_LANES(t[0]));
+    v[13] = _mm512_xor_si512(v[13], X8_LANES(t[1]));
+    v[14] = _mm512_xor_si512(v[14], X8_LANES(f[0]));
+    v[15] = _mm512_xor_si512(v[15], X8_LANES(f[1]));
+
+    X8_ROUND(0);
+    X8_ROUND(1);
+    X8_ROUND(2);
+    X8_ROUND(3);
+    X8_ROUND(4);
+    X8_ROUND(5);
+    X8_ROUND(6);
+    X8_ROUND(7);
+    X8_ROUND(8);
+    X8_ROUND(9);
+    X8_ROUND(10);
+    X8_ROUND(11);
+
+    for (i = 0; i < 8; ++i) {
+        h[i] = _mm512_xor_si512(h[i], _mm512_xor_si512(v[i], v[i + 8]));
+    }
+    X8_TRANSPOSE(h);
+    for (i = 0; i < 8; ++i) {
+        _mm512_storeu_si512((void *)S[i]->h, h[i]);
+    }
+}
+
+#endif /* BLAKE2B_HAVE_SIMD */
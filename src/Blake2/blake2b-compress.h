@@ -0,0 +1,47 @@
+#ifndef BLAKE2B_COMPRESS_H
+#define BLAKE2B_COMPRESS_H
+
+#include "blake2.h"
+#include "../cpu-features.h"
+
+/*
+ * Blake2b compression kernels. blake2b.c picks one on first use and every
+ * user of the streaming API (shsBlake2, blake2b_long, Argon2's InitialHash)
+ * goes through it. The SIMD kernels keep the state as rows in vector
+ * registers, diagonalize with lane shuffles and gather each round's message
+ * words through the sigma permutation table.
+ */
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef void (*blake2b_compress_fn)(blake2b_state *S, const uint8_t *block);
+
+void blake2b_compress_portable(blake2b_state *S, const uint8_t *block);
+
+/* The selected single-state kernel */
+void blake2b_compress_x1(blake2b_state *S, const uint8_t *block);
+
+/* Four independent states, one block each. Counters and flags must already
+ * be set; lanes are transposed internally. */
+void blake2b_compress_x4(blake2b_state *S[4], const uint8_t *const blocks[4]);
+void blake2b_compress_x8(blake2b_state *S[8], const uint8_t *const blocks[8]);
+
+#if defined(SHS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define BLAKE2B_HAVE_SIMD 1
+void blake2b_compress_ssse3(blake2b_state *S, const uint8_t *block);
+void blake2b_compress_sse41(blake2b_state *S, const uint8_t *block);
+void blake2b_compress_avx2(blake2b_state *S, const uint8_t *block);
+void blake2b_compress_x4_avx2(blake2b_state *S[4], const uint8_t *const blocks[4]);
+void blake2b_compress_x8_avx512(blake2b_state *S[8], const uint8_t *const blocks[8]);
+#endif
+
+/* Selected kernel: "avx2", "sse41", "ssse3" or "portable" */
+const char *blake2b_compress_backend(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,191 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "blake2b-mb.h"
+#include "blake2-impl.h"
+#include "blake2b-compress.h"
+
+typedef struct {
+    blake2b_state S;
+    const blake2b_mb_msg *msg;
+    uint8_t *out;
+    uint64_t base;    /* bytes compressed before the lane took over */
+    uint64_t prefix;  /* key or pending block bytes kept in tail */
+    uint64_t total;   /* prefix + message bytes */
+    size_t block;     /* next block to compress */
+    size_t nblocks;
+    uint8_t tail[BLAKE2B_BLOCKBYTES]; /* prefix block, then the padded last block */
+} blake2b_mb_lane;
+
+unsigned blake2b_mb_lanes(void) {
+#ifdef BLAKE2B_HAVE_SIMD
+    if (shs_cpu_has_avx512f()) {
+        return 8;
+    }
+    if (shs_cpu_has_avx2()) {
+        return 4;
+    }
+#endif
+    return 1;
+}
+
+static void lane_load(blake2b_mb_lane *L, const blake2b_mb_msg *msg, uint8_t *out) {
+    blake2b_param P;
+
+    if (msg->start != NULL) {
+        memcpy(L->S.h, msg->start->h, sizeof(L->S.h));
+        L->S.t[0] = msg->start->t[0];
+        L->S.t[1] = msg->start->t[1];
+        L->S.f[0] = L->S.f[1] = 0;
+        L->prefix = msg->start->buflen;
+        if (L->prefix > 0) {
+            memcpy(L->tail, msg->start->buf, BLAKE2B_BLOCKBYTES);
+        }
+    } else {
+        memset(&P, 0, sizeof(P));
+        P.digest_length = (uint8_t)msg->outlen;
+        P.key_length = (uint8_t)msg->keylen;
+        P.fanout = 1;
+        P.depth = 1;
+        blake2b_init_param(&L->S, &P);
+        L->prefix = msg->keylen > 0 ? BLAKE2B_BLOCKBYTES : 0;
+        if (msg->keylen > 0) {
+            memset(L->tail, 0, BLAKE2B_BLOCKBYTES);
+            memcpy(L->tail, msg->key, msg->keylen);
+        }
+    }
+
+    L->msg = msg;
+    L->out = out;
+    L->base = L->S.t[0];
+    L->total = L->prefix + (uint64_t)msg->inlen;
+    L->nblocks = L->total == 0 ? 1 : (size_t)((L->total + BLAKE2B_BLOCKBYTES - 1) / BLAKE2B_BLOCKBYTES);
+    L->block = 0;
+}
+
+/* Sets the counter and flags for the lane's next block and returns it */
+static const uint8_t *lane_next_block(blake2b_mb_lane *L) {
+    const size_t prefix = (size_t)L->prefix;
+    const uint64_t start = (uint64_t)L->block * BLAKE2B_BLOCKBYTES;
+    const uint8_t *data = (const uint8_t *)L->msg->in;
+
+    if (L->block + 1 < L->nblocks) {
+        L->S.t[0] = L->base + start + BLAKE2B_BLOCKBYTES;
+        if (prefix > 0 && L->block == 0) {
+            return L->tail;
+        }
+        return data + (start - prefix);
+    }
+
+    L->S.t[0] = L->base + L->total;
+    L->S.f[0] = (uint64_t)-1;
+    if (prefix > 0 && L->block == 0) {
+        return L->tail; /* empty message: the prefix block is last */
+    }
+    memset(L->tail, 0, BLAKE2B_BLOCKBYTES);
+    memcpy(L->tail, data + (start - prefix), (size_t)(L->total - start));
+    return L->tail;
+}
+
+static void lane_store(blake2b_mb_lane *L) {
+    uint8_t buffer[BLAKE2B_OUTBYTES];
+    unsigned int i;
+
+    for (i = 0; i < 8; ++i) {
+        store64(buffer + i * sizeof(L->S.h[i]), L->S.h[i]);
+    }
+    memcpy(L->out, buffer, L->msg->outlen);
+    burn(buffer, sizeof(buffer));
+}
+
+int blake2b_mb(const blake2b_mb_msg *msgs, size_t count, uint8_t *out) {
+    blake2b_mb_lane lanes[BLAKE2B_MB_MAX_LANES];
+    blake2b_state idle;
+    blake2b_state *states[BLAKE2B_MB_MAX_LANES];
+    const uint8_t *blocks[BLAKE2B_MB_MAX_LANES];
+    uint8_t idle_block[BLAKE2B_BLOCKBYTES];
+    int busy[BLAKE2B_MB_MAX_LANES];
+    unsigned width, active = 0, i;
+    size_t next = 0;
+
+    for (next = 0; next < count; ++next) {
+        const blake2b_mb_msg *m = &msgs[next];
+        if (m->outlen == 0 || m->outlen > BLAKE2B_OUTBYTES ||
+            (m->in == NULL && m->inlen > 0)) {
+            return -1;
+        }
+        if (m->start != NULL
+                ? (m->start->outlen != m->outlen ||
+                   (m->start->buflen != 0 && m->start->buflen != BLAKE2B_BLOCKBYTES))
+                : (m->keylen > BLAKE2B_KEYBYTES || (m->key == NULL && m->keylen > 0))) {
+            return -1;
+        }
+    }
+
+    width = blake2b_mb_lanes();
+    if (width == 1) {
+        for (next = 0; next < count; ++next) {
+            const blake2b_mb_msg *m = &msgs[next];
+            if (m->start != NULL) {
+                blake2b_state S = *m->start;
+                blake2b_update(&S, m->in, m->inlen);
+                blake2b_final(&S, out, m->outlen);
+                burn(&S, sizeof(S));
+            } else {
+                blake2b(out, m->outlen, m->in, m->inlen, m->key, m->keylen);
+            }
+            out += m->outlen;
+        }
+        return 0;
+    }
+
+    memset(&idle, 0, sizeof(idle));
+    memset(idle_block, 0, sizeof(idle_block));
+    next = 0;
+    for (i = 0; i < width; ++i) {
+        busy[i] = next < count;
+        if (busy[i]) {
+            lane_load(&lanes[i], &msgs[next], out);
+            out += msgs[next++].outlen;
+            ++active;
+        }
+    }
+
+    while (active > 0) {
+        if (active == 1) {
+            /* Last message: no point dragging idle lanes along */
+            for (i = 0; !busy[i]; ++i) {
+            }
+            blake2b_compress_x1(&lanes[i].S, lane_next_block(&lanes[i]));
+        } else {
+            for (i = 0; i < width; ++i) {
+                states[i] = busy[i] ? &lanes[i].S : &idle;
+                blocks[i] = busy[i] ? lane_next_block(&lanes[i]) : idle_block;
+            }
+            if (width == 8) {
+                blake2b_compress_x8(states, blocks);
+            } else {
+                blake2b_compress_x4(states, blocks);
+            }
+        }
+
+        for (i = 0; i < width; ++i) {
+            if (!busy[i] || ++lanes[i].block < lanes[i].nblocks) {
+                continue;
+            }
+            lane_store(&lanes[i]);
+            if (next < count) {
+                lane_load(&lanes[i], &msgs[next], out);
+                out += msgs[next++].outlen;
+            } else {
+                busy[i] = 0;
+                --active;
+            }
+        }
+    }
+
+    for (i = 0; i < width; ++i) {
+        burn(lanes[i].tail, sizeof(lanes[i].tail));
+    }
+    return 0;
+}
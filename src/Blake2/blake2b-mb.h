@@ -0,0 +1,44 @@
+#ifndef BLAKE2B_MB_H
+#define BLAKE2B_MB_H
+
+#include "blake2.h"
+
+/*
+ * Multi-buffer Blake2b: many short, independent messages hashed with one
+ * state per SIMD lane. A lane that finishes its message is refilled with
+ * the next one, so messages of different lengths keep every lane busy
+ * until the queue runs dry.
+ */
+
+#define BLAKE2B_MB_MAX_LANES 8
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef struct __blake2b_mb_msg {
+    const void *in;
+    size_t inlen;
+    const void *key; /* NULL or keylen bytes */
+    size_t keylen;
+    size_t outlen;
+    /* Optional prepared state to continue from instead of key/parameter
+     * setup; key and keylen are then ignored, outlen must match its outlen
+     * and its buffer may hold 0 or 128 pending bytes. The digest equals blake2b_update() of a copy of it
+     * followed by blake2b_final(). */
+    const blake2b_state *start;
+} blake2b_mb_msg;
+
+/* Widest kernel the running CPU supports: 8 (AVX-512), 4 (AVX2) or 1 */
+unsigned blake2b_mb_lanes(void);
+
+/* Digests are written back to back in message order, each taking its
+ * message's outlen bytes. Returns -1 without writing anything if any
+ * message has an invalid outlen or key. */
+int blake2b_mb(const blake2b_mb_msg *msgs, size_t count, uint8_t *out);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
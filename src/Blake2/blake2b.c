@@ -4,6 +4,7 @@
 
 #include "blake2.h"
 #include "blake2-impl.h"
+#include "blake2b-compress.h"
 
 static const uint64_t blake2b_IV[8] = {
     UINT64_C(0x6a09e667f3bcc908), UINT64_C(0xbb67ae8584caa73b),
@@ -145,7 +146,7 @@ int blake2b_init_key(blake2b_state *S, size_t outlen, const void *key,
     return 0;
 }
 
-static void blake2b_compress(blake2b_state *S, const uint8_t *block) {
+void blake2b_compress_portable(blake2b_state *S, const uint8_t *block) {
     uint64_t m[16];
     uint64_t v[16];
     unsigned int i, r;
@@ -203,6 +204,70 @@ static void blake2b_compress(blake2b_state *S, const uint8_t *block) {
 #undef ROUND
 }
 
+static blake2b_compress_fn volatile blake2b_compress_impl = NULL;
+static const char *volatile blake2b_compress_name = NULL;
+
+static blake2b_compress_fn blake2b_compress_resolve(void) {
+    blake2b_compress_fn fn = blake2b_compress_impl;
+    if (fn == NULL) {
+        const char *name = "portable";
+        fn = blake2b_compress_portable;
+#ifdef BLAKE2B_HAVE_SIMD
+        if (shs_cpu_has_avx2()) {
+            name = "avx2";
+            fn = blake2b_compress_avx2;
+        } else if (shs_cpu_has_sse41()) {
+            name = "sse41";
+            fn = blake2b_compress_sse41;
+        } else if (shs_cpu_has_ssse3()) {
+            name = "ssse3";
+            fn = blake2b_compress_ssse3;
+        }
+#endif
+        /* racing first calls all store the same values */
+        blake2b_compress_name = name;
+        blake2b_compress_impl = fn;
+    }
+    return fn;
+}
+
+static BLAKE2_INLINE void blake2b_compress(blake2b_state *S, const uint8_t *block) {
+    blake2b_compress_resolve()(S, block);
+}
+
+void blake2b_compress_x1(blake2b_state *S, const uint8_t *block) {
+    blake2b_compress(S, block);
+}
+
+void blake2b_compress_x4(blake2b_state *S[4], const uint8_t *const blocks[4]) {
+    unsigned int i;
+#ifdef BLAKE2B_HAVE_SIMD
+    if (blake2b_compress_resolve() == blake2b_compress_avx2) {
+        blake2b_compress_x4_avx2(S, blocks);
+        return;
+    }
+#endif
+    for (i = 0; i < 4; ++i) {
+        blake2b_compress(S[i], blocks[i]);
+    }
+}
+
+void blake2b_compress_x8(blake2b_state *S[8], const uint8_t *const blocks[8]) {
+#ifdef BLAKE2B_HAVE_SIMD
+    if (shs_cpu_has_avx512f()) {
+        blake2b_compress_x8_avx512(S, blocks);
+        return;
+    }
+#endif
+    blake2b_compress_x4(S, blocks);
+    blake2b_compress_x4(S + 4, blocks + 4);
+}
+
+const char *blake2b_compress_backend(void) {
+    blake2b_compress_resolve();
+    return blake2b_compress_name;
+}
+
 int blake2b_update(blake2b_state *S, const void *in, size_t inlen) {
     const uint8_t *pin = (const uint8_t *)in;
 
@@ -273,6 +338,41 @@ int blake2b_final(blake2b_state *S, void *out, size_t outlen) {
     return 0;
 }
 
+int blake2b_oneblock(void *out, size_t outlen, const void *in, size_t inlen) {
+    blake2b_state S; /* the compression only reads h, t and f */
+    uint8_t block[BLAKE2B_BLOCKBYTES];
+    uint8_t buffer[BLAKE2B_OUTBYTES];
+    unsigned int i;
+
+    if (NULL == out || outlen == 0 || outlen > BLAKE2B_OUTBYTES ||
+        inlen > BLAKE2B_BLOCKBYTES || (NULL == in && inlen > 0)) {
+        return -1;
+    }
+
+    /* parameter word 0 of an unkeyed sequential hash: fanout 1, depth 1 */
+    memcpy(S.h, blake2b_IV, sizeof(S.h));
+    S.h[0] ^= 0x01010000ULL ^ (uint64_t)outlen;
+    S.t[0] = inlen;
+    S.t[1] = 0;
+    S.f[0] = (uint64_t)-1;
+    S.f[1] = 0;
+
+    if (inlen > 0) {
+        memcpy(block, in, inlen);
+    }
+    memset(block + inlen, 0, BLAKE2B_BLOCKBYTES - inlen);
+    blake2b_compress(&S, block);
+
+    for (i = 0; i < 8; ++i) {
+        store64(buffer + sizeof(S.h[i]) * i, S.h[i]);
+    }
+    memcpy(out, buffer, outlen);
+    burn(block, sizeof(block));
+    burn(buffer, sizeof(buffer));
+    burn(S.h, sizeof(S.h));
+    return 0;
+}
+
 int blake2b(void *out, size_t outlen, const void *in, size_t inlen,
             const void *key, size_t keylen) {
     blake2b_state S;
@@ -291,6 +391,10 @@ int blake2b(void *out, size_t outlen, const void *in, size_t inlen,
         goto fail;
     }
 
+    if (keylen == 0 && inlen <= BLAKE2B_BLOCKBYTES) {
+        return blake2b_oneblock(out, outlen, in, inlen);
+    }
+
     if (keylen > 0) {
         if (blake2b_init_key(&S, outlen, key, keylen) < 0) {
             goto fail;
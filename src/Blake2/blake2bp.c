@@ -0,0 +1,239 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "blake2.h"
+#include "blake2-impl.h"
+#include "blake2b-compress.h"
+
+#define PARALLELISM BLAKE2BP_PARALLELISM
+#define STRIPE (PARALLELISM * BLAKE2B_BLOCKBYTES)
+
+/*
+ * Leaves keep blake2b's lazy-final rule: a leaf's block is only compressed
+ * once the leaf is known to receive another one. Between calls each leaf
+ * therefore holds either nothing or exactly one pending 128-byte block in
+ * its own buffer (S->S[i].buflen is 0 or 128 for all i at once).
+ */
+
+static int blake2bp_init_node(blake2b_state *S, size_t outlen, size_t keylen,
+                              uint64_t offset, uint8_t node_depth) {
+    blake2b_param P;
+
+    P.digest_length = (uint8_t)outlen;
+    P.key_length = (uint8_t)keylen;
+    P.fanout = PARALLELISM;
+    P.depth = 2;
+    P.leaf_length = 0;
+    P.node_offset = offset;
+    P.node_depth = node_depth;
+    P.inner_length = BLAKE2B_OUTBYTES;
+    memset(P.reserved, 0, sizeof(P.reserved));
+    memset(P.salt, 0, sizeof(P.salt));
+    memset(P.personal, 0, sizeof(P.personal));
+
+    return blake2b_init_param(S, &P);
+}
+
+int blake2bp_init_key(blake2bp_state *S, size_t outlen, const void *key,
+                      size_t keylen) {
+    unsigned int i;
+
+    if (S == NULL) {
+        return -1;
+    }
+    if ((outlen == 0) || (outlen > BLAKE2B_OUTBYTES)) {
+        return -1;
+    }
+    if ((key == NULL && keylen > 0) || keylen > BLAKE2B_KEYBYTES) {
+        return -1;
+    }
+
+    memset(S->buf, 0, sizeof(S->buf));
+    S->buflen = 0;
+    S->outlen = outlen;
+
+    if (blake2bp_init_node(&S->R, outlen, keylen, 0, 1) < 0) {
+        return -1;
+    }
+    S->R.last_node = 1;
+
+    for (i = 0; i < PARALLELISM; ++i) {
+        if (blake2bp_init_node(&S->S[i], outlen, keylen, i, 0) < 0) {
+            return -1;
+        }
+        /* leaves always emit a full-width digest for the root */
+        S->S[i].outlen = BLAKE2B_OUTBYTES;
+    }
+    S->S[PARALLELISM - 1].last_node = 1;
+
+    if (keylen > 0) {
+        uint8_t block[BLAKE2B_BLOCKBYTES];
+        memset(block, 0, BLAKE2B_BLOCKBYTES);
+        memcpy(block, key, keylen);
+        for (i = 0; i < PARALLELISM; ++i) {
+            blake2b_update(&S->S[i], block, BLAKE2B_BLOCKBYTES);
+        }
+        burn(block, BLAKE2B_BLOCKBYTES);
+    }
+    return 0;
+}
+
+int blake2bp_init(blake2bp_state *S, size_t outlen) {
+    return blake2bp_init_key(S, outlen, NULL, 0);
+}
+
+/* Compress one block per leaf from four pointers, all lanes at once */
+static void blake2bp_compress_stripe(blake2bp_state *S, const uint8_t *const blocks[PARALLELISM]) {
+    blake2b_state *leaves[PARALLELISM];
+    unsigned int i;
+
+    for (i = 0; i < PARALLELISM; ++i) {
+        leaves[i] = &S->S[i];
+        leaves[i]->t[0] += BLAKE2B_BLOCKBYTES;
+        leaves[i]->t[1] += (leaves[i]->t[0] < BLAKE2B_BLOCKBYTES);
+    }
+    blake2b_compress_x4(leaves, blocks);
+}
+
+/* The leaves' pending blocks are not their last: compress them */
+static void blake2bp_flush_pending(blake2bp_state *S) {
+    const uint8_t *blocks[PARALLELISM];
+    unsigned int i;
+
+    if (S->S[0].buflen == 0) {
+        return;
+    }
+    for (i = 0; i < PARALLELISM; ++i) {
+        blocks[i] = S->S[i].buf;
+    }
+    blake2bp_compress_stripe(S, blocks);
+    for (i = 0; i < PARALLELISM; ++i) {
+        S->S[i].buflen = 0;
+    }
+}
+
+static void blake2bp_set_pending(blake2bp_state *S, const uint8_t *stripe) {
+    unsigned int i;
+
+    for (i = 0; i < PARALLELISM; ++i) {
+        memcpy(S->S[i].buf, stripe + i * BLAKE2B_BLOCKBYTES, BLAKE2B_BLOCKBYTES);
+        S->S[i].buflen = BLAKE2B_BLOCKBYTES;
+    }
+}
+
+int blake2bp_update(blake2bp_state *S, const void *in, size_t inlen) {
+    const uint8_t *pin = (const uint8_t *)in;
+    size_t left, fill;
+    unsigned int i;
+
+    if (inlen == 0) {
+        return 0;
+    }
+    if (S == NULL || in == NULL) {
+        return -1;
+    }
+    if (S->R.f[0] != 0) {
+        return -1;
+    }
+
+    left = S->buflen;
+    fill = sizeof(S->buf) - left;
+
+    if (left && inlen >= fill) {
+        memcpy(S->buf + left, pin, fill);
+        blake2bp_flush_pending(S);
+        blake2bp_set_pending(S, S->buf);
+        pin += fill;
+        inlen -= fill;
+        left = 0;
+    }
+
+    if (inlen >= STRIPE) {
+        blake2bp_flush_pending(S);
+        /* a stripe followed by another full stripe is final for no leaf,
+         * so it is compressed straight from the caller's buffer */
+        while (inlen >= 2 * STRIPE) {
+            const uint8_t *blocks[PARALLELISM];
+            for (i = 0; i < PARALLELISM; ++i) {
+                blocks[i] = pin + i * BLAKE2B_BLOCKBYTES;
+            }
+            blake2bp_compress_stripe(S, blocks);
+            pin += STRIPE;
+            inlen -= STRIPE;
+        }
+        blake2bp_set_pending(S, pin);
+        pin += STRIPE;
+        inlen -= STRIPE;
+    }
+
+    memcpy(S->buf + left, pin, inlen);
+    S->buflen = left + inlen;
+    return 0;
+}
+
+int blake2bp_final(blake2bp_state *S, void *out, size_t outlen) {
+    uint8_t hash[PARALLELISM][BLAKE2B_OUTBYTES];
+    unsigned int i;
+    int ret = -1;
+
+    if (S == NULL || out == NULL || outlen < S->outlen) {
+        return -1;
+    }
+    if (S->R.f[0] != 0) {
+        return -1;
+    }
+
+    /* the tail goes to the leaves round-robin; blake2b_update/final take
+     * care of whichever pending block turns out to be a leaf's last */
+    for (i = 0; i < PARALLELISM; ++i) {
+        if (S->buflen > i * BLAKE2B_BLOCKBYTES) {
+            size_t left = S->buflen - i * BLAKE2B_BLOCKBYTES;
+            if (left > BLAKE2B_BLOCKBYTES) {
+                left = BLAKE2B_BLOCKBYTES;
+            }
+            if (blake2b_update(&S->S[i], S->buf + i * BLAKE2B_BLOCKBYTES, left) < 0) {
+                goto fail;
+            }
+        }
+        if (blake2b_final(&S->S[i], hash[i], BLAKE2B_OUTBYTES) < 0) {
+            goto fail;
+        }
+    }
+
+    for (i = 0; i < PARALLELISM; ++i) {
+        if (blake2b_update(&S->R, hash[i], BLAKE2B_OUTBYTES) < 0) {
+            goto fail;
+        }
+    }
+    ret = blake2b_final(&S->R, out, S->outlen);
+
+fail:
+    burn(hash, sizeof(hash));
+    burn(S->buf, sizeof(S->buf));
+    return ret;
+}
+
+int blake2bp(void *out, size_t outlen, const void *in, size_t inlen,
+             const void *key, size_t keylen) {
+    blake2bp_state S;
+    int ret = -1;
+
+    if (NULL == in && inlen > 0) {
+        goto fail;
+    }
+    if (NULL == out || outlen == 0 || outlen > BLAKE2B_OUTBYTES) {
+        goto fail;
+    }
+
+    if (blake2bp_init_key(&S, outlen, key, keylen) < 0) {
+        goto fail;
+    }
+    if (blake2bp_update(&S, in, inlen) < 0) {
+        goto fail;
+    }
+    ret = blake2bp_final(&S, out, outlen);
+
+fail:
+    burn(&S, sizeof(S));
+    return ret;
+}
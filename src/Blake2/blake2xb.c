@@ -0,0 +1,188 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "blake2.h"
+#include "blake2-impl.h"
+#include "blake2b-compress.h"
+
+/* Output blocks compressed together; the x8 call falls back to narrower
+ * kernels on CPUs without AVX-512 */
+#define XOF_LANES 8
+
+static uint64_t xof_length_of(const blake2xb_state *S) {
+    return S->P.node_offset >> 32;
+}
+
+/* Total stream size: the XOF length, or 2^32 full blocks when unknown */
+static uint64_t xof_limit(const blake2xb_state *S) {
+    uint64_t xof = xof_length_of(S);
+    return xof == BLAKE2XB_UNKNOWN_LENGTH ? ((uint64_t)1 << 32) * BLAKE2B_OUTBYTES : xof;
+}
+
+int blake2xb_init_key(blake2xb_state *S, size_t outlen, const void *key,
+                      size_t keylen) {
+    if (S == NULL || outlen == 0 || (uint64_t)outlen > BLAKE2XB_UNKNOWN_LENGTH) {
+        return -1;
+    }
+    if ((key == NULL && keylen > 0) || keylen > BLAKE2B_KEYBYTES) {
+        return -1;
+    }
+
+    memset(&S->P, 0, sizeof(S->P));
+    S->P.digest_length = BLAKE2B_OUTBYTES;
+    S->P.key_length = (uint8_t)keylen;
+    S->P.fanout = 1;
+    S->P.depth = 1;
+    S->P.node_offset = (uint64_t)outlen << 32;
+
+    if (blake2b_init_param(&S->S, &S->P) < 0) {
+        return -1;
+    }
+    if (keylen > 0) {
+        uint8_t block[BLAKE2B_BLOCKBYTES];
+        memset(block, 0, BLAKE2B_BLOCKBYTES);
+        memcpy(block, key, keylen);
+        blake2b_update(&S->S, block, BLAKE2B_BLOCKBYTES);
+        burn(block, BLAKE2B_BLOCKBYTES);
+    }
+    return 0;
+}
+
+int blake2xb_init(blake2xb_state *S, size_t outlen) {
+    return blake2xb_init_key(S, outlen, NULL, 0);
+}
+
+int blake2xb_update(blake2xb_state *S, const void *in, size_t inlen) {
+    return blake2b_update(&S->S, in, inlen);
+}
+
+int blake2xb_root(blake2xb_state *S, uint8_t root[BLAKE2B_OUTBYTES]) {
+    return blake2b_final(&S->S, root, BLAKE2B_OUTBYTES);
+}
+
+/* Sets C up to compress output block `index`, a `size`-byte digest */
+static void xof_block_state(const blake2xb_state *S, uint64_t index, size_t size,
+                            blake2b_state *C) {
+    blake2b_param P = S->P;
+    P.digest_length = (uint8_t)size;
+    P.key_length = 0;
+    P.fanout = 0;
+    P.depth = 0;
+    P.leaf_length = BLAKE2B_OUTBYTES;
+    P.node_offset = (S->P.node_offset & UINT64_C(0xFFFFFFFF00000000)) | index;
+    P.node_depth = 0;
+    P.inner_length = BLAKE2B_OUTBYTES;
+    blake2b_init_param(C, &P);
+    /* the whole message is the 64-byte root: one final block */
+    C->t[0] = BLAKE2B_OUTBYTES;
+    C->f[0] = (uint64_t)-1;
+}
+
+int blake2xb_output(const blake2xb_state *S, const uint8_t root[BLAKE2B_OUTBYTES],
+                    uint64_t offset, void *out, size_t outlen) {
+    uint8_t block[BLAKE2B_BLOCKBYTES];
+    uint8_t digest[BLAKE2B_OUTBYTES];
+    blake2b_state C[XOF_LANES];
+    blake2b_state *lanes[XOF_LANES];
+    const uint8_t *blocks[XOF_LANES];
+    uint8_t *pout = (uint8_t *)out;
+    const uint64_t limit = S == NULL ? 0 : xof_limit(S);
+    const int unknown = S != NULL && xof_length_of(S) == BLAKE2XB_UNKNOWN_LENGTH;
+    uint64_t index, end;
+    unsigned int i, j, n;
+
+    if (S == NULL || root == NULL || (out == NULL && outlen > 0) ||
+        offset > limit || outlen > limit - offset) {
+        return -1;
+    }
+    if (outlen == 0) {
+        return 0;
+    }
+
+    memset(block, 0, sizeof(block));
+    memcpy(block, root, BLAKE2B_OUTBYTES);
+    for (i = 0; i < XOF_LANES; ++i) {
+        lanes[i] = &C[i];
+        blocks[i] = block;
+    }
+
+    index = offset / BLAKE2B_OUTBYTES;
+    end = (offset + outlen + BLAKE2B_OUTBYTES - 1) / BLAKE2B_OUTBYTES;
+    while (index < end) {
+        n = end - index < XOF_LANES ? (unsigned int)(end - index) : XOF_LANES;
+        for (i = 0; i < n; ++i) {
+            /* only the last block of a known-length stream is shorter */
+            uint64_t start = (index + i) * BLAKE2B_OUTBYTES;
+            size_t size = unknown || limit - start >= BLAKE2B_OUTBYTES
+                              ? BLAKE2B_OUTBYTES : (size_t)(limit - start);
+            xof_block_state(S, index + i, size, &C[i]);
+        }
+        if (n == XOF_LANES) {
+            blake2b_compress_x8(lanes, blocks);
+        } else {
+            for (i = 0; i < n; ++i) {
+                blake2b_compress_x1(&C[i], block);
+            }
+        }
+
+        for (i = 0; i < n; ++i) {
+            uint64_t start = (index + i) * BLAKE2B_OUTBYTES;
+            size_t skip = offset > start ? (size_t)(offset - start) : 0;
+            size_t take = BLAKE2B_OUTBYTES - skip;
+            for (j = 0; j < 8; ++j) {
+                store64(digest + j * 8, C[i].h[j]);
+            }
+            if (take > outlen) {
+                take = outlen;
+            }
+            memcpy(pout, digest + skip, take);
+            pout += take;
+            outlen -= take;
+        }
+        index += n;
+    }
+
+    burn(block, sizeof(block));
+    burn(digest, sizeof(digest));
+    burn(C, sizeof(C));
+    return 0;
+}
+
+int blake2xb_final(blake2xb_state *S, void *out, size_t outlen) {
+    uint8_t root[BLAKE2B_OUTBYTES];
+    uint64_t xof;
+    int ret;
+
+    if (S == NULL || out == NULL) {
+        return -1;
+    }
+    xof = xof_length_of(S);
+    if (xof == BLAKE2XB_UNKNOWN_LENGTH ? outlen == 0 : (uint64_t)outlen != xof) {
+        return -1;
+    }
+    if (blake2xb_root(S, root) < 0) {
+        return -1;
+    }
+    ret = blake2xb_output(S, root, 0, out, outlen);
+    burn(root, sizeof(root));
+    return ret;
+}
+
+int blake2xb(void *out, size_t outlen, const void *in, size_t inlen,
+             const void *key, size_t keylen) {
+    blake2xb_state S;
+    int ret = -1;
+
+    if (in == NULL && inlen > 0) {
+        goto fail;
+    }
+    if (blake2xb_init_key(&S, outlen, key, keylen) < 0 ||
+        blake2xb_update(&S, in, inlen) < 0) {
+        goto fail;
+    }
+    ret = blake2xb_final(&S, out, outlen);
+
+fail:
+    burn(&S, sizeof(S));
+    return ret;
+}
@@ -0,0 +1,132 @@
+#ifndef BLAKE3_IMPL_H
+#define BLAKE3_IMPL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "blake3.h"
+#include "../cpu-features.h"
+
+/*
+ * BLAKE3 internals shared by the hasher and the compression kernels.
+ *
+ * compress_in_place/compress_xof handle one 64-byte block. hash_many hashes
+ * num_inputs equal-length inputs of `blocks` blocks each (whole chunks, or
+ * single parent blocks) into 32-byte chaining values written back to back.
+ * The SIMD versions put one input per lane and hand any remainder narrower
+ * than their width down to the next kernel.
+ */
+
+#if defined(_MSC_VER)
+#define BLAKE3_INLINE __inline
+#elif defined(__GNUC__) || defined(__clang__)
+#define BLAKE3_INLINE __inline__
+#else
+#define BLAKE3_INLINE
+#endif
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+enum blake3_flags {
+    CHUNK_START = 1 << 0,
+    CHUNK_END = 1 << 1,
+    PARENT = 1 << 2,
+    ROOT = 1 << 3,
+    KEYED_HASH = 1 << 4,
+    DERIVE_KEY_CONTEXT = 1 << 5,
+    DERIVE_KEY_MATERIAL = 1 << 6,
+};
+
+static const uint32_t BLAKE3_IV[8] = {0x6A09E667UL, 0xBB67AE85UL, 0x3C6EF372UL,
+                                      0xA54FF53AUL, 0x510E527FUL, 0x9B05688CUL,
+                                      0x1F83D9ABUL, 0x5BE0CD19UL};
+
+/* Message word order per round: the permutation applied r times */
+static const uint8_t BLAKE3_MSG_SCHEDULE[7][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8},
+    {3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1},
+    {10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6},
+    {12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4},
+    {9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7},
+    {11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13},
+};
+
+static BLAKE3_INLINE uint32_t blake3_load32(const void *src) {
+    const uint8_t *p = (const uint8_t *)src;
+    return ((uint32_t)p[0]) | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static BLAKE3_INLINE void blake3_store32(void *dst, uint32_t w) {
+    uint8_t *p = (uint8_t *)dst;
+    p[0] = (uint8_t)w;
+    p[1] = (uint8_t)(w >> 8);
+    p[2] = (uint8_t)(w >> 16);
+    p[3] = (uint8_t)(w >> 24);
+}
+
+static BLAKE3_INLINE void blake3_load_key_words(const uint8_t key[BLAKE3_KEY_LEN], uint32_t words[8]) {
+    unsigned int i;
+    for (i = 0; i < 8; ++i) {
+        words[i] = blake3_load32(key + 4 * i);
+    }
+}
+
+static BLAKE3_INLINE void blake3_store_cv_words(uint8_t out[BLAKE3_OUT_LEN], const uint32_t cv[8]) {
+    unsigned int i;
+    for (i = 0; i < 8; ++i) {
+        blake3_store32(out + 4 * i, cv[i]);
+    }
+}
+
+typedef void (*blake3_compress_in_place_fn)(uint32_t cv[8], const uint8_t block[BLAKE3_BLOCK_LEN],
+                                            uint8_t block_len, uint64_t counter, uint8_t flags);
+typedef void (*blake3_compress_xof_fn)(const uint32_t cv[8], const uint8_t block[BLAKE3_BLOCK_LEN],
+                                       uint8_t block_len, uint64_t counter, uint8_t flags,
+                                       uint8_t out[64]);
+typedef void (*blake3_hash_many_fn)(const uint8_t *const *inputs, size_t num_inputs,
+                                    size_t blocks, const uint32_t key[8], uint64_t counter,
+                                    bool increment_counter, uint8_t flags, uint8_t flags_start,
+                                    uint8_t flags_end, uint8_t *out);
+
+void blake3_compress_in_place_portable(uint32_t cv[8], const uint8_t block[BLAKE3_BLOCK_LEN],
+                                       uint8_t block_len, uint64_t counter, uint8_t flags);
+void blake3_compress_xof_portable(const uint32_t cv[8], const uint8_t block[BLAKE3_BLOCK_LEN],
+                                  uint8_t block_len, uint64_t counter, uint8_t flags,
+                                  uint8_t out[64]);
+void blake3_hash_many_portable(const uint8_t *const *inputs, size_t num_inputs, size_t blocks,
+                               const uint32_t key[8], uint64_t counter, bool increment_counter,
+                               uint8_t flags, uint8_t flags_start, uint8_t flags_end,
+                               uint8_t *out);
+
+#if defined(SHS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define BLAKE3_HAVE_SIMD 1
+void blake3_compress_in_place_sse41(uint32_t cv[8], const uint8_t block[BLAKE3_BLOCK_LEN],
+                                    uint8_t block_len, uint64_t counter, uint8_t flags);
+void blake3_compress_xof_sse41(const uint32_t cv[8], const uint8_t block[BLAKE3_BLOCK_LEN],
+                               uint8_t block_len, uint64_t counter, uint8_t flags,
+                               uint8_t out[64]);
+void blake3_hash_many_sse41(const uint8_t *const *inputs, size_t num_inputs, size_t blocks,
+                            const uint32_t key[8], uint64_t counter, bool increment_counter,
+                            uint8_t flags, uint8_t flags_start, uint8_t flags_end,
+                            uint8_t *out);
+void blake3_hash_many_avx2(const uint8_t *const *inputs, size_t num_inputs, size_t blocks,
+                           const uint32_t key[8], uint64_t counter, bool increment_counter,
+                           uint8_t flags, uint8_t flags_start, uint8_t flags_end,
+                           uint8_t *out);
+void blake3_hash_many_avx512(const uint8_t *const *inputs, size_t num_inputs, size_t blocks,
+                             const uint32_t key[8], uint64_t counter, bool increment_counter,
+                             uint8_t flags, uint8_t flags_start, uint8_t flags_end,
+                             uint8_t *out);
+#endif
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+#include "blake3-impl.h"
+
+static BLAKE3_INLINE uint32_t rotr32(uint32_t w, unsigned c) {
+    return (w >> c) | (w << (32 - c));
+}
+
+#define G(a, b, c, d, x, y)                                                    \
+    do {                                                                       \
+        v[a] = v[a] + v[b] + (x);                                              \
+        v[d] = rotr32(v[d] ^ v[a], 16);                                        \
+        v[c] = v[c] + v[d];                                                    \
+        v[b] = rotr32(v[b] ^ v[c], 12);                                        \
+        v[a] = v[a] + v[b] + (y);                                              \
+        v[d] = rotr32(v[d] ^ v[a], 8);                                         \
+        v[c] = v[c] + v[d];                                                    \
+        v[b] = rotr32(v[b] ^ v[c], 7);                                         \
+    } while ((void)0, 0)
+
+#define ROUND(r)                                                               \
+    do {                                                                       \
+        const uint8_t *s = BLAKE3_MSG_SCHEDULE[r];                             \
+        G(0, 4, 8, 12, m[s[0]], m[s[1]]);                                      \
+        G(1, 5, 9, 13, m[s[2]], m[s[3]]);                                      \
+        G(2, 6, 10, 14, m[s[4]], m[s[5]]);                                     \
+        G(3, 7, 11, 15, m[s[6]], m[s[7]]);                                     \
+        G(0, 5, 10, 15, m[s[8]], m[s[9]]);                                     \
+        G(1, 6, 11, 12, m[s[10]], m[s[11]]);                                   \
+        G(2, 7, 8, 13, m[s[12]], m[s[13]]);                                    \
+        G(3, 4, 9, 14, m[s[14]], m[s[15]]);                                    \
+    } while ((void)0, 0)
+
+static void compress_pre(uint32_t v[16], const uint32_t cv[8],
+                         const uint8_t block[BLAKE3_BLOCK_LEN], uint8_t block_len,
+                         uint64_t counter, uint8_t flags) {
+    uint32_t m[16];
+    unsigned int i;
+
+    for (i = 0; i < 16; ++i) {
+        m[i] = blake3_load32(block + 4 * i);
+    }
+    for (i = 0; i < 8; ++i) {
+        v[i] = cv[i];
+    }
+    v[8] = BLAKE3_IV[0];
+    v[9] = BLAKE3_IV[1];
+    v[10] = BLAKE3_IV[2];
+    v[11] = BLAKE3_IV[3];
+    v[12] = (uint32_t)counter;
+    v[13] = (uint32_t)(counter >> 32);
+    v[14] = (uint32_t)block_len;
+    v[15] = (uint32_t)flags;
+
+    ROUND(0);
+    ROUND(1);
+    ROUND(2);
+    ROUND(3);
+    ROUND(4);
+    ROUND(5);
+    ROUND(6);
+}
+
+void blake3_compress_in_place_portable(uint32_t cv[8], const uint8_t block[BLAKE3_BLOCK_LEN],
+                                       uint8_t block_len, uint64_t counter, uint8_t flags) {
+    uint32_t v[16];
+    unsigned int i;
+
+    compress_pre(v, cv, block, block_len, counter, flags);
+    for (i = 0; i < 8; ++i) {
+        cv[i] = v[i] ^ v[i + 8];
+    }
+}
+
+void blake3_compress_xof_portable(const uint32_t cv[8], const uint8_t block[BLAKE3_BLOCK_LEN],
+                                  uint8_t block_len, uint64_t counter, uint8_t flags,
+                                  uint8_t out[64]) {
+    uint32_t v[16];
+    unsigned int i;
+
+    compress_pre(v, cv, block, block_len, counter, flags);
+    for (i = 0; i < 8; ++i) {
+        blake3_store32(out + 4 * i, v[i] ^ v[i + 8]);
+        blake3_store32(out + 32 + 4 * i, v[i + 8] ^ cv[i]);
+    }
+}
+
+static void hash_one_portable(const uint8_t *input, size_t blocks, const uint32_t key[8],
+                              uint64_t counter, uint8_t flags, uint8_t flags_start,
+                              uint8_t flags_end, uint8_t out[BLAKE3_OUT_LEN]) {
+    uint32_t cv[8];
+    uint8_t block_flags = flags | flags_start;
+
+    memcpy(cv, key, sizeof(cv));
+    while (blocks > 0) {
+        if (blocks == 1) {
+            block_flags |= flags_end;
+        }
+        blake3_compress_in_place_portable(cv, input, BLAKE3_BLOCK_LEN, counter, block_flags);
+        input += BLAKE3_BLOCK_LEN;
+        blocks -= 1;
+        block_flags = flags;
+    }
+    blake3_store_cv_words(out, cv);
+}
+
+void blake3_hash_many_portable(const uint8_t *const *inputs, size_t num_inputs, size_t blocks,
+                               const uint32_t key[8], uint64_t counter, bool increment_counter,
+                               uint8_t flags, uint8_t flags_start, uint8_t flags_end,
+                               uint8_t *out) {
+    while (num_inputs > 0) {
+        hash_one_portable(inputs[0], blocks, key, counter, flags, flags_start, flags_end, out);
+        if (increment_counter) {
+            counter += 1;
+        }
+        inputs += 1;
+        num_inputs -= 1;
+        out += BLAKE3_OUT_LEN;
+    }
+}
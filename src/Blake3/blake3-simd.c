@@ -0,0 +1,480 @@
+#include "blake3-impl.h"
+
+#ifdef BLAKE3_HAVE_SIMD
+
+#include <immintrin.h>
+
+/*
+ * The multi-lane kernels keep state word i of every lane in register v[i],
+ * so G runs on whole registers and needs no diagonalization. Message words
+ * are transposed into the same layout once per block. VADD/VXOR/VROTn are
+ * redefined per instruction set; the round macros are shared.
+ */
+
+#define G(a, b, c, d, x, y)                                                    \
+    do {                                                                       \
+        v[a] = VADD(VADD(v[a], v[b]), x);                                      \
+        v[d] = VROT16(VXOR(v[d], v[a]));                                       \
+        v[c] = VADD(v[c], v[d]);                                               \
+        v[b] = VROT12(VXOR(v[b], v[c]));                                       \
+        v[a] = VADD(VADD(v[a], v[b]), y);                                      \
+        v[d] = VROT8(VXOR(v[d], v[a]));                                        \
+        v[c] = VADD(v[c], v[d]);                                               \
+        v[b] = VROT7(VXOR(v[b], v[c]));                                        \
+    } while ((void)0, 0)
+
+#define ROUND(r)                                                               \
+    do {                                                                       \
+        const uint8_t *s = BLAKE3_MSG_SCHEDULE[r];                             \
+        G(0, 4, 8, 12, m[s[0]], m[s[1]]);                                      \
+        G(1, 5, 9, 13, m[s[2]], m[s[3]]);                                      \
+        G(2, 6, 10, 14, m[s[4]], m[s[5]]);                                     \
+        G(3, 7, 11, 15, m[s[6]], m[s[7]]);                                     \
+        G(0, 5, 10, 15, m[s[8]], m[s[9]]);                                     \
+        G(1, 6, 11, 12, m[s[10]], m[s[11]]);                                   \
+        G(2, 7, 8, 13, m[s[12]], m[s[13]]);                                    \
+        G(3, 4, 9, 14, m[s[14]], m[s[15]]);                                    \
+    } while ((void)0, 0)
+
+#define ROUNDS()                                                               \
+    do {                                                                       \
+        ROUND(0);                                                              \
+        ROUND(1);                                                              \
+        ROUND(2);                                                              \
+        ROUND(3);                                                              \
+        ROUND(4);                                                              \
+        ROUND(5);                                                              \
+        ROUND(6);                                                              \
+    } while ((void)0, 0)
+
+/* Per-lane counters for lanes [0, n) starting at `counter` */
+#define LANE_COUNTERS(n, lo, hi)                                               \
+    do {                                                                       \
+        unsigned int l_;                                                       \
+        for (l_ = 0; l_ < (n); ++l_) {                                         \
+            uint64_t c_ = counter + (increment_counter ? l_ : 0);              \
+            lo[l_] = (uint32_t)c_;                                             \
+            hi[l_] = (uint32_t)(c_ >> 32);                                     \
+        }                                                                      \
+    } while ((void)0, 0)
+
+/* Scatter h[8] (word-major, lane-minor) to one 32-byte CV per lane */
+#define STORE_CVS(n, words, out)                                               \
+    do {                                                                       \
+        unsigned int l_, w_;                                                   \
+        for (l_ = 0; l_ < (n); ++l_) {                                         \
+            for (w_ = 0; w_ < 8; ++w_) {                                       \
+                blake3_store32((out) + l_ * BLAKE3_OUT_LEN + 4 * w_, words[w_][l_]); \
+            }                                                                  \
+        }                                                                      \
+    } while ((void)0, 0)
+
+/* ---------------------------------------------------------------------- */
+/* SSE4.1                                                                  */
+
+#define VADD(a, b) _mm_add_epi32(a, b)
+#define VXOR(a, b) _mm_xor_si128(a, b)
+#define VROT16(x) _mm_shuffle_epi8((x), rot16)
+#define VROT12(x) _mm_or_si128(_mm_srli_epi32((x), 12), _mm_slli_epi32((x), 20))
+#define VROT8(x) _mm_shuffle_epi8((x), rot8)
+#define VROT7(x) _mm_or_si128(_mm_srli_epi32((x), 7), _mm_slli_epi32((x), 25))
+
+#define SSE_ROT_MASKS                                                          \
+    const __m128i rot16 = _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13); \
+    const __m128i rot8 = _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12)
+
+#define SSE_TRANSPOSE4(a, b, c, d)                                             \
+    do {                                                                       \
+        __m128i t0_ = _mm_unpacklo_epi32(a, b);                                \
+        __m128i t1_ = _mm_unpackhi_epi32(a, b);                                \
+        __m128i t2_ = _mm_unpacklo_epi32(c, d);                                \
+        __m128i t3_ = _mm_unpackhi_epi32(c, d);                                \
+        a = _mm_unpacklo_epi64(t0_, t2_);                                      \
+        b = _mm_unpackhi_epi64(t0_, t2_);                                      \
+        c = _mm_unpacklo_epi64(t1_, t3_);                                      \
+        d = _mm_unpackhi_epi64(t1_, t3_);                                      \
+    } while ((void)0, 0)
+
+/* Single block: one state row per register, diagonals by lane rotation */
+#define SSE_G(row0, row1, row2, row3, mx, my)                                  \
+    do {                                                                       \
+        row0 = _mm_add_epi32(_mm_add_epi32(row0, row1), mx);                   \
+        row3 = VROT16(_mm_xor_si128(row3, row0));                              \
+        row2 = _mm_add_epi32(row2, row3);                                      \
+        row1 = VROT12(_mm_xor_si128(row1, row2));                              \
+        row0 = _mm_add_epi32(_mm_add_epi32(row0, row1), my);                   \
+        row3 = VROT8(_mm_xor_si128(row3, row0));                               \
+        row2 = _mm_add_epi32(row2, row3);                                      \
+        row1 = VROT7(_mm_xor_si128(row1, row2));                               \
+    } while ((void)0, 0)
+
+#define SSE_ROUND(r)                                                           \
+    do {                                                                       \
+        const uint8_t *s = BLAKE3_MSG_SCHEDULE[r];                             \
+        SSE_G(row0, row1, row2, row3,                                          \
+              _mm_setr_epi32((int)m[s[0]], (int)m[s[2]], (int)m[s[4]], (int)m[s[6]]), \
+              _mm_setr_epi32((int)m[s[1]], (int)m[s[3]], (int)m[s[5]], (int)m[s[7]])); \
+        row1 = _mm_shuffle_epi32(row1, _MM_SHUFFLE(0, 3, 2, 1));               \
+        row2 = _mm_shuffle_epi32(row2, _MM_SHUFFLE(1, 0, 3, 2));               \
+        row3 = _mm_shuffle_epi32(row3, _MM_SHUFFLE(2, 1, 0, 3));               \
+        SSE_G(row0, row1, row2, row3,                                          \
+              _mm_setr_epi32((int)m[s[8]], (int)m[s[10]], (int)m[s[12]], (int)m[s[14]]), \
+              _mm_setr_epi32((int)m[s[9]], (int)m[s[11]], (int)m[s[13]], (int)m[s[15]])); \
+        row1 = _mm_shuffle_epi32(row1, _MM_SHUFFLE(2, 1, 0, 3));               \
+        row2 = _mm_shuffle_epi32(row2, _MM_SHUFFLE(1, 0, 3, 2));               \
+        row3 = _mm_shuffle_epi32(row3, _MM_SHUFFLE(0, 3, 2, 1));               \
+    } while ((void)0, 0)
+
+#define SSE_COMPRESS_BODY()                                                    \
+    uint32_t m[16];                                                            \
+    unsigned int i;                                                            \
+    for (i = 0; i < 16; ++i) {                                                 \
+        m[i] = blake3_load32(block + 4 * i);                                   \
+    }                                                                          \
+    row0 = _mm_loadu_si128((const __m128i *)&cv[0]);                           \
+    row1 = _mm_loadu_si128((const __m128i *)&cv[4]);                           \
+    row2 = _mm_setr_epi32((int)BLAKE3_IV[0], (int)BLAKE3_IV[1],                \
+                          (int)BLAKE3_IV[2], (int)BLAKE3_IV[3]);               \
+    row3 = _mm_setr_epi32((int)(uint32_t)counter, (int)(uint32_t)(counter >> 32), \
+                          (int)block_len, (int)flags);                         \
+    SSE_ROUND(0);                                                              \
+    SSE_ROUND(1);                                                              \
+    SSE_ROUND(2);                                                              \
+    SSE_ROUND(3);                                                              \
+    SSE_ROUND(4);                                                              \
+    SSE_ROUND(5);                                                              \
+    SSE_ROUND(6)
+
+SHS_TARGET("sse4.1")
+void blake3_compress_in_place_sse41(uint32_t cv[8], const uint8_t block[BLAKE3_BLOCK_LEN],
+                                    uint8_t block_len, uint64_t counter, uint8_t flags) {
+    SSE_ROT_MASKS;
+    __m128i row0, row1, row2, row3;
+    SSE_COMPRESS_BODY();
+    _mm_storeu_si128((__m128i *)&cv[0], _mm_xor_si128(row0, row2));
+    _mm_storeu_si128((__m128i *)&cv[4], _mm_xor_si128(row1, row3));
+}
+
+SHS_TARGET("sse4.1")
+void blake3_compress_xof_sse41(const uint32_t cv[8], const uint8_t block[BLAKE3_BLOCK_LEN],
+                               uint8_t block_len, uint64_t counter, uint8_t flags,
+                               uint8_t out[64]) {
+    SSE_ROT_MASKS;
+    __m128i row0, row1, row2, row3;
+    SSE_COMPRESS_BODY();
+    /* the CV words are little-endian in memory, so vector stores match */
+    _mm_storeu_si128((__m128i *)(out + 0), _mm_xor_si128(row0, row2));
+    _mm_storeu_si128((__m128i *)(out + 16), _mm_xor_si128(row1, row3));
+    _mm_storeu_si128((__m128i *)(out + 32),
+                     _mm_xor_si128(row2, _mm_loadu_si128((const __m128i *)&cv[0])));
+    _mm_storeu_si128((__m128i *)(out + 48),
+                     _mm_xor_si128(row3, _mm_loadu_si128((const __m128i *)&cv[4])));
+}
+
+SHS_TARGET("sse4.1")
+static void hash4_sse41(const uint8_t *const *inputs, size_t blocks, const uint32_t key[8],
+                        uint64_t counter, bool increment_counter, uint8_t flags,
+                        uint8_t flags_start, uint8_t flags_end, uint8_t *out) {
+    SSE_ROT_MASKS;
+    __m128i h[8], v[16], m[16];
+    uint32_t lo[4], hi[4], words[8][4];
+    uint8_t block_flags = flags | flags_start;
+    size_t b;
+    unsigned int i, g;
+
+    LANE_COUNTERS(4, lo, hi);
+    const __m128i ctr_lo = _mm_loadu_si128((const __m128i *)lo);
+    const __m128i ctr_hi = _mm_loadu_si128((const __m128i *)hi);
+    for (i = 0; i < 8; ++i) {
+        h[i] = _mm_set1_epi32((int)key[i]);
+    }
+
+    for (b = 0; b < blocks; ++b) {
+        const size_t offset = b * BLAKE3_BLOCK_LEN;
+        if (b + 1 == blocks) {
+            block_flags |= flags_end;
+        }
+        for (g = 0; g < 4; ++g) {
+            for (i = 0; i < 4; ++i) {
+                m[4 * g + i] = _mm_loadu_si128((const __m128i *)(inputs[i] + offset + 16 * g));
+            }
+            SSE_TRANSPOSE4(m[4 * g], m[4 * g + 1], m[4 * g + 2], m[4 * g + 3]);
+        }
+        for (i = 0; i < 8; ++i) {
+            v[i] = h[i];
+        }
+        for (i = 0; i < 4; ++i) {
+            v[8 + i] = _mm_set1_epi32((int)BLAKE3_IV[i]);
+        }
+        v[12] = ctr_lo;
+        v[13] = ctr_hi;
+        v[14] = _mm_set1_epi32(BLAKE3_BLOCK_LEN);
+        v[15] = _mm_set1_epi32(block_flags);
+        ROUNDS();
+        for (i = 0; i < 8; ++i) {
+            h[i] = _mm_xor_si128(v[i], v[i + 8]);
+        }
+        block_flags = flags;
+    }
+
+    for (i = 0; i < 8; ++i) {
+        _mm_storeu_si128((__m128i *)words[i], h[i]);
+    }
+    STORE_CVS(4, words, out);
+}
+
+SHS_TARGET("sse4.1")
+void blake3_hash_many_sse41(const uint8_t *const *inputs, size_t num_inputs, size_t blocks,
+                            const uint32_t key[8], uint64_t counter, bool increment_counter,
+                            uint8_t flags, uint8_t flags_start, uint8_t flags_end,
+                            uint8_t *out) {
+    while (num_inputs >= 4) {
+        hash4_sse41(inputs, blocks, key, counter, increment_counter, flags, flags_start,
+                    flags_end, out);
+        if (increment_counter) {
+            counter += 4;
+        }
+        inputs += 4;
+        num_inputs -= 4;
+        out += 4 * BLAKE3_OUT_LEN;
+    }
+    blake3_hash_many_portable(inputs, num_inputs, blocks, key, counter, increment_counter,
+                              flags, flags_start, flags_end, out);
+}
+
+#undef VADD
+#undef VXOR
+#undef VROT16
+#undef VROT12
+#undef VROT8
+#undef VROT7
+
+/* ---------------------------------------------------------------------- */
+/* AVX2: eight lanes                                                       */
+
+#define VADD(a, b) _mm256_add_epi32(a, b)
+#define VXOR(a, b) _mm256_xor_si256(a, b)
+#define VROT16(x) _mm256_shuffle_epi8((x), rot16)
+#define VROT12(x) _mm256_or_si256(_mm256_srli_epi32((x), 12), _mm256_slli_epi32((x), 20))
+#define VROT8(x) _mm256_shuffle_epi8((x), rot8)
+#define VROT7(x) _mm256_or_si256(_mm256_srli_epi32((x), 7), _mm256_slli_epi32((x), 25))
+
+/* 8x8 transpose of 32-bit words over r[0..7] */
+#define AVX2_TRANSPOSE8(r)                                                     \
+    do {                                                                       \
+        __m256i ab_01 = _mm256_unpacklo_epi32(r[0], r[1]);                     \
+        __m256i ab_23 = _mm256_unpackhi_epi32(r[0], r[1]);                     \
+        __m256i cd_01 = _mm256_unpacklo_epi32(r[2], r[3]);                     \
+        __m256i cd_23 = _mm256_unpackhi_epi32(r[2], r[3]);                     \
+        __m256i ef_01 = _mm256_unpacklo_epi32(r[4], r[5]);                     \
+        __m256i ef_23 = _mm256_unpackhi_epi32(r[4], r[5]);                     \
+        __m256i gh_01 = _mm256_unpacklo_epi32(r[6], r[7]);                     \
+        __m256i gh_23 = _mm256_unpackhi_epi32(r[6], r[7]);                     \
+        __m256i abcd_0 = _mm256_unpacklo_epi64(ab_01, cd_01);                  \
+        __m256i abcd_1 = _mm256_unpackhi_epi64(ab_01, cd_01);                  \
+        __m256i abcd_2 = _mm256_unpacklo_epi64(ab_23, cd_23);                  \
+        __m256i abcd_3 = _mm256_unpackhi_epi64(ab_23, cd_23);                  \
+        __m256i efgh_0 = _mm256_unpacklo_epi64(ef_01, gh_01);                  \
+        __m256i efgh_1 = _mm256_unpackhi_epi64(ef_01, gh_01);                  \
+        __m256i efgh_2 = _mm256_unpacklo_epi64(ef_23, gh_23);                  \
+        __m256i efgh_3 = _mm256_unpackhi_epi64(ef_23, gh_23);                  \
+        r[0] = _mm256_permute2x128_si256(abcd_0, efgh_0, 0x20);                \
+        r[1] = _mm256_permute2x128_si256(abcd_1, efgh_1, 0x20);                \
+        r[2] = _mm256_permute2x128_si256(abcd_2, efgh_2, 0x20);                \
+        r[3] = _mm256_permute2x128_si256(abcd_3, efgh_3, 0x20);                \
+        r[4] = _mm256_permute2x128_si256(abcd_0, efgh_0, 0x31);                \
+        r[5] = _mm256_permute2x128_si256(abcd_1, efgh_1, 0x31);                \
+        r[6] = _mm256_permute2x128_si256(abcd_2, efgh_2, 0x31);                \
+        r[7] = _mm256_permute2x128_si256(abcd_3, efgh_3, 0x31);                \
+    } while ((void)0, 0)
+
+SHS_TARGET("avx2")
+static void hash8_avx2(const uint8_t *const *inputs, size_t blocks, const uint32_t key[8],
+                       uint64_t counter, bool increment_counter, uint8_t flags,
+                       uint8_t flags_start, uint8_t flags_end, uint8_t *out) {
+    const __m256i rot16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                           2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m256i rot8 = _mm256_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12,
+                                          1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+    __m256i h[8], v[16], m[16];
+    uint32_t lo[8], hi[8], words[8][8];
+    uint8_t block_flags = flags | flags_start;
+    size_t b;
+    unsigned int i, g;
+
+    LANE_COUNTERS(8, lo, hi);
+    const __m256i ctr_lo = _mm256_loadu_si256((const __m256i *)lo);
+    const __m256i ctr_hi = _mm256_loadu_si256((const __m256i *)hi);
+    for (i = 0; i < 8; ++i) {
+        h[i] = _mm256_set1_epi32((int)key[i]);
+    }
+
+    for (b = 0; b < blocks; ++b) {
+        const size_t offset = b * BLAKE3_BLOCK_LEN;
+        if (b + 1 == blocks) {
+            block_flags |= flags_end;
+        }
+        for (g = 0; g < 2; ++g) {
+            for (i = 0; i < 8; ++i) {
+                m[8 * g + i] = _mm256_loadu_si256((const __m256i *)(inputs[i] + offset + 32 * g));
+            }
+            AVX2_TRANSPOSE8((m + 8 * g));
+        }
+        for (i = 0; i < 8; ++i) {
+            v[i] = h[i];
+        }
+        for (i = 0; i < 4; ++i) {
+            v[8 + i] = _mm256_set1_epi32((int)BLAKE3_IV[i]);
+        }
+        v[12] = ctr_lo;
+        v[13] = ctr_hi;
+        v[14] = _mm256_set1_epi32(BLAKE3_BLOCK_LEN);
+        v[15] = _mm256_set1_epi32(block_flags);
+        ROUNDS();
+        for (i = 0; i < 8; ++i) {
+            h[i] = _mm256_xor_si256(v[i], v[i + 8]);
+        }
+        block_flags = flags;
+    }
+
+    for (i = 0; i < 8; ++i) {
+        _mm256_storeu_si256((__m256i *)words[i], h[i]);
+    }
+    STORE_CVS(8, words, out);
+}
+
+SHS_TARGET("avx2")
+void blake3_hash_many_avx2(const uint8_t *const *inputs, size_t num_inputs, size_t blocks,
+                           const uint32_t key[8], uint64_t counter, bool increment_counter,
+                           uint8_t flags, uint8_t flags_start, uint8_t flags_end,
+                           uint8_t *out) {
+    while (num_inputs >= 8) {
+        hash8_avx2(inputs, blocks, key, counter, increment_counter, flags, flags_start,
+                   flags_end, out);
+        if (increment_counter) {
+            counter += 8;
+        }
+        inputs += 8;
+        num_inputs -= 8;
+        out += 8 * BLAKE3_OUT_LEN;
+    }
+    blake3_hash_many_sse41(inputs, num_inputs, blocks, key, counter, increment_counter,
+                           flags, flags_start, flags_end, out);
+}
+
+#undef VADD
+#undef VXOR
+#undef VROT16
+#undef VROT12
+#undef VROT8
+#undef VROT7
+
+/* ---------------------------------------------------------------------- */
+/* AVX-512: sixteen lanes, native rotates                                  */
+
+#define VADD(a, b) _mm512_add_epi32(a, b)
+#define VXOR(a, b) _mm512_xor_si512(a, b)
+#define VROT16(x) _mm512_ror_epi32((x), 16)
+#define VROT12(x) _mm512_ror_epi32((x), 12)
+#define VROT8(x) _mm512_ror_epi32((x), 8)
+#define VROT7(x) _mm512_ror_epi32((x), 7)
+
+/* 16x16 transpose of 32-bit words over r[0..15] */
+#define AVX512_TRANSPOSE16(r)                                                  \
+    do {                                                                       \
+        __m512i x_[4][4], y_[16];                                              \
+        unsigned int q_, j_;                                                   \
+        for (q_ = 0; q_ < 4; ++q_) {                                           \
+            __m512i ab_lo = _mm512_unpacklo_epi32(r[4 * q_], r[4 * q_ + 1]);   \
+            __m512i ab_hi = _mm512_unpackhi_epi32(r[4 * q_], r[4 * q_ + 1]);   \
+            __m512i cd_lo = _mm512_unpacklo_epi32(r[4 * q_ + 2], r[4 * q_ + 3]); \
+            __m512i cd_hi = _mm512_unpackhi_epi32(r[4 * q_ + 2], r[4 * q_ + 3]); \
+            x_[q_][0] = _mm512_unpacklo_epi64(ab_lo, cd_lo);                   \
+            x_[q_][1] = _mm512_unpackhi_epi64(ab_lo, cd_lo);                   \
+            x_[q_][2] = _mm512_unpacklo_epi64(ab_hi, cd_hi);                   \
+            x_[q_][3] = _mm512_unpackhi_epi64(ab_hi, cd_hi);                   \
+        }                                                                      \
+        for (j_ = 0; j_ < 4; ++j_) {                                           \
+            __m512i lo01 = _mm512_shuffle_i32x4(x_[0][j_], x_[1][j_], _MM_SHUFFLE(2, 0, 2, 0)); \
+            __m512i hi01 = _mm512_shuffle_i32x4(x_[0][j_], x_[1][j_], _MM_SHUFFLE(3, 1, 3, 1)); \
+            __m512i lo23 = _mm512_shuffle_i32x4(x_[2][j_], x_[3][j_], _MM_SHUFFLE(2, 0, 2, 0)); \
+            __m512i hi23 = _mm512_shuffle_i32x4(x_[2][j_], x_[3][j_], _MM_SHUFFLE(3, 1, 3, 1)); \
+            y_[j_] = _mm512_shuffle_i32x4(lo01, lo23, _MM_SHUFFLE(2, 0, 2, 0)); \
+            y_[4 + j_] = _mm512_shuffle_i32x4(hi01, hi23, _MM_SHUFFLE(2, 0, 2, 0)); \
+            y_[8 + j_] = _mm512_shuffle_i32x4(lo01, lo23, _MM_SHUFFLE(3, 1, 3, 1)); \
+            y_[12 + j_] = _mm512_shuffle_i32x4(hi01, hi23, _MM_SHUFFLE(3, 1, 3, 1)); \
+        }                                                                      \
+        for (j_ = 0; j_ < 16; ++j_) {                                          \
+            r[j_] = y_[j_];                                                    \
+        }                                                                      \
+    } while ((void)0, 0)
+
+SHS_TARGET("avx512f")
+static void hash16_avx512(const uint8_t *const *inputs, size_t blocks, const uint32_t key[8],
+                          uint64_t counter, bool increment_counter, uint8_t flags,
+                          uint8_t flags_start, uint8_t flags_end, uint8_t *out) {
+    __m512i h[8], v[16], m[16];
+    uint32_t lo[16], hi[16], words[8][16];
+    uint8_t block_flags = flags | flags_start;
+    size_t b;
+    unsigned int i;
+
+    LANE_COUNTERS(16, lo, hi);
+    const __m512i ctr_lo = _mm512_loadu_si512((const void *)lo);
+    const __m512i ctr_hi = _mm512_loadu_si512((const void *)hi);
+    for (i = 0; i < 8; ++i) {
+        h[i] = _mm512_set1_epi32((int)key[i]);
+    }
+
+    for (b = 0; b < blocks; ++b) {
+        const size_t offset = b * BLAKE3_BLOCK_LEN;
+        if (b + 1 == blocks) {
+            block_flags |= flags_end;
+        }
+        for (i = 0; i < 16; ++i) {
+            m[i] = _mm512_loadu_si512((const void *)(inputs[i] + offset));
+        }
+        AVX512_TRANSPOSE16(m);
+        for (i = 0; i < 8; ++i) {
+            v[i] = h[i];
+        }
+        for (i = 0; i < 4; ++i) {
+            v[8 + i] = _mm512_set1_epi32((int)BLAKE3_IV[i]);
+        }
+        v[12] = ctr_lo;
+        v[13] = ctr_hi;
+        v[14] = _mm512_set1_epi32(BLAKE3_BLOCK_LEN);
+        v[15] = _mm512_set1_epi32(block_flags);
+        ROUNDS();
+        for (i = 0; i < 8; ++i) {
+            h[i] = _mm512_xor_si512(v[i], v[i + 8]);
+        }
+        block_flags = flags;
+    }
+
+    for (i = 0; i < 8; ++i) {
+        _mm512_storeu_si512((void *)words[i], h[i]);
+    }
+    STORE_CVS(16, words, out);
+}
+
+SHS_TARGET("avx512f")
+void blake3_hash_many_avx512(const uint8_t *const *inputs, size_t num_inputs, size_t blocks,
+                             const uint32_t key[8], uint64_t counter, bool increment_counter,
+                             uint8_t flags, uint8_t flags_start, uint8_t flags_end,
+                             uint8_t *out) {
+    while (num_inputs >= 16) {
+        hash16_avx512(inputs, blocks, key, counter, increment_counter, flags, flags_start,
+                      flags_end, out);
+        if (increment_counter) {
+            counter += 16;
+        }
+        inputs += 16;
+        num_inputs -= 16;
+        out += 16 * BLAKE3_OUT_LEN;
+    }
+    blake3_hash_many_avx2(inputs, num_inputs, blocks, key, counter, increment_counter,
+                          flags, flags_start, flags_end, out);
+}
+
+#endif /* BLAKE3_HAVE_SIMD */
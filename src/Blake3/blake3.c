@@ -0,0 +1,450 @@
+#include "blake3-impl.h"
+
+/*
+ * BLAKE3 hasher on top of the dispatched kernels.
+ *
+ * Input is consumed in the largest power-of-two subtrees the chunk counter
+ * allows. A subtree is split into tasks of up to SUBTREE_TASK_CHUNKS chunks;
+ * each task hashes its chunks side by side through hash_many and folds them
+ * into one chaining value, and the task CVs are then folded the same way
+ * until two remain. Those two go on the CV stack, which is merged lazily so
+ * the last pushed values are never mistaken for the root.
+ */
+
+#define SUBTREE_TASK_CHUNKS 64
+#define SUBTREE_MAX_CHUNKS (1u << 16)
+#define SUBTREE_MAX_TASKS (SUBTREE_MAX_CHUNKS / SUBTREE_TASK_CHUNKS)
+
+typedef struct {
+    const char *name;
+    size_t degree;
+    blake3_compress_in_place_fn compress_in_place;
+    blake3_compress_xof_fn compress_xof;
+    blake3_hash_many_fn hash_many;
+} blake3_ops;
+
+static const blake3_ops blake3_ops_portable = {
+    "portable", 1, blake3_compress_in_place_portable, blake3_compress_xof_portable,
+    blake3_hash_many_portable};
+
+#ifdef BLAKE3_HAVE_SIMD
+static const blake3_ops blake3_ops_sse41 = {
+    "sse41", 4, blake3_compress_in_place_sse41, blake3_compress_xof_sse41,
+    blake3_hash_many_sse41};
+static const blake3_ops blake3_ops_avx2 = {
+    "avx2", 8, blake3_compress_in_place_sse41, blake3_compress_xof_sse41,
+    blake3_hash_many_avx2};
+static const blake3_ops blake3_ops_avx512 = {
+    "avx512", 16, blake3_compress_in_place_sse41, blake3_compress_xof_sse41,
+    blake3_hash_many_avx512};
+#endif
+
+static const blake3_ops *volatile blake3_ops_impl = NULL;
+
+static const blake3_ops *blake3_ops_resolve(void) {
+    const blake3_ops *ops = blake3_ops_impl;
+    if (ops == NULL) {
+        ops = &blake3_ops_portable;
+#ifdef BLAKE3_HAVE_SIMD
+        if (shs_cpu_has_avx512f()) {
+            ops = &blake3_ops_avx512;
+        } else if (shs_cpu_has_avx2()) {
+            ops = &blake3_ops_avx2;
+        } else if (shs_cpu_has_sse41()) {
+            ops = &blake3_ops_sse41;
+        }
+#endif
+        /* racing first calls all store the same value */
+        blake3_ops_impl = ops;
+    }
+    return ops;
+}
+
+const char *blake3_backend(void) {
+    return blake3_ops_resolve()->name;
+}
+
+size_t blake3_simd_degree(void) {
+    return blake3_ops_resolve()->degree;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Outputs: everything needed to compress a node once more, possibly as root */
+
+typedef struct {
+    uint32_t input_cv[8];
+    uint64_t counter;
+    uint8_t block[BLAKE3_BLOCK_LEN];
+    uint8_t block_len;
+    uint8_t flags;
+} blake3_output;
+
+static blake3_output make_output(const uint32_t input_cv[8], const uint8_t block[BLAKE3_BLOCK_LEN],
+                                 uint8_t block_len, uint64_t counter, uint8_t flags) {
+    blake3_output o;
+    memcpy(o.input_cv, input_cv, sizeof(o.input_cv));
+    memcpy(o.block, block, BLAKE3_BLOCK_LEN);
+    o.block_len = block_len;
+    o.counter = counter;
+    o.flags = flags;
+    return o;
+}
+
+static blake3_output parent_output(const uint8_t block[BLAKE3_BLOCK_LEN], const uint32_t key[8],
+                                   uint8_t flags) {
+    return make_output(key, block, BLAKE3_BLOCK_LEN, 0, flags | PARENT);
+}
+
+static void output_chaining_value(const blake3_output *o, uint8_t cv[BLAKE3_OUT_LEN]) {
+    uint32_t words[8];
+    memcpy(words, o->input_cv, sizeof(words));
+    blake3_ops_resolve()->compress_in_place(words, o->block, o->block_len, o->counter,
+                                            o->flags);
+    blake3_store_cv_words(cv, words);
+}
+
+static void output_root_bytes(const blake3_output *o, uint64_t seek, uint8_t *out,
+                              size_t out_len) {
+    const blake3_compress_xof_fn compress_xof = blake3_ops_resolve()->compress_xof;
+    uint64_t counter = seek / BLAKE3_BLOCK_LEN;
+    size_t offset = (size_t)(seek % BLAKE3_BLOCK_LEN);
+    uint8_t wide[BLAKE3_BLOCK_LEN];
+
+    while (out_len > 0) {
+        size_t take = BLAKE3_BLOCK_LEN - offset;
+        if (take > out_len) {
+            take = out_len;
+        }
+        compress_xof(o->input_cv, o->block, o->block_len, counter, o->flags | ROOT, wide);
+        memcpy(out, wide + offset, take);
+        out += take;
+        out_len -= take;
+        counter += 1;
+        offset = 0;
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/* Chunk state: the last block is held back until more input arrives       */
+
+static void chunk_state_init(blake3_chunk_state *cs, const uint32_t key[8], uint8_t flags) {
+    memcpy(cs->cv, key, sizeof(cs->cv));
+    cs->chunk_counter = 0;
+    memset(cs->buf, 0, BLAKE3_BLOCK_LEN);
+    cs->buf_len = 0;
+    cs->blocks_compressed = 0;
+    cs->flags = flags;
+}
+
+static void chunk_state_reset(blake3_chunk_state *cs, const uint32_t key[8],
+                              uint64_t chunk_counter) {
+    chunk_state_init(cs, key, cs->flags);
+    cs->chunk_counter = chunk_counter;
+}
+
+static size_t chunk_state_len(const blake3_chunk_state *cs) {
+    return BLAKE3_BLOCK_LEN * (size_t)cs->blocks_compressed + cs->buf_len;
+}
+
+static uint8_t chunk_state_start_flag(const blake3_chunk_state *cs) {
+    return cs->blocks_compressed == 0 ? CHUNK_START : 0;
+}
+
+static size_t chunk_state_fill_buf(blake3_chunk_state *cs, const uint8_t *input,
+                                   size_t input_len) {
+    size_t take = BLAKE3_BLOCK_LEN - cs->buf_len;
+    if (take > input_len) {
+        take = input_len;
+    }
+    memcpy(cs->buf + cs->buf_len, input, take);
+    cs->buf_len += (uint8_t)take;
+    return take;
+}
+
+static void chunk_state_update(blake3_chunk_state *cs, const uint8_t *input, size_t input_len) {
+    const blake3_compress_in_place_fn compress = blake3_ops_resolve()->compress_in_place;
+
+    if (cs->buf_len > 0) {
+        size_t take = chunk_state_fill_buf(cs, input, input_len);
+        input += take;
+        input_len -= take;
+        if (input_len > 0) {
+            compress(cs->cv, cs->buf, BLAKE3_BLOCK_LEN, cs->chunk_counter,
+                     cs->flags | chunk_state_start_flag(cs));
+            cs->blocks_compressed += 1;
+            cs->buf_len = 0;
+            memset(cs->buf, 0, BLAKE3_BLOCK_LEN);
+        }
+    }
+
+    while (input_len > BLAKE3_BLOCK_LEN) {
+        compress(cs->cv, input, BLAKE3_BLOCK_LEN, cs->chunk_counter,
+                 cs->flags | chunk_state_start_flag(cs));
+        cs->blocks_compressed += 1;
+        input += BLAKE3_BLOCK_LEN;
+        input_len -= BLAKE3_BLOCK_LEN;
+    }
+
+    chunk_state_fill_buf(cs, input, input_len);
+}
+
+static blake3_output chunk_state_output(const blake3_chunk_state *cs) {
+    return make_output(cs->cv, cs->buf, cs->buf_len, cs->chunk_counter,
+                       cs->flags | chunk_state_start_flag(cs) | CHUNK_END);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Subtrees                                                                */
+
+/* Fold n (a power of two) CVs in place until `target` remain */
+static void fold_parents(const blake3_ops *ops, const uint32_t key[8], uint8_t flags,
+                         uint8_t *cvs, size_t n, size_t target) {
+    const uint8_t *parents[SUBTREE_MAX_TASKS / 2];
+    size_t i;
+
+    while (n > target) {
+        /* output i lands at i*32, below every block still to be read */
+        for (i = 0; i < n / 2; ++i) {
+            parents[i] = cvs + i * 2 * BLAKE3_OUT_LEN;
+        }
+        ops->hash_many(parents, n / 2, 1, key, 0, false, flags | PARENT, 0, 0, cvs);
+        n /= 2;
+    }
+}
+
+typedef struct {
+    const blake3_ops *ops;
+    const uint32_t *key;
+    uint8_t flags;
+    const uint8_t *input;
+    size_t task_chunks;
+    uint64_t chunk_counter;
+    uint8_t *cvs;
+} blake3_subtree_job;
+
+static void subtree_task(void *arg, size_t index) {
+    const blake3_subtree_job *job = (const blake3_subtree_job *)arg;
+    const uint8_t *chunks[SUBTREE_TASK_CHUNKS];
+    uint8_t cvs[SUBTREE_TASK_CHUNKS * BLAKE3_OUT_LEN];
+    const uint8_t *input = job->input + index * job->task_chunks * BLAKE3_CHUNK_LEN;
+    size_t i;
+
+    for (i = 0; i < job->task_chunks; ++i) {
+        chunks[i] = input + i * BLAKE3_CHUNK_LEN;
+    }
+    job->ops->hash_many(chunks, job->task_chunks, BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN,
+                        job->key, job->chunk_counter + index * job->task_chunks, true,
+                        job->flags, CHUNK_START, CHUNK_END, cvs);
+    fold_parents(job->ops, job->key, job->flags, cvs, job->task_chunks, 1);
+    memcpy(job->cvs + index * BLAKE3_OUT_LEN, cvs, BLAKE3_OUT_LEN);
+}
+
+/* Hashes `chunks` (a power of two, at least 2) whole chunks down to the two
+ * children of the subtree root, written to out[0..63]. */
+static void compress_subtree(const blake3_hasher *self, const uint8_t *input, size_t chunks,
+                             blake3_parallel_for parallel_for, void *pool,
+                             uint8_t out[2 * BLAKE3_OUT_LEN]) {
+    uint8_t cvs[SUBTREE_MAX_TASKS * BLAKE3_OUT_LEN];
+    blake3_subtree_job job;
+    size_t tasks, i;
+
+    job.ops = blake3_ops_resolve();
+    job.key = self->key;
+    job.flags = self->chunk.flags;
+    job.input = input;
+    job.task_chunks = chunks / 2 < SUBTREE_TASK_CHUNKS ? chunks / 2 : SUBTREE_TASK_CHUNKS;
+    job.chunk_counter = self->chunk.chunk_counter;
+    job.cvs = cvs;
+    tasks = chunks / job.task_chunks;
+
+    if (parallel_for != NULL && tasks > 2) {
+        parallel_for(pool, tasks, subtree_task, &job);
+    } else {
+        for (i = 0; i < tasks; ++i) {
+            subtree_task(&job, i);
+        }
+    }
+    fold_parents(job.ops, self->key, self->chunk.flags, cvs, tasks, 2);
+    memcpy(out, cvs, 2 * BLAKE3_OUT_LEN);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Hasher                                                                  */
+
+static unsigned int popcount64(uint64_t x) {
+    unsigned int count = 0;
+    while (x != 0) {
+        count += 1;
+        x &= x - 1;
+    }
+    return count;
+}
+
+static uint64_t round_down_to_power_of_2(uint64_t x) {
+    while (x & (x - 1)) {
+        x &= x - 1;
+    }
+    return x;
+}
+
+static void hasher_init_base(blake3_hasher *self, const uint32_t key[8], uint8_t flags) {
+    memcpy(self->key, key, sizeof(self->key));
+    chunk_state_init(&self->chunk, key, flags);
+    self->cv_stack_len = 0;
+}
+
+/* After `total_chunks` chunks, complete subtrees correspond to its set bits */
+static void hasher_merge_cv_stack(blake3_hasher *self, uint64_t total_chunks) {
+    const size_t post_merge = popcount64(total_chunks);
+
+    while (self->cv_stack_len > post_merge) {
+        uint8_t *parent = &self->cv_stack[(self->cv_stack_len - 2) * BLAKE3_OUT_LEN];
+        blake3_output o = parent_output(parent, self->key, self->chunk.flags);
+        output_chaining_value(&o, parent);
+        self->cv_stack_len -= 1;
+    }
+}
+
+static void hasher_push_cv(blake3_hasher *self, const uint8_t cv[BLAKE3_OUT_LEN],
+                           uint64_t chunk_counter) {
+    hasher_merge_cv_stack(self, chunk_counter);
+    memcpy(&self->cv_stack[self->cv_stack_len * BLAKE3_OUT_LEN], cv, BLAKE3_OUT_LEN);
+    self->cv_stack_len += 1;
+}
+
+void blake3_hasher_init(blake3_hasher *self) {
+    hasher_init_base(self, BLAKE3_IV, 0);
+}
+
+void blake3_hasher_init_keyed(blake3_hasher *self, const uint8_t key[BLAKE3_KEY_LEN]) {
+    uint32_t words[8];
+    blake3_load_key_words(key, words);
+    hasher_init_base(self, words, KEYED_HASH);
+}
+
+void blake3_hasher_init_derive_key_raw(blake3_hasher *self, const void *context,
+                                       size_t context_len) {
+    blake3_hasher context_hasher;
+    uint8_t context_key[BLAKE3_KEY_LEN];
+    uint32_t words[8];
+
+    hasher_init_base(&context_hasher, BLAKE3_IV, DERIVE_KEY_CONTEXT);
+    blake3_hasher_update(&context_hasher, context, context_len);
+    blake3_hasher_finalize(&context_hasher, context_key, BLAKE3_KEY_LEN);
+    blake3_load_key_words(context_key, words);
+    hasher_init_base(self, words, DERIVE_KEY_MATERIAL);
+}
+
+void blake3_hasher_update_parallel(blake3_hasher *self, const void *input, size_t input_len,
+                                   blake3_parallel_for parallel_for, void *pool) {
+    const uint8_t *in = (const uint8_t *)input;
+
+    if (input_len == 0) {
+        return;
+    }
+
+    /* finish the partial chunk; push it only if more input follows */
+    if (chunk_state_len(&self->chunk) > 0) {
+        size_t take = BLAKE3_CHUNK_LEN - chunk_state_len(&self->chunk);
+        if (take > input_len) {
+            take = input_len;
+        }
+        chunk_state_update(&self->chunk, in, take);
+        in += take;
+        input_len -= take;
+        if (input_len == 0) {
+            return;
+        }
+        {
+            uint8_t cv[BLAKE3_OUT_LEN];
+            blake3_output o = chunk_state_output(&self->chunk);
+            output_chaining_value(&o, cv);
+            hasher_push_cv(self, cv, self->chunk.chunk_counter);
+            chunk_state_reset(&self->chunk, self->key, self->chunk.chunk_counter + 1);
+        }
+    }
+
+    /* whole subtrees, aligned to the chunk counter; at least one byte of the
+     * input is left over unless a subtree ends exactly at the end */
+    while (input_len > BLAKE3_CHUNK_LEN) {
+        const uint64_t count_so_far = self->chunk.chunk_counter * BLAKE3_CHUNK_LEN;
+        uint64_t subtree_len = round_down_to_power_of_2(input_len);
+        uint64_t subtree_chunks;
+
+        if (subtree_len > (uint64_t)SUBTREE_MAX_CHUNKS * BLAKE3_CHUNK_LEN) {
+            subtree_len = (uint64_t)SUBTREE_MAX_CHUNKS * BLAKE3_CHUNK_LEN;
+        }
+        while (((subtree_len - 1) & count_so_far) != 0) {
+            subtree_len /= 2;
+        }
+        subtree_chunks = subtree_len / BLAKE3_CHUNK_LEN;
+
+        if (subtree_chunks == 1) {
+            blake3_chunk_state cs;
+            uint8_t cv[BLAKE3_OUT_LEN];
+            blake3_output o;
+            chunk_state_init(&cs, self->key, self->chunk.flags);
+            cs.chunk_counter = self->chunk.chunk_counter;
+            chunk_state_update(&cs, in, BLAKE3_CHUNK_LEN);
+            o = chunk_state_output(&cs);
+            output_chaining_value(&o, cv);
+            hasher_push_cv(self, cv, cs.chunk_counter);
+        } else {
+            uint8_t children[2 * BLAKE3_OUT_LEN];
+            compress_subtree(self, in, (size_t)subtree_chunks, parallel_for, pool, children);
+            hasher_push_cv(self, children, self->chunk.chunk_counter);
+            hasher_push_cv(self, children + BLAKE3_OUT_LEN,
+                           self->chunk.chunk_counter + subtree_chunks / 2);
+        }
+        self->chunk.chunk_counter += subtree_chunks;
+        in += subtree_len;
+        input_len -= (size_t)subtree_len;
+    }
+
+    if (input_len > 0) {
+        chunk_state_update(&self->chunk, in, input_len);
+        hasher_merge_cv_stack(self, self->chunk.chunk_counter);
+    }
+}
+
+void blake3_hasher_update(blake3_hasher *self, const void *input, size_t input_len) {
+    blake3_hasher_update_parallel(self, input, input_len, NULL, NULL);
+}
+
+void blake3_hasher_finalize_seek(const blake3_hasher *self, uint64_t seek, uint8_t *out,
+                                 size_t out_len) {
+    blake3_output o;
+    size_t remaining;
+
+    if (out_len == 0) {
+        return;
+    }
+    if (self->cv_stack_len == 0) {
+        o = chunk_state_output(&self->chunk);
+        output_root_bytes(&o, seek, out, out_len);
+        return;
+    }
+
+    /* an empty chunk state means a subtree ended exactly at the input's end,
+     * leaving its two children on top of the stack */
+    if (chunk_state_len(&self->chunk) > 0) {
+        remaining = self->cv_stack_len;
+        o = chunk_state_output(&self->chunk);
+    } else {
+        remaining = self->cv_stack_len - 2u;
+        o = parent_output(&self->cv_stack[remaining * BLAKE3_OUT_LEN], self->key,
+                          self->chunk.flags);
+    }
+    while (remaining > 0) {
+        uint8_t parent[BLAKE3_BLOCK_LEN];
+        remaining -= 1;
+        memcpy(parent, &self->cv_stack[remaining * BLAKE3_OUT_LEN], BLAKE3_OUT_LEN);
+        output_chaining_value(&o, parent + BLAKE3_OUT_LEN);
+        o = parent_output(parent, self->key, self->chunk.flags);
+    }
+    output_root_bytes(&o, seek, out, out_len);
+}
+
+void blake3_hasher_finalize(const blake3_hasher *self, uint8_t *out, size_t out_len) {
+    blake3_hasher_finalize_seek(self, 0, out, out_len);
+}
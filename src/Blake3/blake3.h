@@ -0,0 +1,65 @@
+#ifndef PORTABLE_BLAKE3_H
+#define PORTABLE_BLAKE3_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define BLAKE3_KEY_LEN 32
+#define BLAKE3_OUT_LEN 32
+#define BLAKE3_BLOCK_LEN 64
+#define BLAKE3_CHUNK_LEN 1024
+#define BLAKE3_MAX_DEPTH 54
+
+typedef struct __blake3_chunk_state {
+    uint32_t cv[8];
+    uint64_t chunk_counter;
+    uint8_t buf[BLAKE3_BLOCK_LEN];
+    uint8_t buf_len;
+    uint8_t blocks_compressed;
+    uint8_t flags;
+} blake3_chunk_state;
+
+/* The last chunk always stays in `chunk` until finalization, so subtree
+ * chaining values on the stack are never the root. */
+typedef struct __blake3_hasher {
+    uint32_t key[8];
+    blake3_chunk_state chunk;
+    uint8_t cv_stack_len;
+    uint8_t cv_stack[(BLAKE3_MAX_DEPTH + 1) * BLAKE3_OUT_LEN];
+} blake3_hasher;
+
+/* Runs body(arg, i) for i in [0, count), possibly on several threads, and
+ * returns when all calls are done. `pool` is passed through untouched. */
+typedef void (*blake3_parallel_for)(void *pool, size_t count,
+                                    void (*body)(void *arg, size_t i), void *arg);
+
+void blake3_hasher_init(blake3_hasher *self);
+void blake3_hasher_init_keyed(blake3_hasher *self, const uint8_t key[BLAKE3_KEY_LEN]);
+void blake3_hasher_init_derive_key_raw(blake3_hasher *self, const void *context,
+                                       size_t context_len);
+void blake3_hasher_update(blake3_hasher *self, const void *input, size_t input_len);
+/* Same result as blake3_hasher_update; whole subtrees of the input are
+ * hashed through `parallel_for` (serially if it is NULL) */
+void blake3_hasher_update_parallel(blake3_hasher *self, const void *input,
+                                   size_t input_len, blake3_parallel_for parallel_for,
+                                   void *pool);
+/* Output bytes [seek, seek + out_len) of the XOF. Does not modify the
+ * hasher, so more input may follow. */
+void blake3_hasher_finalize_seek(const blake3_hasher *self, uint64_t seek,
+                                 uint8_t *out, size_t out_len);
+void blake3_hasher_finalize(const blake3_hasher *self, uint8_t *out, size_t out_len);
+
+/* Selected kernel: "avx512", "avx2", "sse41" or "portable" */
+const char *blake3_backend(void);
+/* Chunks the selected kernel hashes at once */
+size_t blake3_simd_degree(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,95 @@
+#include <string.h>
+
+#include "hmac-sha512.h"
+
+#define HMAC_SHA512_BLOCKLEN 128
+#define HMAC_SHA512_OUTLEN 64
+
+/* prevents compiler optimizing out memset() */
+void hmac_sha512_wipe(void *v, size_t n) {
+    static void *(*const volatile memset_v)(void *, int, size_t) = &memset;
+    memset_v(v, 0, n);
+}
+
+/**
+   Absorb the padded key into the inner and outer states
+   @param hk      The prepared key to fill in
+   @param key     The HMAC key (hashed first if longer than one block)
+   @param keylen  The length of the key (octets)
+   @return 0 if successful
+*/
+int hmac_sha512_setkey(hmac_sha512_key *hk, const unsigned char *key, size_t keylen) {
+    unsigned char block[HMAC_SHA512_BLOCKLEN];
+    size_t i;
+
+    if (hk == NULL) return 1;
+    if (key == NULL && keylen != 0) return 1;
+
+    memset(block, 0, sizeof(block));
+    if (keylen > HMAC_SHA512_BLOCKLEN) {
+        sha512(key, keylen, block);
+    } else if (keylen != 0) {
+        memcpy(block, key, keylen);
+    }
+
+    for (i = 0; i < HMAC_SHA512_BLOCKLEN; i++) {
+        block[i] ^= 0x36;
+    }
+    sha512_init(&hk->inner);
+    sha512_update(&hk->inner, block, HMAC_SHA512_BLOCKLEN);
+
+    for (i = 0; i < HMAC_SHA512_BLOCKLEN; i++) {
+        block[i] ^= 0x36 ^ 0x5c;
+    }
+    sha512_init(&hk->outer);
+    sha512_update(&hk->outer, block, HMAC_SHA512_BLOCKLEN);
+
+    hmac_sha512_wipe(block, sizeof(block));
+    return 0;
+}
+
+/**
+   Start a MAC from the cached inner midstate
+   @param md  The hash state to initialize
+   @param hk  The prepared key
+   @return 0 if successful
+*/
+int hmac_sha512_init(sha512_context *md, const hmac_sha512_key *hk) {
+    if (md == NULL || hk == NULL) return 1;
+    *md = hk->inner;
+    return 0;
+}
+
+/**
+   Finish the inner hash and run the outer hash from the cached outer midstate
+   @param md   The inner hash state (wiped on return)
+   @param hk   The prepared key
+   @param out  [out] The destination of the tag (64 bytes)
+   @return 0 if successful
+*/
+int hmac_sha512_final(sha512_context *md, const hmac_sha512_key *hk, unsigned char *out) {
+    unsigned char inner[HMAC_SHA512_OUTLEN];
+    sha512_context outer;
+    int err;
+
+    if (md == NULL || hk == NULL || out == NULL) return 1;
+
+    if ((err = sha512_final(md, inner)) != 0) return err;
+    outer = hk->outer;
+    sha512_update(&outer, inner, HMAC_SHA512_OUTLEN);
+    err = sha512_final(&outer, out);
+
+    hmac_sha512_wipe(inner, sizeof(inner));
+    hmac_sha512_wipe(&outer, sizeof(outer));
+    hmac_sha512_wipe(md, sizeof(*md));
+    return err;
+}
+
+int hmac_sha512(const hmac_sha512_key *hk, const unsigned char *in, size_t inlen, unsigned char *out) {
+    sha512_context md;
+    int err;
+
+    if ((err = hmac_sha512_init(&md, hk)) != 0) return err;
+    if (inlen != 0 && (err = sha512_update(&md, in, inlen)) != 0) return err;
+    return hmac_sha512_final(&md, hk, out);
+}
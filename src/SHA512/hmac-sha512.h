@@ -0,0 +1,30 @@
+#ifndef HMAC_SHA512_H
+#define HMAC_SHA512_H
+
+#include <stddef.h>
+
+#include "sha512.h"
+
+/* Prepared HMAC key: SHA-512 states right after the ipad and opad blocks.
+ * Every MAC starts from a copy of these midstates, so the two key blocks
+ * are compressed once per key instead of once per message. */
+typedef struct hmac_sha512_key_ {
+    sha512_context inner;
+    sha512_context outer;
+} hmac_sha512_key;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int hmac_sha512_setkey(hmac_sha512_key *hk, const unsigned char *key, size_t keylen);
+int hmac_sha512_init(sha512_context *md, const hmac_sha512_key *hk);
+int hmac_sha512_final(sha512_context *md, const hmac_sha512_key *hk, unsigned char *out);
+int hmac_sha512(const hmac_sha512_key *hk, const unsigned char *in, size_t inlen, unsigned char *out);
+void hmac_sha512_wipe(void *v, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
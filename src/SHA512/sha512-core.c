@@ -0,0 +1,469 @@
+/*
+ * SHA-512 compression and streaming interface. The streaming layer keeps
+ * the LibTomCrypt (Tom St Denis, public domain) API the Ed25519 code was
+ * written against; the rounds are unrolled with a rolling 16-word schedule
+ * and compiled once per backend.
+ */
+
+#include <string.h>
+
+#include "sha512-core.h"
+#include "../cpu-features.h"
+
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#define SHA512_INLINE static __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#define SHA512_INLINE static inline __attribute__((always_inline))
+#else
+#define SHA512_INLINE static inline
+#endif
+
+/* the K array */
+const uint64_t sha512_K[80] = {
+    UINT64_C(0x428a2f98d728ae22), UINT64_C(0x7137449123ef65cd),
+    UINT64_C(0xb5c0fbcfec4d3b2f), UINT64_C(0xe9b5dba58189dbbc),
+    UINT64_C(0x3956c25bf348b538), UINT64_C(0x59f111f1b605d019),
+    UINT64_C(0x923f82a4af194f9b), UINT64_C(0xab1c5ed5da6d8118),
+    UINT64_C(0xd807aa98a3030242), UINT64_C(0x12835b0145706fbe),
+    UINT64_C(0x243185be4ee4b28c), UINT64_C(0x550c7dc3d5ffb4e2),
+    UINT64_C(0x72be5d74f27b896f), UINT64_C(0x80deb1fe3b1696b1),
+    UINT64_C(0x9bdc06a725c71235), UINT64_C(0xc19bf174cf692694),
+    UINT64_C(0xe49b69c19ef14ad2), UINT64_C(0xefbe4786384f25e3),
+    UINT64_C(0x0fc19dc68b8cd5b5), UINT64_C(0x240ca1cc77ac9c65),
+    UINT64_C(0x2de92c6f592b0275), UINT64_C(0x4a7484aa6ea6e483),
+    UINT64_C(0x5cb0a9dcbd41fbd4), UINT64_C(0x76f988da831153b5),
+    UINT64_C(0x983e5152ee66dfab), UINT64_C(0xa831c66d2db43210),
+    UINT64_C(0xb00327c898fb213f), UINT64_C(0xbf597fc7beef0ee4),
+    UINT64_C(0xc6e00bf33da88fc2), UINT64_C(0xd5a79147930aa725),
+    UINT64_C(0x06ca6351e003826f), UINT64_C(0x142929670a0e6e70),
+    UINT64_C(0x27b70a8546d22ffc), UINT64_C(0x2e1b21385c26c926),
+    UINT64_C(0x4d2c6dfc5ac42aed), UINT64_C(0x53380d139d95b3df),
+    UINT64_C(0x650a73548baf63de), UINT64_C(0x766a0abb3c77b2a8),
+    UINT64_C(0x81c2c92e47edaee6), UINT64_C(0x92722c851482353b),
+    UINT64_C(0xa2bfe8a14cf10364), UINT64_C(0xa81a664bbc423001),
+    UINT64_C(0xc24b8b70d0f89791), UINT64_C(0xc76c51a30654be30),
+    UINT64_C(0xd192e819d6ef5218), UINT64_C(0xd69906245565a910),
+    UINT64_C(0xf40e35855771202a), UINT64_C(0x106aa07032bbd1b8),
+    UINT64_C(0x19a4c116b8d2d0c8), UINT64_C(0x1e376c085141ab53),
+    UINT64_C(0x2748774cdf8eeb99), UINT64_C(0x34b0bcb5e19b48a8),
+    UINT64_C(0x391c0cb3c5c95a63), UINT64_C(0x4ed8aa4ae3418acb),
+    UINT64_C(0x5b9cca4f7763e373), UINT64_C(0x682e6ff3d6b2b8a3),
+    UINT64_C(0x748f82ee5defb2fc), UINT64_C(0x78a5636f43172f60),
+    UINT64_C(0x84c87814a1f0ab72), UINT64_C(0x8cc702081a6439ec),
+    UINT64_C(0x90befffa23631e28), UINT64_C(0xa4506cebde82bde9),
+    UINT64_C(0xbef9a3f7b2c67915), UINT64_C(0xc67178f2e372532b),
+    UINT64_C(0xca273eceea26619c), UINT64_C(0xd186b8c721c0c207),
+    UINT64_C(0xeada7dd6cde0eb1e), UINT64_C(0xf57d4f7fee6ed178),
+    UINT64_C(0x06f067aa72176fba), UINT64_C(0x0a637dc5a2c898a6),
+    UINT64_C(0x113f9804bef90dae), UINT64_C(0x1b710b35131c471b),
+    UINT64_C(0x28db77f523047d84), UINT64_C(0x32caab7b40c72493),
+    UINT64_C(0x3c9ebe0a15c9bebc), UINT64_C(0x431d67c49c100d4c),
+    UINT64_C(0x4cc5d4becb3e42b6), UINT64_C(0x597f299cfc657e2a),
+    UINT64_C(0x5fcb6fab3ad6faec), UINT64_C(0x6c44198c4a475817)
+};
+
+SHA512_INLINE uint64_t ror64(uint64_t x, unsigned n) {
+    return (x >> n) | (x << (64 - n));
+}
+
+SHA512_INLINE uint64_t load64_be(const unsigned char *p) {
+#if defined(__GNUC__) || defined(__clang__)
+    uint64_t v;
+    memcpy(&v, p, 8);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+#elif defined(_MSC_VER)
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return _byteswap_uint64(v);
+#else
+    return ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) |
+           ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+           ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) |
+           ((uint64_t)p[6] << 8) | (uint64_t)p[7];
+#endif
+}
+
+SHA512_INLINE void store64_be(unsigned char *p, uint64_t v) {
+    p[0] = (unsigned char)(v >> 56); p[1] = (unsigned char)(v >> 48);
+    p[2] = (unsigned char)(v >> 40); p[3] = (unsigned char)(v >> 32);
+    p[4] = (unsigned char)(v >> 24); p[5] = (unsigned char)(v >> 16);
+    p[6] = (unsigned char)(v >> 8);  p[7] = (unsigned char)v;
+}
+
+#define Ch(x,y,z)       ((z) ^ ((x) & ((y) ^ (z))))
+#define Maj(x,y,z)      ((((x) | (y)) & (z)) | ((x) & (y)))
+#define Sigma0(x)       (ror64(x, 28) ^ ror64(x, 34) ^ ror64(x, 39))
+#define Sigma1(x)       (ror64(x, 14) ^ ror64(x, 18) ^ ror64(x, 41))
+#define Gamma0(x)       (ror64(x, 1) ^ ror64(x, 8) ^ ((x) >> 7))
+#define Gamma1(x)       (ror64(x, 19) ^ ror64(x, 61) ^ ((x) >> 6))
+
+/* One round; the caller rotates the roles of a..h instead of moving data */
+#define RND(a,b,c,d,e,f,g,h,k,w)                         \
+    do {                                                 \
+        uint64_t t0 = h + Sigma1(e) + Ch(e, f, g) + (k) + (w); \
+        uint64_t t1 = Sigma0(a) + Maj(a, b, c);          \
+        d += t0;                                         \
+        h = t0 + t1;                                     \
+    } while (0)
+
+/* Message schedule in place: W[i & 15] becomes W[i] */
+#define SCHED(i) \
+    (W[(i) & 15] += Gamma1(W[((i) - 2) & 15]) + W[((i) - 7) & 15] + Gamma0(W[((i) - 15) & 15]))
+
+#define RND8(i, w)                                                   \
+    RND(a, b, c, d, e, f, g, h, sha512_K[(i) + 0], w((i) + 0));      \
+    RND(h, a, b, c, d, e, f, g, sha512_K[(i) + 1], w((i) + 1));      \
+    RND(g, h, a, b, c, d, e, f, sha512_K[(i) + 2], w((i) + 2));      \
+    RND(f, g, h, a, b, c, d, e, sha512_K[(i) + 3], w((i) + 3));      \
+    RND(e, f, g, h, a, b, c, d, sha512_K[(i) + 4], w((i) + 4));      \
+    RND(d, e, f, g, h, a, b, c, sha512_K[(i) + 5], w((i) + 5));      \
+    RND(c, d, e, f, g, h, a, b, sha512_K[(i) + 6], w((i) + 6));      \
+    RND(b, c, d, e, f, g, h, a, sha512_K[(i) + 7], w((i) + 7))
+
+#define WLOAD(i) (W[i])
+
+/* Rounds over 16 words already in W; shared by every backend */
+SHA512_INLINE void sha512_rounds(uint64_t state[8], uint64_t W[16]) {
+    uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+    int i;
+
+    RND8(0, WLOAD);
+    RND8(8, WLOAD);
+    for (i = 16; i < 80; i += 16) {
+        RND8(i, SCHED);
+        RND8(i + 8, SCHED);
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+SHA512_INLINE void sha512_blocks_body(uint64_t state[8], const unsigned char *in, size_t nblocks) {
+    uint64_t W[16];
+    int i;
+
+    while (nblocks--) {
+        for (i = 0; i < 16; i++) {
+            W[i] = load64_be(in + 8 * i);
+        }
+        sha512_rounds(state, W);
+        in += 128;
+    }
+}
+
+/* H^n of a 64-byte value. A digest's big-endian words are exactly the next
+ * message's words, so iterations never go back through bytes. */
+SHA512_INLINE void sha512_iterate_body(uint64_t h[8], uint64_t n, const uint64_t iv[8]) {
+    uint64_t W[16], state[8];
+    int i;
+
+    while (n--) {
+        for (i = 0; i < 8; i++) {
+            W[i] = h[i];
+            state[i] = iv[i];
+        }
+        W[8] = UINT64_C(0x8000000000000000);
+        W[9] = W[10] = W[11] = W[12] = W[13] = W[14] = 0;
+        W[15] = 512;
+        sha512_rounds(state, W);
+        for (i = 0; i < 8; i++) {
+            h[i] = state[i];
+        }
+    }
+}
+
+#define SHA512_BACKEND(suffix, attr)                                                    \
+    attr static void sha512_blocks_##suffix(uint64_t state[8], const unsigned char *in, \
+                                            size_t nblocks) {                           \
+        sha512_blocks_body(state, in, nblocks);                                         \
+    }                                                                                   \
+    attr static void sha512_words_##suffix(uint64_t state[8], const uint64_t block[16]) { \
+        uint64_t W[16];                                                                 \
+        memcpy(W, block, sizeof(W));                                                    \
+        sha512_rounds(state, W);                                                        \
+    }                                                                                   \
+    attr static void sha512_iterate_##suffix(uint64_t h[8], uint64_t n,                 \
+                                             const uint64_t iv[8]) {                    \
+        sha512_iterate_body(h, n, iv);                                                  \
+    }
+
+SHA512_BACKEND(portable, )
+
+#if defined(SHS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SHA512_HAVE_BMI2 1
+/* Same code; rorx/andn shorten the Sigma and Ch dependency chains */
+SHA512_BACKEND(bmi2, SHS_TARGET("bmi2"))
+#endif
+
+typedef struct sha512_backend_ops_ {
+    const char *name;
+    void (*blocks)(uint64_t state[8], const unsigned char *in, size_t nblocks);
+    void (*words)(uint64_t state[8], const uint64_t block[16]);
+    void (*iterate)(uint64_t h[8], uint64_t n, const uint64_t iv[8]);
+} sha512_backend_ops;
+
+static const sha512_backend_ops sha512_ops_portable = {
+    "portable", sha512_blocks_portable, sha512_words_portable, sha512_iterate_portable
+};
+
+#ifdef SHA512_HAVE_BMI2
+static const sha512_backend_ops sha512_ops_bmi2 = {
+    "bmi2", sha512_blocks_bmi2, sha512_words_bmi2, sha512_iterate_bmi2
+};
+#endif
+
+static const sha512_backend_ops *volatile sha512_ops = NULL;
+
+static const sha512_backend_ops *sha512_resolve(void) {
+    const sha512_backend_ops *ops = sha512_ops;
+    if (ops == NULL) {
+        /* racing first calls all store the same pointer */
+        ops = &sha512_ops_portable;
+#ifdef SHA512_HAVE_BMI2
+        if (shs_cpu_has_bmi2()) {
+            ops = &sha512_ops_bmi2;
+        }
+#endif
+        sha512_ops = ops;
+    }
+    return ops;
+}
+
+void sha512_blocks(uint64_t state[8], const unsigned char *in, size_t nblocks) {
+    sha512_resolve()->blocks(state, in, nblocks);
+}
+
+const char *sha512_backend(void) {
+    return sha512_resolve()->name;
+}
+
+/* compress 1024-bits given as 16 already decoded big-endian words */
+void sha512_compress_words(uint64_t state[8], const uint64_t block[16]) {
+    sha512_resolve()->words(state, block);
+}
+
+static void sha512_set_iv(sha512_context *md, const uint64_t iv[8]) {
+    md->curlen = 0;
+    md->length = 0;
+    memcpy(md->state, iv, sizeof(md->state));
+}
+
+static const uint64_t sha512_iv[8] = {
+    UINT64_C(0x6a09e667f3bcc908), UINT64_C(0xbb67ae8584caa73b),
+    UINT64_C(0x3c6ef372fe94f82b), UINT64_C(0xa54ff53a5f1d36f1),
+    UINT64_C(0x510e527fade682d1), UINT64_C(0x9b05688c2b3e6c1f),
+    UINT64_C(0x1f83d9abfb41bd6b), UINT64_C(0x5be0cd19137e2179)
+};
+
+/* SHA-384 and SHA-512/256 (FIPS 180-4): same rounds, own IVs, truncated output */
+static const uint64_t sha384_iv[8] = {
+    UINT64_C(0xcbbb9d5dc1059ed8), UINT64_C(0x629a292a367cd507),
+    UINT64_C(0x9159015a3070dd17), UINT64_C(0x152fecd8f70e5939),
+    UINT64_C(0x67332667ffc00b31), UINT64_C(0x8eb44a8768581511),
+    UINT64_C(0xdb0c2e0d64f98fa7), UINT64_C(0x47b5481dbefa4fa4)
+};
+
+static const uint64_t sha512_256_iv[8] = {
+    UINT64_C(0x22312194fc2bf72c), UINT64_C(0x9f555fa3c84c64c2),
+    UINT64_C(0x2393b86b6f53b151), UINT64_C(0x963877195940eabd),
+    UINT64_C(0x96283ee2a88effe3), UINT64_C(0xbe5e1e2553863992),
+    UINT64_C(0x2b0199fc2c85b8aa), UINT64_C(0x0eb72ddc81c52ca2)
+};
+
+/**
+   Initialize the hash state
+   @param md   The hash state you wish to initialize
+   @return 0 if successful
+*/
+int sha512_init(sha512_context * md) {
+    if (md == NULL) return 1;
+    sha512_set_iv(md, sha512_iv);
+    return 0;
+}
+
+int sha384_init(sha512_context * md) {
+    if (md == NULL) return 1;
+    sha512_set_iv(md, sha384_iv);
+    return 0;
+}
+
+int sha512_256_init(sha512_context * md) {
+    if (md == NULL) return 1;
+    sha512_set_iv(md, sha512_256_iv);
+    return 0;
+}
+
+/**
+   Process a block of memory though the hash
+   @param md     The hash state
+   @param in     The data to hash
+   @param inlen  The length of the data (octets)
+   @return 0 if successful
+*/
+int sha512_update(sha512_context * md, const unsigned char *in, size_t inlen) {
+    size_t n, nblocks;
+
+    if (md == NULL) return 1;
+    if (in == NULL && inlen > 0) return 1;
+    if (md->curlen > sizeof(md->buf)) return 1;
+
+    if (md->curlen > 0) {
+        n = 128 - md->curlen;
+        if (n > inlen) n = inlen;
+        memcpy(md->buf + md->curlen, in, n);
+        md->curlen += n;
+        in += n;
+        inlen -= n;
+        if (md->curlen < 128) return 0;
+        sha512_blocks(md->state, md->buf, 1);
+        md->length += 128 * 8;
+        md->curlen = 0;
+    }
+
+    /* whole blocks straight from the caller's buffer */
+    nblocks = inlen / 128;
+    if (nblocks > 0) {
+        sha512_blocks(md->state, in, nblocks);
+        md->length += (uint64_t)nblocks * 128 * 8;
+        in += nblocks * 128;
+        inlen -= nblocks * 128;
+    }
+
+    if (inlen > 0) {
+        memcpy(md->buf, in, inlen);
+        md->curlen = inlen;
+    }
+    return 0;
+}
+
+/**
+   Pad, compress the last block(s) and emit the first outwords state words
+   @param md       The hash state
+   @param out      [out] The destination of the hash (8*outwords bytes)
+   @param outwords Number of 64-bit state words to output
+   @return 0 if successful
+*/
+static int sha512_finish(sha512_context * md, unsigned char *out, int outwords) {
+    int i;
+
+    if (md == NULL) return 1;
+    if (out == NULL) return 1;
+    if (md->curlen >= sizeof(md->buf)) return 1;
+
+    /* increase the length of the message */
+    md->length += md->curlen * UINT64_C(8);
+
+    /* append the '1' bit */
+    md->buf[md->curlen++] = (unsigned char)0x80;
+
+    /* no room for the length: pad this block out and start another */
+    if (md->curlen > 112) {
+        memset(md->buf + md->curlen, 0, 128 - md->curlen);
+        sha512_blocks(md->state, md->buf, 1);
+        md->curlen = 0;
+    }
+
+    /* zeroes up to the 128-bit length; its upper 64 bits are always zero here */
+    memset(md->buf + md->curlen, 0, 120 - md->curlen);
+    store64_be(md->buf + 120, md->length);
+    sha512_blocks(md->state, md->buf, 1);
+
+    for (i = 0; i < outwords; i++) {
+        store64_be(out + 8 * i, md->state[i]);
+    }
+    return 0;
+}
+
+/**
+   Terminate the hash to get the digest
+   @param md  The hash state
+   @param out [out] The destination of the hash (64 bytes)
+   @return 0 if successful
+*/
+int sha512_final(sha512_context * md, unsigned char *out) {
+    return sha512_finish(md, out, 8);
+}
+
+int sha384_final(sha512_context * md, unsigned char *out) {
+    return sha512_finish(md, out, 6);
+}
+
+int sha512_256_final(sha512_context * md, unsigned char *out) {
+    return sha512_finish(md, out, 4);
+}
+
+/* Padded single blocks for 32/64/96-byte messages; only the message words
+ * are filled in per call */
+static const uint64_t sha512_pad_32[16] = {
+    0, 0, 0, 0, UINT64_C(0x8000000000000000), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 256
+};
+static const uint64_t sha512_pad_64[16] = {
+    0, 0, 0, 0, 0, 0, 0, 0, UINT64_C(0x8000000000000000), 0, 0, 0, 0, 0, 0, 512
+};
+static const uint64_t sha512_pad_96[16] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, UINT64_C(0x8000000000000000), 0, 0, 768
+};
+
+static void sha512_fixed(const uint64_t pad[16], int nwords,
+                         const unsigned char *in, unsigned char out[64]) {
+    uint64_t W[16], state[8];
+    int i;
+
+    memcpy(W, pad, sizeof(W));
+    for (i = 0; i < nwords; i++) {
+        W[i] = load64_be(in + 8 * i);
+    }
+    memcpy(state, sha512_iv, sizeof(state));
+    sha512_resolve()->words(state, W);
+    for (i = 0; i < 8; i++) {
+        store64_be(out + 8 * i, state[i]);
+    }
+}
+
+void sha512_32(const unsigned char in[32], unsigned char out[64]) {
+    sha512_fixed(sha512_pad_32, 4, in, out);
+}
+
+void sha512_64(const unsigned char in[64], unsigned char out[64]) {
+    sha512_fixed(sha512_pad_64, 8, in, out);
+}
+
+void sha512_96(const unsigned char in[96], unsigned char out[64]) {
+    sha512_fixed(sha512_pad_96, 12, in, out);
+}
+
+void sha512_iterate(const unsigned char in[64], uint64_t n, unsigned char out[64]) {
+    uint64_t h[8];
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        h[i] = load64_be(in + 8 * i);
+    }
+    sha512_resolve()->iterate(h, n, sha512_iv);
+    for (i = 0; i < 8; i++) {
+        store64_be(out + 8 * i, h[i]);
+    }
+}
+
+int sha512(const unsigned char *message, size_t message_len, unsigned char *out) {
+    sha512_context ctx;
+    int ret;
+
+    if (out == NULL || (message == NULL && message_len > 0)) return 1;
+    switch (message_len) {
+    case 32: sha512_32(message, out); return 0;
+    case 64: sha512_64(message, out); return 0;
+    case 96: sha512_96(message, out); return 0;
+    default: break;
+    }
+
+    if ((ret = sha512_init(&ctx))) return ret;
+    if ((ret = sha512_update(&ctx, message, message_len))) return ret;
+    if ((ret = sha512_final(&ctx, out))) return ret;
+    return 0;
+}
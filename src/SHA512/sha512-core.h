@@ -0,0 +1,61 @@
+#ifndef SHA512_CORE_H
+#define SHA512_CORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The library's one SHA-512 engine. shsSHA512, the truncated variants,
+ * HMAC/HKDF/PBKDF2 and the Ed25519 code (through src/ed25519/include/sha512.h)
+ * all end up in sha512_blocks(), which picks the fastest compression
+ * backend for the running CPU on first use.
+ */
+
+/* state */
+typedef struct sha512_context_ {
+    uint64_t  length, state[8];
+    size_t curlen;
+    unsigned char buf[128];
+} sha512_context;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int sha512_init(sha512_context * md);
+int sha512_final(sha512_context * md, unsigned char *out);
+int sha512_update(sha512_context * md, const unsigned char *in, size_t inlen);
+int sha512(const unsigned char *message, size_t message_len, unsigned char *out);
+
+/* Truncated variants; update with sha512_update() */
+int sha384_init(sha512_context * md);
+int sha384_final(sha512_context * md, unsigned char *out);
+int sha512_256_init(sha512_context * md);
+int sha512_256_final(sha512_context * md, unsigned char *out);
+
+/* One-shot SHA-512 of exactly 32, 64 or 96 bytes: a single compression on
+ * a precomputed padding block, no context or buffering. sha512() takes
+ * these paths by itself for those lengths. */
+void sha512_32(const unsigned char in[32], unsigned char out[64]);
+void sha512_64(const unsigned char in[64], unsigned char out[64]);
+void sha512_96(const unsigned char in[96], unsigned char out[64]);
+
+/* Hash chain: out = SHA-512 applied n times to the 64-byte in (n = 0 copies).
+ * in and out may alias. */
+void sha512_iterate(const unsigned char in[64], uint64_t n, unsigned char out[64]);
+
+/* Compress nblocks consecutive 128-byte blocks with the selected backend */
+void sha512_blocks(uint64_t state[8], const unsigned char *in, size_t nblocks);
+
+/* Name of the backend sha512_blocks() uses: "bmi2" or "portable" */
+const char *sha512_backend(void);
+
+/* Raw compression for callers that build their own padded blocks */
+extern const uint64_t sha512_K[80];
+void sha512_compress_words(uint64_t state[8], const uint64_t block[16]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,152 @@
+#include <string.h>
+
+#include "sha512-mb.h"
+#include "../cpu-features.h"
+
+#if defined(SHS_X86)
+#include <immintrin.h>
+#endif
+
+/* Portable fallback: run the scalar compression lane by lane */
+static void sha512_x_portable(uint64_t *state, const uint64_t *block, unsigned lanes) {
+    uint64_t S[8], W[16];
+    unsigned lane, i;
+
+    for (lane = 0; lane < lanes; lane++) {
+        for (i = 0; i < 8; i++) S[i] = state[i * lanes + lane];
+        for (i = 0; i < 16; i++) W[i] = block[i * lanes + lane];
+        sha512_compress_words(S, W);
+        for (i = 0; i < 8; i++) state[i * lanes + lane] = S[i];
+    }
+}
+
+#if defined(SHS_X86)
+
+#define MB_ROUNDS(VEC, ADD, XOR, SET1, ROTR, SHR, CH, MAJ)                    \
+    do {                                                                      \
+        VEC a = s[0], b = s[1], c = s[2], d = s[3];                           \
+        VEC e = s[4], f = s[5], g = s[6], h = s[7];                           \
+        int i;                                                                \
+        for (i = 0; i < 80; i++) {                                            \
+            VEC w, t0, t1;                                                    \
+            if (i < 16) {                                                     \
+                w = W[i];                                                     \
+            } else {                                                          \
+                VEC w2 = W[(i - 2) & 15], w15 = W[(i - 15) & 15];             \
+                VEC g1 = XOR(XOR(ROTR(w2, 19), ROTR(w2, 61)), SHR(w2, 6));    \
+                VEC g0 = XOR(XOR(ROTR(w15, 1), ROTR(w15, 8)), SHR(w15, 7));   \
+                w = W[i & 15] = ADD(ADD(g1, W[(i - 7) & 15]),                 \
+                                    ADD(g0, W[i & 15]));                      \
+            }                                                                 \
+            t0 = ADD(ADD(h, XOR(XOR(ROTR(e, 14), ROTR(e, 18)), ROTR(e, 41))), \
+                     ADD(CH(e, f, g), ADD(SET1((long long)sha512_K[i]), w))); \
+            t1 = ADD(XOR(XOR(ROTR(a, 28), ROTR(a, 34)), ROTR(a, 39)),         \
+                     MAJ(a, b, c));                                           \
+            h = g; g = f; f = e; e = ADD(d, t0);                              \
+            d = c; c = b; b = a; a = ADD(t0, t1);                             \
+        }                                                                     \
+        s[0] = ADD(s[0], a); s[1] = ADD(s[1], b);                             \
+        s[2] = ADD(s[2], c); s[3] = ADD(s[3], d);                             \
+        s[4] = ADD(s[4], e); s[5] = ADD(s[5], f);                             \
+        s[6] = ADD(s[6], g); s[7] = ADD(s[7], h);                             \
+    } while ((void)0, 0)
+
+#define AVX2_ROTR(x, n) \
+    _mm256_or_si256(_mm256_srli_epi64((x), (n)), _mm256_slli_epi64((x), 64 - (n)))
+#define AVX2_CH(x, y, z) \
+    _mm256_xor_si256((z), _mm256_and_si256((x), _mm256_xor_si256((y), (z))))
+#define AVX2_MAJ(x, y, z) \
+    _mm256_or_si256(_mm256_and_si256(_mm256_or_si256((x), (y)), (z)), _mm256_and_si256((x), (y)))
+
+SHS_TARGET("avx2")
+static void sha512_x4_avx2(uint64_t state[8][4], const uint64_t block[16][4]) {
+    __m256i s[8], W[16];
+    int j;
+
+    for (j = 0; j < 8; j++) s[j] = _mm256_loadu_si256((const __m256i *)state[j]);
+    for (j = 0; j < 16; j++) W[j] = _mm256_loadu_si256((const __m256i *)block[j]);
+
+    MB_ROUNDS(__m256i, _mm256_add_epi64, _mm256_xor_si256, _mm256_set1_epi64x,
+              AVX2_ROTR, _mm256_srli_epi64, AVX2_CH, AVX2_MAJ);
+
+    for (j = 0; j < 8; j++) _mm256_storeu_si256((__m256i *)state[j], s[j]);
+}
+
+/* Ch and Maj as single vpternlogq: 0xCA = x ? y : z, 0xE8 = majority */
+#define AVX512_CH(x, y, z) _mm512_ternarylogic_epi64((x), (y), (z), 0xCA)
+#define AVX512_MAJ(x, y, z) _mm512_ternarylogic_epi64((x), (y), (z), 0xE8)
+
+SHS_TARGET("avx512f")
+static void sha512_x8_avx512(uint64_t state[8][8], const uint64_t block[16][8]) {
+    __m512i s[8], W[16];
+    int j;
+
+    for (j = 0; j < 8; j++) s[j] = _mm512_loadu_si512((const void *)state[j]);
+    for (j = 0; j < 16; j++) W[j] = _mm512_loadu_si512((const void *)block[j]);
+
+    MB_ROUNDS(__m512i, _mm512_add_epi64, _mm512_xor_si512, _mm512_set1_epi64,
+              _mm512_ror_epi64, _mm512_srli_epi64, AVX512_CH, AVX512_MAJ);
+
+    for (j = 0; j < 8; j++) _mm512_storeu_si512((void *)state[j], s[j]);
+}
+
+#endif /* SHS_X86 */
+
+/* 0 = not probed yet */
+static volatile unsigned sha512_mb_width = 0;
+
+unsigned sha512_mb_lanes(void) {
+    unsigned width = sha512_mb_width;
+    if (width == 0) {
+        width = 1;
+#if defined(SHS_X86)
+        if (shs_cpu_has_avx512f()) {
+            width = 8;
+        } else if (shs_cpu_has_avx2()) {
+            width = 4;
+        }
+#endif
+        sha512_mb_width = width;
+    }
+    return width;
+}
+
+void sha512_compress_words_x4(uint64_t state[8][4], const uint64_t block[16][4]) {
+#if defined(SHS_X86)
+    if (sha512_mb_lanes() >= 4) {
+        sha512_x4_avx2(state, block);
+        return;
+    }
+#endif
+    sha512_x_portable(&state[0][0], &block[0][0], 4);
+}
+
+void sha512_compress_words_x8(uint64_t state[8][8], const uint64_t block[16][8]) {
+#if defined(SHS_X86)
+    unsigned width = sha512_mb_lanes();
+    if (width >= 8) {
+        sha512_x8_avx512(state, block);
+        return;
+    }
+    if (width >= 4) {
+        uint64_t lo_s[8][4], hi_s[8][4], lo_b[16][4], hi_b[16][4];
+        int j;
+        for (j = 0; j < 8; j++) {
+            memcpy(lo_s[j], &state[j][0], sizeof(lo_s[j]));
+            memcpy(hi_s[j], &state[j][4], sizeof(hi_s[j]));
+        }
+        for (j = 0; j < 16; j++) {
+            memcpy(lo_b[j], &block[j][0], sizeof(lo_b[j]));
+            memcpy(hi_b[j], &block[j][4], sizeof(hi_b[j]));
+        }
+        sha512_x4_avx2(lo_s, lo_b);
+        sha512_x4_avx2(hi_s, hi_b);
+        for (j = 0; j < 8; j++) {
+            memcpy(&state[j][0], lo_s[j], sizeof(lo_s[j]));
+            memcpy(&state[j][4], hi_s[j], sizeof(hi_s[j]));
+        }
+        return;
+    }
+#endif
+    sha512_x_portable(&state[0][0], &block[0][0], 8);
+}
@@ -0,0 +1,29 @@
+#ifndef SHA512_MB_H
+#define SHA512_MB_H
+
+#include "sha512.h"
+
+/*
+ * Multi-buffer SHA-512 compression: 4 or 8 independent states advance one
+ * block each per call, one state per SIMD lane. Both states and blocks are
+ * stored transposed (word-major, lane-minor) and blocks are already decoded
+ * big-endian words, so fixed-format callers never touch bytes.
+ */
+
+#define SHA512_MB_MAX_LANES 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Widest kernel the running CPU supports: 8 (AVX-512), 4 (AVX2) or 1 */
+unsigned sha512_mb_lanes(void);
+
+void sha512_compress_words_x4(uint64_t state[8][4], const uint64_t block[16][4]);
+void sha512_compress_words_x8(uint64_t state[8][8], const uint64_t block[16][8]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
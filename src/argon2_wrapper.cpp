@@ -3,6 +3,8 @@
 // Подключаем оригинальный код
 #include "Argon2/argon2.h"
 
+#include <vector>
+
 namespace mylib::crypto::argon2 {
 
 using ::Argon2_Context;
@@ -22,6 +24,28 @@ int hash_argon2d(void* out, size_t outlen,
     return ::hash_argon2d(out, outlen, in, inlen, salt, saltlen, t_cost, m_cost);
 }
 
+int hash_argon2(Type type, void* out, size_t outlen,
+                const void* in, size_t inlen,
+                const void* salt, size_t saltlen,
+                unsigned int t_cost, unsigned int m_cost,
+                unsigned int lanes, unsigned int threads) {
+    // Ядро стирает пароль после предхэширования, поэтому работаем с копией
+    std::vector<uint8_t> pwd(static_cast<const uint8_t*>(in),
+                             static_cast<const uint8_t*>(in) + inlen);
+    Argon2_Context context(static_cast<uint8_t*>(out), (uint32_t) outlen,
+                           pwd.data(), (uint32_t) pwd.size(),
+                           (uint8_t*) salt, (uint32_t) saltlen,
+                           NULL, 0, NULL, 0,
+                           t_cost, m_cost, lanes, threads,
+                           NULL, NULL, true, false, true, false);
+    switch (type) {
+        case Type::i:  return ::Argon2i(&context);
+        case Type::d:  return ::Argon2d(&context);
+        case Type::id: return ::Argon2id(&context);
+    }
+    return ARGON2_INCORRECT_TYPE;
+}
+
 int Argon2i(Argon2_Context* context) {
     return ::Argon2i(context);
 }
@@ -38,6 +62,38 @@ int Argon2ds(Argon2_Context* context) {
     return ::Argon2ds(context);
 }
 
+const char* FillBackend() {
+    return ::Argon2FillBackend();
+}
+
+int SelectFillBackend(const char* name) {
+    return ::Argon2SelectFillBackend(name);
+}
+
+uint32_t PrefetchDistance() {
+    return ::Argon2PrefetchDistance();
+}
+
+int SetPrefetchDistance(uint32_t distance) {
+    return ::Argon2SetPrefetchDistance(distance);
+}
+
+int ArenaAllocate(uint8_t** memory, size_t bytes) {
+    return ::Argon2ArenaAllocate(memory, bytes);
+}
+
+void ArenaFree(uint8_t* memory, size_t bytes) {
+    ::Argon2ArenaFree(memory, bytes);
+}
+
+int ConfigureArena(size_t cache_limit, int pages) {
+    return ::Argon2ArenaConfigure(cache_limit, static_cast<Argon2_arena_pages>(pages));
+}
+
+void TrimArena() {
+    ::Argon2ArenaTrim();
+}
+
 // Ошибки
 const char* ErrorMessage(int error_code) {
     return ::ErrorMessage(error_code);
@@ -0,0 +1,97 @@
+#ifndef SHS_CPU_FEATURES_H
+#define SHS_CPU_FEATURES_H
+
+/*
+ * Runtime CPU feature checks for backend dispatch.
+ *
+ * SIMD kernels are compiled with SHS_TARGET("avx2") etc. so the library
+ * itself needs no -m flags; callers pick a kernel once with the checks
+ * below and fall back to the portable code everywhere else.
+ */
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SHS_X86 1
+#endif
+
+#if defined(SHS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SHS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SHS_TARGET(isa)
+#endif
+
+#if defined(SHS_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(SHS_X86) && defined(_MSC_VER)
+static __inline int shs_cpu_xcr0_has(unsigned long long mask) {
+    int info[4];
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27))) { /* OSXSAVE */
+        return 0;
+    }
+    return (_xgetbv(0) & mask) == mask;
+}
+
+static __inline int shs_cpu_leaf7_ebx(int bit) {
+    int info[4];
+    __cpuidex(info, 7, 0);
+    return (info[1] >> bit) & 1;
+}
+#endif
+
+static __inline int shs_cpu_has_ssse3(void) {
+#if defined(SHS_X86) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("ssse3");
+#elif defined(SHS_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] >> 9) & 1;
+#else
+    return 0;
+#endif
+}
+
+static __inline int shs_cpu_has_sse41(void) {
+#if defined(SHS_X86) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("sse4.1");
+#elif defined(SHS_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] >> 19) & 1;
+#else
+    return 0;
+#endif
+}
+
+static __inline int shs_cpu_has_bmi2(void) {
+#if defined(SHS_X86) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("bmi2");
+#elif defined(SHS_X86) && defined(_MSC_VER)
+    return shs_cpu_leaf7_ebx(8);
+#else
+    return 0;
+#endif
+}
+
+static __inline int shs_cpu_has_avx2(void) {
+#if defined(SHS_X86) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("avx2");
+#elif defined(SHS_X86) && defined(_MSC_VER)
+    return shs_cpu_xcr0_has(0x6) && shs_cpu_leaf7_ebx(5);
+#else
+    return 0;
+#endif
+}
+
+static __inline int shs_cpu_has_avx512f(void) {
+#if defined(SHS_X86) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("avx512f");
+#elif defined(SHS_X86) && defined(_MSC_VER)
+    return shs_cpu_xcr0_has(0xE6) && shs_cpu_leaf7_ebx(16);
+#else
+    return 0;
+#endif
+}
+
+#endif
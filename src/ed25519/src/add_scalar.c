@@ -15,7 +15,6 @@ void ed25519_add_scalar(unsigned char *public_key, unsigned char *private_key, c
     ge_p3 public_key_unpacked;
     ge_cached T;
 
-    sha512_context hash;
     unsigned char hashbuf[64];
 
     int i;
@@ -31,10 +30,11 @@ void ed25519_add_scalar(unsigned char *public_key, unsigned char *private_key, c
         sc_muladd(private_key, SC_1, n, private_key);
 
         // https://github.com/orlp/ed25519/issues/3
-        sha512_init(&hash);
-        sha512_update(&hash, private_key + 32, 32);
-        sha512_update(&hash, scalar, 32);
-        sha512_final(&hash, hashbuf);
+        for (i = 0; i < 32; ++i) {
+            hashbuf[i] = private_key[32 + i];
+            hashbuf[32 + i] = scalar[i];
+        }
+        sha512_64(hashbuf, hashbuf);
         for (i = 0; i < 32; ++i) {
             private_key[32 + i] = hashbuf[i];
         }
@@ -6,7 +6,7 @@
 void ed25519_create_keypair(unsigned char *public_key, unsigned char *private_key, const unsigned char *seed) {
     ge_p3 A;
 
-    sha512(seed, 32, private_key);
+    sha512_32(seed, private_key);
     private_key[0] &= 248;
     private_key[31] &= 63;
     private_key[31] |= 64;
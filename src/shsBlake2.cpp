@@ -1,11 +1,158 @@
 #include "shsBlake2.hpp"
 #include "Blake2/blake2.h"
+#include "Blake2/blake2b-mb.h"
+#include "Blake2/blake2b-compress.h"
+#include "Blake2/blake2-impl.h"
+#include "shsBlake2Tree.hpp"
+#include "shsFileFeed.hpp"
+#include "shsStateBlob.hpp"
+#include "shsThreadPool.hpp"
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
+// `initial` is the state right after init; a key block, if any, is still
+// pending in its buffer. `ready` has that block compressed and is where
+// non-empty messages start. An empty keyed message must finish the key
+// block itself, so it starts from `initial`.
+struct shsBlake2::Template::State {
+    blake2b_state initial;
+    blake2b_state ready;
+
+    ~State() {
+        burn(&initial, sizeof(initial));
+        burn(&ready, sizeof(ready));
+    }
+
+    const blake2b_state& start(size_t length) const {
+        return length == 0 ? initial : ready;
+    }
+};
+
+namespace {
+
+std::shared_ptr<const shsBlake2::Template::State> prepareTemplate(
+        blake2b_param& params, const void* key, size_t key_length) {
+    if (params.digest_length == 0 || params.digest_length > shsBlake2::MAX_OUTPUT_SIZE) {
+        throw std::invalid_argument("Invalid output length");
+    }
+    if (key_length > shsBlake2::MAX_KEY_SIZE) {
+        throw std::invalid_argument("Key too long");
+    }
+    if (key == nullptr && key_length != 0) {
+        throw std::invalid_argument("Input pointer is NULL");
+    }
+    params.key_length = static_cast<uint8_t>(key_length);
+
+    auto state = std::make_shared<shsBlake2::Template::State>();
+    blake2b_init_param(&state->initial, &params);
+    if (key_length > 0) {
+        uint8_t block[BLAKE2B_BLOCKBYTES] = {0};
+        memcpy(block, key, key_length);
+        blake2b_update(&state->initial, block, BLAKE2B_BLOCKBYTES);
+        burn(block, sizeof(block));
+    }
+
+    state->ready = state->initial;
+    if (state->ready.buflen == BLAKE2B_BLOCKBYTES) {
+        state->ready.t[0] += BLAKE2B_BLOCKBYTES;
+        blake2b_compress_x1(&state->ready, state->ready.buf);
+        burn(state->ready.buf, sizeof(state->ready.buf));
+        state->ready.buflen = 0;
+    }
+    return state;
+}
+
+blake2b_param sequentialParams(size_t output_length) {
+    blake2b_param params{};
+    params.digest_length = static_cast<uint8_t>(
+        output_length > shsBlake2::MAX_OUTPUT_SIZE ? 0 : output_length);
+    params.fanout = 1;
+    params.depth = 1;
+    return params;
+}
+
+} // namespace
+
+shsBlake2::Template::Template(size_t output_length)
+    : Template(nullptr, 0, output_length) {}
+
+shsBlake2::Template::Template(const void* key, size_t key_length, size_t output_length) {
+    blake2b_param params = sequentialParams(output_length);
+    state = prepareTemplate(params, key, key_length);
+}
+
+shsBlake2::Template::Template(const std::array<uint8_t, SALT_SIZE>& salt,
+                              const std::array<uint8_t, PERSONAL_SIZE>& personal,
+                              size_t output_length, const void* key, size_t key_length) {
+    blake2b_param params = sequentialParams(output_length);
+    std::copy(salt.begin(), salt.end(), params.salt);
+    std::copy(personal.begin(), personal.end(), params.personal);
+    state = prepareTemplate(params, key, key_length);
+}
+
+size_t shsBlake2::Template::output_length() const {
+    return state->initial.outlen;
+}
+
+void shsBlake2::Template::hash(const void* data, size_t length, uint8_t* out) const {
+    if (data == nullptr && length != 0) {
+        throw std::invalid_argument("Input pointer is NULL");
+    }
+    blake2b_state S = state->start(length);
+    blake2b_update(&S, data, length);
+    blake2b_final(&S, out, S.outlen);
+    burn(&S, sizeof(S));
+}
+
+std::vector<uint8_t> shsBlake2::Template::hash(const void* data, size_t length) const {
+    std::vector<uint8_t> result(output_length());
+    hash(data, length, result.data());
+    return result;
+}
+
 struct shsBlake2::Impl {
     blake2b_state state;
+    std::unique_ptr<blake2bp_state> parallel;  // set in Mode::Parallel
+    std::unique_ptr<shsBlake2Tree> tree;       // set in tree mode
+    std::shared_ptr<const Template::State> prepared;  // set when built from a Template
+
+    // Mode::XOF; root is valid once squeezing starts
+    std::unique_ptr<blake2xb_state> xof;
+    uint8_t root[BLAKE2B_OUTBYTES];
+    bool squeezing = false;
+    uint64_t position = 0;
+
+    uint64_t consumed = 0;  // input bytes passed to update()
+
+    // Built from a Template with nothing hashed since: the key block is
+    // still the last block
+    bool templateUntouched() const {
+        return prepared && state.buflen == 0 && state.t[0] == prepared->ready.t[0];
+    }
+
+    ~Impl() {
+        burn(&state, sizeof(state));
+        if (xof) {
+            burn(xof.get(), sizeof(*xof));
+            burn(root, sizeof(root));
+        }
+    }
 };
 
+namespace {
+
+// XOF reads at least this large are spread over the thread pool
+constexpr size_t XOF_PARALLEL_THRESHOLD = 1 << 20;
+constexpr size_t XOF_PARALLEL_CHUNK = 1 << 18;
+
+uint64_t xofLimit(size_t output_length) {
+    return output_length == shsBlake2::XOF_UNKNOWN_LENGTH
+        ? (uint64_t(1) << 32) * BLAKE2B_OUTBYTES : output_length;
+}
+
+} // namespace
+
 shsBlake2::shsBlake2(size_t output_length) 
     : impl(std::make_unique<Impl>()), output_len(output_length) {
     if (output_length == 0 || output_length > MAX_OUTPUT_SIZE) {
@@ -32,6 +179,51 @@ shsBlake2::shsBlake2(const void* key, size_t key_length, size_t output_length)
 shsBlake2::shsBlake2(const std::vector<uint8_t>& key, size_t output_length)
     : shsBlake2(key.data(), key.size(), output_length) {}
 
+shsBlake2::shsBlake2(Mode mode, size_t output_length)
+    : shsBlake2(mode, nullptr, 0, output_length) {}
+
+shsBlake2::shsBlake2(Mode mode, const void* key, size_t key_length, size_t output_length)
+    : impl(std::make_unique<Impl>()), output_len(output_length) {
+    size_t max_output = mode == Mode::XOF ? XOF_UNKNOWN_LENGTH : MAX_OUTPUT_SIZE;
+    if (output_length == 0 || output_length > max_output) {
+        throw std::invalid_argument("Invalid output length");
+    }
+    if (key_length > MAX_KEY_SIZE) {
+        throw std::invalid_argument("Key too long");
+    }
+    if (mode == Mode::XOF) {
+        impl->xof = std::make_unique<blake2xb_state>();
+        if (blake2xb_init_key(impl->xof.get(), output_length, key, key_length) != 0) {
+            throw std::runtime_error("Failed to initialize BLAKE2Xb");
+        }
+        return;
+    }
+    if (mode == Mode::Sequential) {
+        int ret = key_length > 0
+            ? blake2b_init_key(&impl->state, output_length, key, key_length)
+            : blake2b_init(&impl->state, output_length);
+        if (ret != 0) {
+            throw std::runtime_error("Failed to initialize Blake2b");
+        }
+        return;
+    }
+    impl->parallel = std::make_unique<blake2bp_state>();
+    if (blake2bp_init_key(impl->parallel.get(), output_length, key, key_length) != 0) {
+        throw std::runtime_error("Failed to initialize BLAKE2bp");
+    }
+}
+
+shsBlake2::shsBlake2(const TreeParams& tree, size_t output_length)
+    : impl(std::make_unique<Impl>()), output_len(output_length) {
+    impl->tree = std::make_unique<shsBlake2Tree>(tree, output_length);
+}
+
+shsBlake2::shsBlake2(const Template& prepared)
+    : impl(std::make_unique<Impl>()), output_len(prepared.output_length()) {
+    impl->state = prepared.state->ready;
+    impl->prepared = prepared.state;
+}
+
 shsBlake2::shsBlake2(const std::array<uint8_t, SALT_SIZE>& salt,
                      const std::array<uint8_t, PERSONAL_SIZE>& personal,
                      size_t output_length)
@@ -57,6 +249,30 @@ shsBlake2::shsBlake2(const std::array<uint8_t, SALT_SIZE>& salt,
 shsBlake2::~shsBlake2() = default;
 
 void shsBlake2::update(const void* data, size_t length) {
+    updateState(data, length);
+    impl->consumed += length;
+}
+
+void shsBlake2::updateState(const void* data, size_t length) {
+    if (impl->xof) {
+        if (impl->squeezing) {
+            throw std::runtime_error("Cannot update BLAKE2Xb after squeeze");
+        }
+        if (blake2xb_update(impl->xof.get(), data, length) != 0) {
+            throw std::runtime_error("Failed to update BLAKE2Xb hash");
+        }
+        return;
+    }
+    if (impl->tree) {
+        impl->tree->update(static_cast<const uint8_t*>(data), length);
+        return;
+    }
+    if (impl->parallel) {
+        if (blake2bp_update(impl->parallel.get(), data, length) != 0) {
+            throw std::runtime_error("Failed to update BLAKE2bp hash");
+        }
+        return;
+    }
     if (blake2b_update(&impl->state, data, length) != 0) {
         throw std::runtime_error("Failed to update Blake2b hash");
     }
@@ -71,10 +287,11 @@ void shsBlake2::update(const std::string& data) {
 }
 
 std::vector<uint8_t> shsBlake2::finalize() {
-    std::vector<uint8_t> result(output_len);
-    if (blake2b_final(&impl->state, result.data(), output_len) != 0) {
-        throw std::runtime_error("Failed to finalize Blake2b hash");
+    if (impl->xof && output_len == XOF_UNKNOWN_LENGTH) {
+        throw std::invalid_argument("Unknown-length XOF output must be read with squeeze");
     }
+    std::vector<uint8_t> result(output_len);
+    finalize(result.data(), result.size());
     return result;
 }
 
@@ -82,16 +299,232 @@ void shsBlake2::finalize(void* out, size_t outlen) {
     if (outlen != output_len) {
         throw std::invalid_argument("Output length mismatch");
     }
-    if (blake2b_final(&impl->state, out, outlen) != 0) {
+    if (impl->tree) {
+        impl->tree->finalize(static_cast<uint8_t*>(out));
+        return;
+    }
+    if (impl->xof) {
+        if (output_len == XOF_UNKNOWN_LENGTH) {
+            throw std::invalid_argument("Unknown-length XOF output must be read with squeeze");
+        }
+        readXof(0, static_cast<uint8_t*>(out), outlen);
+        return;
+    }
+    if (impl->templateUntouched()) {
+        impl->state = impl->prepared->initial;
+    }
+    int ret = impl->parallel
+        ? blake2bp_final(impl->parallel.get(), out, outlen)
+        : blake2b_final(&impl->state, out, outlen);
+    if (ret != 0) {
         throw std::runtime_error("Failed to finalize Blake2b hash");
     }
 }
 
+void shsBlake2::readXof(uint64_t offset, uint8_t* out, size_t length) {
+    if (!impl->squeezing) {
+        if (blake2xb_root(impl->xof.get(), impl->root) != 0) {
+            throw std::runtime_error("Failed to finalize BLAKE2Xb root");
+        }
+        impl->squeezing = true;
+    }
+    if (offset > xofLimit(output_len) || length > xofLimit(output_len) - offset) {
+        throw std::invalid_argument("Read past the end of the XOF output");
+    }
+
+    const blake2xb_state* state = impl->xof.get();
+    const uint8_t* root = impl->root;
+    auto& pool = shsThreadPool::shared();
+    if (length < XOF_PARALLEL_THRESHOLD) {
+        if (blake2xb_output(state, root, offset, out, length) != 0) {
+            throw std::runtime_error("Failed to compute BLAKE2Xb output");
+        }
+        return;
+    }
+    size_t chunks = (length + XOF_PARALLEL_CHUNK - 1) / XOF_PARALLEL_CHUNK;
+    pool.parallelFor(chunks, [&](size_t i) {
+        size_t begin = i * XOF_PARALLEL_CHUNK;
+        size_t len = std::min(XOF_PARALLEL_CHUNK, length - begin);
+        if (blake2xb_output(state, root, offset + begin, out + begin, len) != 0) {
+            throw std::runtime_error("Failed to compute BLAKE2Xb output");
+        }
+    });
+}
+
+void shsBlake2::squeeze(void* out, size_t length) {
+    if (!impl->xof) {
+        throw std::runtime_error("squeeze() requires Mode::XOF");
+    }
+    readXof(impl->position, static_cast<uint8_t*>(out), length);
+    impl->position += length;
+}
+
+std::vector<uint8_t> shsBlake2::squeeze(size_t length) {
+    std::vector<uint8_t> result(length);
+    squeeze(result.data(), length);
+    return result;
+}
+
+void shsBlake2::seek(uint64_t offset) {
+    if (!impl->xof) {
+        throw std::runtime_error("seek() requires Mode::XOF");
+    }
+    if (offset > xofLimit(output_len)) {
+        throw std::invalid_argument("Seek past the end of the XOF output");
+    }
+    impl->position = offset;
+}
+
+
+namespace {
+
+using shs_state_blob::Kind;
+
+void writeState(shs_state_blob::Writer& out, const blake2b_state& S) {
+    for (uint64_t word : S.h) out.u64(word);
+    for (uint64_t word : S.t) out.u64(word);
+    for (uint64_t word : S.f) out.u64(word);
+    out.bytes(S.buf, sizeof(S.buf));
+    out.u32(S.buflen);
+    out.u32(S.outlen);
+    out.u8(S.last_node);
+}
+
+void readState(shs_state_blob::Reader& in, blake2b_state& S) {
+    for (uint64_t& word : S.h) word = in.u64();
+    for (uint64_t& word : S.t) word = in.u64();
+    for (uint64_t& word : S.f) word = in.u64();
+    in.bytes(S.buf, sizeof(S.buf));
+    S.buflen = in.u32();
+    S.outlen = in.u32();
+    S.last_node = in.u8();
+    // A finalized state cannot take more input
+    if (S.buflen > BLAKE2B_BLOCKBYTES || S.outlen == 0 || S.outlen > BLAKE2B_OUTBYTES ||
+        S.f[0] != 0) {
+        throw std::invalid_argument("Corrupt Blake2b state");
+    }
+}
+
+void writeParam(shs_state_blob::Writer& out, const blake2b_param& P) {
+    out.u8(P.digest_length);
+    out.u8(P.key_length);
+    out.u8(P.fanout);
+    out.u8(P.depth);
+    out.u32(P.leaf_length);
+    out.u64(P.node_offset);
+    out.u8(P.node_depth);
+    out.u8(P.inner_length);
+    out.bytes(P.reserved, sizeof(P.reserved));
+    out.bytes(P.salt, sizeof(P.salt));
+    out.bytes(P.personal, sizeof(P.personal));
+}
+
+void readParam(shs_state_blob::Reader& in, blake2b_param& P) {
+    P.digest_length = in.u8();
+    P.key_length = in.u8();
+    P.fanout = in.u8();
+    P.depth = in.u8();
+    P.leaf_length = in.u32();
+    P.node_offset = in.u64();
+    P.node_depth = in.u8();
+    P.inner_length = in.u8();
+    in.bytes(P.reserved, sizeof(P.reserved));
+    in.bytes(P.salt, sizeof(P.salt));
+    in.bytes(P.personal, sizeof(P.personal));
+}
+
+} // namespace
+
+std::vector<uint8_t> shsBlake2::export_state(const void* mac_key, size_t mac_key_length) const {
+    if (impl->tree) {
+        throw std::runtime_error("State export is not supported in tree mode");
+    }
+    shs_state_blob::Writer out;
+    out.u64(output_len);
+    if (impl->xof) {
+        if (impl->squeezing) {
+            throw std::runtime_error("Cannot export BLAKE2Xb state after squeeze");
+        }
+        writeState(out, impl->xof->S);
+        writeParam(out, impl->xof->P);
+        return out.seal(Kind::Blake2Xb, impl->consumed, mac_key, mac_key_length);
+    }
+    if (impl->parallel) {
+        const blake2bp_state& S = *impl->parallel;
+        for (const blake2b_state& leaf : S.S) writeState(out, leaf);
+        writeState(out, S.R);
+        out.bytes(S.buf, sizeof(S.buf));
+        out.u64(S.buflen);
+        out.u64(S.outlen);
+        return out.seal(Kind::Blake2bp, impl->consumed, mac_key, mac_key_length);
+    }
+    // The importer has no Template, so hand it the state finalize() would use
+    writeState(out, impl->templateUntouched() ? impl->prepared->initial : impl->state);
+    return out.seal(Kind::Blake2b, impl->consumed, mac_key, mac_key_length);
+}
+
+std::vector<uint8_t> shsBlake2::export_state(const std::vector<uint8_t>& mac_key) const {
+    return export_state(mac_key.data(), mac_key.size());
+}
+
+uint64_t shsBlake2::import_state(const void* blob, size_t blob_length,
+                                 const void* mac_key, size_t mac_key_length) {
+    shs_state_blob::Reader in(blob, blob_length, mac_key, mac_key_length);
+    auto restored = std::make_unique<Impl>();
+    uint64_t output_length = in.u64();
+
+    switch (in.kind()) {
+    case Kind::Blake2b:
+        readState(in, restored->state);
+        if (output_length != restored->state.outlen) {
+            throw std::invalid_argument("Corrupt Blake2b state");
+        }
+        break;
+    case Kind::Blake2bp: {
+        restored->parallel = std::make_unique<blake2bp_state>();
+        blake2bp_state& S = *restored->parallel;
+        for (blake2b_state& leaf : S.S) readState(in, leaf);
+        readState(in, S.R);
+        in.bytes(S.buf, sizeof(S.buf));
+        S.buflen = static_cast<size_t>(in.u64());
+        S.outlen = static_cast<size_t>(in.u64());
+        if (S.buflen > sizeof(S.buf) || S.outlen != output_length || output_length == 0 ||
+            output_length > MAX_OUTPUT_SIZE) {
+            throw std::invalid_argument("Corrupt BLAKE2bp state");
+        }
+        break;
+    }
+    case Kind::Blake2Xb:
+        restored->xof = std::make_unique<blake2xb_state>();
+        readState(in, restored->xof->S);
+        readParam(in, restored->xof->P);
+        if (output_length == 0 || output_length > XOF_UNKNOWN_LENGTH) {
+            throw std::invalid_argument("Corrupt BLAKE2Xb state");
+        }
+        break;
+    default:
+        throw std::invalid_argument("State blob does not hold a Blake2 state");
+    }
+    in.finish();
+
+    restored->consumed = in.inputOffset();
+    impl = std::move(restored);
+    output_len = static_cast<size_t>(output_length);
+    return impl->consumed;
+}
+
+uint64_t shsBlake2::import_state(const std::vector<uint8_t>& blob,
+                                 const std::vector<uint8_t>& mac_key) {
+    return import_state(blob.data(), blob.size(), mac_key.data(), mac_key.size());
+}
 
 std::vector<uint8_t> shsBlake2::hash(const void* data, size_t length, size_t output_length) {
-    shsBlake2 hasher(output_length);
-    hasher.update(data, length);
-    return hasher.finalize();
+    if (output_length == 0 || output_length > MAX_OUTPUT_SIZE) {
+        throw std::invalid_argument("Invalid output length");
+    }
+    std::vector<uint8_t> result(output_length);
+    hash_into(data, length, result.data(), output_length);
+    return result;
 }
 
 std::vector<uint8_t> shsBlake2::hash(const std::vector<uint8_t>& data, size_t output_length) {
@@ -102,6 +535,21 @@ std::vector<uint8_t> shsBlake2::hash(const std::string& data, size_t output_leng
     return hash(data.data(), data.size(), output_length);
 }
 
+void shsBlake2::hash_into(const void* data, size_t length, uint8_t* out, size_t output_length) {
+    if (output_length == 0 || output_length > MAX_OUTPUT_SIZE) {
+        throw std::invalid_argument("Invalid output length");
+    }
+    if ((data == nullptr && length != 0) || out == nullptr) {
+        throw std::invalid_argument("Input pointer is NULL");
+    }
+    int ret = length <= BLOCK_SIZE
+        ? blake2b_oneblock(out, output_length, data, length)
+        : blake2b(out, output_length, data, length, nullptr, 0);
+    if (ret != 0) {
+        throw std::runtime_error("Failed to compute Blake2b hash");
+    }
+}
+
 std::vector<uint8_t> shsBlake2::hash_keyed(const void* data, size_t length, 
                                           const void* key, size_t key_length,
                                           size_t output_length) {
@@ -116,6 +564,97 @@ std::vector<uint8_t> shsBlake2::hash_keyed(const std::vector<uint8_t>& data,
     return hash_keyed(data.data(), data.size(), key.data(), key.size(), output_length);
 }
 
+std::vector<uint8_t> shsBlake2::hash_parallel(const void* data, size_t length, size_t output_length) {
+    if (output_length == 0 || output_length > MAX_OUTPUT_SIZE) {
+        throw std::invalid_argument("Invalid output length");
+    }
+    std::vector<uint8_t> result(output_length);
+    if (blake2bp(result.data(), output_length, data, length, nullptr, 0) != 0) {
+        throw std::runtime_error("Failed to compute BLAKE2bp hash");
+    }
+    return result;
+}
+
+std::vector<uint8_t> shsBlake2::hash_parallel(const std::vector<uint8_t>& data, size_t output_length) {
+    return hash_parallel(data.data(), data.size(), output_length);
+}
+
+std::vector<uint8_t> shsBlake2::hash_parallel(const std::string& data, size_t output_length) {
+    return hash_parallel(data.data(), data.size(), output_length);
+}
+
+void shsBlake2::hash_batch(const BatchMessage* messages, size_t count, uint8_t* out) {
+    std::vector<blake2b_mb_msg> msgs(count);
+    for (size_t i = 0; i < count; ++i) {
+        const BatchMessage& m = messages[i];
+        if (m.output_length == 0 || m.output_length > MAX_OUTPUT_SIZE) {
+            throw std::invalid_argument("Invalid output length");
+        }
+        if (m.key_length > MAX_KEY_SIZE) {
+            throw std::invalid_argument("Key too long");
+        }
+        if ((m.data == nullptr && m.length != 0) || (m.key == nullptr && m.key_length != 0)) {
+            throw std::invalid_argument("Input pointer is NULL");
+        }
+        msgs[i] = {m.data, m.length, m.key, m.key_length, m.output_length, nullptr};
+    }
+    if (count > 0 && blake2b_mb(msgs.data(), count, out) != 0) {
+        throw std::runtime_error("Failed to compute Blake2b batch");
+    }
+}
+
+void shsBlake2::hash_batch(const std::vector<BatchMessage>& messages, uint8_t* out) {
+    hash_batch(messages.data(), messages.size(), out);
+}
+
+void shsBlake2::hash_batch(const Template& prepared, const void* const* data,
+                           const size_t* lengths, size_t count, uint8_t* out) {
+    const size_t outlen = prepared.output_length();
+    std::vector<blake2b_mb_msg> msgs(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (data[i] == nullptr && lengths[i] != 0) {
+            throw std::invalid_argument("Input pointer is NULL");
+        }
+        msgs[i].in = data[i];
+        msgs[i].inlen = lengths[i];
+        msgs[i].outlen = outlen;
+        msgs[i].start = &prepared.state->start(lengths[i]);
+    }
+    if (count > 0 && blake2b_mb(msgs.data(), count, out) != 0) {
+        throw std::runtime_error("Failed to compute Blake2b batch");
+    }
+}
+
+size_t shsBlake2::batch_lanes() {
+    return blake2b_mb_lanes();
+}
+
+std::vector<uint8_t> shsBlake2::hash_tree(const void* data, size_t length,
+                                          const TreeParams& tree, size_t output_length) {
+    shsBlake2 hasher(tree, output_length);
+    hasher.update(data, length);
+    return hasher.finalize();
+}
+
+std::vector<uint8_t> shsBlake2::hash_tree(const std::vector<uint8_t>& data,
+                                          const TreeParams& tree, size_t output_length) {
+    return hash_tree(data.data(), data.size(), tree, output_length);
+}
+
+std::vector<uint8_t> shsBlake2::hash_xof(const void* data, size_t length, size_t output_length,
+                                         const void* key, size_t key_length) {
+    if (output_length == XOF_UNKNOWN_LENGTH) {
+        throw std::invalid_argument("Invalid output length");
+    }
+    shsBlake2 hasher(Mode::XOF, key, key_length, output_length);
+    hasher.update(data, length);
+    return hasher.finalize();
+}
+
+std::vector<uint8_t> shsBlake2::hash_xof(const std::vector<uint8_t>& data, size_t output_length) {
+    return hash_xof(data.data(), data.size(), output_length);
+}
+
 std::vector<uint8_t> shsBlake2::hash_long(const void* data, size_t length, size_t output_length) {
     std::vector<uint8_t> result(output_length);
     if (blake2b_long(result.data(), output_length, data, length) != 0) {
@@ -130,4 +669,44 @@ std::vector<uint8_t> shsBlake2::hash_long(const std::vector<uint8_t>& data, size
 
 std::vector<uint8_t> shsBlake2::hash_long(const std::string& data, size_t output_length) {
     return hash_long(data.data(), data.size(), output_length);
-}
\ No newline at end of file
+}
+
+namespace {
+
+shsBlake2::FileResult finishFile(shsBlake2& hasher, const shs_file_feed::Stats& stats) {
+    shsBlake2::FileResult result;
+    result.digest = hasher.finalize();
+    result.bytes = stats.bytes;
+    result.seconds = stats.seconds;
+    result.bytes_per_second = stats.bytesPerSecond();
+    return result;
+}
+
+} // namespace
+
+shsBlake2::FileResult shsBlake2::hash_file(const std::string& path, size_t output_length) {
+    shsBlake2 hasher(output_length);
+    auto stats = shs_file_feed::feedPath(path, [&](const uint8_t* data, size_t length) {
+        hasher.update(data, length);
+    });
+    return finishFile(hasher, stats);
+}
+
+shsBlake2::FileResult shsBlake2::hash_file(int fd, size_t output_length) {
+    shsBlake2 hasher(output_length);
+    auto stats = shs_file_feed::feedDescriptor(fd, [&](const uint8_t* data, size_t length) {
+        hasher.update(data, length);
+    });
+    return finishFile(hasher, stats);
+}
+
+shsBlake2::FileResult shsBlake2::hash_file(const std::string& path, const TreeParams& tree,
+                                           size_t output_length) {
+    shsBlake2 hasher(tree, output_length);
+    // Map windows as large as a batch of leaves so they are hashed in place
+    size_t window = std::max(shs_file_feed::MMAP_WINDOW, hasher.impl->tree->preferredChunk());
+    auto stats = shs_file_feed::feedPath(path, [&](const uint8_t* data, size_t length) {
+        hasher.update(data, length);
+    }, window);
+    return finishFile(hasher, stats);
+}
@@ -0,0 +1,501 @@
+#include "shsBlake2Merkle.hpp"
+#include "shsThreadPool.hpp"
+#include "Blake2/blake2.h"
+#include "Blake2/blake2b-mb.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr size_t HASH_SIZE = shsBlake2Merkle::HASH_SIZE;
+constexpr size_t PARENT_SIZE = shsBlake2Merkle::PARENT_SIZE;
+constexpr size_t HEADER_SIZE = shsBlake2Merkle::HEADER_SIZE;
+
+// Bytes of chunks per pool task while building, and parents per task on
+// the upper levels
+constexpr size_t TASK_BYTES = size_t(1) << 18;
+constexpr size_t PARENTS_PER_TASK = 4096;
+
+constexpr char PERSONAL[] = "ShS-Merkle-v1";
+
+uint64_t loadLength(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+void storeLength(uint8_t* p, uint64_t v) {
+    for (size_t i = 0; i < HEADER_SIZE; ++i) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+// Chunks are leaves at node depth 0 and offset = chunk index, parents sit
+// at node depth 1 whatever their height; the tree is unbalanced, so the
+// depth field only separates the two kinds. The root is the one node
+// hashed with the last-node flag, and its salt carries the input length.
+blake2b_param nodeParams(size_t chunk_size, uint64_t offset, uint8_t depth) {
+    blake2b_param P{};
+    P.digest_length = HASH_SIZE;
+    P.fanout = 2;
+    P.depth = 255;
+    P.leaf_length = static_cast<uint32_t>(chunk_size);
+    P.node_offset = offset;
+    P.node_depth = depth;
+    P.inner_length = HASH_SIZE;
+    std::memcpy(P.personal, PERSONAL, sizeof(PERSONAL) - 1);
+    return P;
+}
+
+blake2b_state initState(const blake2b_param& P) {
+    blake2b_state S;
+    blake2b_init_param(&S, &P);
+    return S;
+}
+
+blake2b_state nodeState(size_t chunk_size, uint64_t offset, uint8_t depth) {
+    return initState(nodeParams(chunk_size, offset, depth));
+}
+
+// Every slice passes through the root, so binding the length here
+// authenticates the header even when the slice stops short of the last chunk
+blake2b_state rootState(size_t chunk_size, uint8_t depth, uint64_t content_length) {
+    blake2b_param P = nodeParams(chunk_size, 0, depth);
+    storeLength(P.salt, content_length);
+    return initState(P);
+}
+
+void finishNode(blake2b_state S, const uint8_t* data, size_t length, bool root, uint8_t* out) {
+    S.last_node = root ? 1 : 0;
+    if (blake2b_update(&S, data, length) != 0 || blake2b_final(&S, out, HASH_SIZE) != 0) {
+        throw std::runtime_error("Failed to compute Merkle node hash");
+    }
+}
+
+bool sameHash(const uint8_t* a, const uint8_t* b) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < HASH_SIZE; ++i) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+uint64_t chunkCount(uint64_t length, size_t chunk_size) {
+    return std::max<uint64_t>(1, length / chunk_size + (length % chunk_size != 0));
+}
+
+uint64_t chunkLength(uint64_t index, uint64_t length, size_t chunk_size) {
+    uint64_t begin = index * chunk_size;
+    return begin >= length ? 0 : std::min<uint64_t>(chunk_size, length - begin);
+}
+
+// Chunks in the left child of a parent over `count` chunks (count >= 2)
+uint64_t leftCount(uint64_t count) {
+    uint64_t left = 1;
+    while (left * 2 < count) {
+        left *= 2;
+    }
+    return left;
+}
+
+unsigned ceilLog2(uint64_t n) {
+    unsigned k = 0;
+    while ((uint64_t(1) << k) < n) {
+        ++k;
+    }
+    return k;
+}
+
+// Bytes a subtree occupies in an encoding, parents first
+uint64_t subtreeSize(uint64_t first, uint64_t count, uint64_t length,
+                     size_t chunk_size, bool with_chunks) {
+    uint64_t size = (count - 1) * PARENT_SIZE;
+    if (with_chunks) {
+        uint64_t begin = std::min(first * chunk_size, length);
+        uint64_t end = std::min((first + count) * chunk_size, length);
+        size += end - begin;
+    }
+    return size;
+}
+
+// Chunks [first, last] a slice of [start, start + length) has to carry
+void chunkRange(uint64_t total, size_t chunk_size, uint64_t start, uint64_t length,
+                uint64_t& first, uint64_t& last) {
+    if (total == 0) {
+        first = last = 0;
+        return;
+    }
+    uint64_t begin = std::min(start, total - 1);
+    uint64_t end = begin;
+    if (start < total && length > 0) {
+        end = start + std::min(length, total - start) - 1;
+    }
+    first = begin / chunk_size;
+    last = end / chunk_size;
+}
+
+} // namespace
+
+// levels[k] holds the hashes of the subtrees covering 2^k chunks, the last
+// one possibly fewer. The top level has the root's two children.
+struct shsBlake2Merkle::Tree {
+    std::vector<std::vector<uint8_t>> levels;
+    Hash root;
+
+    const uint8_t* node(uint64_t first, uint64_t count) const {
+        unsigned k = ceilLog2(count);
+        return levels[k].data() + (first >> k) * HASH_SIZE;
+    }
+};
+
+shsBlake2Merkle::shsBlake2Merkle(size_t chunk_size, size_t threads)
+    : chunk_len(chunk_size), threads(threads) {
+    if (chunk_size < MIN_CHUNK_SIZE || chunk_size > MAX_CHUNK_SIZE ||
+        (chunk_size & (chunk_size - 1)) != 0) {
+        throw std::invalid_argument("Merkle chunk size must be a power of two between 1 KiB and 16 MiB");
+    }
+}
+
+shsBlake2Merkle::Tree shsBlake2Merkle::build(const uint8_t* data, uint64_t length) const {
+    Tree tree;
+    uint64_t chunks = chunkCount(length, chunk_len);
+    if (chunks == 1) {
+        finishNode(rootState(chunk_len, 0, length), data, length, true, tree.root.data());
+        return tree;
+    }
+
+    // Leaves go through the multi-buffer kernel, each with its own offset
+    std::vector<uint8_t> leaves(chunks * HASH_SIZE);
+    size_t per_task = std::max<size_t>(1, TASK_BYTES / chunk_len);
+    size_t tasks = (chunks + per_task - 1) / per_task;
+    shsThreadPool::shared().parallelFor(tasks, [&](size_t t) {
+        uint64_t begin = t * per_task;
+        size_t n = static_cast<size_t>(std::min<uint64_t>(per_task, chunks - begin));
+        std::vector<blake2b_state> starts(n);
+        std::vector<blake2b_mb_msg> msgs(n);
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t index = begin + i;
+            starts[i] = nodeState(chunk_len, index, 0);
+            msgs[i] = {data + index * chunk_len, chunkLength(index, length, chunk_len),
+                       nullptr, 0, HASH_SIZE, &starts[i]};
+        }
+        if (blake2b_mb(msgs.data(), n, leaves.data() + begin * HASH_SIZE) != 0) {
+            throw std::runtime_error("Failed to compute Merkle leaf hashes");
+        }
+    }, threads);
+    tree.levels.push_back(std::move(leaves));
+
+    // Pair up each level, carrying an odd last node up unchanged, until only
+    // the root's children are left
+    const blake2b_state parent = nodeState(chunk_len, 0, 1);
+    while (tree.levels.back().size() > PARENT_SIZE) {
+        const std::vector<uint8_t>& below = tree.levels.back();
+        size_t nodes = below.size() / HASH_SIZE;
+        size_t pairs = nodes / 2;
+        std::vector<uint8_t> level((pairs + nodes % 2) * HASH_SIZE);
+        size_t level_tasks = (pairs + PARENTS_PER_TASK - 1) / PARENTS_PER_TASK;
+        shsThreadPool::shared().parallelFor(level_tasks, [&](size_t t) {
+            size_t begin = t * PARENTS_PER_TASK;
+            size_t n = std::min(PARENTS_PER_TASK, pairs - begin);
+            std::vector<blake2b_mb_msg> msgs(n);
+            for (size_t i = 0; i < n; ++i) {
+                msgs[i] = {below.data() + (begin + i) * PARENT_SIZE, PARENT_SIZE,
+                           nullptr, 0, HASH_SIZE, &parent};
+            }
+            if (blake2b_mb(msgs.data(), n, level.data() + begin * HASH_SIZE) != 0) {
+                throw std::runtime_error("Failed to compute Merkle parent hashes");
+            }
+        }, threads);
+        if (nodes % 2 != 0) {
+            std::memcpy(level.data() + pairs * HASH_SIZE, below.data() + pairs * PARENT_SIZE, HASH_SIZE);
+        }
+        tree.levels.push_back(std::move(level));
+    }
+    finishNode(rootState(chunk_len, 1, length), tree.levels.back().data(), PARENT_SIZE,
+               true, tree.root.data());
+    return tree;
+}
+
+std::vector<uint8_t> shsBlake2Merkle::serialize(const Tree& tree, const uint8_t* data,
+                                                uint64_t length, bool with_chunks) const {
+    uint64_t chunks = chunkCount(length, chunk_len);
+    std::vector<uint8_t> out(HEADER_SIZE + subtreeSize(0, chunks, length, chunk_len, with_chunks));
+    storeLength(out.data(), length);
+    uint8_t* p = out.data() + HEADER_SIZE;
+
+    // Pre-order walk: a parent's hashes, then its left and right subtrees
+    std::vector<std::pair<uint64_t, uint64_t>> todo{{0, chunks}};
+    while (!todo.empty()) {
+        uint64_t first = todo.back().first;
+        uint64_t count = todo.back().second;
+        todo.pop_back();
+        if (count == 1) {
+            if (with_chunks) {
+                size_t n = chunkLength(first, length, chunk_len);
+                if (n > 0) {
+                    std::memcpy(p, data + first * chunk_len, n);
+                }
+                p += n;
+            }
+            continue;
+        }
+        uint64_t left = leftCount(count);
+        std::memcpy(p, tree.node(first, left), HASH_SIZE);
+        std::memcpy(p + HASH_SIZE, tree.node(first + left, count - left), HASH_SIZE);
+        p += PARENT_SIZE;
+        todo.emplace_back(first + left, count - left);
+        todo.emplace_back(first, left);
+    }
+    return out;
+}
+
+shsBlake2Merkle::Hash shsBlake2Merkle::root(const void* data, size_t length) const {
+    return build(static_cast<const uint8_t*>(data), length).root;
+}
+
+shsBlake2Merkle::Encoded shsBlake2Merkle::encode(const void* data, size_t length) const {
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    Tree tree = build(in, length);
+    return {tree.root, serialize(tree, in, length, true)};
+}
+
+shsBlake2Merkle::Encoded shsBlake2Merkle::outboard(const void* data, size_t length) const {
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    Tree tree = build(in, length);
+    return {tree.root, serialize(tree, in, length, false)};
+}
+
+std::vector<uint8_t> shsBlake2Merkle::slice(const uint8_t* encoded, size_t encoded_length,
+                                            const uint8_t* data, uint64_t start,
+                                            uint64_t length) const {
+    if (encoded_length < HEADER_SIZE) {
+        throw std::invalid_argument("Merkle encoding is missing its header");
+    }
+    uint64_t total = loadLength(encoded);
+    uint64_t chunks = chunkCount(total, chunk_len);
+    bool with_chunks = data == nullptr;
+    if (chunks - 1 > (encoded_length - HEADER_SIZE) / PARENT_SIZE ||
+        HEADER_SIZE + subtreeSize(0, chunks, total, chunk_len, with_chunks) > encoded_length) {
+        throw std::invalid_argument("Merkle encoding is truncated");
+    }
+
+    uint64_t first_chunk, last_chunk;
+    chunkRange(total, chunk_len, start, length, first_chunk, last_chunk);
+    auto wanted = [&](uint64_t first, uint64_t count) {
+        return first <= last_chunk && first + count > first_chunk;
+    };
+
+    std::vector<uint8_t> out(encoded, encoded + HEADER_SIZE);
+    struct Pending {
+        uint64_t first;
+        uint64_t count;
+        uint64_t offset;
+    };
+    std::vector<Pending> todo{{0, chunks, HEADER_SIZE}};
+    while (!todo.empty()) {
+        Pending node = todo.back();
+        todo.pop_back();
+        if (node.count == 1) {
+            size_t n = chunkLength(node.first, total, chunk_len);
+            const uint8_t* src = with_chunks ? encoded + node.offset : data + node.first * chunk_len;
+            out.insert(out.end(), src, src + n);
+            continue;
+        }
+        out.insert(out.end(), encoded + node.offset, encoded + node.offset + PARENT_SIZE);
+        uint64_t left = leftCount(node.count);
+        uint64_t left_offset = node.offset + PARENT_SIZE;
+        uint64_t right_offset = left_offset + subtreeSize(node.first, left, total, chunk_len, with_chunks);
+        if (wanted(node.first + left, node.count - left)) {
+            todo.push_back({node.first + left, node.count - left, right_offset});
+        }
+        if (wanted(node.first, left)) {
+            todo.push_back({node.first, left, left_offset});
+        }
+    }
+    return out;
+}
+
+std::vector<uint8_t> shsBlake2Merkle::extract_slice(const void* encoded, size_t encoded_length,
+                                                    uint64_t start, uint64_t length) const {
+    return slice(static_cast<const uint8_t*>(encoded), encoded_length, nullptr, start, length);
+}
+
+std::vector<uint8_t> shsBlake2Merkle::extract_slice(const void* outboard, size_t outboard_length,
+                                                    const void* data, size_t data_length,
+                                                    uint64_t start, uint64_t length) const {
+    const uint8_t* ob = static_cast<const uint8_t*>(outboard);
+    if (outboard_length < HEADER_SIZE || loadLength(ob) != data_length) {
+        throw std::invalid_argument("Outboard encoding does not match the data length");
+    }
+    // A zero-length input has no bytes to point at
+    static const uint8_t empty = 0;
+    const uint8_t* in = data_length == 0 ? &empty : static_cast<const uint8_t*>(data);
+    return slice(ob, outboard_length, in, start, length);
+}
+
+std::vector<uint8_t> shsBlake2Merkle::decode_slice(const void* slice_data, size_t slice_length,
+                                                   const Hash& root_hash, uint64_t start,
+                                                   uint64_t length) const {
+    SliceDecoder decoder(*this, root_hash, start, length);
+    std::vector<uint8_t> out;
+    decoder.update(slice_data, slice_length, out);
+    if (!decoder.finished()) {
+        throw std::runtime_error("Merkle slice is truncated");
+    }
+    return out;
+}
+
+std::vector<uint8_t> shsBlake2Merkle::decode(const void* encoded, size_t encoded_length,
+                                             const Hash& root_hash) const {
+    return decode_slice(encoded, encoded_length, root_hash, 0, UINT64_MAX);
+}
+
+
+shsBlake2Merkle::SliceDecoder::SliceDecoder(const shsBlake2Merkle& tree, const Hash& root,
+                                            uint64_t start, uint64_t length)
+    : chunk_size(tree.chunk_len), threads(tree.threads), root_hash(root),
+      start(start), length(length) {}
+
+bool shsBlake2Merkle::SliceDecoder::finished() const {
+    return have_header && stack.empty();
+}
+
+void shsBlake2Merkle::SliceDecoder::begin(uint64_t content_length) {
+    // The length is not trusted until the root verifies, which is the first
+    // node after the header
+    total = content_length;
+    chunkRange(total, chunk_size, start, length, first_chunk, last_chunk);
+    stack.push_back({0, chunkCount(total, chunk_size), root_hash, true});
+    have_header = true;
+}
+
+void shsBlake2Merkle::SliceDecoder::update(const void* data, size_t data_length,
+                                           std::vector<uint8_t>& out) {
+    // Whole slices handed over at once are parsed in place; only an
+    // incomplete node at the end is kept for the next call
+    const uint8_t* buf = static_cast<const uint8_t*>(data);
+    size_t avail = data_length;
+    bool buffered = !pending.empty();
+    if (buffered) {
+        pending.insert(pending.end(), buf, buf + data_length);
+        buf = pending.data();
+        avail = pending.size();
+    }
+    auto keep = [&](size_t consumed) {
+        if (buffered) {
+            pending.erase(pending.begin(), pending.begin() + consumed);
+        } else {
+            pending.assign(buf + consumed, buf + avail);
+        }
+    };
+
+    size_t pos = 0;
+    if (!have_header) {
+        if (avail < HEADER_SIZE) {
+            keep(0);
+            return;
+        }
+        begin(loadLength(buf));
+        pos = HEADER_SIZE;
+    }
+
+    // Parents are checked on arrival since they decide what comes next;
+    // the chunks that arrived are collected and checked together below
+    struct Chunk {
+        size_t pos;
+        size_t size;
+        uint64_t index;
+        Hash expected;
+        bool root;
+    };
+    std::vector<Chunk> chunks;
+    while (!stack.empty()) {
+        Node node = stack.back();
+        if (node.count == 1) {
+            size_t n = chunkLength(node.first, total, chunk_size);
+            if (avail - pos < n) {
+                break;
+            }
+            chunks.push_back({pos, n, node.first, node.expected, node.root});
+            stack.pop_back();
+            pos += n;
+            continue;
+        }
+        if (avail - pos < PARENT_SIZE) {
+            break;
+        }
+        Hash actual;
+        finishNode(node.root ? rootState(chunk_size, 1, total) : nodeState(chunk_size, 0, 1),
+                   buf + pos, PARENT_SIZE, node.root, actual.data());
+        if (!sameHash(actual.data(), node.expected.data())) {
+            throw std::runtime_error("Merkle parent hash mismatch");
+        }
+        stack.pop_back();
+
+        uint64_t left = leftCount(node.count);
+        Node l{node.first, left, {}, false};
+        Node r{node.first + left, node.count - left, {}, false};
+        std::memcpy(l.expected.data(), buf + pos, HASH_SIZE);
+        std::memcpy(r.expected.data(), buf + pos + HASH_SIZE, HASH_SIZE);
+        pos += PARENT_SIZE;
+        if (r.first <= last_chunk) {
+            stack.push_back(r);
+        }
+        if (l.first + l.count > first_chunk) {
+            stack.push_back(l);
+        }
+    }
+
+    std::vector<uint8_t> valid(chunks.size());
+    if (chunks.size() == 1 && chunks[0].root) {
+        Hash actual;
+        finishNode(rootState(chunk_size, 0, total), buf + chunks[0].pos, chunks[0].size,
+                   true, actual.data());
+        valid[0] = sameHash(actual.data(), chunks[0].expected.data());
+    } else if (!chunks.empty()) {
+        size_t per_task = std::max<size_t>(1, TASK_BYTES / chunk_size);
+        size_t tasks = (chunks.size() + per_task - 1) / per_task;
+        shsThreadPool::shared().parallelFor(tasks, [&](size_t t) {
+            size_t begin = t * per_task;
+            size_t n = std::min(per_task, chunks.size() - begin);
+            std::vector<blake2b_state> starts(n);
+            std::vector<blake2b_mb_msg> msgs(n);
+            std::vector<uint8_t> actual(n * HASH_SIZE);
+            for (size_t i = 0; i < n; ++i) {
+                const Chunk& c = chunks[begin + i];
+                starts[i] = nodeState(chunk_size, c.index, 0);
+                msgs[i] = {buf + c.pos, c.size, nullptr, 0, HASH_SIZE, &starts[i]};
+            }
+            if (blake2b_mb(msgs.data(), n, actual.data()) != 0) {
+                throw std::runtime_error("Failed to compute Merkle leaf hashes");
+            }
+            for (size_t i = 0; i < n; ++i) {
+                valid[begin + i] = sameHash(actual.data() + i * HASH_SIZE,
+                                            chunks[begin + i].expected.data());
+            }
+        }, threads);
+    }
+
+    uint64_t range_end = start < total ? start + std::min(length, total - start) : start;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (!valid[i]) {
+            throw std::runtime_error("Merkle chunk hash mismatch");
+        }
+        uint64_t begin = chunks[i].index * chunk_size;
+        uint64_t from = std::max(begin, start);
+        uint64_t to = std::min(begin + chunks[i].size, range_end);
+        if (from < to) {
+            const uint8_t* p = buf + chunks[i].pos + (from - begin);
+            out.insert(out.end(), p, p + (to - from));
+        }
+    }
+
+    if (stack.empty() && pos < avail) {
+        throw std::runtime_error("Unexpected data after the Merkle slice");
+    }
+    keep(pos);
+}
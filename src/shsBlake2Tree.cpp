@@ -0,0 +1,144 @@
+#include "shsBlake2Tree.hpp"
+#include "shsThreadPool.hpp"
+#include "Blake2/blake2.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Leaves handed to the pool at once per worker; a few per thread keeps
+// the pool busy when leaves finish unevenly
+constexpr size_t LEAVES_PER_THREAD = 4;
+
+// Cap on the copy buffer used for small or misaligned updates
+constexpr size_t MAX_BUFFER = size_t(1) << 28;
+
+} // namespace
+
+shsBlake2Tree::shsBlake2Tree(const shsBlake2::TreeParams& tree_params, size_t output_length)
+    : params(tree_params), output_len(output_length) {
+    if (output_length == 0 || output_length > shsBlake2::MAX_OUTPUT_SIZE) {
+        throw std::invalid_argument("Invalid output length");
+    }
+    if (params.leaf_length == 0) {
+        throw std::invalid_argument("Tree leaf length must be non-zero");
+    }
+    if (params.fanout == 1) {
+        throw std::invalid_argument("Tree fanout must be 0 or at least 2");
+    }
+    if (params.max_depth < 2) {
+        throw std::invalid_argument("Tree depth must be at least 2");
+    }
+
+    size_t pool = shsThreadPool::shared().concurrency();
+    threads = params.threads == 0 ? pool : std::min(params.threads, pool);
+    size_t batch = std::max<size_t>(1, MAX_BUFFER / params.leaf_length);
+    batch = std::min(batch, threads * LEAVES_PER_THREAD);
+    capacity = batch * params.leaf_length;
+}
+
+void shsBlake2Tree::hashNode(const uint8_t* data, size_t length, uint64_t offset,
+                             uint8_t depth, bool last, uint8_t* out, size_t outlen) const {
+    blake2b_param P{};
+    P.digest_length = static_cast<uint8_t>(outlen);
+    P.fanout = params.fanout;
+    P.depth = params.max_depth;
+    P.leaf_length = params.leaf_length;
+    P.node_offset = offset;
+    P.node_depth = depth;
+    P.inner_length = INNER_LENGTH;
+
+    blake2b_state S;
+    blake2b_init_param(&S, &P);
+    S.last_node = last ? 1 : 0;
+    if (blake2b_update(&S, data, length) != 0 || blake2b_final(&S, out, outlen) != 0) {
+        throw std::runtime_error("Failed to compute Blake2b tree node");
+    }
+}
+
+void shsBlake2Tree::hashLeaves(const std::vector<const uint8_t*>& leaves) {
+    // Only called for leaves known to be followed by more input
+    uint64_t first = digests.size() / INNER_LENGTH;
+    digests.resize(digests.size() + leaves.size() * INNER_LENGTH);
+    uint8_t* out = digests.data() + first * INNER_LENGTH;
+    shsThreadPool::shared().parallelFor(leaves.size(), [&](size_t i) {
+        hashNode(leaves[i], params.leaf_length, first + i, 0, false,
+                 out + i * INNER_LENGTH, INNER_LENGTH);
+    }, threads);
+}
+
+void shsBlake2Tree::update(const uint8_t* data, size_t length) {
+    const size_t L = params.leaf_length;
+
+    // Complete a partial leaf left over from the previous call
+    if (buffer.size() % L != 0 && length > 0) {
+        size_t take = std::min(L - buffer.size() % L, length);
+        buffer.insert(buffer.end(), data, data + take);
+        data += take;
+        length -= take;
+    }
+    if (length == 0) {
+        return;
+    }
+
+    // Everything buffered is now whole leaves with input after them. Input
+    // leaves qualify while at least one byte follows them, since the last
+    // leaf of the message must be hashed with the last-node flag.
+    size_t direct = (length - 1) / L;
+    if (buffer.size() / L + direct >= capacity / L || buffer.size() + length > capacity) {
+        std::vector<const uint8_t*> leaves;
+        leaves.reserve(buffer.size() / L + direct);
+        for (size_t pos = 0; pos < buffer.size(); pos += L) {
+            leaves.push_back(buffer.data() + pos);
+        }
+        for (size_t i = 0; i < direct; ++i) {
+            leaves.push_back(data + i * L);
+        }
+        hashLeaves(leaves);
+        buffer.clear();
+        data += direct * L;
+        length -= direct * L;
+    }
+    buffer.insert(buffer.end(), data, data + length);
+}
+
+void shsBlake2Tree::finalize(uint8_t* out) {
+    const size_t L = params.leaf_length;
+
+    // Remaining leaves; an empty message still has one empty leaf
+    size_t tail = std::max<size_t>(1, (buffer.size() + L - 1) / L);
+    uint64_t first = digests.size() / INNER_LENGTH;
+    digests.resize(digests.size() + tail * INNER_LENGTH);
+    shsThreadPool::shared().parallelFor(tail, [&](size_t i) {
+        size_t begin = i * L;
+        size_t len = std::min(L, buffer.size() - std::min(begin, buffer.size()));
+        hashNode(buffer.data() + begin, len, first + i, 0, i + 1 == tail,
+                 digests.data() + (first + i) * INNER_LENGTH, INNER_LENGTH);
+    }, threads);
+
+    std::vector<uint8_t> level = std::move(digests);
+    std::vector<uint8_t> next;
+    for (uint8_t depth = 1;; ++depth) {
+        size_t children = level.size() / INNER_LENGTH;
+        size_t fanout = params.fanout;
+        if (fanout == 0 || depth + 1 == params.max_depth) {
+            fanout = children;
+        }
+        size_t nodes = (children + fanout - 1) / fanout;
+        if (nodes == 1) {
+            hashNode(level.data(), level.size(), 0, depth, true, out, output_len);
+            break;
+        }
+        next.resize(nodes * INNER_LENGTH);
+        shsThreadPool::shared().parallelFor(nodes, [&](size_t j) {
+            size_t begin = j * fanout * INNER_LENGTH;
+            size_t len = std::min(fanout * INNER_LENGTH, level.size() - begin);
+            hashNode(level.data() + begin, len, j, depth, j + 1 == nodes,
+                     next.data() + j * INNER_LENGTH, INNER_LENGTH);
+        }, threads);
+        level.swap(next);
+    }
+
+    buffer.clear();
+    digests.clear();
+}
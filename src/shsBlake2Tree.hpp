@@ -0,0 +1,40 @@
+#ifndef SHS_BLAKE2_TREE_HPP
+#define SHS_BLAKE2_TREE_HPP
+
+#include "shsBlake2.hpp"
+#include <cstdint>
+#include <vector>
+
+// Blake2b tree mode. Input is cut into leaf_length leaves (node_depth 0,
+// node_offset = leaf index) that are hashed on the shared thread pool.
+// Each following level hashes the concatenated 64-byte digests of up to
+// `fanout` children (all of them when fanout is 0 or the level is the last
+// one max_depth allows) until a single root remains. The rightmost node of
+// every level carries the last-node flag. Inner nodes output inner_length =
+// 64 bytes, the root outputs the requested length.
+class shsBlake2Tree {
+public:
+    static constexpr size_t INNER_LENGTH = 64;
+
+    shsBlake2Tree(const shsBlake2::TreeParams& params, size_t output_length);
+
+    void update(const uint8_t* data, size_t length);
+    void finalize(uint8_t* out);
+
+    // Bytes per update that let whole batches be hashed without copying
+    size_t preferredChunk() const { return capacity; }
+
+private:
+    void hashLeaves(const std::vector<const uint8_t*>& leaves);
+    void hashNode(const uint8_t* data, size_t length, uint64_t offset, uint8_t depth,
+                  bool last, uint8_t* out, size_t outlen) const;
+
+    shsBlake2::TreeParams params;
+    size_t output_len;
+    size_t threads;
+    size_t capacity;               // buffer limit, a whole number of leaves
+    std::vector<uint8_t> buffer;   // input not yet hashed
+    std::vector<uint8_t> digests;  // leaf digests, INNER_LENGTH each
+};
+
+#endif // SHS_BLAKE2_TREE_HPP
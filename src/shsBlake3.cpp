@@ -0,0 +1,223 @@
+#include "shsBlake3.hpp"
+#include "Blake3/blake3.h"
+#include "Blake2/blake2-impl.h"
+#include "shsFileFeed.hpp"
+#include "shsThreadPool.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+struct shsBlake3::Impl {
+    blake3_hasher hasher;
+    bool squeezing = false;
+    uint64_t position = 0;
+
+    ~Impl() {
+        burn(&hasher, sizeof(hasher));
+    }
+};
+
+namespace {
+
+// Mapped file window; each one is split into 64 KiB tasks across the pool
+constexpr size_t FILE_WINDOW = 1 << 24;
+
+struct PoolLoop {
+    shsThreadPool& pool;
+    size_t threads;
+};
+
+void poolParallelFor(void* ctx, size_t count, void (*body)(void*, size_t), void* arg) {
+    auto* loop = static_cast<PoolLoop*>(ctx);
+    loop->pool.parallelFor(count, [&](size_t i) { body(arg, i); }, loop->threads);
+}
+
+void checkOutputLength(size_t output_length) {
+    if (output_length == 0) {
+        throw std::invalid_argument("Invalid output length");
+    }
+}
+
+} // namespace
+
+shsBlake3::shsBlake3(size_t output_length)
+    : impl(std::make_unique<Impl>()), output_len(output_length) {
+    checkOutputLength(output_length);
+    blake3_hasher_init(&impl->hasher);
+}
+
+shsBlake3::shsBlake3(const std::array<uint8_t, KEY_SIZE>& key, size_t output_length)
+    : shsBlake3(key.data(), key.size(), output_length) {}
+
+shsBlake3::shsBlake3(const void* key, size_t key_length, size_t output_length)
+    : impl(std::make_unique<Impl>()), output_len(output_length) {
+    checkOutputLength(output_length);
+    if (key == nullptr || key_length != KEY_SIZE) {
+        throw std::invalid_argument("BLAKE3 key must be 32 bytes");
+    }
+    blake3_hasher_init_keyed(&impl->hasher, static_cast<const uint8_t*>(key));
+}
+
+shsBlake3::shsBlake3(const std::vector<uint8_t>& key, size_t output_length)
+    : shsBlake3(key.data(), key.size(), output_length) {}
+
+shsBlake3::shsBlake3(const DeriveKeyContext& derive, size_t output_length)
+    : impl(std::make_unique<Impl>()), output_len(output_length) {
+    checkOutputLength(output_length);
+    blake3_hasher_init_derive_key_raw(&impl->hasher, derive.context.data(),
+                                      derive.context.size());
+}
+
+shsBlake3::~shsBlake3() = default;
+
+void shsBlake3::update(const void* data, size_t length) {
+    if (impl->squeezing) {
+        throw std::runtime_error("Cannot update BLAKE3 after squeeze");
+    }
+    if (data == nullptr && length != 0) {
+        throw std::invalid_argument("Input pointer is NULL");
+    }
+    blake3_hasher_update(&impl->hasher, data, length);
+}
+
+void shsBlake3::update(const std::vector<uint8_t>& data) {
+    update(data.data(), data.size());
+}
+
+void shsBlake3::update(const std::string& data) {
+    update(data.data(), data.size());
+}
+
+void shsBlake3::update_parallel(const void* data, size_t length, size_t threads) {
+    if (impl->squeezing) {
+        throw std::runtime_error("Cannot update BLAKE3 after squeeze");
+    }
+    if (data == nullptr && length != 0) {
+        throw std::invalid_argument("Input pointer is NULL");
+    }
+    PoolLoop loop{shsThreadPool::shared(), threads};
+    blake3_hasher_update_parallel(&impl->hasher, data, length, poolParallelFor, &loop);
+}
+
+std::vector<uint8_t> shsBlake3::finalize() {
+    std::vector<uint8_t> result(output_len);
+    finalize(result.data(), result.size());
+    return result;
+}
+
+void shsBlake3::finalize(void* out, size_t outlen) {
+    if (outlen != output_len) {
+        throw std::invalid_argument("Output length mismatch");
+    }
+    blake3_hasher_finalize(&impl->hasher, static_cast<uint8_t*>(out), outlen);
+}
+
+void shsBlake3::squeeze(void* out, size_t length) {
+    if (out == nullptr && length != 0) {
+        throw std::invalid_argument("Output pointer is NULL");
+    }
+    impl->squeezing = true;
+    blake3_hasher_finalize_seek(&impl->hasher, impl->position, static_cast<uint8_t*>(out),
+                                length);
+    impl->position += length;
+}
+
+std::vector<uint8_t> shsBlake3::squeeze(size_t length) {
+    std::vector<uint8_t> result(length);
+    squeeze(result.data(), length);
+    return result;
+}
+
+void shsBlake3::seek(uint64_t offset) {
+    impl->position = offset;
+}
+
+
+std::vector<uint8_t> shsBlake3::hash(const void* data, size_t length, size_t output_length) {
+    shsBlake3 hasher(output_length);
+    hasher.update(data, length);
+    return hasher.finalize();
+}
+
+std::vector<uint8_t> shsBlake3::hash(const std::vector<uint8_t>& data, size_t output_length) {
+    return hash(data.data(), data.size(), output_length);
+}
+
+std::vector<uint8_t> shsBlake3::hash(const std::string& data, size_t output_length) {
+    return hash(data.data(), data.size(), output_length);
+}
+
+std::vector<uint8_t> shsBlake3::hash_keyed(const void* data, size_t length,
+                                           const void* key, size_t key_length,
+                                           size_t output_length) {
+    shsBlake3 hasher(key, key_length, output_length);
+    hasher.update(data, length);
+    return hasher.finalize();
+}
+
+std::vector<uint8_t> shsBlake3::hash_keyed(const std::vector<uint8_t>& data,
+                                           const std::vector<uint8_t>& key,
+                                           size_t output_length) {
+    return hash_keyed(data.data(), data.size(), key.data(), key.size(), output_length);
+}
+
+std::vector<uint8_t> shsBlake3::derive_key(const std::string& context, const void* material,
+                                           size_t length, size_t output_length) {
+    shsBlake3 hasher(DeriveKeyContext{context}, output_length);
+    hasher.update(material, length);
+    return hasher.finalize();
+}
+
+std::vector<uint8_t> shsBlake3::derive_key(const std::string& context,
+                                           const std::vector<uint8_t>& material,
+                                           size_t output_length) {
+    return derive_key(context, material.data(), material.size(), output_length);
+}
+
+std::vector<uint8_t> shsBlake3::hash_parallel(const void* data, size_t length,
+                                              size_t output_length) {
+    shsBlake3 hasher(output_length);
+    hasher.update_parallel(data, length);
+    return hasher.finalize();
+}
+
+std::vector<uint8_t> shsBlake3::hash_parallel(const std::vector<uint8_t>& data,
+                                              size_t output_length) {
+    return hash_parallel(data.data(), data.size(), output_length);
+}
+
+std::vector<uint8_t> shsBlake3::hash_parallel(const std::string& data, size_t output_length) {
+    return hash_parallel(data.data(), data.size(), output_length);
+}
+
+namespace {
+
+shsBlake3::FileResult finishFile(shsBlake3& hasher, const shs_file_feed::Stats& stats) {
+    shsBlake3::FileResult result;
+    result.digest = hasher.finalize();
+    result.bytes = stats.bytes;
+    result.seconds = stats.seconds;
+    result.bytes_per_second = stats.bytesPerSecond();
+    return result;
+}
+
+} // namespace
+
+shsBlake3::FileResult shsBlake3::hash_file(const std::string& path, size_t output_length) {
+    shsBlake3 hasher(output_length);
+    auto stats = shs_file_feed::feedPath(path, [&](const uint8_t* data, size_t length) {
+        hasher.update_parallel(data, length);
+    }, FILE_WINDOW);
+    return finishFile(hasher, stats);
+}
+
+shsBlake3::FileResult shsBlake3::hash_file(int fd, size_t output_length) {
+    shsBlake3 hasher(output_length);
+    auto stats = shs_file_feed::feedDescriptor(fd, [&](const uint8_t* data, size_t length) {
+        hasher.update_parallel(data, length);
+    }, FILE_WINDOW);
+    return finishFile(hasher, stats);
+}
+
+const char* shsBlake3::backend() {
+    return blake3_backend();
+}
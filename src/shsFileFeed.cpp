@@ -0,0 +1,252 @@
+#include "shsFileFeed.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace shs_file_feed {
+
+namespace {
+
+std::runtime_error ioError(const char* what) {
+    return std::runtime_error(std::string(what) + ": " + std::strerror(errno));
+}
+
+#ifdef _WIN32
+
+uint64_t feedRead(int fd, const Sink& sink) {
+    std::vector<uint8_t> buffer(BUFFER_SIZE);
+    uint64_t total = 0;
+    for (;;) {
+        int n = _read(fd, buffer.data(), static_cast<unsigned>(buffer.size()));
+        if (n < 0) throw ioError("Failed to read file");
+        if (n == 0) break;
+        sink(buffer.data(), static_cast<size_t>(n));
+        total += static_cast<uint64_t>(n);
+    }
+    return total;
+}
+
+uint64_t feed(int fd, const Sink& sink, size_t /*window*/) {
+    return feedRead(fd, sink);
+}
+
+#else
+
+// read()/pread() wrapper that retries on EINTR; offset < 0 means read()
+ssize_t readSome(int fd, uint8_t* buf, size_t len, off_t offset) {
+    for (;;) {
+        ssize_t n = offset < 0 ? ::read(fd, buf, len) : ::pread(fd, buf, len, offset);
+        if (n >= 0 || errno != EINTR) return n;
+    }
+}
+
+// Small regular files: one buffer, no helper thread
+uint64_t feedSequential(int fd, off_t offset, const Sink& sink) {
+    std::vector<uint8_t> buffer(BUFFER_SIZE);
+    uint64_t total = 0;
+    for (;;) {
+        ssize_t n = readSome(fd, buffer.data(), buffer.size(), offset);
+        if (n < 0) throw ioError("Failed to read file");
+        if (n == 0) break;
+        sink(buffer.data(), static_cast<size_t>(n));
+        total += static_cast<uint64_t>(n);
+        if (offset >= 0) offset += n;
+    }
+    if (offset >= 0) ::lseek(fd, offset, SEEK_SET);
+    return total;
+}
+
+// Reader thread fills one buffer while the caller hashes the other
+uint64_t feedDoubleBuffered(int fd, off_t offset, const Sink& sink) {
+    struct Slot {
+        std::vector<uint8_t> data = std::vector<uint8_t>(BUFFER_SIZE);
+        size_t length = 0;
+        bool full = false;
+    };
+    Slot slots[2];
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    bool cancelled = false;
+    int read_errno = 0;
+
+    std::thread reader([&]() {
+        off_t pos = offset;
+        for (size_t i = 0;; i ^= 1) {
+            Slot& slot = slots[i];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return !slot.full || cancelled; });
+                if (cancelled) return;
+            }
+            // Fill the whole buffer unless EOF: pipes return short reads
+            size_t filled = 0;
+            ssize_t n = 1;
+            while (filled < slot.data.size()) {
+                n = readSome(fd, slot.data.data() + filled, slot.data.size() - filled, pos);
+                if (n <= 0) break;
+                filled += static_cast<size_t>(n);
+                if (pos >= 0) pos += n;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (n < 0) read_errno = errno;
+            slot.length = filled;
+            slot.full = filled > 0;
+            if (n <= 0) {
+                done = true;
+                if (pos >= 0) ::lseek(fd, pos, SEEK_SET);
+            }
+            cv.notify_all();
+            if (done) return;
+        }
+    });
+
+    uint64_t total = 0;
+    try {
+        for (size_t i = 0;; i ^= 1) {
+            Slot& slot = slots[i];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return slot.full || done; });
+                if (!slot.full) break;
+            }
+            sink(slot.data.data(), slot.length);
+            total += slot.length;
+            std::lock_guard<std::mutex> lock(mutex);
+            slot.full = false;
+            cv.notify_all();
+        }
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelled = true;
+        }
+        cv.notify_all();
+        reader.join();
+        throw;
+    }
+    reader.join();
+
+    if (read_errno != 0) {
+        errno = read_errno;
+        throw ioError("Failed to read file");
+    }
+    return total;
+}
+
+uint64_t feedMapped(int fd, off_t offset, off_t end, const Sink& sink, size_t window) {
+    const size_t length = static_cast<size_t>(end - offset);
+    const off_t page = static_cast<off_t>(::sysconf(_SC_PAGESIZE));
+    const off_t map_offset = offset - offset % page;
+    const size_t skip = static_cast<size_t>(offset - map_offset);
+
+    void* map = ::mmap(nullptr, length + skip, PROT_READ, MAP_PRIVATE, fd, map_offset);
+    if (map == MAP_FAILED) {
+        return feedDoubleBuffered(fd, offset, sink);
+    }
+    ::madvise(map, length + skip, MADV_SEQUENTIAL);
+
+    // Hash in windows and ask for the next one ahead of time so page faults
+    // overlap with compression instead of stalling it
+    const uint8_t* base = static_cast<const uint8_t*>(map);
+    try {
+        for (size_t pos = 0; pos < length + skip; pos += window) {
+            size_t next = pos + window;
+            if (next < length + skip) {
+                ::madvise(const_cast<uint8_t*>(base) + next,
+                          std::min(window, length + skip - next), MADV_WILLNEED);
+            }
+            size_t begin = pos < skip ? skip : pos;
+            size_t end = std::min(next, length + skip);
+            if (end > begin) sink(base + begin, end - begin);
+        }
+    } catch (...) {
+        ::munmap(map, length + skip);
+        throw;
+    }
+    ::munmap(map, length + skip);
+    ::lseek(fd, end, SEEK_SET);
+    return length;
+}
+
+uint64_t feed(int fd, const Sink& sink, size_t window) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0) throw ioError("Failed to stat file");
+
+    if (S_ISREG(st.st_mode)) {
+        off_t offset = ::lseek(fd, 0, SEEK_CUR);
+        if (offset < 0) throw ioError("Failed to query file offset");
+        if (offset >= st.st_size) return 0;
+        if (static_cast<uint64_t>(st.st_size - offset) >= MMAP_THRESHOLD) {
+            return feedMapped(fd, offset, st.st_size, sink, window);
+        }
+        return feedSequential(fd, offset, sink);
+    }
+    return feedDoubleBuffered(fd, -1, sink);
+}
+
+#endif
+
+template <typename F>
+Stats timed(F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    Stats stats;
+    stats.bytes = body();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+} // namespace
+
+Stats feedPath(const std::string& path, const Sink& sink, size_t window) {
+#ifdef _WIN32
+    int fd = ::_open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    try {
+        Stats stats = timed([&] { return feed(fd, sink, window); });
+#ifdef _WIN32
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+        return stats;
+    } catch (...) {
+#ifdef _WIN32
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+        throw;
+    }
+}
+
+Stats feedDescriptor(int fd, const Sink& sink, size_t window) {
+    if (fd < 0) {
+        throw std::invalid_argument("Invalid file descriptor");
+    }
+    return timed([&] { return feed(fd, sink, window); });
+}
+
+} // namespace shs_file_feed
@@ -0,0 +1,41 @@
+#ifndef SHS_FILE_FEED_HPP
+#define SHS_FILE_FEED_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+// Streams a file into a hash update function without staging it in user
+// buffers. Regular files above MMAP_THRESHOLD are memory-mapped and passed
+// to the sink straight from the page cache; pipes, sockets and anything
+// that cannot be mapped are read with two buffers so the next read runs
+// while the current one is being hashed.
+namespace shs_file_feed {
+
+constexpr size_t MMAP_THRESHOLD = 1 << 20;
+constexpr size_t BUFFER_SIZE = 1 << 18;
+constexpr size_t MMAP_WINDOW = 1 << 22;
+
+struct Stats {
+    uint64_t bytes = 0;
+    double seconds = 0.0;
+
+    double bytesPerSecond() const {
+        return seconds > 0.0 ? static_cast<double>(bytes) / seconds : 0.0;
+    }
+};
+
+using Sink = std::function<void(const uint8_t* data, size_t length)>;
+
+// Throws std::runtime_error if the file cannot be opened or read. Mapped
+// files reach the sink in chunks of `window` bytes.
+Stats feedPath(const std::string& path, const Sink& sink, size_t window = MMAP_WINDOW);
+
+// Reads from the current offset of fd to end of file. The descriptor is not
+// closed; for seekable files its offset is left at end of file.
+Stats feedDescriptor(int fd, const Sink& sink, size_t window = MMAP_WINDOW);
+
+} // namespace shs_file_feed
+
+#endif // SHS_FILE_FEED_HPP
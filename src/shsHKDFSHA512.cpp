@@ -0,0 +1,161 @@
+#include "shsHKDFSHA512.hpp"
+#include "hmac-sha512.h"
+#include <stdexcept>
+#include <cstring>
+
+namespace {
+
+void checkLength(size_t out_length) {
+    if (out_length > shsHKDFSHA512::MAX_OUTPUT_SIZE) {
+        throw std::invalid_argument("HKDF output too long");
+    }
+}
+
+void extractKey(hmac_sha512_key* prk_key, const uint8_t* salt, size_t salt_length,
+                const uint8_t* ikm, size_t ikm_length) {
+    // RFC 5869: a missing salt is HashLen zero bytes, which HMAC pads to the same key
+    hmac_sha512_key salt_key;
+    uint8_t prk[shsHKDFSHA512::HASH_SIZE];
+
+    hmac_sha512_setkey(&salt_key, salt, salt_length);
+    hmac_sha512(&salt_key, ikm, ikm_length, prk);
+    hmac_sha512_setkey(prk_key, prk, sizeof(prk));
+
+    hmac_sha512_wipe(prk, sizeof(prk));
+    hmac_sha512_wipe(&salt_key, sizeof(salt_key));
+}
+
+// T(i) = HMAC(PRK, T(i-1) || info || i); full blocks land in out directly
+void expandKey(const hmac_sha512_key* prk_key, const uint8_t* info, size_t info_length,
+               uint8_t* out, size_t out_length) {
+    const size_t hash_size = shsHKDFSHA512::HASH_SIZE;
+    uint8_t block[shsHKDFSHA512::HASH_SIZE];
+    const uint8_t* prev = nullptr;
+    sha512_context md;
+
+    for (uint8_t counter = 1; out_length > 0; ++counter) {
+        hmac_sha512_init(&md, prk_key);
+        if (prev != nullptr) {
+            sha512_update(&md, prev, hash_size);
+        }
+        if (info_length != 0) {
+            sha512_update(&md, info, info_length);
+        }
+        sha512_update(&md, &counter, 1);
+
+        if (out_length >= hash_size) {
+            hmac_sha512_final(&md, prk_key, out);
+            prev = out;
+            out += hash_size;
+            out_length -= hash_size;
+        } else {
+            hmac_sha512_final(&md, prk_key, block);
+            memcpy(out, block, out_length);
+            out_length = 0;
+        }
+    }
+    hmac_sha512_wipe(block, sizeof(block));
+}
+
+} // namespace
+
+struct shsHKDFSHA512::Impl {
+    hmac_sha512_key prk;
+
+    ~Impl() {
+        hmac_sha512_wipe(&prk, sizeof(prk));
+    }
+};
+
+shsHKDFSHA512::shsHKDFSHA512(const uint8_t* prk, size_t prk_length)
+    : impl(std::make_unique<Impl>()) {
+    if (prk == nullptr && prk_length != 0) {
+        throw std::invalid_argument("PRK pointer is NULL");
+    }
+    hmac_sha512_setkey(&impl->prk, prk, prk_length);
+}
+
+shsHKDFSHA512::shsHKDFSHA512(const std::vector<uint8_t>& prk)
+    : shsHKDFSHA512(prk.data(), prk.size()) {}
+
+shsHKDFSHA512::shsHKDFSHA512(const uint8_t* salt, size_t salt_length,
+                             const uint8_t* ikm, size_t ikm_length)
+    : impl(std::make_unique<Impl>()) {
+    if ((salt == nullptr && salt_length != 0) || (ikm == nullptr && ikm_length != 0)) {
+        throw std::invalid_argument("Input pointer is NULL");
+    }
+    extractKey(&impl->prk, salt, salt_length, ikm, ikm_length);
+}
+
+shsHKDFSHA512::shsHKDFSHA512(const std::vector<uint8_t>& salt, const std::vector<uint8_t>& ikm)
+    : shsHKDFSHA512(salt.data(), salt.size(), ikm.data(), ikm.size()) {}
+
+shsHKDFSHA512::~shsHKDFSHA512() = default;
+
+void shsHKDFSHA512::expand(const uint8_t* info, size_t info_length,
+                           uint8_t* out, size_t out_length) const {
+    checkLength(out_length);
+    expandKey(&impl->prk, info, info_length, out, out_length);
+}
+
+std::vector<uint8_t> shsHKDFSHA512::expand(const std::vector<uint8_t>& info, size_t length) const {
+    std::vector<uint8_t> result(length);
+    expand(info.data(), info.size(), result.data(), length);
+    return result;
+}
+
+std::vector<uint8_t> shsHKDFSHA512::expand(const std::string& info, size_t length) const {
+    std::vector<uint8_t> result(length);
+    expand(reinterpret_cast<const uint8_t*>(info.data()), info.size(), result.data(), length);
+    return result;
+}
+
+void shsHKDFSHA512::expand_many(const Label* labels, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+        checkLength(labels[i].out_length);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        expandKey(&impl->prk, labels[i].info, labels[i].info_length,
+                  labels[i].out, labels[i].out_length);
+    }
+}
+
+std::array<uint8_t, 64> shsHKDFSHA512::extract(const uint8_t* salt, size_t salt_length,
+                                               const uint8_t* ikm, size_t ikm_length) {
+    hmac_sha512_key salt_key;
+    std::array<uint8_t, 64> prk;
+    hmac_sha512_setkey(&salt_key, salt, salt_length);
+    hmac_sha512(&salt_key, ikm, ikm_length, prk.data());
+    hmac_sha512_wipe(&salt_key, sizeof(salt_key));
+    return prk;
+}
+
+std::array<uint8_t, 64> shsHKDFSHA512::extract(const std::vector<uint8_t>& salt,
+                                               const std::vector<uint8_t>& ikm) {
+    return extract(salt.data(), salt.size(), ikm.data(), ikm.size());
+}
+
+std::vector<uint8_t> shsHKDFSHA512::derive(const std::vector<uint8_t>& salt,
+                                           const std::vector<uint8_t>& ikm,
+                                           const std::vector<uint8_t>& info,
+                                           size_t length) {
+    std::vector<uint8_t> result(length);
+    Label label = {info.data(), info.size(), result.data(), length};
+    derive_many(salt.data(), salt.size(), ikm.data(), ikm.size(), &label, 1);
+    return result;
+}
+
+void shsHKDFSHA512::derive_many(const uint8_t* salt, size_t salt_length,
+                                const uint8_t* ikm, size_t ikm_length,
+                                const Label* labels, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        checkLength(labels[i].out_length);
+    }
+    hmac_sha512_key prk_key;
+    extractKey(&prk_key, salt, salt_length, ikm, ikm_length);
+    for (size_t i = 0; i < count; ++i) {
+        expandKey(&prk_key, labels[i].info, labels[i].info_length,
+                  labels[i].out, labels[i].out_length);
+    }
+    hmac_sha512_wipe(&prk_key, sizeof(prk_key));
+}
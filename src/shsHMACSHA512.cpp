@@ -0,0 +1,126 @@
+#include "shsHMACSHA512.hpp"
+#include "hmac-sha512.h"
+#include <stdexcept>
+
+struct shsHMACSHA512::Impl {
+    hmac_sha512_key key;
+    sha512_context stream;
+
+    ~Impl() {
+        hmac_sha512_wipe(&key, sizeof(key));
+        hmac_sha512_wipe(&stream, sizeof(stream));
+    }
+};
+
+shsHMACSHA512::shsHMACSHA512(const uint8_t* key, size_t key_length)
+    : impl(std::make_unique<Impl>()) {
+    if (key == nullptr && key_length != 0) {
+        throw std::invalid_argument("Key pointer is NULL");
+    }
+    hmac_sha512_setkey(&impl->key, key, key_length);
+    hmac_sha512_init(&impl->stream, &impl->key);
+}
+
+shsHMACSHA512::shsHMACSHA512(const std::vector<uint8_t>& key)
+    : shsHMACSHA512(key.data(), key.size()) {}
+
+shsHMACSHA512::shsHMACSHA512(const std::string& key)
+    : shsHMACSHA512(reinterpret_cast<const uint8_t*>(key.data()), key.size()) {}
+
+shsHMACSHA512::~shsHMACSHA512() = default;
+
+void shsHMACSHA512::update(const uint8_t* data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    sha512_update(&impl->stream, data, length);
+}
+
+void shsHMACSHA512::update(const std::vector<uint8_t>& data) {
+    update(data.data(), data.size());
+}
+
+void shsHMACSHA512::update(const std::string& data) {
+    update(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+void shsHMACSHA512::finalize(uint8_t* out) {
+    hmac_sha512_final(&impl->stream, &impl->key, out);
+    hmac_sha512_init(&impl->stream, &impl->key);
+}
+
+std::array<uint8_t, 64> shsHMACSHA512::finalize() {
+    std::array<uint8_t, 64> result;
+    finalize(result.data());
+    return result;
+}
+
+void shsHMACSHA512::reset() {
+    hmac_sha512_init(&impl->stream, &impl->key);
+}
+
+void shsHMACSHA512::mac(const uint8_t* data, size_t length, uint8_t* out) const {
+    hmac_sha512(&impl->key, data, length, out);
+}
+
+std::array<uint8_t, 64> shsHMACSHA512::mac(const uint8_t* data, size_t length) const {
+    std::array<uint8_t, 64> result;
+    mac(data, length, result.data());
+    return result;
+}
+
+std::array<uint8_t, 64> shsHMACSHA512::mac(const std::vector<uint8_t>& data) const {
+    return mac(data.data(), data.size());
+}
+
+std::array<uint8_t, 64> shsHMACSHA512::mac(const std::string& data) const {
+    return mac(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+void shsHMACSHA512::mac_batch(const uint8_t* const* data, const size_t* lengths,
+                              size_t count, uint8_t* out) const {
+    for (size_t i = 0; i < count; ++i) {
+        hmac_sha512(&impl->key, data[i], lengths[i], out + i * OUTPUT_SIZE);
+    }
+}
+
+std::vector<std::array<uint8_t, 64>> shsHMACSHA512::mac_batch(
+    const std::vector<std::vector<uint8_t>>& messages) const {
+    std::vector<std::array<uint8_t, 64>> result(messages.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+        mac(messages[i].data(), messages[i].size(), result[i].data());
+    }
+    return result;
+}
+
+bool shsHMACSHA512::verify(const uint8_t* data, size_t length, const uint8_t* tag) const {
+    return verify_truncated(data, length, tag, OUTPUT_SIZE);
+}
+
+bool shsHMACSHA512::verify_truncated(const uint8_t* data, size_t length,
+                                     const uint8_t* tag, size_t tag_length) const {
+    if (tag_length < MIN_TRUNCATED_TAG_SIZE || tag_length > OUTPUT_SIZE) {
+        return false;
+    }
+    std::array<uint8_t, 64> expected;
+    mac(data, length, expected.data());
+
+    uint8_t diff = 0;
+    for (size_t i = 0; i < tag_length; ++i) {
+        diff |= expected[i] ^ tag[i];
+    }
+    hmac_sha512_wipe(expected.data(), expected.size());
+    return diff == 0;
+}
+
+std::array<uint8_t, 64> shsHMACSHA512::hash(const std::vector<uint8_t>& key,
+                                            const std::vector<uint8_t>& data) {
+    shsHMACSHA512 hmac(key);
+    return hmac.mac(data);
+}
+
+std::array<uint8_t, 64> shsHMACSHA512::hash(const std::string& key,
+                                            const std::string& data) {
+    shsHMACSHA512 hmac(key);
+    return hmac.mac(data);
+}
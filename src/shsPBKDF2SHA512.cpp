@@ -0,0 +1,237 @@
+#include "shsPBKDF2SHA512.hpp"
+#include "hmac-sha512.h"
+#include "sha512-mb.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// One output block T_i of one job, iterated in a SIMD lane
+struct Task {
+    uint64_t inner[8];     // midstate after key ^ ipad
+    uint64_t outer[8];     // midstate after key ^ opad
+    uint64_t u[8];         // U_j as big-endian words
+    uint64_t t[8];         // running XOR of U_1..U_j
+    uint32_t remaining;    // iterations still to run
+    uint8_t* out;
+    size_t out_length;
+};
+
+uint64_t load64be(const uint8_t* p) {
+    uint64_t w = 0;
+    for (int i = 0; i < 8; ++i) {
+        w = (w << 8) | p[i];
+    }
+    return w;
+}
+
+void store64be(uint8_t* p, uint64_t w) {
+    for (int i = 7; i >= 0; --i) {
+        p[i] = static_cast<uint8_t>(w);
+        w >>= 8;
+    }
+}
+
+// U_1 = HMAC(P, S || INT(i)) is the only variable-length step
+void startTask(Task& task, const hmac_sha512_key& key, const shsPBKDF2SHA512::Job& job,
+               uint32_t block_index) {
+    uint8_t counter[4] = {
+        static_cast<uint8_t>(block_index >> 24), static_cast<uint8_t>(block_index >> 16),
+        static_cast<uint8_t>(block_index >> 8), static_cast<uint8_t>(block_index)
+    };
+    uint8_t u1[shsPBKDF2SHA512::HASH_SIZE];
+    sha512_context md;
+
+    hmac_sha512_init(&md, &key);
+    if (job.salt_length != 0) {
+        sha512_update(&md, job.salt, job.salt_length);
+    }
+    sha512_update(&md, counter, sizeof(counter));
+    hmac_sha512_final(&md, &key, u1);
+
+    for (int w = 0; w < 8; ++w) {
+        task.inner[w] = key.inner.state[w];
+        task.outer[w] = key.outer.state[w];
+        task.u[w] = task.t[w] = load64be(u1 + 8 * w);
+    }
+    task.remaining = job.iterations - 1;
+    size_t offset = static_cast<size_t>(block_index - 1) * shsPBKDF2SHA512::HASH_SIZE;
+    task.out = job.out + offset;
+    task.out_length = std::min(job.out_length - offset, shsPBKDF2SHA512::HASH_SIZE);
+    hmac_sha512_wipe(u1, sizeof(u1));
+}
+
+void finishTask(Task& task) {
+    uint8_t block[shsPBKDF2SHA512::HASH_SIZE];
+    for (int w = 0; w < 8; ++w) {
+        store64be(block + 8 * w, task.t[w]);
+    }
+    memcpy(task.out, block, task.out_length);
+    hmac_sha512_wipe(block, sizeof(block));
+    hmac_sha512_wipe(&task, sizeof(task));
+}
+
+void compressLanes(uint64_t state[8][1], const uint64_t block[16][1]) {
+    sha512_compress_words(&state[0][0], &block[0][0]);
+}
+
+/*
+ * Runs all tasks L at a time. Each step is two compressions per lane:
+ *   H = compress(inner, U || pad),  U = compress(outer, H || pad),  T ^= U
+ * where pad is the constant tail of a 64-byte message after a 128-byte key
+ * block. Lanes that finish are refilled from the queue; idle lanes at the
+ * tail just compute garbage that is never read.
+ */
+template <unsigned L>
+void runTasks(Task* tasks, size_t count,
+              void (*compress)(uint64_t[8][L], const uint64_t[16][L])) {
+    uint64_t state[8][L];
+    uint64_t block[16][L];
+    Task* lane_task[L] = {};
+    size_t next = 0;
+    unsigned active = 0;
+
+    memset(state, 0, sizeof(state));
+    memset(block, 0, sizeof(block));
+    for (unsigned l = 0; l < L; ++l) {
+        block[8][l] = UINT64_C(0x8000000000000000);
+        block[15][l] = (128 + 64) * 8;
+    }
+
+    auto refill = [&](unsigned l) {
+        while (next < count && tasks[next].remaining == 0) {
+            finishTask(tasks[next++]);
+        }
+        lane_task[l] = (next < count) ? &tasks[next++] : nullptr;
+        if (lane_task[l] != nullptr) {
+            ++active;
+        }
+    };
+    for (unsigned l = 0; l < L; ++l) {
+        refill(l);
+    }
+
+    while (active > 0) {
+        for (unsigned l = 0; l < L; ++l) {
+            if (lane_task[l] != nullptr) {
+                for (unsigned w = 0; w < 8; ++w) {
+                    state[w][l] = lane_task[l]->inner[w];
+                    block[w][l] = lane_task[l]->u[w];
+                }
+            }
+        }
+        compress(state, block);
+
+        for (unsigned l = 0; l < L; ++l) {
+            if (lane_task[l] != nullptr) {
+                for (unsigned w = 0; w < 8; ++w) {
+                    block[w][l] = state[w][l];
+                    state[w][l] = lane_task[l]->outer[w];
+                }
+            }
+        }
+        compress(state, block);
+
+        for (unsigned l = 0; l < L; ++l) {
+            Task* task = lane_task[l];
+            if (task == nullptr) {
+                continue;
+            }
+            for (unsigned w = 0; w < 8; ++w) {
+                task->u[w] = state[w][l];
+                task->t[w] ^= state[w][l];
+            }
+            if (--task->remaining == 0) {
+                finishTask(*task);
+                --active;
+                refill(l);
+            }
+        }
+    }
+
+    // Tasks with a single iteration never entered a lane
+    while (next < count) {
+        finishTask(tasks[next++]);
+    }
+    hmac_sha512_wipe(state, sizeof(state));
+    hmac_sha512_wipe(block, sizeof(block));
+}
+
+} // namespace
+
+void shsPBKDF2SHA512::derive_batch(const Job* jobs, size_t count) {
+    size_t total_blocks = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Job& job = jobs[i];
+        if (job.iterations == 0) {
+            throw std::invalid_argument("PBKDF2 iteration count must be positive");
+        }
+        if ((job.password == nullptr && job.password_length != 0) ||
+            (job.salt == nullptr && job.salt_length != 0) ||
+            (job.out == nullptr && job.out_length != 0)) {
+            throw std::invalid_argument("Input pointer is NULL");
+        }
+        if (job.out_length > static_cast<uint64_t>(UINT32_MAX) * HASH_SIZE) {
+            throw std::invalid_argument("PBKDF2 output too long");
+        }
+        total_blocks += (job.out_length + HASH_SIZE - 1) / HASH_SIZE;
+    }
+
+    std::vector<Task> tasks(total_blocks);
+    size_t t = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Job& job = jobs[i];
+        hmac_sha512_key key;
+        hmac_sha512_setkey(&key, job.password, job.password_length);
+        uint32_t blocks = static_cast<uint32_t>((job.out_length + HASH_SIZE - 1) / HASH_SIZE);
+        for (uint32_t b = 1; b <= blocks; ++b) {
+            startTask(tasks[t++], key, job, b);
+        }
+        hmac_sha512_wipe(&key, sizeof(key));
+    }
+
+    // Narrow batches are not worth the wider kernels' idle lanes
+    unsigned width = sha512_mb_lanes();
+    if (width >= 8 && total_blocks > 4) {
+        runTasks<8>(tasks.data(), tasks.size(), sha512_compress_words_x8);
+    } else if (width >= 4 && total_blocks > 1) {
+        runTasks<4>(tasks.data(), tasks.size(), sha512_compress_words_x4);
+    } else {
+        runTasks<1>(tasks.data(), tasks.size(), compressLanes);
+    }
+}
+
+void shsPBKDF2SHA512::derive(const uint8_t* password, size_t password_length,
+                             const uint8_t* salt, size_t salt_length,
+                             uint32_t iterations, uint8_t* out, size_t out_length) {
+    Job job = {password, password_length, salt, salt_length, iterations, out, out_length};
+    derive_batch(&job, 1);
+}
+
+std::vector<uint8_t> shsPBKDF2SHA512::derive(const std::string& password,
+                                             const std::vector<uint8_t>& salt,
+                                             uint32_t iterations, size_t length) {
+    std::vector<uint8_t> result(length);
+    derive(reinterpret_cast<const uint8_t*>(password.data()), password.size(),
+           salt.data(), salt.size(), iterations, result.data(), length);
+    return result;
+}
+
+bool shsPBKDF2SHA512::verify(const std::string& password, const std::vector<uint8_t>& salt,
+                             uint32_t iterations, const std::vector<uint8_t>& expected) {
+    if (expected.empty()) {
+        return false;
+    }
+    auto computed = derive(password, salt, iterations, expected.size());
+    uint8_t diff = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        diff |= computed[i] ^ expected[i];
+    }
+    hmac_sha512_wipe(computed.data(), computed.size());
+    return diff == 0;
+}
+
+unsigned shsPBKDF2SHA512::lanes() {
+    return sha512_mb_lanes();
+}
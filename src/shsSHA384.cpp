@@ -0,0 +1,52 @@
+#include "shsSHA384.hpp"
+#include "sha512.h"
+
+struct shsSHA384::Impl {
+    sha512_context context;
+};
+
+shsSHA384::shsSHA384() : impl(new Impl) {
+    sha384_init(&impl->context);
+}
+
+shsSHA384::~shsSHA384() {
+    delete impl;
+}
+
+void shsSHA384::update(const std::vector<uint8_t>& data) {
+    sha512_update(&impl->context, data.data(), data.size());
+}
+
+void shsSHA384::update(const std::string& data) {
+    sha512_update(&impl->context,
+                 reinterpret_cast<const unsigned char*>(data.data()),
+                 data.size());
+}
+
+void shsSHA384::update(const uint8_t* data, size_t length) {
+    sha512_update(&impl->context, data, length);
+}
+
+std::array<uint8_t, shsSHA384::DIGEST_SIZE> shsSHA384::finalize() {
+    std::array<uint8_t, DIGEST_SIZE> result;
+    sha384_final(&impl->context, result.data());
+    return result;
+}
+
+std::array<uint8_t, shsSHA384::DIGEST_SIZE> shsSHA384::hash(const std::vector<uint8_t>& data) {
+    shsSHA384 hasher;
+    hasher.update(data);
+    return hasher.finalize();
+}
+
+std::array<uint8_t, shsSHA384::DIGEST_SIZE> shsSHA384::hash(const std::string& data) {
+    shsSHA384 hasher;
+    hasher.update(data);
+    return hasher.finalize();
+}
+
+std::array<uint8_t, shsSHA384::DIGEST_SIZE> shsSHA384::hash(const uint8_t* data, size_t length) {
+    shsSHA384 hasher;
+    hasher.update(data, length);
+    return hasher.finalize();
+}
@@ -1,5 +1,8 @@
 #include "shsSHA512.hpp"
 #include "sha512.h"
+#include "shsFileFeed.hpp"
+#include "shsStateBlob.hpp"
+#include <stdexcept>
 
 struct shsSHA512::Impl {
     sha512_context context;
@@ -33,20 +36,112 @@ std::array<uint8_t, 64> shsSHA512::finalize() {
     return result;
 }
 
+std::vector<uint8_t> shsSHA512::export_state(const uint8_t* mac_key, size_t mac_key_length) const {
+    const sha512_context& md = impl->context;
+    shs_state_blob::Writer out;
+    out.u64(md.length);
+    for (uint64_t word : md.state) out.u64(word);
+    out.u32(static_cast<uint32_t>(md.curlen));
+    out.bytes(md.buf, sizeof(md.buf));
+    return out.seal(shs_state_blob::Kind::SHA512, md.length / 8 + md.curlen,
+                    mac_key, mac_key_length);
+}
+
+std::vector<uint8_t> shsSHA512::export_state(const std::vector<uint8_t>& mac_key) const {
+    return export_state(mac_key.data(), mac_key.size());
+}
+
+uint64_t shsSHA512::import_state(const uint8_t* blob, size_t blob_length,
+                                 const uint8_t* mac_key, size_t mac_key_length) {
+    shs_state_blob::Reader in(blob, blob_length, mac_key, mac_key_length);
+    if (in.kind() != shs_state_blob::Kind::SHA512) {
+        throw std::invalid_argument("State blob does not hold a SHA-512 state");
+    }
+    sha512_context md;
+    md.length = in.u64();
+    for (uint64_t& word : md.state) word = in.u64();
+    md.curlen = in.u32();
+    in.bytes(md.buf, sizeof(md.buf));
+    in.finish();
+    // length counts whole compressed blocks, in bits; a full buffer is
+    // always compressed right away
+    if (md.length % (8 * sizeof(md.buf)) != 0 || md.curlen >= sizeof(md.buf) ||
+        in.inputOffset() != md.length / 8 + md.curlen) {
+        throw std::invalid_argument("Corrupt SHA-512 state");
+    }
+    impl->context = md;
+    return in.inputOffset();
+}
+
+uint64_t shsSHA512::import_state(const std::vector<uint8_t>& blob,
+                                 const std::vector<uint8_t>& mac_key) {
+    return import_state(blob.data(), blob.size(), mac_key.data(), mac_key.size());
+}
+
+// One-shots run on a stack context; no Impl allocation
 std::array<uint8_t, 64> shsSHA512::hash(const std::vector<uint8_t>& data) {
-    shsSHA512 hasher;
-    hasher.update(data);
-    return hasher.finalize();
+    return hash(data.data(), data.size());
 }
 
 std::array<uint8_t, 64> shsSHA512::hash(const std::string& data) {
-    shsSHA512 hasher;
-    hasher.update(data);
-    return hasher.finalize();
+    return hash(reinterpret_cast<const uint8_t*>(data.data()), data.size());
 }
 
 std::array<uint8_t, 64> shsSHA512::hash(const uint8_t* data, size_t length) {
+    std::array<uint8_t, 64> result;
+    sha512(data, length, result.data());
+    return result;
+}
+
+std::array<uint8_t, 64> shsSHA512::hash(const std::array<uint8_t, 32>& data) {
+    std::array<uint8_t, 64> result;
+    sha512_32(data.data(), result.data());
+    return result;
+}
+
+std::array<uint8_t, 64> shsSHA512::hash(const std::array<uint8_t, 64>& data) {
+    std::array<uint8_t, 64> result;
+    sha512_64(data.data(), result.data());
+    return result;
+}
+
+std::array<uint8_t, 64> shsSHA512::hash(const std::array<uint8_t, 96>& data) {
+    std::array<uint8_t, 64> result;
+    sha512_96(data.data(), result.data());
+    return result;
+}
+
+std::array<uint8_t, 64> shsSHA512::iterate(const std::array<uint8_t, 64>& seed, uint64_t n) {
+    std::array<uint8_t, 64> result;
+    sha512_iterate(seed.data(), n, result.data());
+    return result;
+}
+
+namespace {
+
+shsSHA512::FileResult finishFile(shsSHA512& hasher, const shs_file_feed::Stats& stats) {
+    shsSHA512::FileResult result;
+    result.digest = hasher.finalize();
+    result.bytes = stats.bytes;
+    result.seconds = stats.seconds;
+    result.bytes_per_second = stats.bytesPerSecond();
+    return result;
+}
+
+} // namespace
+
+shsSHA512::FileResult shsSHA512::hash_file(const std::string& path) {
     shsSHA512 hasher;
-    hasher.update(data, length);
-    return hasher.finalize();
-}
\ No newline at end of file
+    auto stats = shs_file_feed::feedPath(path, [&](const uint8_t* data, size_t length) {
+        hasher.update(data, length);
+    });
+    return finishFile(hasher, stats);
+}
+
+shsSHA512::FileResult shsSHA512::hash_file(int fd) {
+    shsSHA512 hasher;
+    auto stats = shs_file_feed::feedDescriptor(fd, [&](const uint8_t* data, size_t length) {
+        hasher.update(data, length);
+    });
+    return finishFile(hasher, stats);
+}
@@ -0,0 +1,52 @@
+#include "shsSHA512_256.hpp"
+#include "sha512.h"
+
+struct shsSHA512_256::Impl {
+    sha512_context context;
+};
+
+shsSHA512_256::shsSHA512_256() : impl(new Impl) {
+    sha512_256_init(&impl->context);
+}
+
+shsSHA512_256::~shsSHA512_256() {
+    delete impl;
+}
+
+void shsSHA512_256::update(const std::vector<uint8_t>& data) {
+    sha512_update(&impl->context, data.data(), data.size());
+}
+
+void shsSHA512_256::update(const std::string& data) {
+    sha512_update(&impl->context,
+                 reinterpret_cast<const unsigned char*>(data.data()),
+                 data.size());
+}
+
+void shsSHA512_256::update(const uint8_t* data, size_t length) {
+    sha512_update(&impl->context, data, length);
+}
+
+std::array<uint8_t, shsSHA512_256::DIGEST_SIZE> shsSHA512_256::finalize() {
+    std::array<uint8_t, DIGEST_SIZE> result;
+    sha512_256_final(&impl->context, result.data());
+    return result;
+}
+
+std::array<uint8_t, shsSHA512_256::DIGEST_SIZE> shsSHA512_256::hash(const std::vector<uint8_t>& data) {
+    shsSHA512_256 hasher;
+    hasher.update(data);
+    return hasher.finalize();
+}
+
+std::array<uint8_t, shsSHA512_256::DIGEST_SIZE> shsSHA512_256::hash(const std::string& data) {
+    shsSHA512_256 hasher;
+    hasher.update(data);
+    return hasher.finalize();
+}
+
+std::array<uint8_t, shsSHA512_256::DIGEST_SIZE> shsSHA512_256::hash(const uint8_t* data, size_t length) {
+    shsSHA512_256 hasher;
+    hasher.update(data, length);
+    return hasher.finalize();
+}
@@ -0,0 +1,138 @@
+#include "shsStateBlob.hpp"
+#include "shsHMACSHA512.hpp"
+#include "hmac-sha512.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace shs_state_blob {
+
+namespace {
+
+constexpr uint8_t MAGIC[4] = {'S', 'H', 'S', 'S'};
+constexpr size_t HEADER_SIZE = 20;
+constexpr size_t TAG_SIZE = shsHMACSHA512::OUTPUT_SIZE;
+
+void checkKey(const void* key, size_t key_length) {
+    if (key == nullptr || key_length == 0) {
+        throw std::invalid_argument("State MAC key must not be empty");
+    }
+}
+
+uint64_t load(const uint8_t* p, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        value |= static_cast<uint64_t>(p[i]) << (8 * i);
+    }
+    return value;
+}
+
+void store(std::vector<uint8_t>& out, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+} // namespace
+
+Writer::~Writer() {
+    hmac_sha512_wipe(payload.data(), payload.size());
+}
+
+void Writer::u8(uint8_t value) {
+    payload.push_back(value);
+}
+
+void Writer::u32(uint32_t value) {
+    store(payload, value, 4);
+}
+
+void Writer::u64(uint64_t value) {
+    store(payload, value, 8);
+}
+
+void Writer::bytes(const void* data, size_t length) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    payload.insert(payload.end(), p, p + length);
+}
+
+std::vector<uint8_t> Writer::seal(Kind kind, uint64_t input_offset,
+                                  const void* key, size_t key_length) const {
+    checkKey(key, key_length);
+    std::vector<uint8_t> header;
+    header.insert(header.end(), MAGIC, MAGIC + sizeof(MAGIC));
+    header.push_back(VERSION);
+    header.push_back(static_cast<uint8_t>(kind));
+    store(header, 0, 2);
+    store(header, input_offset, 8);
+    store(header, payload.size(), 4);
+
+    std::vector<uint8_t> blob(HEADER_SIZE + payload.size() + TAG_SIZE);
+    memcpy(blob.data(), header.data(), HEADER_SIZE);
+    if (!payload.empty()) {
+        memcpy(blob.data() + HEADER_SIZE, payload.data(), payload.size());
+    }
+    shsHMACSHA512 hmac(static_cast<const uint8_t*>(key), key_length);
+    hmac.mac(blob.data(), HEADER_SIZE + payload.size(), blob.data() + HEADER_SIZE + payload.size());
+    return blob;
+}
+
+Reader::Reader(const void* blob, size_t length, const void* key, size_t key_length) {
+    checkKey(key, key_length);
+    const uint8_t* p = static_cast<const uint8_t*>(blob);
+    if (p == nullptr || length < HEADER_SIZE + TAG_SIZE) {
+        throw std::invalid_argument("State blob is truncated");
+    }
+    // Authenticate before trusting any field
+    shsHMACSHA512 hmac(static_cast<const uint8_t*>(key), key_length);
+    if (!hmac.verify(p, length - TAG_SIZE, p + length - TAG_SIZE)) {
+        throw std::runtime_error("State blob failed authentication");
+    }
+    if (memcmp(p, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::invalid_argument("Not a hash state blob");
+    }
+    if (p[4] != VERSION) {
+        throw std::invalid_argument("Unsupported state blob version");
+    }
+    blob_kind = static_cast<Kind>(p[5]);
+    input_offset = load(p + 8, 8);
+    payload_length = static_cast<size_t>(load(p + 16, 4));
+    if (payload_length != length - HEADER_SIZE - TAG_SIZE) {
+        throw std::invalid_argument("State blob length mismatch");
+    }
+    payload = p + HEADER_SIZE;
+}
+
+uint8_t Reader::u8() {
+    uint8_t value;
+    bytes(&value, 1);
+    return value;
+}
+
+uint32_t Reader::u32() {
+    uint8_t raw[4];
+    bytes(raw, sizeof(raw));
+    return static_cast<uint32_t>(load(raw, sizeof(raw)));
+}
+
+uint64_t Reader::u64() {
+    uint8_t raw[8];
+    bytes(raw, sizeof(raw));
+    return load(raw, sizeof(raw));
+}
+
+void Reader::bytes(void* out, size_t length) {
+    if (length > payload_length - position) {
+        throw std::invalid_argument("State blob is truncated");
+    }
+    memcpy(out, payload + position, length);
+    position += length;
+}
+
+void Reader::finish() const {
+    if (position != payload_length) {
+        throw std::invalid_argument("State blob has trailing data");
+    }
+}
+
+} // namespace shs_state_blob
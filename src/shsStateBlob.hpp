@@ -0,0 +1,74 @@
+#ifndef SHS_STATE_BLOB_HPP
+#define SHS_STATE_BLOB_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Checkpoint format for streaming hash states:
+//
+//   "SHSS" | version u8 | kind u8 | 0 u16 | input offset u64 |
+//   payload length u32 | payload | HMAC-SHA512 tag (64 bytes)
+//
+// Integers are little-endian and the tag covers every byte before it. The
+// payload is each algorithm's state written field by field, so blobs move
+// between builds and hosts regardless of struct layout. It is not
+// encrypted: a blob reveals the hashed data's state (and, for keyed
+// hashers, enough to forge MACs), so store it like key material.
+namespace shs_state_blob {
+
+constexpr uint8_t VERSION = 1;
+
+enum class Kind : uint8_t {
+    Blake2b = 1,
+    Blake2bp = 2,
+    Blake2Xb = 3,
+    SHA512 = 4,
+};
+
+class Writer {
+public:
+    ~Writer();
+
+    void u8(uint8_t value);
+    void u32(uint32_t value);
+    void u64(uint64_t value);
+    void bytes(const void* data, size_t length);
+
+    // Header, payload and tag; the key must not be empty
+    std::vector<uint8_t> seal(Kind kind, uint64_t input_offset,
+                              const void* key, size_t key_length) const;
+
+private:
+    std::vector<uint8_t> payload;
+};
+
+// Throws std::runtime_error if the tag does not verify under `key` and
+// std::invalid_argument if an authentic blob is malformed, has another
+// version, or is read past its end.
+class Reader {
+public:
+    Reader(const void* blob, size_t length, const void* key, size_t key_length);
+
+    Kind kind() const { return blob_kind; }
+    uint64_t inputOffset() const { return input_offset; }
+
+    uint8_t u8();
+    uint32_t u32();
+    uint64_t u64();
+    void bytes(void* out, size_t length);
+
+    // Every payload byte must have been read
+    void finish() const;
+
+private:
+    const uint8_t* payload;
+    size_t payload_length;
+    size_t position = 0;
+    Kind blob_kind;
+    uint64_t input_offset;
+};
+
+} // namespace shs_state_blob
+
+#endif // SHS_STATE_BLOB_HPP
@@ -0,0 +1,133 @@
+#include "shsThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+struct shsThreadPool::Job {
+    size_t count;
+    const std::function<void(size_t)>* body;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> finished{0};
+    size_t helpers_left;  // guarded by the pool mutex
+
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+};
+
+shsThreadPool::shsThreadPool(size_t workers) : worker_count(workers) {}
+
+shsThreadPool::~shsThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+shsThreadPool& shsThreadPool::shared() {
+    static shsThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+void shsThreadPool::start() {
+    // called with mutex held
+    started = true;
+    workers.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+void shsThreadPool::runJob(Job& job) {
+    size_t i;
+    while ((i = job.next.fetch_add(1)) < job.count) {
+        try {
+            (*job.body)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            if (!job.error) {
+                job.error = std::current_exception();
+            }
+        }
+        if (job.finished.fetch_add(1) + 1 == job.count) {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            job.done.notify_all();
+        }
+    }
+}
+
+void shsThreadPool::workerLoop() {
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = queue.front();
+            // Drop the job from the queue once it needs no more helpers
+            if (--job->helpers_left == 0 || job->next.load() >= job->count) {
+                queue.pop_front();
+            }
+        }
+        runJob(*job);
+    }
+}
+
+void shsThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body,
+                                size_t max_threads) {
+    if (count == 0) {
+        return;
+    }
+    size_t helpers = std::min(worker_count, count - 1);
+    if (max_threads > 0) {
+        helpers = std::min(helpers, max_threads - 1);
+    }
+    if (helpers == 0) {
+        for (size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->count = count;
+    job->body = &body;
+    job->helpers_left = helpers;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!started) {
+            start();
+        }
+        queue.push_back(job);
+    }
+    if (helpers == 1) {
+        wake.notify_one();
+    } else {
+        wake.notify_all();
+    }
+
+    runJob(*job);
+
+    // Every index is claimed; make sure no late worker picks the job up
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find(queue.begin(), queue.end(), job);
+        if (it != queue.end()) {
+            queue.erase(it);
+        }
+    }
+    {
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->done.wait(lock, [&] { return job->finished.load() == job->count; });
+    }
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef SHS_THREAD_POOL_HPP
+#define SHS_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Worker pool for the library's data-parallel loops. Workers start on the
+// first parallelFor and then stay parked on a condition variable. The
+// calling thread always works on its own loop, so a loop issued from inside
+// another loop's body (or from several threads at once) still completes
+// even when every worker is busy.
+class shsThreadPool {
+public:
+    explicit shsThreadPool(size_t workers);
+    ~shsThreadPool();
+
+    // Process-wide pool with hardware_concurrency() - 1 workers
+    static shsThreadPool& shared();
+
+    // Threads that can work on one loop: the workers plus the caller
+    size_t concurrency() const { return worker_count + 1; }
+
+    // Calls body(i) for every i in [0, count) and returns when all calls
+    // are done. At most max_threads threads (caller included) take part;
+    // 0 means no limit. The first exception thrown by body is rethrown.
+    void parallelFor(size_t count, const std::function<void(size_t)>& body,
+                     size_t max_threads = 0);
+
+    shsThreadPool(const shsThreadPool&) = delete;
+    shsThreadPool& operator=(const shsThreadPool&) = delete;
+
+private:
+    struct Job;
+
+    void start();
+    void workerLoop();
+    static void runJob(Job& job);
+
+    const size_t worker_count;
+    std::vector<std::thread> workers;
+    std::deque<std::shared_ptr<Job>> queue;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool started = false;
+    bool stopping = false;
+};
+
+#endif // SHS_THREAD_POOL_HPP
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include "Argon2Hasher.hpp"
+#include "Argon2Calibrator.hpp"
+#include "argon2.h"
 #include <vector>
 #include <string>
 #include <stdexcept>
@@ -7,6 +9,8 @@
 #include <iomanip>
 #include <functional>
 #include <cstring>
+#include <thread>
+#include <sstream>
 
 using namespace mylib::crypto;
 
@@ -34,9 +38,324 @@ TEST_F(Argon2HasherTest, HashPasswordWithSalt_GeneratesDifferentSalts) {
     EXPECT_NE(result1, result2);
 }
 
+TEST_F(Argon2HasherTest, EncodedParamsRoundTrip) {
+    using Type = Argon2Hasher::Type;
+    for (Type type : {Type::i, Type::d, Type::id}) {
+        for (unsigned int lanes : {1u, 4u}) {
+            auto stored = Argon2Hasher::hashPasswordWithSalt("secret", 2, 1 << 10, 16, 24, type, lanes);
+            ASSERT_EQ(stored[0], '$');
+            auto params = Argon2Hasher::storedParams(stored);
+            EXPECT_EQ(params.type, type);
+            EXPECT_EQ(params.t_cost, 2u);
+            EXPECT_EQ(params.m_cost, 1u << 10);
+            EXPECT_EQ(params.lanes, lanes);
+            auto [salt, hash] = Argon2Hasher::splitSaltAndHash(stored);
+            EXPECT_EQ(salt.size(), 32u);
+            EXPECT_EQ(hash.size(), 48u);
+
+            // The stored parameters win over the arguments, any thread count works
+            EXPECT_TRUE(Argon2Hasher::verifyPassword("secret", stored));
+            EXPECT_TRUE(Argon2Hasher::verifyPassword("secret", stored, 7, 1 << 14, 64, 1));
+            EXPECT_FALSE(Argon2Hasher::verifyPassword("Secret", stored));
+        }
+    }
+    auto stored = Argon2Hasher::hashPasswordWithSalt("secret", 1, 1 << 9, 16, 32, Type::id, 2, 1);
+    EXPECT_EQ(stored.substr(0, stored.find('$', 24)), "$shs-argon2id$v=16$m=512,t=1,p=2");
+}
+
+TEST_F(Argon2HasherTest, LegacyStoredFormatStillVerifies) {
+    const std::string password = "legacyPassword";
+    const std::string salt = "00112233445566778899aabbccddeeff";
+    std::vector<uint8_t> out(32);
+    std::string copy = password; // hash_argon2i wipes its input
+    ASSERT_EQ(argon2::hash_argon2i(out.data(), out.size(), copy.data(), copy.size(),
+                                   salt.data(), salt.size(), 3, 1 << 12), 0);
+    std::string hex;
+    for (uint8_t b : out) {
+        hex += "0123456789abcdef"[b >> 4];
+        hex += "0123456789abcdef"[b & 15];
+    }
+    const std::string stored = salt + "$" + hex;
+
+    EXPECT_TRUE(Argon2Hasher::verifyPassword(password, stored));
+    EXPECT_FALSE(Argon2Hasher::verifyPassword("wrong", stored));
+    EXPECT_FALSE(Argon2Hasher::verifyPassword(password, stored, 2));
+    EXPECT_EQ(Argon2Hasher::storedParams(stored).lanes, 1u);
+}
+
+TEST_F(Argon2HasherTest, MalformedStoredStringsThrow) {
+    for (const char* stored : {"$shs-argon2x$v=16$m=512,t=1,p=1$aa$bb",
+                               "$shs-argon2i$v=19$m=512,t=1,p=1$aa$bb",
+                               "$shs-argon2i$v=16$m=512,t=1$aa$bb",
+                               "$shs-argon2i$v=16$m=512,t=1,p=1,x=2$aa$bb",
+                               "$shs-argon2i$v=16$m=512,t=1,p=1$aa",
+                               "$shs-argon2i$v=16$m=512,t=1,p=1$$bb",
+                               // Only plain digits, no overflow, nothing the core rejects
+                               "$shs-argon2i$v=16$m=-1,t=1,p=1$aa$bb",
+                               "$shs-argon2i$v=16$m=512,t=1,p=-1$aa$bb",
+                               "$shs-argon2i$v=16$m=+512,t=1,p=1$aa$bb",
+                               "$shs-argon2i$v=16$m= 512,t=1,p=1$aa$bb",
+                               "$shs-argon2i$v=16$m=512,t=,p=1$aa$bb",
+                               "$shs-argon2i$v=16$m=512,t=1,p=1,$aa$bb",
+                               "$shs-argon2i$v=16$m=4294967296,t=1,p=1$aa$bb",
+                               "$shs-argon2i$v=16$m=512,t=0,p=1$aa$bb",
+                               "$shs-argon2i$v=16$m=512,t=1,p=0$aa$bb",
+                               "$shs-argon2i$v=16$m=0,t=1,p=1$aa$bb",
+                               "$shs-argon2i$v=16$m=8,t=1,p=2$aa$bb",
+                               "$shs-argon2i$v=16$t=1,m=512,p=1$aa$bb",
+                               // Standard PHC strings from libargon2 are not ours
+                               "$argon2id$v=19$m=65536,t=3,p=4$c29tZXNhbHQ$cXVpdGVhbm90aGVyaGFzaA",
+                               "$argon2i$v=16$m=512,t=1,p=1$aa$bb",
+                               "nodollar"}) {
+        EXPECT_THROW(Argon2Hasher::verifyPassword("pw", stored), std::invalid_argument) << stored;
+    }
+}
+
+// Raw Argon2 call with explicit lanes and threads
+static std::vector<uint8_t> runArgon2(int (*variant)(Argon2_Context*), uint32_t t_cost,
+                                      uint32_t m_cost, uint32_t lanes, uint32_t threads,
+                                      std::string pwd = "password",
+                                      AllocateMemoryCallback allocate = NULL,
+                                      FreeMemoryCallback release = NULL) {
+    std::vector<uint8_t> out(32);
+    std::string salt = "somesaltsomesalt";
+    Argon2_Context context(out.data(), out.size(),
+                           (uint8_t*) pwd.data(), pwd.size(),
+                           (uint8_t*) salt.data(), salt.size(),
+                           NULL, 0, NULL, 0,
+                           t_cost, m_cost, lanes, threads,
+                           allocate, release, false, false, false, false);
+    int result = variant(&context);
+    if (result != 0) {
+        throw std::runtime_error(argon2::ErrorMessage(result));
+    }
+    return out;
+}
+
+TEST_F(Argon2HasherTest, ThreadCountDoesNotChangeOutput) {
+    for (auto variant : {argon2::Argon2i, argon2::Argon2d, argon2::Argon2id}) {
+        auto single = runArgon2(variant, 3, 1 << 10, 4, 1);
+        EXPECT_EQ(runArgon2(variant, 3, 1 << 10, 4, 4), single);
+        EXPECT_EQ(runArgon2(variant, 3, 1 << 10, 4, 64), single);
+        EXPECT_NE(runArgon2(variant, 3, 1 << 10, 2, 2), single);
+    }
+}
+
+TEST_F(Argon2HasherTest, HashArgon2MatchesContextApi) {
+    const std::string salt = "somesaltsomesalt";
+    std::vector<uint8_t> out(32);
+    std::string pwd = "password";
+    ASSERT_EQ(argon2::hash_argon2(argon2::Type::id, out.data(), out.size(), pwd.data(), pwd.size(),
+                                  salt.data(), salt.size(), 3, 1 << 10, 4, 2), 0);
+    EXPECT_EQ(pwd, "password"); // the input is not wiped
+    EXPECT_EQ(out, runArgon2(argon2::Argon2id, 3, 1 << 10, 4, 4));
+}
+
+static std::vector<std::string> fillBackends() {
+    std::vector<std::string> names;
+    for (const char* name : {"avx512", "avx2", "sse2"}) {
+        if (argon2::SelectFillBackend(name) == 0) {
+            names.push_back(name);
+        }
+    }
+    argon2::SelectFillBackend(nullptr);
+    return names;
+}
+
+TEST_F(Argon2HasherTest, FillBackendsAgree) {
+    using Variant = int (*)(Argon2_Context*);
+    ASSERT_EQ(argon2::SelectFillBackend("sse2"), 0);
+    EXPECT_NE(argon2::SelectFillBackend("mmx"), 0);
+    std::vector<std::vector<uint8_t>> expected;
+    for (Variant variant : {argon2::Argon2i, argon2::Argon2d, argon2::Argon2id, argon2::Argon2ds}) {
+        expected.push_back(runArgon2(variant, 2, 512, 2, 2));
+    }
+    for (const auto& name : fillBackends()) {
+        ASSERT_EQ(argon2::SelectFillBackend(name.c_str()), 0);
+        EXPECT_EQ(argon2::FillBackend(), name);
+        size_t i = 0;
+        for (Variant variant : {argon2::Argon2i, argon2::Argon2d, argon2::Argon2id, argon2::Argon2ds}) {
+            EXPECT_EQ(runArgon2(variant, 2, 512, 2, 2), expected[i++]) << name << " variant " << i;
+        }
+    }
+    argon2::SelectFillBackend(nullptr);
+}
+
+TEST_F(Argon2HasherTest, PrefetchDistanceDoesNotChangeOutput) {
+    using Variant = int (*)(Argon2_Context*);
+    const uint32_t original = argon2::PrefetchDistance();
+    EXPECT_NE(argon2::SetPrefetchDistance(ARGON2_MAX_PREFETCH_DISTANCE + 1), 0);
+    EXPECT_EQ(argon2::PrefetchDistance(), original);
+
+    ASSERT_EQ(argon2::SetPrefetchDistance(0), 0);
+    std::vector<std::vector<uint8_t>> expected;
+    for (Variant variant : {argon2::Argon2i, argon2::Argon2id}) {
+        expected.push_back(runArgon2(variant, 2, 512, 2, 2));
+    }
+    // 256 is longer than the 64-block segments here
+    for (uint32_t distance : {1u, 16u, ARGON2_MAX_PREFETCH_DISTANCE}) {
+        ASSERT_EQ(argon2::SetPrefetchDistance(distance), 0);
+        size_t i = 0;
+        for (Variant variant : {argon2::Argon2i, argon2::Argon2id}) {
+            EXPECT_EQ(runArgon2(variant, 2, 512, 2, 2), expected[i++]) << "distance " << distance;
+        }
+    }
+    argon2::SetPrefetchDistance(original);
+}
+
+// Many request threads hashing at once, each also fanning its lanes out to
+// the shared pool; every result must match the one computed alone
+TEST_F(Argon2HasherTest, ConcurrentHashingStress) {
+    using Variant = int (*)(Argon2_Context*);
+    const Variant variants[] = {argon2::Argon2i, argon2::Argon2d, argon2::Argon2id,
+                                argon2::Argon2ds};
+    const int thread_count = 8;
+    const int rounds = 6;
+
+    auto jobFor = [&](int t, int round) {
+        return std::make_pair(variants[(t + round) % 4], "pw-" + std::to_string(t * rounds + round));
+    };
+    std::vector<std::vector<std::vector<uint8_t>>> expected(thread_count);
+    for (int t = 0; t < thread_count; ++t) {
+        for (int round = 0; round < rounds; ++round) {
+            auto job = jobFor(t, round);
+            expected[t].push_back(runArgon2(job.first, 2, 256, 2, 1, job.second));
+        }
+    }
+
+    std::vector<int> mismatches(thread_count, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int round = 0; round < rounds; ++round) {
+                auto job = jobFor(t, round);
+                if (runArgon2(job.first, 2, 256, 2, 2, job.second) != expected[t][round]) {
+                    ++mismatches[t];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int t = 0; t < thread_count; ++t) {
+        EXPECT_EQ(mismatches[t], 0) << "thread " << t;
+    }
+}
 
 
+TEST_F(Argon2HasherTest, ArenaMatchesDefaultAllocator) {
+    using Variant = int (*)(Argon2_Context*);
+    for (Variant variant : {argon2::Argon2i, argon2::Argon2d, argon2::Argon2id, argon2::Argon2ds}) {
+        auto expected = runArgon2(variant, 2, 1 << 10, 2, 2);
+        for (int round = 0; round < 3; ++round) {
+            EXPECT_EQ(runArgon2(variant, 2, 1 << 10, 2, 2, "password",
+                                argon2::ArenaAllocate, argon2::ArenaFree), expected);
+        }
+    }
+    EXPECT_GE(Argon2ArenaCachedBytes(), size_t(1) << 20);
+    argon2::TrimArena();
+    EXPECT_EQ(Argon2ArenaCachedBytes(), 0u);
+}
+
+TEST_F(Argon2HasherTest, ArenaReusesAndWipesRegions) {
+    const size_t size = (size_t(1) << 20) + 1024;
+    for (int pages : {0, 1, 2}) {
+        ASSERT_EQ(argon2::ConfigureArena(size_t(1) << 30, pages), 0);
+        uint8_t* first = nullptr;
+        ASSERT_EQ(argon2::ArenaAllocate(&first, size), 0);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % 64, 0u);
+        std::memset(first, 0xA5, size);
+        argon2::ArenaFree(first, size);
+        EXPECT_GE(Argon2ArenaCachedBytes(), size);
+
+        // A slightly smaller request takes the same region, wiped
+        uint8_t* second = nullptr;
+        ASSERT_EQ(argon2::ArenaAllocate(&second, size - 4096), 0);
+        EXPECT_EQ(second, first);
+        EXPECT_EQ(Argon2ArenaCachedBytes(), 0u);
+        size_t dirty = 0;
+        for (size_t i = 0; i < size; ++i) {
+            dirty += second[i] != 0;
+        }
+        EXPECT_EQ(dirty, 0u);
+        argon2::ArenaFree(second, size - 4096);
+    }
+    EXPECT_NE(argon2::ConfigureArena(0, 7), 0);
+
+    // A much smaller request gets its own region instead of pinning a big one
+    ASSERT_EQ(argon2::ConfigureArena(size_t(1) << 30, 0), 0);
+    uint8_t* big = nullptr;
+    uint8_t* small = nullptr;
+    ASSERT_EQ(argon2::ArenaAllocate(&big, size), 0);
+    argon2::ArenaFree(big, size);
+    ASSERT_EQ(argon2::ArenaAllocate(&small, 64 * 1024), 0);
+    EXPECT_NE(small, big);
+    argon2::ArenaFree(small, 64 * 1024);
+
+    // A zero limit keeps nothing
+    ASSERT_EQ(argon2::ConfigureArena(0, 0), 0);
+    EXPECT_EQ(Argon2ArenaCachedBytes(), 0u);
+    uint8_t* region = nullptr;
+    ASSERT_EQ(argon2::ArenaAllocate(&region, 4096), 0);
+    argon2::ArenaFree(region, 4096);
+    EXPECT_EQ(Argon2ArenaCachedBytes(), 0u);
+    ASSERT_EQ(argon2::ConfigureArena(size_t(1) << 30, 0), 0);
+}
+
+TEST_F(Argon2HasherTest, CalibrationStaysWithinTarget) {
+    Argon2Calibrator::Target target;
+    target.max_latency_ms = 40;
+    target.concurrency = 2;
+    target.memory_budget = size_t(32) << 20;
+    target.repeats = 1;
+    auto result = Argon2Calibrator::calibrate(target);
 
+    ASSERT_TRUE(result.meets_target);
+    EXPECT_LE(result.latency_ms, target.max_latency_ms);
+    EXPECT_EQ(result.params.type, Argon2Hasher::Type::id);
+    EXPECT_GE(result.params.t_cost, 1u);
+    EXPECT_LE(size_t(result.params.m_cost) * 1024 * target.concurrency, target.memory_budget);
+    ASSERT_FALSE(result.curve.empty());
+    for (const auto& sample : result.curve) {
+        EXPECT_EQ(sample.within_target, sample.latency_ms <= target.max_latency_ms);
+        EXPECT_GT(sample.hashes_per_sec, 0);
+    }
+
+    std::ostringstream report;
+    result.writeReport(report);
+    std::string line;
+    size_t rows = 0;
+    std::istringstream lines(report.str());
+    while (std::getline(lines, line)) {
+        rows += !line.empty() && line[0] != '#';
+    }
+    EXPECT_EQ(rows, result.curve.size() + 1); // header + one row per sample
+
+    // The selected parameters hash and verify through Argon2Hasher
+    auto stored = Argon2Hasher::hashPasswordWithSalt("pw", result.params.t_cost, result.params.m_cost,
+                                                     16, 32, result.params.type, result.params.lanes,
+                                                     result.threads);
+    EXPECT_TRUE(Argon2Hasher::verifyPassword("pw", stored));
+}
+
+TEST_F(Argon2HasherTest, CalibrationReportsUnreachableTargets) {
+    Argon2Calibrator::Target target;
+    target.max_latency_ms = 1e-6;
+    target.concurrency = 1;
+    target.memory_budget = size_t(4) << 20;
+    target.repeats = 1;
+    auto result = Argon2Calibrator::calibrate(target);
+    EXPECT_FALSE(result.meets_target);
+    EXPECT_EQ(result.params.m_cost, 8u);
+    EXPECT_EQ(result.params.t_cost, 1u);
+
+    target.memory_budget = 4 * 1024; // 4 KiB cannot hold 8 blocks
+    EXPECT_THROW(Argon2Calibrator::calibrate(target), std::invalid_argument);
+    target.memory_budget = size_t(4) << 20;
+    target.concurrency = 0;
+    EXPECT_THROW(Argon2Calibrator::calibrate(target), std::invalid_argument);
+}
 
 class Argon2PerformanceTest : public ::testing::Test {
 protected:
@@ -114,51 +433,119 @@ TEST_F(Argon2PerformanceTest, VerifyPerformance) {
     });
 }
 
+// Small memory sizes, where per-slice thread startup used to dominate
+TEST_F(Argon2PerformanceTest, MultiLanePerformance) {
+    runBenchmark("4 MB, 4 lanes, 1 thread", []() {
+        runArgon2(argon2::Argon2id, 3, 1 << 12, 4, 1);
+    }, 20);
+    runBenchmark("4 MB, 4 lanes, 4 threads", []() {
+        runArgon2(argon2::Argon2id, 3, 1 << 12, 4, 4);
+    }, 20);
+}
+
+// Repeated hashing at 64 MB: with the arena the block memory stays resident
+// between calls instead of being faulted in again every time
+TEST_F(Argon2PerformanceTest, ArenaPerformance) {
+    runBenchmark("64 MB, t=1, new[]", []() {
+        runArgon2(argon2::Argon2id, 1, 1 << 16, 1, 1);
+    });
+    runBenchmark("64 MB, t=1, arena", []() {
+        runArgon2(argon2::Argon2id, 1, 1 << 16, 1, 1, "password",
+                  argon2::ArenaAllocate, argon2::ArenaFree);
+    });
+    ASSERT_EQ(argon2::ConfigureArena(size_t(1) << 30, 1), 0);
+    runBenchmark("64 MB, t=1, arena + THP", []() {
+        runArgon2(argon2::Argon2id, 1, 1 << 16, 1, 1, "password",
+                  argon2::ArenaAllocate, argon2::ArenaFree);
+    });
+    ASSERT_EQ(argon2::ConfigureArena(size_t(1) << 30, 0), 0);
+    argon2::TrimArena();
+}
+
+// Memory-bound comparison at 256 MB: Argon2i knows its reference blocks in
+// advance and prefetches them, Argon2d has to wait for each one
+TEST_F(Argon2PerformanceTest, DataIndependentAddressingPerformance) {
+    const uint32_t original = argon2::PrefetchDistance();
+    for (uint32_t distance : {0u, 16u}) {
+        ASSERT_EQ(argon2::SetPrefetchDistance(distance), 0);
+        runBenchmark("Argon2i, 256 MB, t=3, prefetch distance " + std::to_string(distance), []() {
+            runArgon2(argon2::Argon2i, 3, 1 << 18, 1, 1);
+        }, 2);
+    }
+    argon2::SetPrefetchDistance(original);
+    runBenchmark("Argon2id, 256 MB, t=3", []() {
+        runArgon2(argon2::Argon2id, 3, 1 << 18, 1, 1);
+    }, 2);
+    runBenchmark("Argon2d, 256 MB, t=3", []() {
+        runArgon2(argon2::Argon2d, 3, 1 << 18, 1, 1);
+    }, 2);
+}
+
+// Throughput curve the calibrator measures on this machine for a typical
+// login target
+TEST_F(Argon2PerformanceTest, CalibrationReport) {
+    Argon2Calibrator::Target target;
+    target.max_latency_ms = 100;
+    target.concurrency = 2;
+    target.memory_budget = size_t(256) << 20;
+    auto result = Argon2Calibrator::calibrate(target);
+    EXPECT_FALSE(result.curve.empty());
+    std::cout << "\n";
+    result.writeReport(std::cout);
+}
+
 using namespace std;
 
 TEST_F(Argon2PerformanceTest, PerformanceDifferentParameters) {
     const int iterations = 10; 
+    // Every backend runs the whole table, so fewer rounds each
+    const int backend_iterations = 3;
     const vector<tuple<string, int, size_t>> test_params = {
-        {"Fast (t=1, m=16MB)", 1, 1<<16},      
-        {"Balanced (t=3, m=64MB)", 3, 1<<18},  
-        {"Secure (t=5, m=256MB)", 5, 1<<20}   
+        {"Fast (t=1, m=64MB)", 1, 1<<16},      
+        {"Balanced (t=3, m=256MB)", 3, 1<<18},  
+        {"Secure (t=5, m=1GB)", 5, 1<<20}   
     };
 
-    cout << "\nArgon2 Performance results (avg per operation):\n";
-    cout << "----------------------------------------------------------------------------\n";
-    cout << "| Config                 | Hash (ms) | Verify (ms) | Memory (MB) | Threads |\n";
-    cout << "----------------------------------------------------------------------------\n";
+    cout << "\nArgon2 Performance results by fill backend (avg per operation):\n";
+    cout << "---------------------------------------------------------------------------------------\n";
+    cout << "| Backend | Config                 | Hash (ms) | Verify (ms) | Memory (MB) | Threads |\n";
+    cout << "---------------------------------------------------------------------------------------\n";
 
     const string test_password = "testPassword123";
 
-    for (const auto& [name, t_cost, m_cost] : test_params) {
+    for (const auto& backend : fillBackends()) {
+        ASSERT_EQ(argon2::SelectFillBackend(backend.c_str()), 0);
+        for (const auto& [name, t_cost, m_cost] : test_params) {
 
-        auto start_hash = chrono::high_resolution_clock::now();
-        string stored_hash;
-        for (int i = 0; i < iterations; ++i) {
-            stored_hash = Argon2Hasher::hashPasswordWithSalt(test_password, t_cost, m_cost);
-        }
-        auto end_hash = chrono::high_resolution_clock::now();
-        double hash_time = chrono::duration_cast<chrono::milliseconds>(end_hash - start_hash).count() / iterations;
+            auto start_hash = chrono::high_resolution_clock::now();
+            string stored_hash;
+            for (int i = 0; i < backend_iterations; ++i) {
+                stored_hash = Argon2Hasher::hashPasswordWithSalt(test_password, t_cost, m_cost);
+            }
+            auto end_hash = chrono::high_resolution_clock::now();
+            double hash_time = chrono::duration_cast<chrono::milliseconds>(end_hash - start_hash).count() / backend_iterations;
 
 
-        auto start_verify = chrono::high_resolution_clock::now();
-        for (int i = 0; i < iterations; ++i) {
-            bool result = Argon2Hasher::verifyPassword(test_password, stored_hash);
-        }
-        auto end_verify = chrono::high_resolution_clock::now();
-        double verify_time = chrono::duration_cast<chrono::milliseconds>(end_verify - start_verify).count() / iterations;
+            auto start_verify = chrono::high_resolution_clock::now();
+            for (int i = 0; i < backend_iterations; ++i) {
+                bool result = Argon2Hasher::verifyPassword(test_password, stored_hash);
+            }
+            auto end_verify = chrono::high_resolution_clock::now();
+            double verify_time = chrono::duration_cast<chrono::milliseconds>(end_verify - start_verify).count() / backend_iterations;
 
-        cout << "| " << setw(22) << left << name << " | "
-             << setw(9) << fixed << setprecision(2) << hash_time << " | "
-             << setw(11) << verify_time << " | "
-             << setw(11) << (m_cost/(1024*1024)) << " | "
-             << setw(7) << "1" << " |\n";
+            cout << "| " << setw(7) << left << backend << " | "
+                 << setw(22) << name << " | "
+                 << setw(9) << fixed << setprecision(2) << hash_time << " | "
+                 << setw(11) << verify_time << " | "
+                 << setw(11) << (m_cost/1024) << " | "
+                 << setw(7) << "1" << " |\n";
+        }
     }
-    cout << "----------------------------------------------------------------------------\n";
+    argon2::SelectFillBackend(nullptr);
+    cout << "---------------------------------------------------------------------------------------\n";
 
 
-    cout << "\nArgon2 Performance with different password lengths (t=3, m=64MB, p=1):\n";
+    cout << "\nArgon2 Performance with different password lengths (t=3, m=256MB, p=1):\n";
     cout << "--------------------------------------------------------\n";
     cout << "| Password Length | Hash (ms) | Verify (ms) |\n";
     cout << "--------------------------------------------------------\n";
@@ -0,0 +1,251 @@
+#include <gtest/gtest.h>
+#include "Argon2HashService.hpp"
+#include <chrono>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mylib::crypto;
+using namespace std::chrono_literals;
+
+class Argon2HashServiceTest : public ::testing::Test {
+protected:
+    static Argon2HashService::Options options(unsigned int workers, unsigned int m_cost = 1 << 10,
+                                              size_t budget_jobs = 64) {
+        Argon2HashService::Options opts;
+        opts.workers = workers;
+        opts.params.type = Argon2Hasher::Type::id;
+        opts.params.t_cost = 1;
+        opts.params.m_cost = m_cost;
+        opts.memory_budget = size_t(m_cost) * 1024 * budget_jobs;
+        return opts;
+    }
+
+    template <typename T>
+    static bool isReady(std::future<T>& future) {
+        return future.wait_for(0s) == std::future_status::ready;
+    }
+};
+
+TEST_F(Argon2HashServiceTest, HashThenVerify) {
+    Argon2HashService service(options(2));
+    std::string stored = service.hash("t", "correct horse").get();
+    EXPECT_EQ(stored.rfind("$shs-argon2id$v=16$m=1024,t=1,p=1$", 0), 0u);
+    EXPECT_TRUE(Argon2Hasher::verifyPassword("correct horse", stored));
+
+    auto good = service.verify("t", "correct horse", stored);
+    auto bad = service.verify("t", "battery staple", stored);
+    EXPECT_TRUE(good.get());
+    EXPECT_FALSE(bad.get());
+
+    // Legacy "salt$hash" strings are verified with the Argon2Hasher defaults
+    auto legacy = service.verify("t", "pw", "00112233445566778899aabbccddeeff$abcd");
+    EXPECT_FALSE(legacy.get());
+}
+
+TEST_F(Argon2HashServiceTest, RejectsJobsThatCanNeverRun) {
+    Argon2HashService service(options(1, 1 << 10, 1));
+    std::string big = Argon2Hasher::hashPasswordWithSalt("pw", 1, 1 << 11, 16, 32, Argon2Hasher::Type::id);
+    EXPECT_THROW(service.verify("t", "pw", big), std::invalid_argument);
+    EXPECT_THROW(service.verify("t", "pw", "$shs-argon2q$v=16$m=8,t=1,p=1$aa$bb"), std::invalid_argument);
+
+    auto opts = options(1);
+    opts.memory_budget = 1024;
+    Argon2HashService tiny(opts);
+    EXPECT_THROW(tiny.hash("t", "pw"), std::invalid_argument);
+}
+
+TEST_F(Argon2HashServiceTest, MemoryBudgetBoundsRunningJobs) {
+    for (size_t budget_jobs : {1, 2}) {
+        Argon2HashService service(options(4, 1 << 12, budget_jobs));
+        std::vector<std::future<std::string>> results;
+        for (int i = 0; i < 12; ++i) {
+            results.push_back(service.hash("tenant-" + std::to_string(i % 3), "pw" + std::to_string(i)));
+        }
+        for (auto& result : results) {
+            EXPECT_FALSE(result.get().empty());
+        }
+        auto metrics = service.metrics();
+        EXPECT_LE(metrics.memory_peak, budget_jobs * (size_t(1) << 22));
+        EXPECT_GE(metrics.memory_peak, size_t(1) << 22);
+        EXPECT_EQ(metrics.memory_in_use, 0u);
+        EXPECT_EQ(metrics.completed, 12u);
+    }
+}
+
+// One worker, so jobs run strictly in the order the scheduler picks them:
+// the small tenant must not wait behind the whole backlog of the big one
+TEST_F(Argon2HashServiceTest, TenantsAreServedRoundRobin) {
+    Argon2HashService service(options(1, 1 << 12));
+    std::vector<std::future<std::string>> noisy;
+    for (int i = 0; i < 10; ++i) {
+        noisy.push_back(service.hash("noisy", "pw"));
+    }
+    std::vector<std::future<std::string>> quiet;
+    for (int i = 0; i < 2; ++i) {
+        quiet.push_back(service.hash("quiet", "pw"));
+    }
+    EXPECT_GE(service.metrics().tenant_queue_depth["noisy"], 8u);
+
+    for (auto& result : quiet) {
+        result.wait();
+    }
+    size_t noisy_done = 0;
+    for (auto& result : noisy) {
+        noisy_done += isReady(result);
+    }
+    EXPECT_LE(noisy_done, 4u);
+    for (auto& result : noisy) {
+        result.wait();
+    }
+}
+
+TEST_F(Argon2HashServiceTest, QueuedJobsExpireAtTheirDeadline) {
+    Argon2HashService service(options(1, 1 << 14));
+    auto blocker = service.hash("t", "pw");
+    auto late = service.hash("t", "pw", Argon2HashService::Clock::now() + 1ms);
+    auto past = service.verify("u", "pw", blocker.get(), Argon2HashService::Clock::now() - 1ms);
+    EXPECT_THROW(late.get(), Argon2HashService::DeadlineExceeded);
+    EXPECT_THROW(past.get(), Argon2HashService::DeadlineExceeded);
+
+    auto metrics = service.metrics();
+    EXPECT_EQ(metrics.expired, 2u);
+    EXPECT_EQ(metrics.completed, 1u);
+}
+
+// The expiring jobs sit behind other work: one behind a queued job of
+// its own tenant, one behind another tenant's head that waits for memory.
+// Both must fail at their deadline, not when a worker reaches them
+TEST_F(Argon2HashServiceTest, ExpiredJobsFailWhereverTheyAreQueued) {
+    auto opts = options(1, 1 << 16, 1);
+    opts.max_queue_per_tenant = 2;
+    Argon2HashService service(opts);
+    auto blocker = service.hash("a", "pw");
+    while (service.metrics().running == 0) {
+        std::this_thread::yield();
+    }
+    auto queued = service.hash("a", "pw");
+    auto behind_own = service.hash("a", "pw", Argon2HashService::Clock::now() + 5ms);
+    auto head = service.hash("b", "pw");
+    auto behind_other = service.hash("b", "pw", Argon2HashService::Clock::now() + 5ms);
+
+    EXPECT_THROW(behind_own.get(), Argon2HashService::DeadlineExceeded);
+    EXPECT_THROW(behind_other.get(), Argon2HashService::DeadlineExceeded);
+    EXPECT_FALSE(isReady(queued));
+    EXPECT_FALSE(isReady(head));
+
+    // The expired job no longer counts against tenant "a"'s queue limit
+    auto refill = service.hash("a", "pw");
+    EXPECT_FALSE(blocker.get().empty());
+    EXPECT_FALSE(queued.get().empty());
+    EXPECT_FALSE(head.get().empty());
+    EXPECT_FALSE(refill.get().empty());
+
+    auto metrics = service.metrics();
+    EXPECT_EQ(metrics.expired, 2u);
+    EXPECT_EQ(metrics.rejected, 0u);
+    EXPECT_EQ(metrics.completed, 4u);
+}
+
+TEST_F(Argon2HashServiceTest, PerTenantQueueLimit) {
+    auto opts = options(1, 1 << 13);
+    opts.max_queue_per_tenant = 2;
+    Argon2HashService service(opts);
+    std::vector<std::future<std::string>> results;
+    for (int i = 0; i < 6; ++i) {
+        results.push_back(service.hash("a", "pw"));
+    }
+    auto other = service.hash("b", "pw");
+
+    size_t rejected = 0;
+    for (auto& result : results) {
+        try {
+            result.get();
+        } catch (const Argon2HashService::Rejected&) {
+            ++rejected;
+        }
+    }
+    EXPECT_GE(rejected, 3u);
+    EXPECT_FALSE(other.get().empty());
+    EXPECT_EQ(service.metrics().rejected, rejected);
+}
+
+TEST_F(Argon2HashServiceTest, DestructionFailsQueuedJobs) {
+    std::vector<std::future<bool>> results;
+    {
+        Argon2HashService service(options(1, 1 << 13));
+        std::string stored = service.hash("t", "pw").get();
+        for (int i = 0; i < 6; ++i) {
+            results.push_back(service.verify("t", "pw", stored));
+        }
+    }
+    size_t rejected = 0;
+    for (auto& result : results) {
+        ASSERT_TRUE(isReady(result));
+        try {
+            EXPECT_TRUE(result.get());
+        } catch (const Argon2HashService::Rejected&) {
+            ++rejected;
+        }
+    }
+    EXPECT_GE(rejected, 1u);
+}
+
+TEST_F(Argon2HashServiceTest, MetricsTrackQueueAndLatency) {
+    Argon2HashService service(options(1, 1 << 12));
+    std::vector<std::future<std::string>> results;
+    for (int i = 0; i < 8; ++i) {
+        results.push_back(service.hash(i % 2 ? "a" : "b", "pw"));
+    }
+    auto busy = service.metrics();
+    EXPECT_GE(busy.queue_depth + busy.running + busy.completed, 8u);
+    EXPECT_LE(busy.running, 1u);
+    for (auto& result : results) {
+        result.get();
+    }
+
+    auto done = service.metrics();
+    EXPECT_EQ(done.queue_depth, 0u);
+    EXPECT_TRUE(done.tenant_queue_depth.empty());
+    EXPECT_EQ(done.completed, 8u);
+    EXPECT_GT(done.latency_p50_ms, 0);
+    EXPECT_LE(done.latency_p50_ms, done.latency_p99_ms);
+    EXPECT_LE(done.latency_p99_ms, done.latency_max_ms);
+    EXPECT_LE(done.wait_p99_ms, done.latency_max_ms);
+}
+
+// Login storm: many verifies from several tenants against a budget that
+// holds a fraction of them at once
+TEST_F(Argon2HashServiceTest, LoginStormPerformance) {
+    auto opts = options(0, 1 << 12, 4);
+    Argon2HashService service(opts);
+    std::string stored = service.hash("setup", "password").get();
+
+    const int requests = 64;
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::future<bool>> results;
+    for (int i = 0; i < requests; ++i) {
+        results.push_back(service.verify("tenant-" + std::to_string(i % 4), "password", stored));
+    }
+    for (auto& result : results) {
+        EXPECT_TRUE(result.get());
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double total_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    auto metrics = service.metrics();
+    EXPECT_LE(metrics.memory_peak, opts.memory_budget);
+    std::cout << std::fixed << std::setprecision(2)
+              << "[PERF] " << requests << " verifies (4 MB, 4 in budget): " << total_ms << " ms, "
+              << requests * 1000.0 / total_ms << " verifies/sec, latency p50 " << metrics.latency_p50_ms
+              << " ms, p99 " << metrics.latency_p99_ms << " ms, peak memory "
+              << (metrics.memory_peak >> 20) << " MB\n";
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
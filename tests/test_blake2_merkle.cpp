@@ -0,0 +1,292 @@
+#include <gtest/gtest.h>
+#include "shsBlake2Merkle.hpp"
+#include "shsBlake2.hpp"
+#include <vector>
+#include <string>
+#include <random>
+#include <iomanip>
+#include <chrono>
+#include <sstream>
+#include <functional>
+
+using namespace std;
+
+class Blake2MerkleTest : public ::testing::Test {
+protected:
+    static vector<uint8_t> patternData(size_t length) {
+        vector<uint8_t> data(length);
+        for (size_t i = 0; i < length; ++i) data[i] = static_cast<uint8_t>(i % 251);
+        return data;
+    }
+
+    static vector<uint8_t> sliceOf(const vector<uint8_t>& data, uint64_t start, uint64_t length) {
+        if (start >= data.size()) return {};
+        size_t end = static_cast<size_t>(min<uint64_t>(data.size(), start + length));
+        return vector<uint8_t>(data.begin() + start, data.begin() + end);
+    }
+
+    // 1 KiB chunks keep the trees deep on small inputs
+    shsBlake2Merkle tree{1024};
+};
+
+static string toHex(const uint8_t* data, size_t length) {
+    ostringstream out;
+    for (size_t i = 0; i < length; ++i) {
+        out << hex << setw(2) << setfill('0') << static_cast<int>(data[i]);
+    }
+    return out.str();
+}
+
+TEST_F(Blake2MerkleTest, InvalidParameters) {
+    EXPECT_THROW(shsBlake2Merkle(512), invalid_argument);
+    EXPECT_THROW(shsBlake2Merkle(3000), invalid_argument);
+    EXPECT_THROW(shsBlake2Merkle(shsBlake2Merkle::MAX_CHUNK_SIZE * 2), invalid_argument);
+
+    vector<uint8_t> short_encoding(4);
+    EXPECT_THROW(tree.extract_slice(short_encoding.data(), short_encoding.size(), 0, 1),
+                 invalid_argument);
+
+    auto data = patternData(5000);
+    auto encoded = tree.encode(data.data(), data.size());
+    EXPECT_THROW(tree.extract_slice(encoded.encoding.data(), encoded.encoding.size() - 1, 0, 1),
+                 invalid_argument);
+    auto ob = tree.outboard(data.data(), data.size());
+    EXPECT_THROW(tree.extract_slice(ob.encoding.data(), ob.encoding.size(), data.data(), 4999, 0, 1),
+                 invalid_argument);
+}
+
+// Computed with an independent Python model of the tree (Blake2b-256 with
+// fanout 2, depth 255, leaf length 1024, personalization "ShS-Merkle-v1",
+// the input length as the root's salt)
+TEST_F(Blake2MerkleTest, KnownRoots) {
+    struct Vector {
+        size_t length;
+        const char* root;
+    };
+    const Vector vectors[] = {
+        {0, "68b4060b67808698a2fe658ac3f187f6cd96db2d9d43a93909b022b2c23dbda8"},
+        {1, "5ca78732f651e52cb90547d6e122e006fe37510fddbc6ae8dbe559f1c5a5cb1f"},
+        {1024, "5efadbf9f1d6aef4c974377bd2881db2bf567c116d17ee5be8000048eae6a46a"},
+        {1025, "721198ca7d6e6708d88f42f79f73ce6135a30998a4b99e245b6fd73b323a9f8a"},
+        {3000, "647880aab09c7a8ac41f0ddc49ff0a93efcc87b2f2fcea1d505086a6637d3410"},
+        {5000, "1c9855afe4405a3461baa1b19cd6019bedcacc418cb3eb299badc4e11e51c0de"},
+    };
+    for (const auto& v : vectors) {
+        auto data = patternData(v.length);
+        auto root = tree.root(data.data(), data.size());
+        EXPECT_EQ(toHex(root.data(), root.size()), v.root) << "length " << v.length;
+        EXPECT_EQ(tree.encode(data.data(), data.size()).root, root);
+        EXPECT_EQ(tree.outboard(data.data(), data.size()).root, root);
+    }
+
+    // Five chunks: header, four parents, the data
+    auto data = patternData(5000);
+    auto encoded = tree.encode(data.data(), data.size());
+    auto ob = tree.outboard(data.data(), data.size());
+    EXPECT_EQ(encoded.encoding.size(), 8 + 4 * 64 + 5000u);
+    EXPECT_EQ(ob.encoding.size(), 8 + 4 * 64u);
+    auto enc_digest = shsBlake2::hash(encoded.encoding, 32);
+    auto ob_digest = shsBlake2::hash(ob.encoding, 32);
+    EXPECT_EQ(toHex(enc_digest.data(), enc_digest.size()),
+              "7f96da1e4c8d854c84f23a0987cfc9d41d0b2b9f073669c17a2b4bf08bcb9737");
+    EXPECT_EQ(toHex(ob_digest.data(), ob_digest.size()),
+              "5a995e183c9a3c0d2f5ebb13b2990088c9184bf2e60dc0536622c7069f9a1e1b");
+}
+
+TEST_F(Blake2MerkleTest, ThreadCountDoesNotChangeRoot) {
+    auto data = patternData(3 * 1024 * 1024 + 17);
+    shsBlake2Merkle single(1024, 1);
+    shsBlake2Merkle parallel(1024, 0);
+    EXPECT_EQ(single.root(data.data(), data.size()), parallel.root(data.data(), data.size()));
+    EXPECT_EQ(single.encode(data.data(), data.size()).encoding,
+              parallel.encode(data.data(), data.size()).encoding);
+}
+
+TEST_F(Blake2MerkleTest, EncodeDecodeRoundTrip) {
+    for (size_t length : {0, 1, 1023, 1024, 1025, 2048, 5000, 65536, 100000}) {
+        auto data = patternData(length);
+        auto encoded = tree.encode(data.data(), data.size());
+        EXPECT_EQ(tree.decode(encoded.encoding.data(), encoded.encoding.size(), encoded.root), data)
+            << "length " << length;
+
+        // The whole range of an outboard encoding is the inline encoding
+        auto ob = tree.outboard(data.data(), data.size());
+        EXPECT_EQ(tree.extract_slice(ob.encoding.data(), ob.encoding.size(), data.data(),
+                                     data.size(), 0, length),
+                  encoded.encoding);
+    }
+}
+
+TEST_F(Blake2MerkleTest, SlicesVerifyAgainstRoot) {
+    auto data = patternData(37 * 1024 + 300);
+    auto encoded = tree.encode(data.data(), data.size());
+    auto ob = tree.outboard(data.data(), data.size());
+
+    mt19937 gen(42);
+    uniform_int_distribution<uint64_t> pos(0, data.size() + 2048);
+    uniform_int_distribution<uint64_t> len(0, 8192);
+    for (int i = 0; i < 200; ++i) {
+        uint64_t start = pos(gen);
+        uint64_t length = len(gen);
+        auto slice = tree.extract_slice(encoded.encoding.data(), encoded.encoding.size(),
+                                        start, length);
+        EXPECT_EQ(tree.extract_slice(ob.encoding.data(), ob.encoding.size(), data.data(),
+                                     data.size(), start, length),
+                  slice);
+        EXPECT_LT(slice.size(), encoded.encoding.size() / 2);
+        EXPECT_EQ(tree.decode_slice(slice.data(), slice.size(), encoded.root, start, length),
+                  sliceOf(data, start, length))
+            << "start " << start << " length " << length;
+    }
+}
+
+TEST_F(Blake2MerkleTest, StreamingDecoder) {
+    auto data = patternData(20 * 1024 + 5);
+    auto encoded = tree.encode(data.data(), data.size());
+    const uint64_t start = 3000, length = 9000;
+    auto slice = tree.extract_slice(encoded.encoding.data(), encoded.encoding.size(), start, length);
+
+    // Byte at a time: data becomes available chunk by chunk
+    shsBlake2Merkle::SliceDecoder decoder(tree, encoded.root, start, length);
+    vector<uint8_t> out;
+    size_t emitted_early = 0;
+    for (size_t i = 0; i < slice.size(); ++i) {
+        decoder.update(&slice[i], 1, out);
+        if (i + 1 < slice.size()) emitted_early = out.size();
+    }
+    EXPECT_TRUE(decoder.finished());
+    EXPECT_EQ(decoder.content_length(), data.size());
+    EXPECT_EQ(out, sliceOf(data, start, length));
+    EXPECT_GT(emitted_early, 0u);
+
+    // Random pieces
+    mt19937 gen(7);
+    uniform_int_distribution<size_t> piece(0, 3000);
+    shsBlake2Merkle::SliceDecoder chunked(tree, encoded.root, start, length);
+    out.clear();
+    for (size_t pos = 0; pos < slice.size();) {
+        size_t n = min(piece(gen), slice.size() - pos);
+        chunked.update(slice.data() + pos, n, out);
+        pos += n;
+    }
+    EXPECT_TRUE(chunked.finished());
+    EXPECT_EQ(out, sliceOf(data, start, length));
+}
+
+TEST_F(Blake2MerkleTest, RejectsTampering) {
+    auto data = patternData(9 * 1024);
+    auto encoded = tree.encode(data.data(), data.size());
+    const auto& enc = encoded.encoding;
+    const uint8_t* p = enc.data();
+
+    auto wrong_root = encoded.root;
+    wrong_root[0] ^= 1;
+    EXPECT_THROW(tree.decode(p, enc.size(), wrong_root), runtime_error);
+
+    // Any flipped bit in the header, a parent or a chunk is caught
+    for (size_t offset : {size_t(0), size_t(8), size_t(8 + 64 + 5), enc.size() - 1}) {
+        vector<uint8_t> bad(enc);
+        bad[offset] ^= 0x80;
+        EXPECT_THROW(tree.decode(bad.data(), bad.size(), encoded.root), runtime_error)
+            << "offset " << offset;
+    }
+
+    // Truncated or padded encodings
+    EXPECT_THROW(tree.decode(p, enc.size() - 1, encoded.root), runtime_error);
+    vector<uint8_t> padded(enc);
+    padded.push_back(0);
+    EXPECT_THROW(tree.decode(padded.data(), padded.size(), encoded.root), runtime_error);
+
+    // A claimed length that shortens the file is caught at the root
+    vector<uint8_t> shorter(enc);
+    shorter[0] = 0xff;
+    shorter[1] = 0x23;
+    shorter.pop_back();
+    EXPECT_THROW(tree.decode(shorter.data(), shorter.size(), encoded.root), runtime_error);
+
+    // Verified chunks ahead of a corrupted one are still delivered
+    vector<uint8_t> bad(enc);
+    bad[enc.size() - 1] ^= 1;
+    shsBlake2Merkle::SliceDecoder decoder(tree, encoded.root, 0, data.size());
+    vector<uint8_t> out;
+    EXPECT_THROW(decoder.update(bad.data(), bad.size(), out), runtime_error);
+    EXPECT_EQ(out, sliceOf(data, 0, 8 * 1024));
+}
+
+// A forged length with the same chunk count keeps the tree shape, so the
+// slice's own parents and chunks would all verify; only the root binds it
+TEST_F(Blake2MerkleTest, ForgedLengthFailsOnSlicesBeforeTheTail) {
+    auto data = patternData(8 * 1024);
+    auto encoded = tree.encode(data.data(), data.size());
+    for (uint64_t start : {uint64_t(0), uint64_t(3 * 1024)}) {
+        auto slice = tree.extract_slice(encoded.encoding.data(), encoded.encoding.size(), start, 1024);
+        ASSERT_EQ(tree.decode_slice(slice.data(), slice.size(), encoded.root, start, 1024),
+                  sliceOf(data, start, 1024));
+
+        vector<uint8_t> forged(slice);
+        const uint64_t fake = 7 * 1024 + 1;
+        for (size_t i = 0; i < 8; ++i) {
+            forged[i] = static_cast<uint8_t>(fake >> (8 * i));
+        }
+        EXPECT_THROW(tree.decode_slice(forged.data(), forged.size(), encoded.root, start, 1024),
+                     runtime_error) << "start " << start;
+
+        // The streaming decoder fails before emitting anything
+        shsBlake2Merkle::SliceDecoder decoder(tree, encoded.root, start, 1024);
+        vector<uint8_t> out;
+        EXPECT_THROW(decoder.update(forged.data(), forged.size(), out), runtime_error);
+        EXPECT_TRUE(out.empty());
+    }
+}
+
+TEST_F(Blake2MerkleTest, EmptyAndPastEndRanges) {
+    auto data = patternData(4100);
+    auto encoded = tree.encode(data.data(), data.size());
+
+    // Both reach the last chunk so the length is proven
+    for (uint64_t start : {uint64_t(10), uint64_t(4100), uint64_t(1) << 40}) {
+        auto slice = tree.extract_slice(encoded.encoding.data(), encoded.encoding.size(), start, 0);
+        EXPECT_TRUE(tree.decode_slice(slice.data(), slice.size(), encoded.root, start, 0).empty());
+    }
+    auto slice = tree.extract_slice(encoded.encoding.data(), encoded.encoding.size(), 5000, 100);
+    shsBlake2Merkle::SliceDecoder decoder(tree, encoded.root, 5000, 100);
+    vector<uint8_t> out;
+    decoder.update(slice.data(), slice.size(), out);
+    EXPECT_TRUE(decoder.finished());
+    EXPECT_TRUE(out.empty());
+    EXPECT_EQ(decoder.content_length(), 4100u);
+}
+
+TEST_F(Blake2MerkleTest, PerformanceBuildAndVerify) {
+    const size_t size = 64 * 1024 * 1024;
+    vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) data[i] = static_cast<uint8_t>(i * 31 + (i >> 13));
+
+    auto measure = [&](const function<void()>& run) {
+        auto start = chrono::high_resolution_clock::now();
+        run();
+        auto end = chrono::high_resolution_clock::now();
+        return 64.0 / chrono::duration<double>(end - start).count();
+    };
+
+    shsBlake2Merkle single(shsBlake2Merkle::DEFAULT_CHUNK_SIZE, 1);
+    shsBlake2Merkle parallel;
+    shsBlake2Merkle::Encoded encoded;
+    cout << "\n64 MB, 16 KiB chunks:\n";
+    cout << "Blake2b:                 " << setw(8) << fixed << setprecision(1)
+         << measure([&] { shsBlake2::hash(data); }) << " MB/s\n";
+    cout << "outboard(), 1 thread:    " << setw(8)
+         << measure([&] { single.outboard(data.data(), data.size()); }) << " MB/s\n";
+    cout << "encode(), all threads:   " << setw(8)
+         << measure([&] { encoded = parallel.encode(data.data(), data.size()); }) << " MB/s\n";
+    cout << "decode(), all threads:   " << setw(8)
+         << measure([&] {
+                EXPECT_EQ(parallel.decode(encoded.encoding.data(), encoded.encoding.size(),
+                                          encoded.root).size(), size);
+            }) << " MB/s\n";
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
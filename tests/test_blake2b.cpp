@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "shsBlake2.hpp"
+#include "blake2b-compress.h"
 #include <vector>
 #include <string>
 #include <array>
@@ -7,6 +8,11 @@
 #include <cstring>
 #include <iomanip>
 #include <functional>
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+#include <chrono>
+#include <sstream>
 
 using namespace std;
 
@@ -214,6 +220,705 @@ TEST_F(Blake2Test, PerformanceTestDifferentSizes) {
     cout << "-------------------------------------------------\n";
 }
 
+TEST_F(Blake2Test, HashFile) {
+    char name[] = "/tmp/shs_blake2_XXXXXX";
+    int fd = mkstemp(name);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+
+    // Below and above the mmap threshold
+    for (size_t size : {size_t(0), size_t(1000), size_t(3 * 1024 * 1024 + 17)}) {
+        auto data = generateRandomData(size);
+        ofstream(name, ios::binary | ios::trunc).write(reinterpret_cast<const char*>(data.data()), data.size());
+
+        auto result = shsBlake2::hash_file(name);
+        EXPECT_EQ(result.digest, shsBlake2::hash(data)) << "size=" << size;
+        EXPECT_EQ(result.bytes, size);
+        EXPECT_EQ(shsBlake2::hash_file(name, 32).digest, shsBlake2::hash(data, 32));
+    }
+    remove(name);
+    EXPECT_THROW(shsBlake2::hash_file("/nonexistent/shs_blake2"), runtime_error);
+}
+
+static string toHex(const vector<uint8_t>& data) {
+    ostringstream out;
+    for (auto byte : data) {
+        out << hex << setw(2) << setfill('0') << static_cast<int>(byte);
+    }
+    return out.str();
+}
+
+TEST_F(Blake2Test, KnownVectors) {
+    EXPECT_EQ(toHex(shsBlake2::hash(string(""))),
+              "786a02f742015903c6c6fd852552d272912f4740e15847618a86e217f71f5419"
+              "d25e1031afee585313896444934eb04b903a685b1448b755d56f701afe9be2ce");
+    EXPECT_EQ(toHex(shsBlake2::hash(string("abc"))),
+              "ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d1"
+              "7d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923");
+
+    vector<uint8_t> key(64), data(1024);
+    for (size_t i = 0; i < key.size(); ++i) key[i] = static_cast<uint8_t>(i);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = static_cast<uint8_t>(i);
+    EXPECT_EQ(toHex(shsBlake2::hash_keyed(data, key)),
+              "199c1d5b4f38a954adcaf5f29e2a4792ee3107b813f9a198ae373498690bc93b"
+              "57ae16c86c039cb429fb6dd02d05e12a85392c90d46dd9320d143828d3df3266");
+}
+
+// Every SIMD kernel the CPU can run against the portable compression
+static vector<pair<const char*, blake2b_compress_fn>> availableKernels() {
+    vector<pair<const char*, blake2b_compress_fn>> kernels = {{"portable", blake2b_compress_portable}};
+#ifdef BLAKE2B_HAVE_SIMD
+    if (shs_cpu_has_ssse3()) kernels.push_back({"ssse3", blake2b_compress_ssse3});
+    if (shs_cpu_has_sse41()) kernels.push_back({"sse41", blake2b_compress_sse41});
+    if (shs_cpu_has_avx2()) kernels.push_back({"avx2", blake2b_compress_avx2});
+#endif
+    return kernels;
+}
+
+TEST_F(Blake2Test, CompressKernelsMatchPortable) {
+    for (int trial = 0; trial < 100; ++trial) {
+        blake2b_state base;
+        auto bytes = generateRandomData(sizeof(base.h) + sizeof(base.t) + sizeof(base.f) + BLAKE2B_BLOCKBYTES);
+        memcpy(base.h, bytes.data(), sizeof(base.h));
+        memcpy(base.t, bytes.data() + 64, sizeof(base.t));
+        memcpy(base.f, bytes.data() + 80, sizeof(base.f));
+        const uint8_t* block = bytes.data() + 96;
+
+        blake2b_state expected = base;
+        blake2b_compress_portable(&expected, block);
+        for (auto& kernel : availableKernels()) {
+            blake2b_state state = base;
+            kernel.second(&state, block);
+            ASSERT_EQ(memcmp(state.h, expected.h, sizeof(state.h)), 0) << kernel.first;
+        }
+    }
+}
+
+TEST_F(Blake2Test, PerformanceCompressBackends) {
+    const int blocks = 200000;
+    auto data = generateRandomData(BLAKE2B_BLOCKBYTES);
+
+    cout << "\nBlake2b compression by backend (selected: " << blake2b_compress_backend() << "):\n";
+    for (auto& kernel : availableKernels()) {
+        blake2b_state state = {};
+        auto start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < blocks; ++i) {
+            kernel.second(&state, data.data());
+        }
+        auto end = chrono::high_resolution_clock::now();
+        double seconds = chrono::duration<double>(end - start).count();
+        cout << setw(10) << kernel.first << ": " << setw(8) << fixed << setprecision(1)
+             << blocks * double(BLAKE2B_BLOCKBYTES) / seconds / (1024 * 1024) << " MB/s\n";
+    }
+}
+
+TEST_F(Blake2Test, ParallelKnownVectors) {
+    EXPECT_EQ(toHex(shsBlake2::hash_parallel(string(""))),
+              "b5ef811a8038f70b628fa8b294daae7492b1ebe343a80eaabbf1f6ae664dd67b"
+              "9d90b0120791eab81dc96985f28849f6a305186a85501b405114bfa678df9380");
+    EXPECT_EQ(toHex(shsBlake2::hash_parallel(vector<uint8_t>{'a', 'b', 'c'}, 32)),
+              "4792f00c05827a437fc55481e447eea1c9a39add28087733b3e53f1c04430dc7");
+
+    // blake2bp-kat.txt: key = 00..3f, in = 00..(n-1)
+    const vector<pair<size_t, string>> kat = {
+        {0, "9d9461073e4eb640a255357b839f394b838c6ff57c9b686a3f76107c1066728f"
+            "3c9956bd785cbc3bf79dc2ab578c5a0c063b9d9c405848de1dbe821cd05c940a"},
+        {1, "ff8e90a37b94623932c59f7559f26035029c376732cb14d41602001cbb73adb7"
+            "9293a2dbda5f60703025144d158e2735529596251c73c0345ca6fccb1fb1e97e"},
+        {127, "7926708859e6e2ab68f604da69a9fb5087bb33f4e8d895730e301ab2d7df748b"
+              "67df0b6b8622e52dd57d8d3ad87d5820d4ecfd24178b2d2b78d64f4fbd387582"},
+        {128, "9280f4d1157032ab315c100d636283fbf4fba2fbad0f8bc020721d76bc1c8973"
+              "ced28871cc907dab60e59756987b0e0f867fa2fe9d9041f2c9618074e44fe5e9"},
+        {129, "5530c2d59f144872e987e4e258a7d8c38ce844e2cc2eed940ffc683b498815e5"
+              "3adb1faaf568946122805ac3b8e2fed435fed6162e76f564e586ba464424e885"},
+        {255, "96fbcbb60bd313b8845033e5bc058a38027438572d7e7957f3684f6268aadd3a"
+              "d08d21767ed6878685331ba98571487e12470aad669326716e46667f69f8d7e8"},
+    };
+    vector<uint8_t> key(64), data(255);
+    for (size_t i = 0; i < key.size(); ++i) key[i] = static_cast<uint8_t>(i);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = static_cast<uint8_t>(i);
+    for (auto& entry : kat) {
+        shsBlake2 hasher(shsBlake2::Mode::Parallel, key.data(), key.size());
+        hasher.update(data.data(), entry.first);
+        EXPECT_EQ(toHex(hasher.finalize()), entry.second) << "n=" << entry.first;
+    }
+}
+
+TEST_F(Blake2Test, ParallelStreamingMatchesOneShot) {
+    vector<uint8_t> data(5000);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = static_cast<uint8_t>(i % 251);
+    EXPECT_EQ(toHex(shsBlake2::hash_parallel(data)),
+              "8b33d6034750171716d5951a7e8df9cd7188ed2b859de92a53c0c61f48007b85"
+              "ee78679522636897950b0143c49c522e58f0531ab3c88329e276428ac98938bd");
+
+    // Stripe boundaries (512 bytes) and pending-block edges, odd chunking
+    mt19937 gen(42);
+    for (size_t length : {size_t(0), size_t(511), size_t(512), size_t(513), size_t(1023),
+                          size_t(1024), size_t(1536), size_t(1537), size_t(5000)}) {
+        vector<uint8_t> input(data.begin(), data.begin() + length);
+        auto expected = shsBlake2::hash_parallel(input);
+        shsBlake2 hasher(shsBlake2::Mode::Parallel);
+        size_t offset = 0;
+        while (offset < length) {
+            size_t chunk = min<size_t>(gen() % 700, length - offset);
+            hasher.update(input.data() + offset, chunk);
+            offset += chunk;
+        }
+        EXPECT_EQ(hasher.finalize(), expected) << "length=" << length;
+    }
+    EXPECT_NE(shsBlake2::hash_parallel(data), shsBlake2::hash(data));
+}
+
+TEST_F(Blake2Test, CompressX4MatchesPortable) {
+    blake2b_state states[4], expected[4];
+    blake2b_state* lanes[4];
+    const uint8_t* blocks[4];
+    auto bytes = generateRandomData(4 * (96 + BLAKE2B_BLOCKBYTES));
+    for (int i = 0; i < 4; ++i) {
+        const uint8_t* p = bytes.data() + i * (96 + BLAKE2B_BLOCKBYTES);
+        memcpy(states[i].h, p, sizeof(states[i].h));
+        memcpy(states[i].t, p + 64, sizeof(states[i].t));
+        memcpy(states[i].f, p + 80, sizeof(states[i].f));
+        blocks[i] = p + 96;
+        lanes[i] = &states[i];
+        expected[i] = states[i];
+        blake2b_compress_portable(&expected[i], blocks[i]);
+    }
+    blake2b_compress_x4(lanes, blocks);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(memcmp(states[i].h, expected[i].h, sizeof(states[i].h)), 0) << "lane " << i;
+    }
+}
+
+TEST_F(Blake2Test, PerformanceParallel) {
+    auto data = generateRandomData(16 * 1024 * 1024);
+
+    auto start_seq = chrono::high_resolution_clock::now();
+    shsBlake2::hash(data);
+    auto end_seq = chrono::high_resolution_clock::now();
+
+    auto start_par = chrono::high_resolution_clock::now();
+    shsBlake2::hash_parallel(data);
+    auto end_par = chrono::high_resolution_clock::now();
+
+    auto mbs = [&](chrono::high_resolution_clock::time_point a, chrono::high_resolution_clock::time_point b) {
+        return 16.0 / chrono::duration<double>(b - a).count();
+    };
+    cout << "\nBlake2b vs BLAKE2bp, 16 MB, one thread:\n";
+    cout << "Blake2b:  " << setw(8) << fixed << setprecision(1) << mbs(start_seq, end_seq) << " MB/s\n";
+    cout << "BLAKE2bp: " << setw(8) << mbs(start_par, end_par) << " MB/s\n";
+}
+
+TEST_F(Blake2Test, CompressX8MatchesPortable) {
+    blake2b_state states[8], expected[8];
+    blake2b_state* lanes[8];
+    const uint8_t* blocks[8];
+    auto bytes = generateRandomData(8 * (96 + BLAKE2B_BLOCKBYTES));
+    for (int i = 0; i < 8; ++i) {
+        const uint8_t* p = bytes.data() + i * (96 + BLAKE2B_BLOCKBYTES);
+        memcpy(states[i].h, p, sizeof(states[i].h));
+        memcpy(states[i].t, p + 64, sizeof(states[i].t));
+        memcpy(states[i].f, p + 80, sizeof(states[i].f));
+        blocks[i] = p + 96;
+        lanes[i] = &states[i];
+        expected[i] = states[i];
+        blake2b_compress_portable(&expected[i], blocks[i]);
+    }
+    blake2b_compress_x8(lanes, blocks);
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_EQ(memcmp(states[i].h, expected[i].h, sizeof(states[i].h)), 0) << "lane " << i;
+    }
+}
+
+TEST_F(Blake2Test, BatchMatchesSequential) {
+    mt19937 gen(1234);
+    auto pool = generateRandomData(20000);
+    auto key = generateRandomData(shsBlake2::MAX_KEY_SIZE);
+
+    // Lengths around block edges, keyed and unkeyed, mixed output sizes
+    vector<shsBlake2::BatchMessage> messages;
+    vector<vector<uint8_t>> expected;
+    size_t total_out = 0;
+    for (size_t n = 0; n < 61; ++n) {
+        size_t length = n < 20 ? n * 64 : gen() % 9000;
+        size_t offset = gen() % (pool.size() - length);
+        size_t outlen = 1 + gen() % 64;
+        size_t keylen = n % 3 == 0 ? 0 : 1 + gen() % 64;
+        messages.push_back({pool.data() + offset, length, outlen,
+                            keylen ? key.data() : nullptr, keylen});
+        expected.push_back(keylen
+            ? shsBlake2::hash_keyed(pool.data() + offset, length, key.data(), keylen, outlen)
+            : shsBlake2::hash(pool.data() + offset, length, outlen));
+        total_out += outlen;
+    }
+
+    for (size_t count : {size_t(1), size_t(3), size_t(8), size_t(9), messages.size()}) {
+        vector<uint8_t> out(total_out + 1, 0xAA);
+        shsBlake2::hash_batch(messages.data(), count, out.data());
+        size_t pos = 0;
+        for (size_t i = 0; i < count; ++i) {
+            EXPECT_EQ(vector<uint8_t>(out.begin() + pos, out.begin() + pos + messages[i].output_length),
+                      expected[i]) << "count=" << count << " message " << i;
+            pos += messages[i].output_length;
+        }
+        EXPECT_EQ(out[pos], 0xAA);
+    }
+
+    shsBlake2::BatchMessage bad{pool.data(), 10, 65};
+    uint8_t out[128];
+    EXPECT_THROW(shsBlake2::hash_batch(&bad, 1, out), invalid_argument);
+    bad.output_length = 32;
+    bad.key_length = 65;
+    bad.key = key.data();
+    EXPECT_THROW(shsBlake2::hash_batch(&bad, 1, out), invalid_argument);
+    EXPECT_GE(shsBlake2::batch_lanes(), 1u);
+}
+
+TEST_F(Blake2Test, PerformanceBatch) {
+    const size_t count = 4096;
+    auto pool = generateRandomData(count * 8192);
+    mt19937 gen(99);
+    vector<shsBlake2::BatchMessage> messages;
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t length = 1024 + gen() % 7169;
+        messages.push_back({pool.data() + i * 8192, length, 32});
+        bytes += length;
+    }
+    vector<uint8_t> out(count * 32);
+
+    auto start_seq = chrono::high_resolution_clock::now();
+    for (const auto& m : messages) {
+        auto digest = shsBlake2::hash(m.data, m.length, 32);
+        memcpy(out.data(), digest.data(), 32);
+    }
+    auto end_seq = chrono::high_resolution_clock::now();
+
+    auto start_batch = chrono::high_resolution_clock::now();
+    shsBlake2::hash_batch(messages, out.data());
+    auto end_batch = chrono::high_resolution_clock::now();
+
+    auto mbs = [&](chrono::high_resolution_clock::time_point a, chrono::high_resolution_clock::time_point b) {
+        return bytes / 1e6 / chrono::duration<double>(b - a).count();
+    };
+    cout << "\nBlake2b on 1-8 KB chunks (" << shsBlake2::batch_lanes() << " lanes):\n";
+    cout << "hash():       " << setw(8) << fixed << setprecision(1) << mbs(start_seq, end_seq) << " MB/s\n";
+    cout << "hash_batch(): " << setw(8) << mbs(start_batch, end_batch) << " MB/s\n";
+}
+
+TEST_F(Blake2Test, TemplateMatchesDirectHashing) {
+    auto key = generateRandomData(48);
+    auto data = generateRandomData(1000);
+
+    shsBlake2::Template plain(40);
+    shsBlake2::Template keyed(key.data(), key.size());
+    shsBlake2::Template salted(test_salt, test_personal, 24);
+    EXPECT_EQ(keyed.output_length(), 64u);
+
+    for (size_t length : {size_t(0), size_t(1), size_t(127), size_t(128), size_t(129), size_t(1000)}) {
+        auto expected_keyed = shsBlake2::hash_keyed(data.data(), length, key.data(), key.size());
+        EXPECT_EQ(keyed.hash(data.data(), length), expected_keyed) << "length=" << length;
+        EXPECT_EQ(plain.hash(data.data(), length), shsBlake2::hash(data.data(), length, 40));
+
+        shsBlake2 direct(test_salt, test_personal, 24);
+        direct.update(data.data(), length);
+        EXPECT_EQ(salted.hash(data.data(), length), direct.finalize());
+
+        // Streaming hashers stamped from the template, split updates
+        shsBlake2 stamped(keyed);
+        stamped.update(data.data(), length / 3);
+        stamped.update(data.data() + length / 3, length - length / 3);
+        EXPECT_EQ(stamped.finalize(), expected_keyed) << "length=" << length;
+    }
+
+    // Salt, personalization and key together; values from Python hashlib
+    array<uint8_t, 16> salt, personal;
+    vector<uint8_t> key32(32);
+    for (int i = 0; i < 16; ++i) { salt[i] = uint8_t(i + 1); personal[i] = uint8_t(16 - i); }
+    for (int i = 0; i < 32; ++i) key32[i] = uint8_t(i);
+    shsBlake2::Template all(salt, personal, 32, key32.data(), key32.size());
+    EXPECT_EQ(toHex(all.hash(nullptr, 0)),
+              "58fa671d499859bc3fb5702f183ad3e482083af20afd6da5c2f8a50c75f6a7f0");
+    EXPECT_EQ(toHex(all.hash("abc", 3)),
+              "29b4b08fbf322ce2a4d87a96542198884c5a918d24b37eae3378bc6f15999172");
+
+    EXPECT_THROW(shsBlake2::Template(0), invalid_argument);
+    EXPECT_THROW(shsBlake2::Template(key.data(), 65), invalid_argument);
+}
+
+TEST_F(Blake2Test, TemplateBatch) {
+    auto key = generateRandomData(64);
+    shsBlake2::Template mac(key.data(), key.size(), 32);
+
+    auto pool = generateRandomData(40000);
+    vector<const void*> data;
+    vector<size_t> lengths;
+    for (size_t i = 0; i < 37; ++i) {
+        size_t length = i < 5 ? i * 64 : 64 + (i * 997) % 3000;
+        data.push_back(pool.data() + i * 1000);
+        lengths.push_back(length);
+    }
+    vector<uint8_t> out(data.size() * 32);
+    shsBlake2::hash_batch(mac, data.data(), lengths.data(), data.size(), out.data());
+    for (size_t i = 0; i < data.size(); ++i) {
+        EXPECT_EQ(vector<uint8_t>(out.begin() + i * 32, out.begin() + (i + 1) * 32),
+                  shsBlake2::hash_keyed(data[i], lengths[i], key.data(), key.size(), 32))
+            << "message " << i;
+    }
+}
+
+TEST_F(Blake2Test, PerformanceTemplateMac) {
+    const size_t count = 200000;
+    auto key = generateRandomData(32);
+    auto messages = generateRandomData(count * 64);
+    vector<uint8_t> out(count * 32);
+
+    auto start_keyed = chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        auto tag = shsBlake2::hash_keyed(messages.data() + i * 64, 64, key.data(), key.size(), 32);
+        memcpy(out.data() + i * 32, tag.data(), 32);
+    }
+    auto end_keyed = chrono::high_resolution_clock::now();
+
+    shsBlake2::Template mac(key.data(), key.size(), 32);
+    auto start_template = chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        mac.hash(messages.data() + i * 64, 64, out.data() + i * 32);
+    }
+    auto end_template = chrono::high_resolution_clock::now();
+
+    vector<const void*> data(count);
+    vector<size_t> lengths(count, 64);
+    for (size_t i = 0; i < count; ++i) data[i] = messages.data() + i * 64;
+    auto start_batch = chrono::high_resolution_clock::now();
+    shsBlake2::hash_batch(mac, data.data(), lengths.data(), count, out.data());
+    auto end_batch = chrono::high_resolution_clock::now();
+
+    auto rate = [&](chrono::high_resolution_clock::time_point a, chrono::high_resolution_clock::time_point b) {
+        return count / 1e6 / chrono::duration<double>(b - a).count();
+    };
+    cout << "\nKeyed Blake2b on 64-byte messages:\n";
+    cout << "hash_keyed():          " << setw(8) << fixed << setprecision(2) << rate(start_keyed, end_keyed) << " M msg/s\n";
+    cout << "Template::hash():      " << setw(8) << rate(start_template, end_template) << " M msg/s\n";
+    cout << "hash_batch(Template):  " << setw(8) << rate(start_batch, end_batch) << " M msg/s\n";
+}
+
+TEST_F(Blake2Test, XofKnownVectors) {
+    // BLAKE2Xb keyed test vectors: key = 00..3f, input = 00..ff
+    vector<uint8_t> key(64), input(256);
+    for (size_t i = 0; i < key.size(); ++i) key[i] = static_cast<uint8_t>(i);
+    for (size_t i = 0; i < input.size(); ++i) input[i] = static_cast<uint8_t>(i);
+    auto keyed = [&](size_t outlen) {
+        return toHex(shsBlake2::hash_xof(input.data(), input.size(), outlen, key.data(), key.size()));
+    };
+    EXPECT_EQ(keyed(1), "64");
+    EXPECT_EQ(keyed(2), "f457");
+    EXPECT_EQ(keyed(3), "e8c045");
+    EXPECT_EQ(keyed(4), "a74c6d0d");
+    EXPECT_EQ(keyed(64),
+              "4324561d76c370ef35ac36a4adf8f3773a50d86504bd284f71f7ce9e2bc4c1f1"
+              "d34a7fb2d67561d101955d448b67577eb30dfee96a95c7f921ef53e20be8bc44");
+    EXPECT_EQ(keyed(65),
+              "78f0ed6e220b3da3cc9381563b2f72c8dc830cb0f39a48c6ae479a6a78dcfa94"
+              "002631dec467e9e9b47cc8f0887eb680e340aec3ec009d4a33d241533c76c8ca8c");
+
+    EXPECT_EQ(toHex(shsBlake2::hash_xof(string("abc").data(), 3, 200)),
+              "875d1e08561cc98d8edeee60ed59b140a6a436e588f7c00de35f5972f7e48da0"
+              "f892abc9bddccdade1eaaf9b31831a7e5d3148c991233ce1bd9ffe83978645c0"
+              "43702563c27b11d954a1cae8557a8b637a279d0e56d7d2df7305e95b3f927dd0"
+              "fb31e3e4b400906caf9830c0d8df9d4bba262583667a447f6ce555c2b117c646"
+              "1367f25781140d0ba50314442eac0624da4a07876881ba24186d9a5e386a3b0d"
+              "3120f758016284bf2f0c674d07d4941655f51332a0fc4ccd1b8f8d2d6686bae9"
+              "24becc4771d7732f");
+
+    // Unknown length: every block is a full digest
+    shsBlake2 open(shsBlake2::Mode::XOF, shsBlake2::XOF_UNKNOWN_LENGTH);
+    open.update(string("abc"));
+    EXPECT_EQ(toHex(open.squeeze(130)),
+              "ae080c1efbcf7f60ed52a04161d02b7ee63bed362534f0661da02c6e40cd2089"
+              "46d066b86b3dff620e57acea9cd72d3056cf6cb0c18341452a17ce2cced67b70"
+              "2669bf0bed358c1b708e97de2533b294cdd5e9e229678be36399b5b28d6541c4"
+              "bc4e3079fb8a0fbdf6023a65f36c654947ce7c114a243670dad347f03275b5c5"
+              "bd38");
+    EXPECT_THROW(open.finalize(), invalid_argument);
+    EXPECT_THROW(open.update(string("more")), runtime_error);
+}
+
+TEST_F(Blake2Test, XofSqueezeAndSeek) {
+    vector<uint8_t> key(64), input(256);
+    for (size_t i = 0; i < key.size(); ++i) key[i] = static_cast<uint8_t>(i);
+    for (size_t i = 0; i < input.size(); ++i) input[i] = static_cast<uint8_t>(i);
+    const size_t total = 3000000;
+
+    // Large reads go through the parallel path
+    shsBlake2 whole(shsBlake2::Mode::XOF, key.data(), key.size(), total);
+    whole.update(input);
+    auto expected = whole.finalize();
+    ASSERT_EQ(expected.size(), total);
+    EXPECT_EQ(toHex(vector<uint8_t>(expected.end() - 20, expected.end())),
+              "77cfa29652bb93a0f895fb5bd9db1838484e91fd");
+
+    // Incremental squeezes of odd sizes produce the same stream
+    shsBlake2 pieces(shsBlake2::Mode::XOF, key.data(), key.size(), total);
+    pieces.update(input.data(), 100);
+    pieces.update(input.data() + 100, 156);
+    mt19937 gen(5);
+    size_t pos = 0;
+    while (pos < 200000) {
+        size_t n = gen() % 300;
+        ASSERT_EQ(pieces.squeeze(n), vector<uint8_t>(expected.begin() + pos, expected.begin() + pos + n));
+        pos += n;
+    }
+
+    // Seek to an unaligned offset, then read across many blocks
+    pieces.seek(1234567);
+    EXPECT_EQ(toHex(pieces.squeeze(40)),
+              "44093af12e69bae54209886515378ba85b3d8a2f20d46d126577bbdbd8abfce7"
+              "7a3f4c1e1a000643");
+    pieces.seek(999999);
+    EXPECT_EQ(pieces.squeeze(1500000),
+              vector<uint8_t>(expected.begin() + 999999, expected.begin() + 2499999));
+
+    pieces.seek(total - 10);
+    EXPECT_EQ(pieces.squeeze(10).size(), 10u);
+    EXPECT_THROW(pieces.squeeze(1), invalid_argument);
+    EXPECT_THROW(pieces.seek(total + 1), invalid_argument);
+
+    shsBlake2 plain;
+    EXPECT_THROW(plain.squeeze(10), runtime_error);
+    EXPECT_THROW(shsBlake2(shsBlake2::Mode::XOF, 0), invalid_argument);
+}
+
+TEST_F(Blake2Test, PerformanceXof) {
+    const size_t length = 64 * 1024 * 1024;
+    vector<uint8_t> out(length);
+    auto seed = generateRandomData(64);
+
+    auto start_long = chrono::high_resolution_clock::now();
+    auto chained = shsBlake2::hash_long(seed, length);
+    auto end_long = chrono::high_resolution_clock::now();
+
+    auto start_xof = chrono::high_resolution_clock::now();
+    shsBlake2 xof(shsBlake2::Mode::XOF, length);
+    xof.update(seed);
+    xof.finalize(out.data(), out.size());
+    auto end_xof = chrono::high_resolution_clock::now();
+
+    auto mbs = [&](chrono::high_resolution_clock::time_point a, chrono::high_resolution_clock::time_point b) {
+        return 64.0 / chrono::duration<double>(b - a).count();
+    };
+    cout << "\n64 MB of Blake2b output:\n";
+    cout << "hash_long(): " << setw(8) << fixed << setprecision(1) << mbs(start_long, end_long) << " MB/s\n";
+    cout << "BLAKE2Xb:    " << setw(8) << mbs(start_xof, end_xof) << " MB/s\n";
+}
+
+static shsBlake2::TreeParams treeParams(uint32_t leaf, uint8_t fanout, uint8_t depth, size_t threads = 0) {
+    shsBlake2::TreeParams params;
+    params.leaf_length = leaf;
+    params.fanout = fanout;
+    params.max_depth = depth;
+    params.threads = threads;
+    return params;
+}
+
+TEST_F(Blake2Test, TreeKnownVectors) {
+    vector<uint8_t> data(10000);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = static_cast<uint8_t>(i % 251);
+
+    // Reference values from Python hashlib.blake2b with the same node parameters
+    EXPECT_EQ(toHex(shsBlake2::hash_tree(data, treeParams(1024, 0, 2))),
+              "368af526a3ac75cfea89e957d2e193fa1035eae46ecb4ea1ae5200219e52e905"
+              "f0678ce40775297b4ebf6049d338ac27189796d2aca0f1a030f68cef85adbbe8");
+    EXPECT_EQ(toHex(shsBlake2::hash_tree(data, treeParams(1024, 2, 255))),
+              "f813caa440a77e2c100a0b3654d4132292c3a97d4fd200a4dd57e0dd78d9b94e"
+              "0b1650f364a13d8a0702ca36cc8795cf27ae1e68d34fa89081cc8bd0a9b6334b");
+    EXPECT_EQ(toHex(shsBlake2::hash_tree(data, treeParams(1024, 4, 3))),
+              "4e7502dce6e784efc81d7f7b5b47ce51ed304439871081f48e49f879a161b1ff"
+              "28e2ee3bbd1ba841bcc3b76e854cbc2546d4c474de7afa553c999b25e40e344a");
+    EXPECT_EQ(toHex(shsBlake2::hash_tree(data, treeParams(1024, 4, 3), 32)),
+              "8f643cbaf3ff15435ba428a1e883190a34a1e6772375f138bc9b9180b1c13090");
+    EXPECT_EQ(toHex(shsBlake2::hash_tree(data.data(), 4096, treeParams(1024, 0, 2))),
+              "e761999f3a27858b7a88f0aaeb5a213c5dd40121a1a7a6287af9e8003e566bd5"
+              "0601c6af6cc59c8fb9955971493a0c2617ce10c4727cbed497b1443fab1188b6");
+    EXPECT_EQ(toHex(shsBlake2::hash_tree(nullptr, 0, treeParams(1024, 0, 2))),
+              "2d7ccbf2c9f835c17f9d286535354c98ee7ec87d605c7f5560b44c5a973f1b72"
+              "609c9be5c6618f730df0bf59fcbfa2d2742a71e0023a44174628afd4e0ae3d70");
+
+    EXPECT_THROW(shsBlake2(treeParams(0, 0, 2)), invalid_argument);
+    EXPECT_THROW(shsBlake2(treeParams(1024, 1, 2)), invalid_argument);
+    EXPECT_THROW(shsBlake2(treeParams(1024, 0, 1)), invalid_argument);
+}
+
+TEST_F(Blake2Test, TreeStreamingMatchesOneShot) {
+    auto data = generateRandomData(300 * 1024 + 77);
+    mt19937 gen(7);
+    for (auto params : {treeParams(4096, 0, 2), treeParams(4096, 3, 255),
+                        treeParams(1000, 8, 3, 1), treeParams(128, 2, 255, 3)}) {
+        auto expected = shsBlake2::hash_tree(data, params);
+        for (size_t max_chunk : {size_t(100), size_t(5000), size_t(200000)}) {
+            shsBlake2 hasher(params);
+            size_t offset = 0;
+            while (offset < data.size()) {
+                size_t chunk = min<size_t>(gen() % max_chunk + 1, data.size() - offset);
+                hasher.update(data.data() + offset, chunk);
+                offset += chunk;
+            }
+            EXPECT_EQ(hasher.finalize(), expected)
+                << "leaf=" << params.leaf_length << " chunk=" << max_chunk;
+        }
+    }
+
+    // Single-threaded and pooled runs agree
+    auto params = treeParams(2048, 0, 2, 1);
+    auto single = shsBlake2::hash_tree(data, params);
+    params.threads = 0;
+    EXPECT_EQ(shsBlake2::hash_tree(data, params), single);
+}
+
+TEST_F(Blake2Test, TreeHashFile) {
+    char name[] = "/tmp/shs_blake2_tree_XXXXXX";
+    int fd = mkstemp(name);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+
+    auto params = treeParams(64 * 1024, 0, 2);
+    for (size_t size : {size_t(1000), size_t(5 * 1024 * 1024 + 3)}) {
+        auto data = generateRandomData(size);
+        ofstream(name, ios::binary | ios::trunc).write(reinterpret_cast<const char*>(data.data()), data.size());
+
+        auto result = shsBlake2::hash_file(name, params);
+        EXPECT_EQ(result.digest, shsBlake2::hash_tree(data, params)) << "size=" << size;
+        EXPECT_EQ(result.bytes, size);
+    }
+    remove(name);
+}
+
+TEST_F(Blake2Test, PerformanceTree) {
+    const size_t size = 256 * 1024 * 1024;
+    vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) data[i] = static_cast<uint8_t>(i * 31 + (i >> 13));
+
+    auto measure = [&](size_t threads) {
+        auto start = chrono::high_resolution_clock::now();
+        shsBlake2::hash_tree(data, treeParams(1 << 20, 0, 2, threads));
+        auto end = chrono::high_resolution_clock::now();
+        return 256.0 / chrono::duration<double>(end - start).count();
+    };
+    cout << "\nBlake2b tree mode, 256 MB, 1 MiB leaves:\n";
+    for (size_t threads : {size_t(1), size_t(2), size_t(4), size_t(0)}) {
+        double rate = measure(threads);
+        cout << (threads ? to_string(threads) : string("all")) << " threads: "
+             << setw(8) << fixed << setprecision(1) << rate << " MB/s\n";
+    }
+}
+
+TEST_F(Blake2Test, StateCheckpointRoundTrip) {
+    const vector<uint8_t> mac_key = {'c', 'h', 'e', 'c', 'k', 'p', 'o', 'i', 'n', 't'};
+    const vector<uint8_t> key = {1, 2, 3, 4, 5};
+    auto data = generateRandomData(100000);
+    shsBlake2::Template prepared(key.data(), key.size(), 32);
+
+    using Factory = function<unique_ptr<shsBlake2>()>;
+    const vector<pair<const char*, Factory>> modes = {
+        {"sequential", [&] { return make_unique<shsBlake2>(key, 48); }},
+        {"template", [&] { return make_unique<shsBlake2>(prepared); }},
+        {"parallel", [&] { return make_unique<shsBlake2>(shsBlake2::Mode::Parallel, key.data(), key.size()); }},
+        {"xof", [&] { return make_unique<shsBlake2>(shsBlake2::Mode::XOF, 1000); }},
+    };
+    for (const auto& mode : modes) {
+        auto whole = mode.second();
+        whole->update(data);
+        auto expected = whole->finalize();
+
+        for (size_t cut : {size_t(0), size_t(128), size_t(777), size_t(4 * 128 * 10)}) {
+            auto before = mode.second();
+            before->update(data.data(), cut);
+            auto blob = before->export_state(mac_key);
+
+            // The restored hasher takes its mode and length from the blob
+            shsBlake2 after;
+            uint64_t offset = after.import_state(blob, mac_key);
+            ASSERT_EQ(offset, cut);
+            after.update(data.data() + offset, data.size() - offset);
+            EXPECT_EQ(after.finalize(), expected) << mode.first << " cut=" << cut;
+        }
+    }
+
+    shsBlake2 hasher(32);
+    hasher.update(default_data);
+    auto blob = hasher.export_state(mac_key);
+    auto tampered = blob;
+    tampered[100] ^= 0x80;
+    EXPECT_THROW(hasher.import_state(tampered, mac_key), runtime_error);
+    EXPECT_THROW(hasher.import_state(blob, key), runtime_error);
+    EXPECT_THROW(hasher.import_state(vector<uint8_t>(10), mac_key), invalid_argument);
+    EXPECT_THROW(hasher.export_state(nullptr, 0), invalid_argument);
+    EXPECT_EQ(hasher.finalize(), shsBlake2::hash(default_data, 32));
+
+    shsBlake2 tree(treeParams(1024, 0, 2));
+    EXPECT_THROW(tree.export_state(mac_key), runtime_error);
+    shsBlake2 squeezed(shsBlake2::Mode::XOF, 100);
+    squeezed.squeeze(10);
+    EXPECT_THROW(squeezed.export_state(mac_key), runtime_error);
+}
+
+TEST_F(Blake2Test, OneBlockFastPath) {
+    auto data = generateRandomData(300);
+    for (size_t length = 0; length <= 300; ++length) {
+        for (size_t outlen : {size_t(1), size_t(20), size_t(32), size_t(64)}) {
+            shsBlake2 streaming(outlen);
+            streaming.update(data.data(), length);
+            auto expected = streaming.finalize();
+
+            vector<uint8_t> out(outlen);
+            shsBlake2::hash_into(data.data(), length, out.data(), outlen);
+            ASSERT_EQ(out, expected) << "length=" << length << " outlen=" << outlen;
+            ASSERT_EQ(shsBlake2::hash(data.data(), length, outlen), expected);
+        }
+    }
+
+    auto digest = shsBlake2::hash_array(nullptr, 0);
+    EXPECT_EQ(toHex(vector<uint8_t>(digest.begin(), digest.end())),
+              "786a02f742015903c6c6fd852552d272912f4740e15847618a86e217f71f5419"
+              "d25e1031afee585313896444934eb04b903a685b1448b755d56f701afe9be2ce");
+    auto short_digest = shsBlake2::hash_array<32>("abc", 3);
+    EXPECT_EQ(vector<uint8_t>(short_digest.begin(), short_digest.end()), shsBlake2::hash(string("abc"), 32));
+
+    uint8_t out[64];
+    EXPECT_THROW(shsBlake2::hash_into(data.data(), 10, out, 0), invalid_argument);
+    EXPECT_THROW(shsBlake2::hash_into(data.data(), 10, out, 65), invalid_argument);
+    EXPECT_THROW(shsBlake2::hash_into(nullptr, 10, out), invalid_argument);
+}
+
+TEST_F(Blake2Test, PerformanceSmallMessages) {
+    const int iterations = 1000000;
+    auto data = generateRandomData(64);
+    uint8_t out[32];
+
+    auto start_stream = chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        shsBlake2 hasher(32);
+        hasher.update(data.data(), data.size());
+        hasher.finalize(out, sizeof(out));
+        data[0] = out[0];
+    }
+    auto end_stream = chrono::high_resolution_clock::now();
+
+    auto start_into = chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        shsBlake2::hash_into(data.data(), data.size(), out, sizeof(out));
+        data[0] = out[0];
+    }
+    auto end_into = chrono::high_resolution_clock::now();
+
+    auto ns = [&](chrono::high_resolution_clock::time_point a, chrono::high_resolution_clock::time_point b) {
+        return chrono::duration<double, nano>(b - a).count() / iterations;
+    };
+    cout << "\nBlake2b-256 of 64-byte messages:\n";
+    cout << "hasher object: " << setw(8) << fixed << setprecision(1) << ns(start_stream, end_stream) << " ns\n";
+    cout << "hash_into():   " << setw(8) << ns(start_into, end_into) << " ns\n";
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
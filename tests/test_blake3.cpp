@@ -0,0 +1,343 @@
+#include <gtest/gtest.h>
+#include "shsBlake3.hpp"
+#include "shsBlake2.hpp"
+#include "blake3-impl.h"
+#include <vector>
+#include <string>
+#include <array>
+#include <random>
+#include <cstring>
+#include <iomanip>
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+#include <chrono>
+#include <sstream>
+
+using namespace std;
+
+class Blake3Test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        default_data = "Test message for BLAKE3 hashing";
+        for (size_t i = 0; i < test_key.size(); ++i) test_key[i] = static_cast<uint8_t>(i);
+    }
+
+    vector<uint8_t> generateRandomData(size_t length) {
+        vector<uint8_t> data(length);
+        random_device rd;
+        mt19937 gen(rd());
+        uniform_int_distribution<> dis(0, 255);
+
+        for (auto& byte : data) {
+            byte = static_cast<uint8_t>(dis(gen));
+        }
+        return data;
+    }
+
+    // The pattern of the official BLAKE3 test vectors
+    static vector<uint8_t> patternData(size_t length) {
+        vector<uint8_t> data(length);
+        for (size_t i = 0; i < length; ++i) data[i] = static_cast<uint8_t>(i % 251);
+        return data;
+    }
+
+    string default_data;
+    array<uint8_t, 32> test_key;
+    const string context = "BLAKE3 2019-12-27 16:29:52 test vectors context";
+};
+
+static string toHex(const vector<uint8_t>& data) {
+    ostringstream out;
+    for (auto byte : data) {
+        out << hex << setw(2) << setfill('0') << static_cast<int>(byte);
+    }
+    return out.str();
+}
+
+TEST_F(Blake3Test, DefaultConstructor) {
+    shsBlake3 hasher;
+    hasher.update(default_data);
+    auto hash = hasher.finalize();
+    EXPECT_EQ(hash.size(), shsBlake3::DEFAULT_OUTPUT_SIZE);
+}
+
+TEST_F(Blake3Test, InvalidParameters) {
+    EXPECT_THROW(shsBlake3(0), invalid_argument);
+    vector<uint8_t> short_key(16);
+    EXPECT_THROW(shsBlake3{short_key}, invalid_argument);
+    EXPECT_THROW(shsBlake3::hash_keyed(default_data.data(), default_data.size(), nullptr, 32),
+                 invalid_argument);
+
+    shsBlake3 hasher;
+    vector<uint8_t> out(16);
+    EXPECT_THROW(hasher.finalize(out.data(), out.size()), invalid_argument);
+}
+
+// Reference values from the BLAKE3 reference implementation; key = 00..1f
+TEST_F(Blake3Test, KnownVectors) {
+    struct Vector {
+        size_t length;
+        const char* hash;
+        const char* keyed;
+        const char* derived;
+    };
+    const Vector vectors[] = {
+        {0, "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262",
+            "73492b19995d71cdb1e9d74decc09809eb732f1b00bc95c27cb15f9dd4d6478f",
+            "2cc39783c223154fea8dfb7c1b1660f2ac2dcbd1c1de8277b0b0dd39b7e50d7d"},
+        {1, "2d3adedff11b61f14c886e35afa036736dcd87a74d27b5c1510225d0f592e213",
+            "d08b45c6b127ee94f3f8527a0b82a5f80be1695a0eaec6022e772c0eb95a7e8b",
+            "b3e2e340a117a499c6cf2398a19ee0d29cca2bb7404c73063382693bf66cb06c"},
+        {1023, "10108970eeda3eb932baac1428c7a2163b0e924c9a9e25b35bba72b28f70bd11",
+               "da1f18069871512af22af9f13dc005800dfd52c55f42753b5ae718086fe2ee44",
+               "74a16c1c3d44368a86e1ca6df64be6a2f64cce8f09220787450722d85725dea5"},
+        {1024, "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7",
+               "f45a9249a627fdf1fcf13c0e6376f6a9a9b2056d6e1b5693a4b119a3453665f9",
+               "7356cd7720d5b66b6d0697eb3177d9f8d73a4a5c5e968896eb6a689684302706"},
+        {1025, "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444",
+               "82223147a9b804a0c3f9a921b8d8aee250d1a51bb76be72152e6d5e8f27349b3",
+               "effaa245f065fbf82ac186839a249707c3bddf6d3fdda22d1b95a3c970379bcb"},
+        {2048, "e776b6028c7cd22a4d0ba182a8bf62205d2ef576467e838ed6f2529b85fba24a",
+               "636bfa717d4f9fc3e59da9b2e5cce6a2b78eb70469c0fce49da38b5419892423",
+               "7b2945cb4fef70885cc5d78a87bf6f6207dd901ff239201351ffac04e1088a23"},
+        {2049, "5f4d72f40d7a5f82b15ca2b2e44b1de3c2ef86c426c95c1af0b6879522563030",
+               "5442eec85e3fd173dcff07c39cd8cff9689f17224471e655618ed728cf03b056",
+               "2ea477c5515cc3dd606512ee72bb3e0e758cfae7232826f35fb98ca1bcbdf273"},
+        {3072, "b98cb0ff3623be03326b373de6b9095218513e64f1ee2edd2525c7ad1e5cffd2",
+               "66315151ac08f5cdf077f76e1b5f584a4da7b48a75036de5729be38dac835fb7",
+               "050df97f8c2ead654d9bb3ab8c9178edcd902a32f8495949feadcc1e0480c46b"},
+        {4097, "9b4052b38f1c5fc8b1f9ff7ac7b27cd242487b3d890d15c96a1c25b8aa0fb995",
+               "a3b7fe277011b5efcde8a33d90b0edb88c29e73831f34d9b02aebab51c98e2a6",
+               "aca51029626b55fda7117b42a7c211f8c6e9ba4fe5b7a8ca922f34299500ead8"},
+        {8193, "bab6c09cb8ce8cf459261398d2e7aef35700bf488116ceb94a36d0f5f1b7bc3b",
+               "c666ccf5fa240c07a9d0a6b8ae92c67668b482e7c2751fb5e1d9d7078fa9637e",
+               "af1e0346e389b17c23200270a64aa4e1ead98c61695d917de7d5b00491c9b0f1"},
+        {31744, "62b6960e1a44bcc1eb1a611a8d6235b6b4b78f32e7abc4fb4c6cdcce94895c47",
+                "55253f057bce59e7811fea47ac0e72751ca12c40c4a5b8f3c42e54daa5073272",
+                "39772aef80e0ebe60596361e45b061e8f417429d529171b6764468c22928e28e"},
+        {102400, "bc3e3d41a1146b069abffad3c0d44860cf664390afce4d9661f7902e7943e085",
+                 "ab2ecf0478e816065ba6039d8ec583cbce8a2335efe903e2d7313c04ba5330d2",
+                 "4652cff7a3f385a6103b5c260fc1593e13c778dbe608efb092fe7ee69df6e9c6"},
+    };
+    vector<uint8_t> key(test_key.begin(), test_key.end());
+    for (const auto& v : vectors) {
+        auto data = patternData(v.length);
+        EXPECT_EQ(toHex(shsBlake3::hash(data)), v.hash) << "length=" << v.length;
+        EXPECT_EQ(toHex(shsBlake3::hash_keyed(data, key)), v.keyed) << "length=" << v.length;
+        EXPECT_EQ(toHex(shsBlake3::derive_key(context, data)), v.derived) << "length=" << v.length;
+        EXPECT_EQ(toHex(shsBlake3::hash_parallel(data)), v.hash) << "length=" << v.length;
+    }
+}
+
+TEST_F(Blake3Test, StreamingMatchesOneShot) {
+    auto data = generateRandomData(300000);
+    auto expected = shsBlake3::hash(data);
+    auto expected_keyed = shsBlake3::hash_keyed(data.data(), data.size(), test_key.data(), test_key.size());
+
+    // Piece sizes that straddle block, chunk and subtree boundaries
+    for (size_t piece : {size_t(1), size_t(63), size_t(64), size_t(1000), size_t(1024),
+                         size_t(4097), size_t(65536), size_t(100000)}) {
+        shsBlake3 hasher;
+        shsBlake3 keyed(test_key);
+        size_t limit = piece == 1 ? 20000 : data.size();
+        for (size_t pos = 0; pos < limit; pos += piece) {
+            size_t n = min(piece, limit - pos);
+            hasher.update(data.data() + pos, n);
+            keyed.update_parallel(data.data() + pos, n);
+        }
+        if (limit == data.size()) {
+            EXPECT_EQ(hasher.finalize(), expected) << "piece=" << piece;
+            EXPECT_EQ(keyed.finalize(), expected_keyed) << "piece=" << piece;
+        } else {
+            EXPECT_EQ(hasher.finalize(), shsBlake3::hash(data.data(), limit));
+        }
+    }
+
+    // finalize() leaves the hasher usable
+    shsBlake3 hasher;
+    hasher.update(data.data(), 5000);
+    EXPECT_EQ(hasher.finalize(), shsBlake3::hash(data.data(), 5000));
+    hasher.update(data.data() + 5000, data.size() - 5000);
+    EXPECT_EQ(hasher.finalize(), expected);
+}
+
+TEST_F(Blake3Test, ParallelMatchesSerial) {
+    // Over the 64 MiB subtree cap, and at an unaligned length
+    const size_t size = 80 * 1024 * 1024 + 12345;
+    vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) data[i] = static_cast<uint8_t>(i * 31 + (i >> 13));
+
+    auto serial = shsBlake3::hash(data);
+    EXPECT_EQ(shsBlake3::hash_parallel(data), serial);
+
+    shsBlake3 two_threads;
+    two_threads.update_parallel(data.data(), 3 * 1024 * 1024 + 1);
+    two_threads.update_parallel(data.data() + 3 * 1024 * 1024 + 1, size - 3 * 1024 * 1024 - 1, 2);
+    EXPECT_EQ(two_threads.finalize(), serial);
+}
+
+// Every SIMD kernel the CPU can run against the portable one
+static vector<pair<const char*, blake3_hash_many_fn>> availableKernels() {
+    vector<pair<const char*, blake3_hash_many_fn>> kernels = {{"portable", blake3_hash_many_portable}};
+#ifdef BLAKE3_HAVE_SIMD
+    if (shs_cpu_has_sse41()) kernels.push_back({"sse41", blake3_hash_many_sse41});
+    if (shs_cpu_has_avx2()) kernels.push_back({"avx2", blake3_hash_many_avx2});
+    if (shs_cpu_has_avx512f()) kernels.push_back({"avx512", blake3_hash_many_avx512});
+#endif
+    return kernels;
+}
+
+TEST_F(Blake3Test, HashManyKernelsMatchPortable) {
+    const size_t inputs = 37;
+    auto data = generateRandomData(inputs * BLAKE3_CHUNK_LEN);
+    vector<const uint8_t*> chunks(inputs);
+    for (size_t i = 0; i < inputs; ++i) chunks[i] = data.data() + i * BLAKE3_CHUNK_LEN;
+    uint32_t key[8];
+    memcpy(key, BLAKE3_IV, sizeof(key));
+
+    // Whole chunks with a counter crossing 2^32, then single parent blocks
+    for (size_t count = 1; count <= inputs; ++count) {
+        vector<uint8_t> expected(count * BLAKE3_OUT_LEN), got(count * BLAKE3_OUT_LEN);
+        const uint64_t counter = 0xFFFFFFF0ULL;
+        blake3_hash_many_portable(chunks.data(), count, BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN, key,
+                                  counter, true, KEYED_HASH, CHUNK_START, CHUNK_END, expected.data());
+        for (auto& kernel : availableKernels()) {
+            kernel.second(chunks.data(), count, BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN, key,
+                          counter, true, KEYED_HASH, CHUNK_START, CHUNK_END, got.data());
+            ASSERT_EQ(got, expected) << kernel.first << " count=" << count;
+        }
+
+        blake3_hash_many_portable(chunks.data(), count, 1, key, 0, false, PARENT, 0, 0, expected.data());
+        for (auto& kernel : availableKernels()) {
+            kernel.second(chunks.data(), count, 1, key, 0, false, PARENT, 0, 0, got.data());
+            ASSERT_EQ(got, expected) << kernel.first << " parents=" << count;
+        }
+    }
+
+#ifdef BLAKE3_HAVE_SIMD
+    if (shs_cpu_has_sse41()) {
+        for (int trial = 0; trial < 100; ++trial) {
+            auto block = generateRandomData(BLAKE3_BLOCK_LEN);
+            uint32_t cv1[8], cv2[8];
+            memcpy(cv1, block.data(), sizeof(cv1));
+            memcpy(cv2, block.data(), sizeof(cv2));
+            uint8_t len = static_cast<uint8_t>(trial % 65);
+            uint64_t counter = 0x123456789ULL * trial;
+            blake3_compress_in_place_portable(cv1, block.data(), len, counter, CHUNK_END | ROOT);
+            blake3_compress_in_place_sse41(cv2, block.data(), len, counter, CHUNK_END | ROOT);
+            ASSERT_EQ(memcmp(cv1, cv2, sizeof(cv1)), 0);
+
+            uint8_t out1[64], out2[64];
+            blake3_compress_xof_portable(cv1, block.data(), len, counter, ROOT, out1);
+            blake3_compress_xof_sse41(cv1, block.data(), len, counter, ROOT, out2);
+            ASSERT_EQ(memcmp(out1, out2, sizeof(out1)), 0);
+        }
+    }
+#endif
+}
+
+TEST_F(Blake3Test, XofSqueezeAndSeek) {
+    auto data = patternData(1025);
+    const size_t total = 200000;
+
+    shsBlake3 whole(total);
+    whole.update(data);
+    auto expected = whole.finalize();
+    ASSERT_EQ(expected.size(), total);
+    // The default-length digest is a prefix of every longer output
+    EXPECT_EQ(vector<uint8_t>(expected.begin(), expected.begin() + 32), shsBlake3::hash(data));
+    EXPECT_EQ(toHex(vector<uint8_t>(expected.begin(), expected.begin() + 131)),
+              "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444"
+              "f4c4a22b4b399155358a994e52bf255de60035742ec71bd08ac275a1b51cc6bf"
+              "e332b0ef84b409108cda080e6269ed4b3e2c3f7d722aa4cdc98d16deb554e562"
+              "7be8f955c98e1d5f9565a9194cad0c4285f93700062d9595adb992ae68ff1280"
+              "0ab67a");
+    EXPECT_EQ(toHex(vector<uint8_t>(expected.end() - 20, expected.end())),
+              "a9b066a791492e67b8db163ffd88c660e62dbdb2");
+
+    shsBlake3 pieces;
+    pieces.update(data.data(), 700);
+    pieces.update(data.data() + 700, 325);
+    mt19937 gen(5);
+    size_t pos = 0;
+    while (pos < 50000) {
+        size_t n = gen() % 300;
+        ASSERT_EQ(pieces.squeeze(n), vector<uint8_t>(expected.begin() + pos, expected.begin() + pos + n));
+        pos += n;
+    }
+
+    pieces.seek(100000);
+    EXPECT_EQ(toHex(pieces.squeeze(40)),
+              "5f37187fb4c6c522060b8409101a938318e98567605b24e78d9cdbb2fdfb272f"
+              "90191b2c2e9cb408");
+    pieces.seek(12345);
+    EXPECT_EQ(pieces.squeeze(100000), vector<uint8_t>(expected.begin() + 12345, expected.begin() + 112345));
+    EXPECT_THROW(pieces.update(default_data), runtime_error);
+}
+
+TEST_F(Blake3Test, HashFile) {
+    char name[] = "/tmp/shs_blake3_XXXXXX";
+    int fd = mkstemp(name);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+
+    // Below and above the mmap threshold
+    for (size_t size : {size_t(0), size_t(1000), size_t(3 * 1024 * 1024 + 17)}) {
+        auto data = generateRandomData(size);
+        ofstream(name, ios::binary | ios::trunc).write(reinterpret_cast<const char*>(data.data()), data.size());
+
+        auto result = shsBlake3::hash_file(name);
+        EXPECT_EQ(result.digest, shsBlake3::hash(data)) << "size=" << size;
+        EXPECT_EQ(result.bytes, size);
+        EXPECT_EQ(shsBlake3::hash_file(name, 64).digest, shsBlake3::hash(data, 64));
+    }
+    remove(name);
+    EXPECT_THROW(shsBlake3::hash_file("/nonexistent/shs_blake3"), runtime_error);
+}
+
+TEST_F(Blake3Test, PerformanceHashManyBackends) {
+    const size_t chunks = 16 * 1024;
+    auto data = generateRandomData(chunks * BLAKE3_CHUNK_LEN);
+    vector<const uint8_t*> inputs(chunks);
+    for (size_t i = 0; i < chunks; ++i) inputs[i] = data.data() + i * BLAKE3_CHUNK_LEN;
+    vector<uint8_t> out(chunks * BLAKE3_OUT_LEN);
+
+    cout << "\nBLAKE3 chunk hashing by backend (selected: " << shsBlake3::backend() << "):\n";
+    for (auto& kernel : availableKernels()) {
+        auto start = chrono::high_resolution_clock::now();
+        for (int rep = 0; rep < 4; ++rep) {
+            kernel.second(inputs.data(), chunks, BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN, BLAKE3_IV, 0,
+                          true, 0, CHUNK_START, CHUNK_END, out.data());
+        }
+        auto end = chrono::high_resolution_clock::now();
+        double seconds = chrono::duration<double>(end - start).count();
+        cout << setw(10) << kernel.first << ": " << setw(8) << fixed << setprecision(1)
+             << 4 * 16.0 / seconds << " MB/s\n";
+    }
+}
+
+TEST_F(Blake3Test, PerformanceVsBlake2b) {
+    const size_t size = 128 * 1024 * 1024;
+    vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) data[i] = static_cast<uint8_t>(i * 31 + (i >> 13));
+
+    auto measure = [&](const function<void()>& run) {
+        auto start = chrono::high_resolution_clock::now();
+        run();
+        auto end = chrono::high_resolution_clock::now();
+        return 128.0 / chrono::duration<double>(end - start).count();
+    };
+    cout << "\n128 MB:\n";
+    cout << "Blake2b:                " << setw(8) << fixed << setprecision(1)
+         << measure([&] { shsBlake2::hash(data); }) << " MB/s\n";
+    cout << "BLAKE3:                 " << setw(8)
+         << measure([&] { shsBlake3::hash(data); }) << " MB/s\n";
+    cout << "BLAKE3 hash_parallel(): " << setw(8)
+         << measure([&] { shsBlake3::hash_parallel(data); }) << " MB/s\n";
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "shsHKDFSHA512.hpp"
+#include "shsHMACSHA512.hpp"
+#include <vector>
+#include <string>
+#include <array>
+#include <random>
+#include <stdexcept>
+
+using namespace std;
+
+class HKDFSHA512Test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // RFC 5869 test case 1 inputs
+        ikm = vector<uint8_t>(22, 0x0b);
+        for (uint8_t i = 0; i <= 0x0c; ++i) salt.push_back(i);
+        for (uint8_t i = 0xf0; i <= 0xf9; ++i) info.push_back(i);
+    }
+
+    static vector<uint8_t> fromHex(const string& hex) {
+        vector<uint8_t> out(hex.size() / 2);
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = static_cast<uint8_t>(stoi(hex.substr(2 * i, 2), nullptr, 16));
+        }
+        return out;
+    }
+
+    // Straight from the RFC, one HMAC object per block
+    static vector<uint8_t> referenceExpand(const vector<uint8_t>& prk,
+                                           const vector<uint8_t>& info, size_t length) {
+        vector<uint8_t> okm, t;
+        for (uint8_t i = 1; okm.size() < length; ++i) {
+            vector<uint8_t> msg(t);
+            msg.insert(msg.end(), info.begin(), info.end());
+            msg.push_back(i);
+            auto block = shsHMACSHA512::hash(prk, msg);
+            t.assign(block.begin(), block.end());
+            okm.insert(okm.end(), t.begin(), t.end());
+        }
+        okm.resize(length);
+        return okm;
+    }
+
+    vector<uint8_t> ikm;
+    vector<uint8_t> salt;
+    vector<uint8_t> info;
+};
+
+TEST_F(HKDFSHA512Test, KnownVectors) {
+    auto prk = shsHKDFSHA512::extract(salt, ikm);
+    auto expected_prk = fromHex(
+        "665799823737ded04a88e47e54a5890bb2c3d247c7a4254a8e61350723590a26"
+        "c36238127d8661b88cf80ef802d57e2f7cebcf1e00e083848be19929c61b4237");
+    EXPECT_TRUE(equal(prk.begin(), prk.end(), expected_prk.begin()));
+
+    EXPECT_EQ(shsHKDFSHA512::derive(salt, ikm, info, 42), fromHex(
+        "832390086cda71fb47625bb5ceb168e4c8e26a1a16ed34d9fc7fe92c14815793"
+        "38da362cb8d9f925d7cb"));
+
+    // No salt and no info
+    EXPECT_EQ(shsHKDFSHA512::derive({}, ikm, {}, 42), fromHex(
+        "f5fa02b18298a72a8c23898a8703472c6eb179dc204c03425c970e3b164bf90f"
+        "ff22d04836d0e2343bac"));
+}
+
+TEST_F(HKDFSHA512Test, ExpandMatchesReference) {
+    auto prk_arr = shsHKDFSHA512::extract(salt, ikm);
+    vector<uint8_t> prk(prk_arr.begin(), prk_arr.end());
+    shsHKDFSHA512 hkdf(prk);
+
+    for (size_t length : vector<size_t>{0, 1, 63, 64, 65, 128, 200, 1000, shsHKDFSHA512::MAX_OUTPUT_SIZE}) {
+        EXPECT_EQ(hkdf.expand(info, length), referenceExpand(prk, info, length))
+            << "length=" << length;
+    }
+}
+
+TEST_F(HKDFSHA512Test, ExtractConstructorMatchesPrk) {
+    auto prk_arr = shsHKDFSHA512::extract(salt, ikm);
+    shsHKDFSHA512 from_prk(vector<uint8_t>(prk_arr.begin(), prk_arr.end()));
+    shsHKDFSHA512 from_secret(salt, ikm);
+    EXPECT_EQ(from_prk.expand(info, 100), from_secret.expand(info, 100));
+}
+
+TEST_F(HKDFSHA512Test, ManyLabels) {
+    const vector<string> names = {"enc key", "mac key", "client iv", "server iv"};
+    const vector<size_t> sizes = {32, 64, 12, 12};
+
+    vector<vector<uint8_t>> out(names.size());
+    vector<shsHKDFSHA512::Label> labels;
+    for (size_t i = 0; i < names.size(); ++i) {
+        out[i].resize(sizes[i]);
+        labels.push_back({reinterpret_cast<const uint8_t*>(names[i].data()), names[i].size(),
+                          out[i].data(), out[i].size()});
+    }
+
+    shsHKDFSHA512::derive_many(salt.data(), salt.size(), ikm.data(), ikm.size(),
+                               labels.data(), labels.size());
+
+    shsHKDFSHA512 hkdf(salt, ikm);
+    vector<vector<uint8_t>> via_instance(names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        via_instance[i].resize(sizes[i]);
+        labels[i].out = via_instance[i].data();
+    }
+    hkdf.expand_many(labels.data(), labels.size());
+
+    for (size_t i = 0; i < names.size(); ++i) {
+        EXPECT_EQ(out[i], hkdf.expand(names[i], sizes[i]));
+        EXPECT_EQ(out[i], via_instance[i]);
+    }
+    EXPECT_NE(out[2], out[3]);
+}
+
+TEST_F(HKDFSHA512Test, OutputTooLong) {
+    shsHKDFSHA512 hkdf(salt, ikm);
+    EXPECT_THROW(hkdf.expand(info, shsHKDFSHA512::MAX_OUTPUT_SIZE + 1), invalid_argument);
+    EXPECT_THROW(shsHKDFSHA512::derive(salt, ikm, info, shsHKDFSHA512::MAX_OUTPUT_SIZE + 1),
+                 invalid_argument);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
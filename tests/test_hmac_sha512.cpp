@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include "shsHMACSHA512.hpp"
+#include "shsSHA512.hpp"
+#include <vector>
+#include <string>
+#include <array>
+#include <random>
+#include <chrono>
+#include <iomanip>
+
+using namespace std;
+
+class HMACSHA512Test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_key = "secret key for HMAC";
+        test_message = "GET /api/v1/orders?id=42";
+        random_data = generateRandomData(4096);
+    }
+
+    vector<uint8_t> generateRandomData(size_t length) {
+        vector<uint8_t> data(length);
+        random_device rd;
+        mt19937 gen(rd());
+        uniform_int_distribution<> dis(0, 255);
+
+        for (auto& byte : data) {
+            byte = static_cast<uint8_t>(dis(gen));
+        }
+        return data;
+    }
+
+    static array<uint8_t, 64> fromHex(const string& hex) {
+        array<uint8_t, 64> out{};
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = static_cast<uint8_t>(stoi(hex.substr(2 * i, 2), nullptr, 16));
+        }
+        return out;
+    }
+
+    // HMAC(K, m) = H((K ^ opad) || H((K ^ ipad) || m)) without any caching
+    static array<uint8_t, 64> naiveHmac(const vector<uint8_t>& key, const vector<uint8_t>& data) {
+        vector<uint8_t> block(128, 0);
+        if (key.size() > 128) {
+            auto hk = shsSHA512::hash(key);
+            copy(hk.begin(), hk.end(), block.begin());
+        } else {
+            copy(key.begin(), key.end(), block.begin());
+        }
+        vector<uint8_t> ipad(block), opad(block);
+        for (auto& b : ipad) b ^= 0x36;
+        for (auto& b : opad) b ^= 0x5c;
+
+        shsSHA512 inner;
+        inner.update(ipad);
+        inner.update(data);
+        auto inner_hash = inner.finalize();
+
+        shsSHA512 outer;
+        outer.update(opad);
+        outer.update(inner_hash.data(), inner_hash.size());
+        return outer.finalize();
+    }
+
+    string test_key;
+    string test_message;
+    vector<uint8_t> random_data;
+};
+
+TEST_F(HMACSHA512Test, RFC4231Vectors) {
+    // Test case 1
+    vector<uint8_t> key1(20, 0x0b);
+    EXPECT_EQ(shsHMACSHA512::hash(key1, vector<uint8_t>{'H','i',' ','T','h','e','r','e'}),
+              fromHex("87aa7cdea5ef619d4ff0b4241a1d6cb02379f4e2ce4ec2787ad0b30545e17cde"
+                      "daa833b7d6b8a702038b274eaea3f4e4be9d914eeb61f1702e696c203a126854"));
+
+    // Test case 2
+    EXPECT_EQ(shsHMACSHA512::hash(string("Jefe"), string("what do ya want for nothing?")),
+              fromHex("164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+                      "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737"));
+
+    // Test case 6: key longer than one block is hashed first
+    vector<uint8_t> key6(131, 0xaa);
+    string msg6 = "Test Using Larger Than Block-Size Key - Hash Key First";
+    EXPECT_EQ(shsHMACSHA512::hash(key6, vector<uint8_t>(msg6.begin(), msg6.end())),
+              fromHex("80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f352"
+                      "6b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598"));
+}
+
+TEST_F(HMACSHA512Test, MatchesNaiveConstruction) {
+    for (size_t key_len : {0, 1, 64, 127, 128, 129, 300}) {
+        auto key = generateRandomData(key_len);
+        shsHMACSHA512 hmac(key);
+        for (size_t msg_len : {0, 1, 111, 112, 128, 1000}) {
+            vector<uint8_t> msg(random_data.begin(), random_data.begin() + msg_len);
+            EXPECT_EQ(hmac.mac(msg), naiveHmac(key, msg))
+                << "key_len=" << key_len << " msg_len=" << msg_len;
+        }
+    }
+}
+
+TEST_F(HMACSHA512Test, StreamingMatchesOneShot) {
+    shsHMACSHA512 hmac(test_key);
+    auto expected = hmac.mac(random_data);
+
+    const size_t chunk_size = 100;
+    for (size_t i = 0; i < random_data.size(); i += chunk_size) {
+        size_t end = min(i + chunk_size, random_data.size());
+        hmac.update(random_data.data() + i, end - i);
+    }
+    EXPECT_EQ(hmac.finalize(), expected);
+
+    // finalize() resets to the keyed state, so the object is reusable
+    hmac.update(random_data);
+    EXPECT_EQ(hmac.finalize(), expected);
+
+    hmac.update(test_message);
+    hmac.reset();
+    hmac.update(random_data);
+    EXPECT_EQ(hmac.finalize(), expected);
+}
+
+TEST_F(HMACSHA512Test, OneShotDoesNotDisturbStream) {
+    shsHMACSHA512 hmac(test_key);
+    hmac.update(test_message.substr(0, 5));
+    auto unrelated = hmac.mac(random_data);
+    hmac.update(test_message.substr(5));
+    EXPECT_EQ(hmac.finalize(), hmac.mac(test_message));
+    EXPECT_NE(unrelated, hmac.mac(test_message));
+}
+
+TEST_F(HMACSHA512Test, BatchMatchesSingle) {
+    shsHMACSHA512 hmac(test_key);
+    vector<vector<uint8_t>> messages;
+    for (size_t len : {0, 5, 64, 128, 129, 1000}) {
+        messages.push_back(generateRandomData(len));
+    }
+
+    auto tags = hmac.mac_batch(messages);
+    ASSERT_EQ(tags.size(), messages.size());
+
+    vector<const uint8_t*> ptrs;
+    vector<size_t> lengths;
+    for (const auto& m : messages) {
+        ptrs.push_back(m.data());
+        lengths.push_back(m.size());
+    }
+    vector<uint8_t> flat(messages.size() * shsHMACSHA512::OUTPUT_SIZE);
+    hmac.mac_batch(ptrs.data(), lengths.data(), messages.size(), flat.data());
+
+    for (size_t i = 0; i < messages.size(); ++i) {
+        EXPECT_EQ(tags[i], hmac.mac(messages[i]));
+        EXPECT_TRUE(equal(tags[i].begin(), tags[i].end(), flat.begin() + i * 64));
+    }
+}
+
+TEST_F(HMACSHA512Test, Verify) {
+    shsHMACSHA512 hmac(test_key);
+    auto msg = reinterpret_cast<const uint8_t*>(test_message.data());
+    auto tag = hmac.mac(test_message);
+
+    EXPECT_TRUE(hmac.verify(msg, test_message.size(), tag.data()));
+    EXPECT_TRUE(hmac.verify_truncated(msg, test_message.size(), tag.data(), 32));
+    EXPECT_TRUE(hmac.verify_truncated(msg, test_message.size(), tag.data(),
+                                      shsHMACSHA512::MIN_TRUNCATED_TAG_SIZE));
+
+    tag[10] ^= 1;
+    EXPECT_FALSE(hmac.verify(msg, test_message.size(), tag.data()));
+    EXPECT_FALSE(hmac.verify_truncated(msg, test_message.size(), tag.data(), 32));
+    tag[10] ^= 1;
+
+    // Only the last byte differs: the full check must still see it
+    tag[63] ^= 1;
+    EXPECT_FALSE(hmac.verify(msg, test_message.size(), tag.data()));
+    EXPECT_TRUE(hmac.verify_truncated(msg, test_message.size(), tag.data(), 32));
+}
+
+TEST_F(HMACSHA512Test, VerifyRejectsShortTags) {
+    shsHMACSHA512 hmac(test_key);
+    auto msg = reinterpret_cast<const uint8_t*>(test_message.data());
+    auto tag = hmac.mac(test_message);
+
+    // A correct 1-byte prefix must not pass: it could be forged 1 time in 256
+    for (size_t len : {size_t(0), size_t(1), size_t(8), shsHMACSHA512::MIN_TRUNCATED_TAG_SIZE - 1}) {
+        EXPECT_FALSE(hmac.verify_truncated(msg, test_message.size(), tag.data(), len)) << len;
+    }
+    EXPECT_FALSE(hmac.verify_truncated(msg, test_message.size(), tag.data(),
+                                       shsHMACSHA512::OUTPUT_SIZE + 1));
+}
+
+TEST_F(HMACSHA512Test, PerformanceShortMessages) {
+    const int iterations = 100000;
+    vector<uint8_t> key(test_key.begin(), test_key.end());
+    vector<uint8_t> msg(test_message.begin(), test_message.end());
+
+    auto start_naive = chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        naiveHmac(key, msg);
+    }
+    auto end_naive = chrono::high_resolution_clock::now();
+
+    shsHMACSHA512 hmac(key);
+    auto start_cached = chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        hmac.mac(msg);
+    }
+    auto end_cached = chrono::high_resolution_clock::now();
+
+    auto naive_ns = chrono::duration_cast<chrono::nanoseconds>(end_naive - start_naive).count() / iterations;
+    auto cached_ns = chrono::duration_cast<chrono::nanoseconds>(end_cached - start_cached).count() / iterations;
+
+    cout << "\nHMAC-SHA512 on " << msg.size() << "-byte messages (avg per MAC):\n";
+    cout << "Naive (two hashers): " << setw(6) << naive_ns << " ns\n";
+    cout << "Cached pad states:   " << setw(6) << cached_ns << " ns\n";
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include "shsPBKDF2SHA512.hpp"
+#include "shsHMACSHA512.hpp"
+#include "sha512-mb.h"
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <iomanip>
+#include <stdexcept>
+
+using namespace std;
+
+class PBKDF2SHA512Test : public ::testing::Test {
+protected:
+    vector<uint8_t> generateRandomData(size_t length) {
+        vector<uint8_t> data(length);
+        for (auto& byte : data) {
+            byte = static_cast<uint8_t>(gen());
+        }
+        return data;
+    }
+
+    static vector<uint8_t> fromHex(const string& hex) {
+        vector<uint8_t> out(hex.size() / 2);
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = static_cast<uint8_t>(stoi(hex.substr(2 * i, 2), nullptr, 16));
+        }
+        return out;
+    }
+
+    static vector<uint8_t> bytes(const string& s) {
+        return vector<uint8_t>(s.begin(), s.end());
+    }
+
+    // Textbook loop over the HMAC API
+    static vector<uint8_t> referencePbkdf2(const vector<uint8_t>& password, const vector<uint8_t>& salt,
+                                           uint32_t iterations, size_t length) {
+        shsHMACSHA512 hmac(password);
+        vector<uint8_t> dk;
+        for (uint32_t i = 1; dk.size() < length; ++i) {
+            vector<uint8_t> msg(salt);
+            msg.push_back(static_cast<uint8_t>(i >> 24));
+            msg.push_back(static_cast<uint8_t>(i >> 16));
+            msg.push_back(static_cast<uint8_t>(i >> 8));
+            msg.push_back(static_cast<uint8_t>(i));
+            auto u = hmac.mac(msg);
+            auto t = u;
+            for (uint32_t j = 1; j < iterations; ++j) {
+                u = hmac.mac(u.data(), u.size());
+                for (size_t k = 0; k < t.size(); ++k) t[k] ^= u[k];
+            }
+            dk.insert(dk.end(), t.begin(), t.end());
+        }
+        dk.resize(length);
+        return dk;
+    }
+
+    mt19937 gen{12345};
+};
+
+TEST_F(PBKDF2SHA512Test, KnownVectors) {
+    EXPECT_EQ(shsPBKDF2SHA512::derive("password", bytes("salt"), 1), fromHex(
+        "867f70cf1ade02cff3752599a3a53dc4af34c7a669815ae5d513554e1c8cf252"
+        "c02d470a285a0501bad999bfe943c08f050235d7d68b1da55e63f73b60a57fce"));
+    EXPECT_EQ(shsPBKDF2SHA512::derive("password", bytes("salt"), 2), fromHex(
+        "e1d9c16aa681708a45f5c7c4e215ceb66e011a2e9f0040713f18aefdb866d53c"
+        "f76cab2868a39b9f7840edce4fef5a82be67335c77a6068e04112754f27ccf4e"));
+    EXPECT_EQ(shsPBKDF2SHA512::derive("password", bytes("salt"), 4096), fromHex(
+        "d197b1b33db0143e018b12f3d1d1479e6cdebdcc97c5c0f87f6902e072f457b5"
+        "143f30602641b3d55cd335988cb36b84376060ecd532e039b742a239434af2d5"));
+    EXPECT_EQ(shsPBKDF2SHA512::derive("passwordPASSWORDpassword",
+                                      bytes("saltSALTsaltSALTsaltSALTsaltSALTsalt"), 4096), fromHex(
+        "8c0511f4c6e597c6ac6315d8f0362e225f3c501495ba23b868c005174dc4ee71"
+        "115b59f9e60cd9532fa33e0f75aefe30225c583a186cd82bd4daea9724a3d3b8"));
+}
+
+TEST_F(PBKDF2SHA512Test, MultiBlockOutputMatchesReference) {
+    auto password = bytes("legacy password");
+    auto salt = generateRandomData(16);
+    for (size_t length : vector<size_t>{1, 63, 64, 65, 200, 512, 1000}) {
+        vector<uint8_t> out(length);
+        shsPBKDF2SHA512::derive(password.data(), password.size(), salt.data(), salt.size(),
+                                100, out.data(), out.size());
+        EXPECT_EQ(out, referencePbkdf2(password, salt, 100, length)) << "length=" << length;
+    }
+}
+
+TEST_F(PBKDF2SHA512Test, BatchMatchesSingle) {
+    const size_t count = 13;  // not a multiple of any lane width
+    vector<vector<uint8_t>> passwords, salts, outputs;
+    vector<shsPBKDF2SHA512::Job> jobs;
+    for (size_t i = 0; i < count; ++i) {
+        passwords.push_back(generateRandomData(1 + i * 11));
+        salts.push_back(generateRandomData(8 + i));
+        outputs.emplace_back(i % 3 == 0 ? 100 : 64);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t iterations = static_cast<uint32_t>(1 + (i * 37) % 200);
+        jobs.push_back({passwords[i].data(), passwords[i].size(), salts[i].data(), salts[i].size(),
+                        iterations, outputs[i].data(), outputs[i].size()});
+    }
+
+    shsPBKDF2SHA512::derive_batch(jobs.data(), jobs.size());
+
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(outputs[i], referencePbkdf2(passwords[i], salts[i], jobs[i].iterations,
+                                              outputs[i].size())) << "job " << i;
+    }
+}
+
+TEST_F(PBKDF2SHA512Test, MultiBufferKernelsMatchScalar) {
+    uint64_t state4[8][4], block4[16][4];
+    uint64_t state8[8][8], block8[16][8];
+    uint64_t scalar[8][8];
+
+    for (int w = 0; w < 8; ++w) {
+        for (int l = 0; l < 8; ++l) {
+            scalar[w][l] = state8[w][l] = (static_cast<uint64_t>(gen()) << 32) | gen();
+            if (l < 4) state4[w][l] = state8[w][l];
+        }
+    }
+    for (int w = 0; w < 16; ++w) {
+        for (int l = 0; l < 8; ++l) {
+            block8[w][l] = (static_cast<uint64_t>(gen()) << 32) | gen();
+            if (l < 4) block4[w][l] = block8[w][l];
+        }
+    }
+
+    for (int l = 0; l < 8; ++l) {
+        uint64_t s[8], b[16];
+        for (int w = 0; w < 8; ++w) s[w] = scalar[w][l];
+        for (int w = 0; w < 16; ++w) b[w] = block8[w][l];
+        sha512_compress_words(s, b);
+        for (int w = 0; w < 8; ++w) scalar[w][l] = s[w];
+    }
+
+    sha512_compress_words_x4(state4, block4);
+    sha512_compress_words_x8(state8, block8);
+
+    for (int w = 0; w < 8; ++w) {
+        for (int l = 0; l < 8; ++l) {
+            EXPECT_EQ(state8[w][l], scalar[w][l]);
+            if (l < 4) {
+                EXPECT_EQ(state4[w][l], scalar[w][l]);
+            }
+        }
+    }
+}
+
+TEST_F(PBKDF2SHA512Test, Verify) {
+    auto salt = generateRandomData(16);
+    auto stored = shsPBKDF2SHA512::derive("hunter2", salt, 1000);
+    EXPECT_TRUE(shsPBKDF2SHA512::verify("hunter2", salt, 1000, stored));
+    EXPECT_FALSE(shsPBKDF2SHA512::verify("hunter3", salt, 1000, stored));
+    EXPECT_FALSE(shsPBKDF2SHA512::verify("hunter2", salt, 999, stored));
+}
+
+TEST_F(PBKDF2SHA512Test, InvalidParameters) {
+    auto salt = generateRandomData(16);
+    EXPECT_THROW(shsPBKDF2SHA512::derive("password", salt, 0), invalid_argument);
+}
+
+TEST_F(PBKDF2SHA512Test, PerformanceBatch) {
+    const uint32_t iterations = 10000;
+    const size_t count = 16;
+    auto salt = generateRandomData(16);
+
+    vector<string> passwords;
+    vector<vector<uint8_t>> outputs(count, vector<uint8_t>(64));
+    vector<shsPBKDF2SHA512::Job> jobs;
+    for (size_t i = 0; i < count; ++i) {
+        passwords.push_back("candidate-" + to_string(i));
+    }
+    for (size_t i = 0; i < count; ++i) {
+        jobs.push_back({reinterpret_cast<const uint8_t*>(passwords[i].data()), passwords[i].size(),
+                        salt.data(), salt.size(), iterations, outputs[i].data(), outputs[i].size()});
+    }
+
+    auto start_single = chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        shsPBKDF2SHA512::derive(passwords[i], salt, iterations);
+    }
+    auto end_single = chrono::high_resolution_clock::now();
+
+    auto start_batch = chrono::high_resolution_clock::now();
+    shsPBKDF2SHA512::derive_batch(jobs.data(), jobs.size());
+    auto end_batch = chrono::high_resolution_clock::now();
+
+    cout << "\nPBKDF2-HMAC-SHA512, " << iterations << " iterations, " << count
+         << " passwords (" << shsPBKDF2SHA512::lanes() << " SIMD lanes):\n";
+    cout << "One by one: " << setw(8)
+         << chrono::duration_cast<chrono::milliseconds>(end_single - start_single).count() << " ms\n";
+    cout << "Batch:      " << setw(8)
+         << chrono::duration_cast<chrono::milliseconds>(end_batch - start_batch).count() << " ms\n";
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include "shsSHA512.hpp"
+#include "shsSHA384.hpp"
+#include "shsSHA512_256.hpp"
 #include <vector>
 #include <string>
 #include <array>
@@ -7,6 +9,13 @@
 #include <cstring>
 #include <iomanip>
 #include <functional>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sstream>
+#include <algorithm>
 
 using namespace std;
 
@@ -258,6 +267,251 @@ TEST_F(SHA512Test, PerformanceTestDifferentSizes) {
          << " μs\n";
 }
 
+template <size_t N>
+static string toHex(const array<uint8_t, N>& digest) {
+    ostringstream out;
+    for (auto byte : digest) {
+        out << hex << setw(2) << setfill('0') << static_cast<int>(byte);
+    }
+    return out.str();
+}
+
+static const string kTwoBlockMessage =
+    "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+    "hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu";
+
+TEST_F(SHA512Test, SplitUpdatesMatchOneShot) {
+    // Every split point across the buffered/direct block boundaries, from an
+    // unaligned source
+    auto data = generateRandomData(400);
+    for (size_t length : {size_t(111), size_t(112), size_t(128), size_t(255), size_t(399)}) {
+        auto expected = shsSHA512::hash(data.data() + 1, length);
+        for (size_t split = 0; split <= length; ++split) {
+            shsSHA512 hasher;
+            hasher.update(data.data() + 1, split);
+            hasher.update(data.data() + 1 + split, length - split);
+            ASSERT_EQ(hasher.finalize(), expected) << "length=" << length << " split=" << split;
+        }
+    }
+}
+
+TEST_F(SHA512Test, FixedLengthFastPaths) {
+    auto data = generateRandomData(96);
+    array<uint8_t, 32> in32;
+    array<uint8_t, 64> in64;
+    array<uint8_t, 96> in96;
+    copy(data.begin(), data.begin() + 32, in32.begin());
+    copy(data.begin(), data.begin() + 64, in64.begin());
+    copy(data.begin(), data.end(), in96.begin());
+
+    shsSHA512 h32, h64, h96;
+    h32.update(data.data(), 32);
+    h64.update(data.data(), 64);
+    h96.update(data.data(), 96);
+    EXPECT_EQ(shsSHA512::hash(in32), h32.finalize());
+    EXPECT_EQ(shsSHA512::hash(in64), h64.finalize());
+    EXPECT_EQ(shsSHA512::hash(in96), h96.finalize());
+}
+
+TEST_F(SHA512Test, IterateMatchesRepeatedHashing) {
+    array<uint8_t, 64> seed = shsSHA512::hash(test_string);
+    EXPECT_EQ(shsSHA512::iterate(seed, 0), seed);
+
+    auto expected = seed;
+    for (int i = 1; i <= 1000; ++i) {
+        shsSHA512 hasher;
+        hasher.update(expected.data(), expected.size());
+        expected = hasher.finalize();
+        if (i == 1 || i == 2 || i == 1000) {
+            EXPECT_EQ(shsSHA512::iterate(seed, i), expected) << "n=" << i;
+        }
+    }
+}
+
+TEST_F(SHA512Test, PerformanceFixedLength) {
+    const int iterations = 200000;
+    array<uint8_t, 64> node{};
+
+    auto start_generic = chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        shsSHA512 hasher;
+        hasher.update(node.data(), node.size());
+        node = hasher.finalize();
+    }
+    auto end_generic = chrono::high_resolution_clock::now();
+    auto generic = node;
+
+    node = {};
+    auto start_fixed = chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        node = shsSHA512::hash(node);
+    }
+    auto end_fixed = chrono::high_resolution_clock::now();
+    EXPECT_EQ(node, generic);
+
+    node = {};
+    auto start_iter = chrono::high_resolution_clock::now();
+    node = shsSHA512::iterate(node, iterations);
+    auto end_iter = chrono::high_resolution_clock::now();
+    EXPECT_EQ(node, generic);
+
+    auto ns = [&](chrono::high_resolution_clock::time_point a, chrono::high_resolution_clock::time_point b) {
+        return chrono::duration_cast<chrono::nanoseconds>(b - a).count() / iterations;
+    };
+    cout << "\nSHA-512 of a 64-byte digest, " << iterations << " chained calls:\n";
+    cout << "update + finalize: " << setw(6) << ns(start_generic, end_generic) << " ns/hash\n";
+    cout << "hash(array<64>):   " << setw(6) << ns(start_fixed, end_fixed) << " ns/hash\n";
+    cout << "iterate():         " << setw(6) << ns(start_iter, end_iter) << " ns/hash\n";
+}
+
+TEST_F(SHA512Test, SHA384KnownHashValues) {
+    EXPECT_EQ(toHex(shsSHA384::hash("")),
+              "38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da"
+              "274edebfe76f65fbd51ad2f14898b95b");
+    EXPECT_EQ(toHex(shsSHA384::hash("abc")),
+              "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed"
+              "8086072ba1e7cc2358baeca134c825a7");
+    EXPECT_EQ(toHex(shsSHA384::hash(kTwoBlockMessage)),
+              "09330c33f71147e83d192fc782cd1b4753111b173b3b05d22fa08086e3b0f712"
+              "fcc7c71a557e2db966c3e9fa91746039");
+}
+
+TEST_F(SHA512Test, SHA512_256KnownHashValues) {
+    EXPECT_EQ(toHex(shsSHA512_256::hash("")),
+              "c672b8d1ef56ed28ab87c3622c5114069bdd3ad7b8f9737498d0c01ecef0967a");
+    EXPECT_EQ(toHex(shsSHA512_256::hash("abc")),
+              "53048e2681941ef99b2e29b76b4c7dabe4c2d0c634fc6d46e0e2f13107e7af23");
+    EXPECT_EQ(toHex(shsSHA512_256::hash(kTwoBlockMessage)),
+              "3928e184fb8690f840da3988121d31be65cb9d3ef83ee6146feac861e19b563a");
+}
+
+TEST_F(SHA512Test, TruncatedVariantsChunkedUpdate) {
+    shsSHA384 sha384;
+    shsSHA512_256 sha512_256;
+    for (size_t offset = 0; offset < large_data.size(); offset += 1000) {
+        size_t chunk = min<size_t>(1000, large_data.size() - offset);
+        sha384.update(large_data.data() + offset, chunk);
+        sha512_256.update(large_data.data() + offset, chunk);
+    }
+    EXPECT_EQ(sha384.finalize(), shsSHA384::hash(large_data));
+    EXPECT_EQ(sha512_256.finalize(), shsSHA512_256::hash(large_data));
+
+    // Own IVs: not a prefix of the SHA-512 digest
+    auto full = shsSHA512::hash(test_string);
+    auto short_digest = shsSHA512_256::hash(test_string);
+    EXPECT_FALSE(equal(short_digest.begin(), short_digest.end(), full.begin()));
+}
+
+static string writeTempFile(const vector<uint8_t>& data) {
+    char name[] = "/tmp/shs_sha512_XXXXXX";
+    int fd = mkstemp(name);
+    EXPECT_GE(fd, 0);
+    ::close(fd);
+    ofstream(name, ios::binary).write(reinterpret_cast<const char*>(data.data()), data.size());
+    return name;
+}
+
+TEST_F(SHA512Test, HashFile) {
+    // Below and above the mmap threshold
+    for (size_t size : {size_t(0), size_t(1000), large_data.size() * 3 + 17}) {
+        auto data = generateRandomData(size);
+        auto path = writeTempFile(data);
+        auto result = shsSHA512::hash_file(path);
+        EXPECT_EQ(result.digest, shsSHA512::hash(data)) << "size=" << size;
+        EXPECT_EQ(result.bytes, size);
+        remove(path.c_str());
+    }
+    EXPECT_THROW(shsSHA512::hash_file("/nonexistent/shs_sha512"), runtime_error);
+}
+
+TEST_F(SHA512Test, HashFileDescriptor) {
+    auto path = writeTempFile(large_data);
+
+    // Starts at the current offset
+    int fd = ::open(path.c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(::lseek(fd, 100, SEEK_SET), 100);
+    auto result = shsSHA512::hash_file(fd);
+    EXPECT_EQ(result.digest, shsSHA512::hash(large_data.data() + 100, large_data.size() - 100));
+    EXPECT_EQ(::lseek(fd, 0, SEEK_CUR), static_cast<off_t>(large_data.size()));
+    ::close(fd);
+    remove(path.c_str());
+
+    // Pipes go through the double-buffered reader
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    thread writer([&]() {
+        size_t offset = 0;
+        while (offset < large_data.size()) {
+            ssize_t n = ::write(fds[1], large_data.data() + offset,
+                                min<size_t>(12345, large_data.size() - offset));
+            if (n <= 0) break;
+            offset += static_cast<size_t>(n);
+        }
+        ::close(fds[1]);
+    });
+    result = shsSHA512::hash_file(fds[0]);
+    writer.join();
+    ::close(fds[0]);
+    EXPECT_EQ(result.digest, shsSHA512::hash(large_data));
+    EXPECT_EQ(result.bytes, large_data.size());
+}
+
+TEST_F(SHA512Test, PerformanceHashFile) {
+    auto data = generateRandomData(64 * 1024 * 1024);
+    auto path = writeTempFile(data);
+
+    auto start = chrono::high_resolution_clock::now();
+    shsSHA512 hasher;
+    ifstream in(path, ios::binary);
+    vector<char> chunk(64 * 1024);
+    while (in.read(chunk.data(), chunk.size()) || in.gcount() > 0) {
+        hasher.update(reinterpret_cast<const uint8_t*>(chunk.data()), static_cast<size_t>(in.gcount()));
+    }
+    auto chunked = hasher.finalize();
+    auto end = chrono::high_resolution_clock::now();
+    double chunked_mbs = 64.0 / chrono::duration<double>(end - start).count();
+
+    auto result = shsSHA512::hash_file(path);
+    EXPECT_EQ(result.digest, chunked);
+    remove(path.c_str());
+
+    cout << "\nSHA-512 file hashing, 64 MB:\n";
+    cout << "ifstream + update: " << setw(8) << fixed << setprecision(1) << chunked_mbs << " MB/s\n";
+    cout << "hash_file:         " << setw(8) << result.bytes_per_second / (1024 * 1024) << " MB/s\n";
+}
+
+TEST_F(SHA512Test, StateCheckpointRoundTrip) {
+    const vector<uint8_t> mac_key = {'c', 'h', 'e', 'c', 'k', 'p', 'o', 'i', 'n', 't'};
+    auto expected = shsSHA512::hash(large_data);
+
+    // Cut points inside a block and on a block boundary
+    for (size_t cut : {size_t(0), size_t(1000), size_t(128 * 1000)}) {
+        shsSHA512 before;
+        before.update(large_data.data(), cut);
+        auto blob = before.export_state(mac_key);
+
+        shsSHA512 after;
+        uint64_t offset = after.import_state(blob, mac_key);
+        ASSERT_EQ(offset, cut);
+        after.update(large_data.data() + offset, large_data.size() - offset);
+        EXPECT_EQ(after.finalize(), expected) << "cut=" << cut;
+    }
+
+    shsSHA512 hasher;
+    hasher.update(test_string);
+    auto blob = hasher.export_state(mac_key);
+    auto tampered = blob;
+    tampered[30] ^= 1;
+    EXPECT_THROW(hasher.import_state(tampered, mac_key), runtime_error);
+    EXPECT_THROW(hasher.import_state(blob, vector<uint8_t>{'x'}), runtime_error);
+    EXPECT_THROW(hasher.import_state(vector<uint8_t>(blob.begin(), blob.begin() + 40), mac_key),
+                 invalid_argument);
+    EXPECT_THROW(hasher.export_state(vector<uint8_t>()), invalid_argument);
+    // Failed imports leave the hasher as it was
+    EXPECT_EQ(hasher.finalize(), shsSHA512::hash(test_string));
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
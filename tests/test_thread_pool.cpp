@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "shsThreadPool.hpp"
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+TEST(ThreadPoolTest, RunsEveryIndexOnce) {
+    shsThreadPool pool(3);
+    EXPECT_EQ(pool.concurrency(), 4u);
+
+    for (size_t count : {size_t(0), size_t(1), size_t(7), size_t(1000)}) {
+        vector<atomic<int>> hits(count);
+        pool.parallelFor(count, [&](size_t i) { hits[i]++; });
+        for (size_t i = 0; i < count; ++i) {
+            EXPECT_EQ(hits[i].load(), 1) << "count=" << count << " i=" << i;
+        }
+    }
+}
+
+TEST(ThreadPoolTest, NestedLoopsComplete) {
+    shsThreadPool pool(2);
+    atomic<size_t> total{0};
+    pool.parallelFor(8, [&](size_t) {
+        pool.parallelFor(50, [&](size_t j) { total += j; });
+    });
+    EXPECT_EQ(total.load(), 8u * (49 * 50 / 2));
+}
+
+TEST(ThreadPoolTest, MaxThreadsLimitsParticipants) {
+    shsThreadPool pool(4);
+    mutex m;
+    set<thread::id> seen;
+    pool.parallelFor(200, [&](size_t) {
+        this_thread::sleep_for(chrono::microseconds(200));
+        lock_guard<mutex> lock(m);
+        seen.insert(this_thread::get_id());
+    }, 2);
+    EXPECT_LE(seen.size(), 2u);
+
+    seen.clear();
+    pool.parallelFor(50, [&](size_t) {
+        lock_guard<mutex> lock(m);
+        seen.insert(this_thread::get_id());
+    }, 1);
+    EXPECT_EQ(seen.size(), 1u);
+    EXPECT_EQ(*seen.begin(), this_thread::get_id());
+}
+
+TEST(ThreadPoolTest, ExceptionIsRethrown) {
+    shsThreadPool pool(2);
+    atomic<int> calls{0};
+    EXPECT_THROW(pool.parallelFor(100, [&](size_t i) {
+        calls++;
+        if (i == 37) throw runtime_error("boom");
+    }), runtime_error);
+    EXPECT_EQ(calls.load(), 100);
+
+    // The pool is still usable afterwards
+    atomic<int> after{0};
+    pool.parallelFor(10, [&](size_t) { after++; });
+    EXPECT_EQ(after.load(), 10);
+}
+
+TEST(ThreadPoolTest, ConcurrentCallers) {
+    shsThreadPool pool(3);
+    vector<thread> callers;
+    atomic<size_t> total{0};
+    for (int t = 0; t < 4; ++t) {
+        callers.emplace_back([&] {
+            for (int round = 0; round < 20; ++round) {
+                pool.parallelFor(64, [&](size_t) { total++; });
+            }
+        });
+    }
+    for (auto& caller : callers) caller.join();
+    EXPECT_EQ(total.load(), 4u * 20 * 64);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
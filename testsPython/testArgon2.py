@@ -1,5 +1,5 @@
 import pytest
-from ShSlibPy import Argon2Hasher
+from ShSlibPy import Argon2Hasher, Argon2Type
 import time
 from typing import Tuple
 import re
@@ -9,12 +9,12 @@ class TestArgon2Basic:
     def test_hash_password_with_salt_format(self):
         """Проверка формата возвращаемого хеша"""
         result = Argon2Hasher.hashPasswordWithSalt("testPassword")
-        assert '$' in result
+        assert result.startswith('$shs-argon2i$v=16$m=4096,t=3,p=1$')
         
         parts = result.split('$')
-        assert len(parts) == 2
-        assert len(parts[0]) > 0  # salt
-        assert len(parts[1]) > 0  # hash
+        assert len(parts) == 6
+        assert len(parts[4]) > 0  # salt
+        assert len(parts[5]) > 0  # hash
 
     def test_hash_password_with_salt_unique_salts(self):
         """Проверка генерации разных солей для одного пароля"""
@@ -42,7 +42,8 @@ class TestArgon2Basic:
         
         # Изменяем хеш
         parts = stored_hash.split('$')
-        tampered_hash = f"{parts[0]}${parts[1][:-1]}x"  # меняем последний символ
+        parts[5] = parts[5][:-1] + "x"  # меняем последний символ
+        tampered_hash = '$'.join(parts)
         
         assert not Argon2Hasher.verifyPassword(password, tampered_hash)
 
@@ -59,8 +60,8 @@ class TestArgon2Basic:
         
         # Проверяем формат
         parts = stored_hash.split('$')
-        assert len(parts[0]) == 32 * 2  # salt в hex
-        assert len(parts[1]) == 64 * 2   # hash в hex
+        assert len(parts[4]) == 32 * 2  # salt в hex
+        assert len(parts[5]) == 64 * 2   # hash в hex
         
         # Проверяем верификацию
         assert Argon2Hasher.verifyPassword(
@@ -70,6 +71,24 @@ class TestArgon2Basic:
             m_cost=65536,
             out_len=64
         )
+        # Параметры берутся из строки
+        assert Argon2Hasher.verifyPassword(password, stored_hash)
+
+    def test_type_and_lanes(self):
+        """Проверка варианта Argon2 и числа дорожек"""
+        password = "testPassword"
+        for argon_type, name in [(Argon2Type.i, "argon2i"), (Argon2Type.d, "argon2d"),
+                                 (Argon2Type.id, "argon2id")]:
+            stored_hash = Argon2Hasher.hashPasswordWithSalt(
+                password, t_cost=2, m_cost=1 << 12, type=argon_type, lanes=4)
+            assert stored_hash.startswith(f"$shs-{name}$v=16$m=4096,t=2,p=4$")
+
+            params = Argon2Hasher.storedParams(stored_hash)
+            assert params.type == argon_type
+            assert params.lanes == 4
+
+            assert Argon2Hasher.verifyPassword(password, stored_hash, threads=1)
+            assert not Argon2Hasher.verifyPassword("wrongPassword", stored_hash)
 
 # Тесты производительности Argon2
 class TestArgon2Performance:
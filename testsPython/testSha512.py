@@ -1,5 +1,6 @@
 import pytest
 from ShSlibPy import SHA512, sha512_hash, sha512_hash_bytes
+from ShSlibPy import SHA384, SHA512_256, sha384_hash, sha512_256_hash
 import secrets
 import time
 from typing import List
@@ -154,6 +155,25 @@ class TestSHA512Basic:
         
         assert our_hash == ref_hash_list, "Our implementation should match hashlib.sha512"
 
+# SHA-384 и SHA-512/256 на том же ядре
+class TestTruncatedVariants:
+    @pytest.mark.parametrize("data", [b"", b"abc", bytes(range(256)) * 5])
+    def test_compatibility_with_hashlib(self, data):
+        """Сравнение с hashlib.sha384 и hashlib.new('sha512_256')"""
+        assert bytes(sha384_hash(data)) == hashlib.sha384(data).digest()
+        assert bytes(sha512_256_hash(data)) == hashlib.new("sha512_256", data).digest()
+
+    def test_streaming(self, large_data):
+        """Пошаговое обновление совпадает с однократным хешированием"""
+        hasher384 = SHA384()
+        hasher256 = SHA512_256()
+        chunk_size = 4096
+        for i in range(0, len(large_data), chunk_size):
+            hasher384.update_bytes(large_data[i:i + chunk_size])
+            hasher256.update_bytes(large_data[i:i + chunk_size])
+        assert bytes(hasher384.finalize()) == hashlib.sha384(large_data).digest()
+        assert bytes(hasher256.finalize()) == hashlib.new("sha512_256", large_data).digest()
+
 # Тесты производительности SHA512
 class TestSHA512Performance:
     @pytest.fixture(autouse=True)